@@ -1,6 +1,8 @@
 #pragma once
 #include "temp/base/assertion.h"
+#include "temp/base/cpu_feature.h"
 #include "temp/base/define.h"
+#include "temp/base/hash.h"
 #include "temp/base/logger.h"
 #include "temp/base/object_manager.h"
 #include "temp/base/read_file.h"
@@ -10,6 +10,6 @@ constexpr const T clamp(const T& v, const T& low, const T& hight) {
 template <class T, class Compare>
 constexpr const T clamp(const T& v, const T& low, const T& hight,
                         Compare comp) {
-  return std::min(std::max(v, low, comp), high, comp);
+  return std::min(std::max(v, low, comp), hight, comp);
 }
 }  // namespace tmep
\ No newline at end of file
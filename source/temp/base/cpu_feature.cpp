@@ -0,0 +1,54 @@
+﻿#include "temp/base/cpu_feature.h"
+#include "temp/base/define.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace temp {
+
+namespace {
+CpuFeatures DetectCpuFeatures() {
+  CpuFeatures features = {};
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 0);
+  auto max_id = info[0];
+
+  __cpuid(info, 1);
+  bool os_xsave = (info[2] & (1 << 27)) != 0;
+  unsigned long long xcr0 = os_xsave ? _xgetbv(0) : 0;
+  bool os_avx = (xcr0 & 0x6) == 0x6;
+  bool os_avx512 = (xcr0 & 0xe6) == 0xe6;
+
+  features.sse41 = (info[2] & (1 << 19)) != 0;
+  features.avx = os_avx && (info[2] & (1 << 28)) != 0;
+  features.fma = os_avx && (info[2] & (1 << 12)) != 0;
+  features.f16c = os_avx && (info[2] & (1 << 29)) != 0;
+
+  if (max_id >= 7) {
+    __cpuidex(info, 7, 0);
+    features.avx2 = os_avx && (info[1] & (1 << 5)) != 0;
+    features.avx512f = os_avx512 && (info[1] & (1 << 16)) != 0;
+  }
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  features.sse41 = __builtin_cpu_supports("sse4.1");
+  features.avx = __builtin_cpu_supports("avx");
+  features.avx2 = __builtin_cpu_supports("avx2");
+  features.fma = __builtin_cpu_supports("fma");
+  features.f16c = __builtin_cpu_supports("f16c");
+  features.avx512f = __builtin_cpu_supports("avx512f");
+#endif
+  return features;
+}
+}  // namespace
+
+const CpuFeatures& GetCpuFeatures() {
+  static const CpuFeatures features = DetectCpuFeatures();
+  return features;
+}
+
+}  // namespace temp
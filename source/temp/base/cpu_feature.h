@@ -0,0 +1,24 @@
+﻿#pragma once
+
+namespace temp {
+
+/**
+ * @brief Instruction set extensions usable on the running CPU and OS
+ */
+struct CpuFeatures {
+  bool sse41;
+  bool avx;
+  bool avx2;
+  bool fma;
+  bool f16c;
+  bool avx512f;
+};
+
+/**
+ * @brief Get the CPU features detected on first call
+ *
+ * @return const CpuFeatures&
+ */
+const CpuFeatures& GetCpuFeatures();
+
+}  // namespace temp
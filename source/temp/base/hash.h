@@ -0,0 +1,41 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace temp {
+
+const std::uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+const std::uint64_t kFnvPrime = 0x100000001b3ull;
+
+/**
+ * @brief Accumulate FNV-1a hash of bytes
+ *
+ * Start hash from kFnvOffsetBasis.
+ */
+inline void HashBytes(const void* data, std::size_t size,
+                      std::uint64_t* hash) {
+  auto bytes = static_cast<const std::uint8_t*>(data);
+  for (std::size_t i = 0; i < size; ++i) {
+    *hash = (*hash ^ bytes[i]) * kFnvPrime;
+  }
+}
+
+/**
+ * @brief Accumulate hash of object representation of value
+ *
+ * Padding is hashed too, so T must have none.
+ */
+template <class T>
+void HashValue(const T& value, std::uint64_t* hash) {
+  HashBytes(&value, sizeof(value), hash);
+}
+
+template <class T>
+void HashVector(const std::vector<T>& values, std::uint64_t* hash) {
+  HashValue(values.size(), hash);
+  HashBytes(values.data(), sizeof(T) * values.size(), hash);
+}
+
+}  // namespace temp
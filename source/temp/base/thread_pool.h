@@ -111,7 +111,7 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
   return res;
 }
 
-void ThreadPool::waitForTasks() {
+inline void ThreadPool::waitForTasks() {
   while (std::any_of(thread_runnings_.begin(), thread_runnings_.end(),
                      [](std::uint8_t runnings) { return runnings == 1; })) {
   }
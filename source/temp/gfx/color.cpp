@@ -1,6 +1,18 @@
 ﻿#include "temp/gfx/color.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "temp/base/clamp.h"
 
+#include "temp/math/simd.h"
+
+#if defined(TEMP_MATH_SIMD_NEON) && defined(__aarch64__)
+// ベクトルの除算と最近接丸めの変換は AArch64 にしかない
+#define TEMP_GFX_COLOR_NEON
+#endif
+
 namespace temp {
 namespace gfx {
 
@@ -22,17 +34,425 @@ const Color32Bit Color32Bit::kYellow = Color32Bit{0xff, 0xff, 0, 0xff};
 const Color32Bit Color32Bit::kCyan = Color32Bit{0, 0xff, 0xff, 0xff};
 const Color32Bit Color32Bit::kMagenta = Color32Bit{0xff, 0, 0xff, 0xff};
 
+namespace {
+std::uint8_t ToByte(float value) {
+  return static_cast<std::uint8_t>(
+      std::nearbyint(clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+// 8ビットのsRGB値から線形値への表
+const float* SrgbToLinearTable() {
+  static const auto table = [] {
+    struct Table {
+      float values[256];
+    } table;
+    for (int i = 0; i < 256; ++i) {
+      table.values[i] = SrgbToLinear((float)i / 255.0f);
+    }
+    return table;
+  }();
+  return table.values;
+}
+
+#if defined(TEMP_MATH_SIMD_SSE) || defined(TEMP_GFX_COLOR_NEON)
+// 線形値から8ビットのsRGB値への区分線形近似。2^-13 から 1 までの各オクターブを
+// 仮数部の上位3ビットで8区間に分ける。誤差は8ビット値の0.02程度
+struct SrgbSegment {
+  float offset;
+  float slope;
+};
+
+constexpr std::uint32_t kSrgbTableMinBits = 0x39000000;  // 2^-13
+constexpr std::uint32_t kSrgbTableMaxBits = 0x3f7fffff;  // 1 の直前
+constexpr int kSrgbTableShift = 20;
+constexpr int kSrgbTableSize =
+    ((kSrgbTableMaxBits - kSrgbTableMinBits) >> kSrgbTableShift) + 1;
+
+float FromBits(std::uint32_t bits) {
+  float v;
+  std::memcpy(&v, &bits, sizeof(v));
+  return v;
+}
+
+const SrgbSegment* LinearToSrgbTable() {
+  static const auto table = [] {
+    struct Table {
+      SrgbSegment segments[kSrgbTableSize];
+    } table;
+    auto f = [](double x) {
+      return 255.0 * LinearToSrgb(static_cast<float>(x));
+    };
+    for (int i = 0; i < kSrgbTableSize; ++i) {
+      double x0 = FromBits(kSrgbTableMinBits + (i << kSrgbTableShift));
+      double x1 = FromBits(kSrgbTableMinBits + ((i + 1) << kSrgbTableShift));
+      // 両端を結ぶ直線を、区間内の最大誤差が最小になるようにずらす
+      double slope = (f(x1) - f(x0)) / (x1 - x0);
+      double low = 0.0;
+      double high = 0.0;
+      const int kSamples = 64;
+      for (int s = 1; s < kSamples; ++s) {
+        double x = x0 + (x1 - x0) * s / kSamples;
+        double d = f(x) - (f(x0) + slope * (x - x0));
+        low = std::min(low, d);
+        high = std::max(high, d);
+      }
+      table.segments[i].offset =
+          static_cast<float>(f(x0) - slope * x0 + (low + high) * 0.5);
+      table.segments[i].slope = static_cast<float>(slope);
+    }
+    return table;
+  }();
+  return table.segments;
+}
+
+#if defined(TEMP_MATH_SIMD_SSE)
+// RGBA 各1要素を floatx4 1つで扱う。アルファはレーン3
+__m128 AlphaLaneMask() {
+  return _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+}
+
+__m128 Clamp01(__m128 v) {
+  return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+// [0, 255] の4ピクセル分を丸めて16バイトに詰める
+__m128i PackBytes(__m128 p0, __m128 p1, __m128 p2, __m128 p3) {
+  auto lo = _mm_packs_epi32(_mm_cvtps_epi32(p0), _mm_cvtps_epi32(p1));
+  auto hi = _mm_packs_epi32(_mm_cvtps_epi32(p2), _mm_cvtps_epi32(p3));
+  return _mm_packus_epi16(lo, hi);
+}
+
+__m128 LinearToSrgb(__m128 linear, const SrgbSegment* table) {
+  auto c = _mm_min_ps(
+      _mm_max_ps(linear, _mm_castsi128_ps(_mm_set1_epi32(kSrgbTableMinBits))),
+      _mm_castsi128_ps(_mm_set1_epi32(kSrgbTableMaxBits)));
+  alignas(16) std::uint32_t index[4];
+  auto offset_bits = _mm_sub_epi32(_mm_castps_si128(c),
+                                   _mm_set1_epi32(kSrgbTableMinBits));
+  _mm_store_si128(reinterpret_cast<__m128i*>(index),
+                  _mm_srli_epi32(offset_bits, kSrgbTableShift));
+  const auto& r = table[index[0]];
+  const auto& g = table[index[1]];
+  const auto& b = table[index[2]];
+  auto offset = _mm_setr_ps(r.offset, g.offset, b.offset, 0.0f);
+  auto slope = _mm_setr_ps(r.slope, g.slope, b.slope, 0.0f);
+  auto srgb = _mm_add_ps(offset, _mm_mul_ps(slope, c));
+  auto alpha = _mm_mul_ps(Clamp01(linear), _mm_set1_ps(255.0f));
+  auto alpha_mask = AlphaLaneMask();
+  return _mm_or_ps(_mm_and_ps(alpha_mask, alpha),
+                   _mm_andnot_ps(alpha_mask, srgb));
+}
+#else
+// RGBA 各1要素を floatx4 1つで扱う。アルファはレーン3
+uint32x4_t AlphaLaneMask() {
+  const std::uint32_t mask[4] = {0, 0, 0, 0xffffffff};
+  return vld1q_u32(mask);
+}
+
+float32x4_t Clamp01(float32x4_t v) {
+  // SSE と同じく NaN は 0 にする
+  return vminq_f32(vmaxnmq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+}
+
+// [0, 255] の4ピクセル分を丸めて16バイトに詰める
+uint8x16_t PackBytes(float32x4_t p0, float32x4_t p1, float32x4_t p2,
+                     float32x4_t p3) {
+  auto lo = vcombine_u16(vqmovn_u32(vcvtnq_u32_f32(p0)),
+                         vqmovn_u32(vcvtnq_u32_f32(p1)));
+  auto hi = vcombine_u16(vqmovn_u32(vcvtnq_u32_f32(p2)),
+                         vqmovn_u32(vcvtnq_u32_f32(p3)));
+  return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi));
+}
+
+float32x4_t LinearToSrgb(float32x4_t linear, const SrgbSegment* table) {
+  auto c = vminq_f32(
+      vmaxnmq_f32(linear,
+                  vreinterpretq_f32_u32(vdupq_n_u32(kSrgbTableMinBits))),
+      vreinterpretq_f32_u32(vdupq_n_u32(kSrgbTableMaxBits)));
+  std::uint32_t index[4];
+  auto offset_bits = vsubq_u32(vreinterpretq_u32_f32(c),
+                               vdupq_n_u32(kSrgbTableMinBits));
+  vst1q_u32(index, vshrq_n_u32(offset_bits, kSrgbTableShift));
+  const auto& r = table[index[0]];
+  const auto& g = table[index[1]];
+  const auto& b = table[index[2]];
+  const float offsets[4] = {r.offset, g.offset, b.offset, 0.0f};
+  const float slopes[4] = {r.slope, g.slope, b.slope, 0.0f};
+  auto srgb =
+      vaddq_f32(vld1q_f32(offsets), vmulq_f32(vld1q_f32(slopes), c));
+  auto alpha = vmulq_n_f32(Clamp01(linear), 255.0f);
+  return vbslq_f32(AlphaLaneMask(), alpha, srgb);
+}
+#endif
+#endif
+}  // namespace
+
 Color Color32BitToColor(const Color32Bit& color32) {
   return Color{(float)color32.red / 255.0f, (float)color32.green / 255.0f,
                (float)color32.blue / 255.0f, (float)color32.alpha / 255.0f};
 }
 
 Color32Bit ColorToColor32Bit(const Color& color) {
-  return Color32Bit{
-      static_cast<std::uint8_t>(clamp(color.red, 0.0f, 1.0f) * 0xff),
-      static_cast<std::uint8_t>(clamp(color.green, 0.0f, 1.0f) * 0xff),
-      static_cast<std::uint8_t>(clamp(color.blue, 0.0f, 1.0f) * 0xff),
-      static_cast<std::uint8_t>(clamp(color.alpha, 0.0f, 1.0f) * 0xff)};
+  return Color32Bit{ToByte(color.red), ToByte(color.green), ToByte(color.blue),
+                    ToByte(color.alpha)};
 }
-}  // namespace base
+
+float SrgbToLinear(float srgb) {
+  return srgb <= 0.04045f ? srgb / 12.92f
+                          : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSrgb(float linear) {
+  return linear <= 0.0031308f
+             ? linear * 12.92f
+             : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+}
+
+Color SrgbToLinear(const Color32Bit& srgb) {
+  auto table = SrgbToLinearTable();
+  return Color{table[srgb.red], table[srgb.green], table[srgb.blue],
+               (float)srgb.alpha / 255.0f};
+}
+
+Color32Bit LinearToSrgb(const Color& linear) {
+  return Color32Bit{ToByte(LinearToSrgb(clamp(linear.red, 0.0f, 1.0f))),
+                    ToByte(LinearToSrgb(clamp(linear.green, 0.0f, 1.0f))),
+                    ToByte(LinearToSrgb(clamp(linear.blue, 0.0f, 1.0f))),
+                    ToByte(linear.alpha)};
+}
+
+Color Premultiply(const Color& color) {
+  return Color{color.red * color.alpha, color.green * color.alpha,
+               color.blue * color.alpha, color.alpha};
+}
+
+Color Unpremultiply(const Color& color) {
+  float inv = color.alpha > 0.0f ? 1.0f / color.alpha : 0.0f;
+  return Color{color.red * inv, color.green * inv, color.blue * inv,
+               color.alpha};
+}
+
+Color32Bit Premultiply(const Color32Bit& color) {
+  // c * a / 255 を除算なしで正確に丸める
+  auto mul = [a = (std::uint32_t)color.alpha](std::uint8_t c) {
+    auto t = c * a + 128;
+    return static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+  };
+  return Color32Bit{mul(color.red), mul(color.green), mul(color.blue),
+                    color.alpha};
+}
+
+void Color32BitToColor(const Color32Bit* colors32, std::size_t count,
+                       Color* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  const auto kZero = _mm_setzero_si128();
+  const auto k255 = _mm_set1_ps(255.0f);
+  auto out = reinterpret_cast<float*>(results);
+  for (; i + 4 <= count; i += 4) {
+    auto bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(colors32 + i));
+    auto lo = _mm_unpacklo_epi8(bytes, kZero);
+    auto hi = _mm_unpackhi_epi8(bytes, kZero);
+    const __m128i pixels[4] = {
+        _mm_unpacklo_epi16(lo, kZero), _mm_unpackhi_epi16(lo, kZero),
+        _mm_unpacklo_epi16(hi, kZero), _mm_unpackhi_epi16(hi, kZero)};
+    for (int p = 0; p < 4; ++p) {
+      _mm_storeu_ps(out + (i + p) * 4,
+                    _mm_div_ps(_mm_cvtepi32_ps(pixels[p]), k255));
+    }
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  const auto k255 = vdupq_n_f32(255.0f);
+  auto out = reinterpret_cast<float*>(results);
+  for (; i + 4 <= count; i += 4) {
+    auto bytes =
+        vld1q_u8(reinterpret_cast<const std::uint8_t*>(colors32 + i));
+    auto lo = vmovl_u8(vget_low_u8(bytes));
+    auto hi = vmovl_u8(vget_high_u8(bytes));
+    const uint32x4_t pixels[4] = {
+        vmovl_u16(vget_low_u16(lo)), vmovl_u16(vget_high_u16(lo)),
+        vmovl_u16(vget_low_u16(hi)), vmovl_u16(vget_high_u16(hi))};
+    for (int p = 0; p < 4; ++p) {
+      vst1q_f32(out + (i + p) * 4,
+                vdivq_f32(vcvtq_f32_u32(pixels[p]), k255));
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = Color32BitToColor(colors32[i]);
+  }
+}
+
+void ColorToColor32Bit(const Color* colors, std::size_t count,
+                       Color32Bit* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  const auto k255 = _mm_set1_ps(255.0f);
+  auto in = reinterpret_cast<const float*>(colors);
+  for (; i + 4 <= count; i += 4) {
+    auto p = in + i * 4;
+    auto to_byte = [k255](__m128 v) { return _mm_mul_ps(Clamp01(v), k255); };
+    auto bytes = PackBytes(to_byte(_mm_loadu_ps(p)),
+                           to_byte(_mm_loadu_ps(p + 4)),
+                           to_byte(_mm_loadu_ps(p + 8)),
+                           to_byte(_mm_loadu_ps(p + 12)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), bytes);
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  auto in = reinterpret_cast<const float*>(colors);
+  for (; i + 4 <= count; i += 4) {
+    auto p = in + i * 4;
+    auto to_byte = [](float32x4_t v) {
+      return vmulq_n_f32(Clamp01(v), 255.0f);
+    };
+    auto bytes = PackBytes(to_byte(vld1q_f32(p)), to_byte(vld1q_f32(p + 4)),
+                           to_byte(vld1q_f32(p + 8)),
+                           to_byte(vld1q_f32(p + 12)));
+    vst1q_u8(reinterpret_cast<std::uint8_t*>(results + i), bytes);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = ColorToColor32Bit(colors[i]);
+  }
+}
+
+void SrgbToLinear(const Color32Bit* srgb, std::size_t count, Color* results) {
+  // 8ビット入力は表引きが最も速い
+  auto table = SrgbToLinearTable();
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = Color{table[srgb[i].red], table[srgb[i].green],
+                       table[srgb[i].blue], (float)srgb[i].alpha / 255.0f};
+  }
+}
+
+void LinearToSrgb(const Color* linear, std::size_t count,
+                  Color32Bit* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  auto table = LinearToSrgbTable();
+  auto in = reinterpret_cast<const float*>(linear);
+  for (; i + 4 <= count; i += 4) {
+    auto p = in + i * 4;
+    auto bytes = PackBytes(LinearToSrgb(_mm_loadu_ps(p), table),
+                           LinearToSrgb(_mm_loadu_ps(p + 4), table),
+                           LinearToSrgb(_mm_loadu_ps(p + 8), table),
+                           LinearToSrgb(_mm_loadu_ps(p + 12), table));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), bytes);
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  auto table = LinearToSrgbTable();
+  auto in = reinterpret_cast<const float*>(linear);
+  for (; i + 4 <= count; i += 4) {
+    auto p = in + i * 4;
+    auto bytes = PackBytes(LinearToSrgb(vld1q_f32(p), table),
+                           LinearToSrgb(vld1q_f32(p + 4), table),
+                           LinearToSrgb(vld1q_f32(p + 8), table),
+                           LinearToSrgb(vld1q_f32(p + 12), table));
+    vst1q_u8(reinterpret_cast<std::uint8_t*>(results + i), bytes);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = LinearToSrgb(linear[i]);
+  }
+}
+
+void Premultiply(Color* colors, std::size_t count) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  auto alpha_mask = AlphaLaneMask();
+  auto p = reinterpret_cast<float*>(colors);
+  for (; i < count; ++i) {
+    auto v = _mm_loadu_ps(p + i * 4);
+    auto alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    auto rgb = _mm_andnot_ps(alpha_mask, _mm_mul_ps(v, alpha));
+    _mm_storeu_ps(p + i * 4, _mm_or_ps(rgb, _mm_and_ps(alpha_mask, v)));
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  auto p = reinterpret_cast<float*>(colors);
+  for (; i < count; ++i) {
+    auto v = vld1q_f32(p + i * 4);
+    auto alpha = vgetq_lane_f32(v, 3);
+    vst1q_f32(p + i * 4, vsetq_lane_f32(alpha, vmulq_n_f32(v, alpha), 3));
+  }
+#endif
+  for (; i < count; ++i) {
+    colors[i] = Premultiply(colors[i]);
+  }
+}
+
+void Unpremultiply(Color* colors, std::size_t count) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  auto alpha_mask = AlphaLaneMask();
+  auto p = reinterpret_cast<float*>(colors);
+  for (; i < count; ++i) {
+    auto v = _mm_loadu_ps(p + i * 4);
+    auto alpha = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+    auto inv = _mm_and_ps(_mm_cmpgt_ps(alpha, _mm_setzero_ps()),
+                          _mm_div_ps(_mm_set1_ps(1.0f), alpha));
+    auto rgb = _mm_andnot_ps(alpha_mask, _mm_mul_ps(v, inv));
+    _mm_storeu_ps(p + i * 4, _mm_or_ps(rgb, _mm_and_ps(alpha_mask, v)));
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  auto p = reinterpret_cast<float*>(colors);
+  for (; i < count; ++i) {
+    auto v = vld1q_f32(p + i * 4);
+    auto alpha = vgetq_lane_f32(v, 3);
+    auto inv = alpha > 0.0f ? 1.0f / alpha : 0.0f;
+    vst1q_f32(p + i * 4, vsetq_lane_f32(alpha, vmulq_n_f32(v, inv), 3));
+  }
+#endif
+  for (; i < count; ++i) {
+    colors[i] = Unpremultiply(colors[i]);
+  }
+}
+
+void Premultiply(Color32Bit* colors, std::size_t count) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  const auto kZero = _mm_setzero_si128();
+  const auto k128 = _mm_set1_epi16(128);
+  // アルファのレーンには255を掛けて値を保つ
+  const auto kAlphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+  const auto k255 = _mm_and_si128(kAlphaLanes, _mm_set1_epi16(255));
+  auto multiply = [&](__m128i c) {
+    auto a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, 0xff), 0xff);
+    a = _mm_or_si128(_mm_andnot_si128(kAlphaLanes, a), k255);
+    auto t = _mm_add_epi16(_mm_mullo_epi16(c, a), k128);
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+  };
+  for (; i + 4 <= count; i += 4) {
+    auto p = reinterpret_cast<__m128i*>(colors + i);
+    auto bytes = _mm_loadu_si128(p);
+    auto lo = multiply(_mm_unpacklo_epi8(bytes, kZero));
+    auto hi = multiply(_mm_unpackhi_epi8(bytes, kZero));
+    _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+  }
+#elif defined(TEMP_GFX_COLOR_NEON)
+  const auto k128 = vdupq_n_u16(128);
+  auto multiply = [k128](uint8x8_t c, uint8x8_t a) {
+    auto t = vaddq_u16(vmull_u8(c, a), k128);
+    return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+  };
+  // チャンネルごとに分けて読み、アルファはそのまま書き戻す
+  for (; i + 16 <= count; i += 16) {
+    auto p = reinterpret_cast<std::uint8_t*>(colors + i);
+    auto pixels = vld4q_u8(p);
+    auto a = pixels.val[3];
+    for (int c = 0; c < 3; ++c) {
+      auto v = pixels.val[c];
+      pixels.val[c] =
+          vcombine_u8(multiply(vget_low_u8(v), vget_low_u8(a)),
+                      multiply(vget_high_u8(v), vget_high_u8(a)));
+    }
+    vst4q_u8(p, pixels);
+  }
+#endif
+  for (; i < count; ++i) {
+    colors[i] = Premultiply(colors[i]);
+  }
+}
+
+}  // namespace gfx
 }  // namespace temp
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace temp {
@@ -38,7 +39,57 @@ struct Color32Bit {
 };
 
 Color Color32BitToColor(const Color32Bit& color32);
+
+/**
+ * @brief Clamp to [0, 1] and round to nearest 8 bit value
+ */
 Color32Bit ColorToColor32Bit(const Color& color);
 
+/**
+ * @brief sRGB transfer function to linear, both in [0, 1]
+ */
+float SrgbToLinear(float srgb);
+float LinearToSrgb(float linear);
+
+/**
+ * @brief Decode sRGB color to linear, alpha is linear already
+ */
+Color SrgbToLinear(const Color32Bit& srgb);
+
+/**
+ * @brief Encode linear color to sRGB, rounding to nearest 8 bit value
+ */
+Color32Bit LinearToSrgb(const Color& linear);
+
+/**
+ * @brief Multiply color channels by alpha
+ */
+Color Premultiply(const Color& color);
+
+/**
+ * @brief Divide color channels by alpha, transparent colors become zero
+ */
+Color Unpremultiply(const Color& color);
+
+/**
+ * @brief Multiply color channels by alpha / 255, rounding to nearest
+ */
+Color32Bit Premultiply(const Color32Bit& color);
+
+// Buffer versions of the conversions above. They use SSE2 on x86 and NEON on
+// AArch64, other targets run the single pixel versions in a loop. The
+// results are the same as the single pixel versions, except that
+// LinearToSrgb may differ by one from the exact encoding on SIMD targets.
+void Color32BitToColor(const Color32Bit* colors32, std::size_t count,
+                       Color* results);
+void ColorToColor32Bit(const Color* colors, std::size_t count,
+                       Color32Bit* results);
+void SrgbToLinear(const Color32Bit* srgb, std::size_t count, Color* results);
+void LinearToSrgb(const Color* linear, std::size_t count,
+                  Color32Bit* results);
+void Premultiply(Color* colors, std::size_t count);
+void Unpremultiply(Color* colors, std::size_t count);
+void Premultiply(Color32Bit* colors, std::size_t count);
+
 }
 }
\ No newline at end of file
@@ -24,6 +24,12 @@ class Device {
       const void* window, std::uint32_t width, std::uint32_t height) const = 0;
 };
 
+/**
+ * @brief Create device and its main swap chain for window
+ *
+ * With null window the device is headless and renders into offscreen images
+ * of width x height, which needs no display.
+ */
 std::shared_ptr<Device> CreateDevice(ApiType api, const void* window,
                                      std::uint32_t width, std::uint32_t height);
 
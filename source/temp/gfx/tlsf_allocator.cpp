@@ -0,0 +1,263 @@
+﻿#include "temp/gfx/tlsf_allocator.h"
+
+#include <algorithm>
+
+#include "temp/base/assertion.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace temp {
+namespace gfx {
+
+namespace {
+// 最上位ビットの位置。value は 0 でないこと
+int MostSignificantBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
+// 最下位ビットの位置。value は 0 でないこと
+int LeastSignificantBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, value);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(value);
+#endif
+}
+}  // namespace
+
+TlsfAllocator::TlsfAllocator(std::uint64_t size)
+    : size_(size),
+      free_size_(size),
+      allocation_count_(0),
+      first_level_bits_(0) {
+  std::fill(std::begin(second_level_bits_), std::end(second_level_bits_), 0);
+  for (auto&& heads : heads_) {
+    std::fill(std::begin(heads), std::end(heads), kInvalidHandle);
+  }
+  if (size > 0) {
+    auto node = CreateNode();
+    nodes_[node] = Node{0,    size,           kInvalidHandle, kInvalidHandle,
+                        kInvalidHandle, kInvalidHandle, true};
+    InsertFree(node);
+  }
+}
+
+bool TlsfAllocator::Allocate(std::uint64_t size, std::uint64_t alignment,
+                             Allocation* allocation) {
+  TEMP_ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0,
+              "alignment must be power of two");
+  size = std::max<std::uint64_t>(size, 1);
+
+  // 先頭をずらしても収まるように、揃えの分だけ大きい領域を探す
+  auto node = FindFree(size + alignment - 1);
+  if (node == kInvalidHandle) {
+    return false;
+  }
+  RemoveFree(node);
+
+  // 揃えで空いた先頭は空き領域として残す
+  auto offset = nodes_[node].offset;
+  auto padding = ((offset + alignment - 1) & ~(alignment - 1)) - offset;
+  if (padding > 0) {
+    auto front = CreateNode();
+    auto&& n = nodes_[node];
+    nodes_[front] = Node{n.offset,       padding,        n.prev_physical,
+                         node,           kInvalidHandle, kInvalidHandle,
+                         true};
+    if (n.prev_physical != kInvalidHandle) {
+      nodes_[n.prev_physical].next_physical = front;
+    }
+    n.prev_physical = front;
+    n.offset += padding;
+    n.size -= padding;
+    InsertFree(front);
+  }
+
+  // 残りは後ろの空き領域に分ける
+  if (nodes_[node].size > size) {
+    auto back = CreateNode();
+    auto&& n = nodes_[node];
+    nodes_[back] = Node{n.offset + size, n.size - size,  node,
+                        n.next_physical, kInvalidHandle, kInvalidHandle,
+                        true};
+    if (n.next_physical != kInvalidHandle) {
+      nodes_[n.next_physical].prev_physical = back;
+    }
+    n.next_physical = back;
+    n.size = size;
+    InsertFree(back);
+  }
+
+  auto&& n = nodes_[node];
+  n.free = false;
+  free_size_ -= n.size;
+  ++allocation_count_;
+  *allocation = Allocation{n.offset, n.size, node};
+  return true;
+}
+
+void TlsfAllocator::Free(Handle handle) {
+  TEMP_ASSERT(handle < nodes_.size() && !nodes_[handle].free,
+              "handle is not allocated");
+  auto node = handle;
+  free_size_ += nodes_[node].size;
+  --allocation_count_;
+
+  // 前後の空き領域とつなげる
+  auto prev = nodes_[node].prev_physical;
+  if (prev != kInvalidHandle && nodes_[prev].free) {
+    RemoveFree(prev);
+    auto&& p = nodes_[prev];
+    p.size += nodes_[node].size;
+    p.next_physical = nodes_[node].next_physical;
+    if (p.next_physical != kInvalidHandle) {
+      nodes_[p.next_physical].prev_physical = prev;
+    }
+    ReleaseNode(node);
+    node = prev;
+  }
+  auto next = nodes_[node].next_physical;
+  if (next != kInvalidHandle && nodes_[next].free) {
+    RemoveFree(next);
+    auto&& n = nodes_[node];
+    n.size += nodes_[next].size;
+    n.next_physical = nodes_[next].next_physical;
+    if (n.next_physical != kInvalidHandle) {
+      nodes_[n.next_physical].prev_physical = node;
+    }
+    ReleaseNode(next);
+  }
+
+  nodes_[node].free = true;
+  InsertFree(node);
+}
+
+std::uint64_t TlsfAllocator::LargestFreeSize() const {
+  if (first_level_bits_ == 0) {
+    return 0;
+  }
+  // 最も大きいリストの中だけを見ればよい
+  auto fl = MostSignificantBit(first_level_bits_);
+  auto sl = MostSignificantBit(second_level_bits_[fl]);
+  std::uint64_t largest = 0;
+  for (auto node = heads_[fl][sl]; node != kInvalidHandle;
+       node = nodes_[node].next_free) {
+    largest = std::max(largest, nodes_[node].size);
+  }
+  return largest;
+}
+
+float TlsfAllocator::Fragmentation() const {
+  if (free_size_ == 0) {
+    return 0.0f;
+  }
+  return 1.0f - static_cast<float>(static_cast<double>(LargestFreeSize()) /
+                                   static_cast<double>(free_size_));
+}
+
+auto TlsfAllocator::CreateNode() -> Handle {
+  if (!unused_nodes_.empty()) {
+    auto node = unused_nodes_.back();
+    unused_nodes_.pop_back();
+    return node;
+  }
+  nodes_.emplace_back();
+  return static_cast<Handle>(nodes_.size() - 1);
+}
+
+void TlsfAllocator::ReleaseNode(Handle node) {
+  // 解放済みのハンドルを二重に Free() したときに検出できるようにする
+  nodes_[node].free = true;
+  unused_nodes_.push_back(node);
+}
+
+namespace {
+// 小さいサイズは第1レベル 0 に線形に、それ以外は上位ビットで分類する
+void MapSize(std::uint64_t size, int second_level_log, int* fl, int* sl) {
+  if (size < (std::uint64_t(1) << second_level_log)) {
+    *fl = 0;
+    *sl = static_cast<int>(size);
+  } else {
+    auto msb = MostSignificantBit(size);
+    *fl = msb - second_level_log + 1;
+    *sl = static_cast<int>((size >> (msb - second_level_log)) ^
+                           (std::uint64_t(1) << second_level_log));
+  }
+}
+}  // namespace
+
+void TlsfAllocator::InsertFree(Handle node) {
+  int fl, sl;
+  MapSize(nodes_[node].size, kSecondLevelLog, &fl, &sl);
+  auto&& n = nodes_[node];
+  n.prev_free = kInvalidHandle;
+  n.next_free = heads_[fl][sl];
+  if (n.next_free != kInvalidHandle) {
+    nodes_[n.next_free].prev_free = node;
+  }
+  heads_[fl][sl] = node;
+  first_level_bits_ |= std::uint64_t(1) << fl;
+  second_level_bits_[fl] |= 1u << sl;
+}
+
+void TlsfAllocator::RemoveFree(Handle node) {
+  int fl, sl;
+  MapSize(nodes_[node].size, kSecondLevelLog, &fl, &sl);
+  auto&& n = nodes_[node];
+  if (n.prev_free != kInvalidHandle) {
+    nodes_[n.prev_free].next_free = n.next_free;
+  } else {
+    heads_[fl][sl] = n.next_free;
+  }
+  if (n.next_free != kInvalidHandle) {
+    nodes_[n.next_free].prev_free = n.prev_free;
+  }
+  if (heads_[fl][sl] == kInvalidHandle) {
+    second_level_bits_[fl] &= ~(1u << sl);
+    if (second_level_bits_[fl] == 0) {
+      first_level_bits_ &= ~(std::uint64_t(1) << fl);
+    }
+  }
+}
+
+auto TlsfAllocator::FindFree(std::uint64_t size) const -> Handle {
+  // 切り上げたリストの要素はどれも size 以上なので、探さずに先頭を使える
+  if (size >= (std::uint64_t(1) << kSecondLevelLog)) {
+    auto round = (std::uint64_t(1) << (MostSignificantBit(size) -
+                                       kSecondLevelLog)) -
+                 1;
+    if (size > ~std::uint64_t(0) - round) {
+      return kInvalidHandle;
+    }
+    size += round;
+  }
+  int fl, sl;
+  MapSize(size, kSecondLevelLog, &fl, &sl);
+
+  auto sl_bits = second_level_bits_[fl] & (~0u << sl);
+  if (sl_bits == 0) {
+    auto fl_bits = fl + 1 < 64 ? first_level_bits_ & (~std::uint64_t(0)
+                                                      << (fl + 1))
+                               : 0;
+    if (fl_bits == 0) {
+      return kInvalidHandle;
+    }
+    fl = LeastSignificantBit(fl_bits);
+    sl_bits = second_level_bits_[fl];
+  }
+  sl = LeastSignificantBit(sl_bits);
+  return heads_[fl][sl];
+}
+
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace temp {
+namespace gfx {
+
+/**
+ * @brief Two-level segregated fit allocator of ranges in a memory block
+ *
+ * Manages offsets only, never touches the memory, so it suballocates GPU
+ * memory as well. Allocate() and Free() take constant time: free ranges are
+ * kept in lists binned by the most significant bits of their size, and a
+ * freed range is merged with its free neighbors.
+ */
+class TlsfAllocator {
+ public:
+  using Handle = std::uint32_t;
+  static constexpr Handle kInvalidHandle = 0xffffffff;
+
+  struct Allocation {
+    std::uint64_t offset;
+    std::uint64_t size;
+    Handle handle;
+  };
+
+  explicit TlsfAllocator(std::uint64_t size);
+
+  /**
+   * @brief Allocate range of size bytes aligned to alignment
+   *
+   * @param alignment power of two
+   * @return false if no free range is large enough
+   */
+  bool Allocate(std::uint64_t size, std::uint64_t alignment,
+                Allocation* allocation);
+
+  void Free(Handle handle);
+
+  std::uint64_t size() const { return size_; }
+  std::uint64_t used_size() const { return size_ - free_size_; }
+  std::uint64_t free_size() const { return free_size_; }
+  std::size_t allocation_count() const { return allocation_count_; }
+
+  /**
+   * @brief Size of the largest free range
+   */
+  std::uint64_t LargestFreeSize() const;
+
+  /**
+   * @brief 1 - largest free range / free size, 0 when free space is one range
+   */
+  float Fragmentation() const;
+
+ private:
+  static constexpr int kSecondLevelLog = 5;
+  static constexpr int kSecondLevelCount = 1 << kSecondLevelLog;
+  static constexpr int kFirstLevelCount = 64 - kSecondLevelLog + 1;
+
+  struct Node {
+    std::uint64_t offset;
+    std::uint64_t size;
+    Handle prev_physical;
+    Handle next_physical;
+    Handle prev_free;
+    Handle next_free;
+    bool free;
+  };
+
+  Handle CreateNode();
+  void ReleaseNode(Handle node);
+  void InsertFree(Handle node);
+  void RemoveFree(Handle node);
+  Handle FindFree(std::uint64_t size) const;
+
+  std::uint64_t size_;
+  std::uint64_t free_size_;
+  std::size_t allocation_count_;
+
+  std::vector<Node> nodes_;
+  std::vector<Handle> unused_nodes_;
+
+  // ビットが立っているリストに空き領域がある
+  std::uint64_t first_level_bits_;
+  std::uint32_t second_level_bits_[kFirstLevelCount];
+  Handle heads_[kFirstLevelCount][kSecondLevelCount];
+};
+
+}  // namespace gfx
+}  // namespace temp
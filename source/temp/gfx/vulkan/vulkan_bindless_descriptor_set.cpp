@@ -0,0 +1,177 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_bindless_descriptor_set.h"
+#include "temp/gfx/vulkan/vulkan_device.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+VulkanBindlessDescriptorSet::VulkanBindlessDescriptorSet(
+    const VulkanDevice& device, std::uint32_t frame_count,
+    std::uint32_t max_textures, std::uint32_t max_buffers)
+    : device_(&device) {
+  if (!device.descriptor_indexing_enabled()) {
+    TEMP_LOG_ERROR("VK_EXT_descriptor_indexing is not supported.");
+    std::abort();
+  }
+  TEMP_ASSERT(frame_count > 0, "frame_count must be positive");
+  auto vk_device = device.device();
+
+  // 更新後にバインドできる記述子の数は通常の上限とは別に決まっている
+  auto properties = device.physical_device().getProperties2KHR<
+      vk::PhysicalDeviceProperties2,
+      vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>(device.dispatcher());
+  auto&& limits =
+      properties.get<vk::PhysicalDeviceDescriptorIndexingPropertiesEXT>();
+  textures_.capacity = std::min(
+      {max_textures, limits.maxDescriptorSetUpdateAfterBindSampledImages,
+       limits.maxPerStageDescriptorUpdateAfterBindSampledImages});
+  buffers_.capacity = std::min(
+      {max_buffers, limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+       limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+  textures_.removed.resize(frame_count);
+  buffers_.removed.resize(frame_count);
+
+  vk::DescriptorSetLayoutBinding bindings[] = {
+      {kTextureBinding, vk::DescriptorType::eCombinedImageSampler,
+       textures_.capacity, vk::ShaderStageFlagBits::eAll},
+      {kBufferBinding, vk::DescriptorType::eStorageBuffer, buffers_.capacity,
+       vk::ShaderStageFlagBits::eAll},
+  };
+  // 使わない番号は空のままにでき、実行中のフレームが読まない番号は書き換え
+  // られる
+  vk::DescriptorBindingFlagsEXT binding_flag =
+      vk::DescriptorBindingFlagBitsEXT::ePartiallyBound |
+      vk::DescriptorBindingFlagBitsEXT::eUpdateAfterBind |
+      vk::DescriptorBindingFlagBitsEXT::eUpdateUnusedWhilePending;
+  vk::DescriptorBindingFlagsEXT binding_flags[] = {binding_flag, binding_flag};
+
+  vk::DescriptorSetLayoutBindingFlagsCreateInfoEXT binding_flags_ci;
+  binding_flags_ci.bindingCount = 2;
+  binding_flags_ci.pBindingFlags = binding_flags;
+  vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_ci;
+  descriptor_set_layout_ci.pNext = &binding_flags_ci;
+  descriptor_set_layout_ci.flags =
+      vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPoolEXT;
+  descriptor_set_layout_ci.bindingCount = 2;
+  descriptor_set_layout_ci.pBindings = bindings;
+  descriptor_set_layout_ =
+      vk_device.createDescriptorSetLayoutUnique(descriptor_set_layout_ci);
+
+  vk::DescriptorPoolSize pool_sizes[] = {
+      {vk::DescriptorType::eCombinedImageSampler, textures_.capacity},
+      {vk::DescriptorType::eStorageBuffer, buffers_.capacity},
+  };
+  vk::DescriptorPoolCreateInfo descriptor_pool_ci;
+  descriptor_pool_ci.flags =
+      vk::DescriptorPoolCreateFlagBits::eUpdateAfterBindEXT;
+  descriptor_pool_ci.maxSets = 1;
+  descriptor_pool_ci.poolSizeCount = 2;
+  descriptor_pool_ci.pPoolSizes = pool_sizes;
+  descriptor_pool_ = vk_device.createDescriptorPoolUnique(descriptor_pool_ci);
+
+  vk::DescriptorSetAllocateInfo descriptor_set_ai;
+  descriptor_set_ai.descriptorPool = *descriptor_pool_;
+  descriptor_set_ai.descriptorSetCount = 1;
+  descriptor_set_ai.pSetLayouts = &descriptor_set_layout_.get();
+  descriptor_set_ = vk_device.allocateDescriptorSets(descriptor_set_ai)[0];
+}
+
+void VulkanBindlessDescriptorSet::BeginFrame(std::uint32_t frame_index) {
+  TEMP_ASSERT(frame_index < textures_.removed.size(),
+              "frame_index is out of range");
+  current_frame_ = frame_index;
+
+  // このフレームで前回外した番号は、もうどのフレームからも読まれない
+  for (auto slots : {&textures_, &buffers_}) {
+    auto&& removed = slots->removed[current_frame_];
+    slots->free.insert(slots->free.end(), removed.begin(), removed.end());
+    removed.clear();
+  }
+}
+
+std::uint32_t VulkanBindlessDescriptorSet::AddTexture(vk::ImageView view,
+                                                      vk::Sampler sampler,
+                                                      vk::ImageLayout layout) {
+  auto index = AcquireSlot(&textures_);
+  vk::DescriptorImageInfo image_info(sampler, view, layout);
+  vk::WriteDescriptorSet write;
+  write.dstSet = descriptor_set_;
+  write.dstBinding = kTextureBinding;
+  write.dstArrayElement = index;
+  write.descriptorCount = 1;
+  write.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+  write.pImageInfo = &image_info;
+  device_->device().updateDescriptorSets(write, nullptr);
+  return index;
+}
+
+std::uint32_t VulkanBindlessDescriptorSet::AddBuffer(vk::Buffer buffer,
+                                                     vk::DeviceSize offset,
+                                                     vk::DeviceSize range) {
+  auto index = AcquireSlot(&buffers_);
+  vk::DescriptorBufferInfo buffer_info(buffer, offset, range);
+  vk::WriteDescriptorSet write;
+  write.dstSet = descriptor_set_;
+  write.dstBinding = kBufferBinding;
+  write.dstArrayElement = index;
+  write.descriptorCount = 1;
+  write.descriptorType = vk::DescriptorType::eStorageBuffer;
+  write.pBufferInfo = &buffer_info;
+  device_->device().updateDescriptorSets(write, nullptr);
+  return index;
+}
+
+void VulkanBindlessDescriptorSet::RemoveTexture(std::uint32_t index) {
+  TEMP_ASSERT(index < textures_.next, "index is not added");
+  textures_.removed[current_frame_].push_back(index);
+}
+
+void VulkanBindlessDescriptorSet::RemoveBuffer(std::uint32_t index) {
+  TEMP_ASSERT(index < buffers_.next, "index is not added");
+  buffers_.removed[current_frame_].push_back(index);
+}
+
+vk::DescriptorSet VulkanBindlessDescriptorSet::descriptor_set() const {
+  return descriptor_set_;
+}
+
+vk::DescriptorSetLayout VulkanBindlessDescriptorSet::descriptor_set_layout()
+    const {
+  return *descriptor_set_layout_;
+}
+
+std::uint32_t VulkanBindlessDescriptorSet::max_textures() const {
+  return textures_.capacity;
+}
+
+std::uint32_t VulkanBindlessDescriptorSet::max_buffers() const {
+  return buffers_.capacity;
+}
+
+std::uint32_t VulkanBindlessDescriptorSet::AcquireSlot(Slots* slots) {
+  if (!slots->free.empty()) {
+    auto index = slots->free.back();
+    slots->free.pop_back();
+    return index;
+  }
+  if (slots->next >= slots->capacity) {
+    TEMP_LOG_ERROR("Bindless descriptor array is full!");
+    std::abort();
+  }
+  return slots->next++;
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Descriptor set holding all textures and storage buffers in arrays
+ *
+ * Binding kTextureBinding is an array of combined image samplers and
+ * kBufferBinding an array of storage buffers, both indexed by the numbers
+ * Add*() returns, so draws pass indices in push constants and the set is
+ * bound once per frame. The arrays are updated after bind, so adding
+ * descriptors does not disturb frames executing on the GPU. Removed indices
+ * are reused only after the frames in flight that may read them finished.
+ *
+ * Requires VulkanDevice::descriptor_indexing_enabled(). Not thread safe.
+ */
+class VulkanBindlessDescriptorSet {
+ public:
+  static constexpr std::uint32_t kTextureBinding = 0;
+  static constexpr std::uint32_t kBufferBinding = 1;
+  static constexpr std::uint32_t kDefaultMaxTextures = 4096;
+  static constexpr std::uint32_t kDefaultMaxBuffers = 4096;
+
+  /**
+   * @param frame_count count of frames in flight
+   * @param max_textures limited by the device
+   * @param max_buffers limited by the device
+   */
+  explicit VulkanBindlessDescriptorSet(
+      const VulkanDevice& device, std::uint32_t frame_count,
+      std::uint32_t max_textures = kDefaultMaxTextures,
+      std::uint32_t max_buffers = kDefaultMaxBuffers);
+
+  VulkanBindlessDescriptorSet(const VulkanBindlessDescriptorSet&) = delete;
+  VulkanBindlessDescriptorSet& operator=(const VulkanBindlessDescriptorSet&) =
+      delete;
+
+  /**
+   * @brief Start frame, making indices removed in frame_index before
+   * reusable
+   *
+   * Call after the GPU finished the previous frame of frame_index.
+   */
+  void BeginFrame(std::uint32_t frame_index);
+
+  /**
+   * @return index in texture array
+   */
+  std::uint32_t AddTexture(
+      vk::ImageView view, vk::Sampler sampler,
+      vk::ImageLayout layout = vk::ImageLayout::eShaderReadOnlyOptimal);
+
+  /**
+   * @return index in buffer array
+   */
+  std::uint32_t AddBuffer(vk::Buffer buffer, vk::DeviceSize offset = 0,
+                          vk::DeviceSize range = VK_WHOLE_SIZE);
+
+  void RemoveTexture(std::uint32_t index);
+  void RemoveBuffer(std::uint32_t index);
+
+  vk::DescriptorSet descriptor_set() const;
+  vk::DescriptorSetLayout descriptor_set_layout() const;
+  std::uint32_t max_textures() const;
+  std::uint32_t max_buffers() const;
+
+ private:
+  /**
+   * @brief Indices of one array
+   */
+  struct Slots {
+    std::uint32_t capacity = 0;
+    // 一度も使っていない最初の番号
+    std::uint32_t next = 0;
+    std::vector<std::uint32_t> free;
+    // フレームごとに、そのフレームで外された番号
+    std::vector<std::vector<std::uint32_t>> removed;
+  };
+
+  static std::uint32_t AcquireSlot(Slots* slots);
+
+  const VulkanDevice* device_;
+  std::uint32_t current_frame_ = 0;
+  Slots textures_;
+  Slots buffers_;
+  vk::UniqueDescriptorSetLayout descriptor_set_layout_;
+  vk::UniqueDescriptorPool descriptor_pool_;
+  // プールと一緒に解放されるので、個別には解放しない
+  vk::DescriptorSet descriptor_set_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,82 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+
+#include "temp/gfx/vulkan/vulkan_command_pool.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+namespace {
+// 足りなくなったときにまとめて確保する最小数
+const std::uint32_t kMinAllocationCount = 4;
+}  // namespace
+
+VulkanCommandPool::VulkanCommandPool(vk::Device device,
+                                     std::uint32_t queue_family_index,
+                                     bool recycle)
+    : device_(device), recycle_(recycle) {
+  vk::CommandPoolCreateInfo command_pool_ci;
+  // 毎フレームリセットする短命なバッファであることをドライバに伝える
+  command_pool_ci.flags = vk::CommandPoolCreateFlagBits::eTransient;
+  command_pool_ci.queueFamilyIndex = queue_family_index;
+  pool_ = device_.createCommandPoolUnique(command_pool_ci);
+}
+
+vk::CommandBuffer VulkanCommandPool::Allocate(vk::CommandBufferLevel level) {
+  auto&& command_buffers =
+      level == vk::CommandBufferLevel::ePrimary ? primaries_ : secondaries_;
+  auto&& buffers = command_buffers.buffers;
+  if (!recycle_) {
+    // 再利用しない場合は、1つずつドライバから確保する
+    vk::CommandBufferAllocateInfo command_buffer_ai;
+    command_buffer_ai.commandPool = *pool_;
+    command_buffer_ai.level = level;
+    command_buffer_ai.commandBufferCount = 1;
+    buffers.push_back(device_.allocateCommandBuffers(command_buffer_ai)[0]);
+    ++command_buffers.used;
+    return buffers.back();
+  }
+  if (command_buffers.used == buffers.size()) {
+    // 倍々に増やして、確保の回数をフレーム数によらず少なくする
+    vk::CommandBufferAllocateInfo command_buffer_ai;
+    command_buffer_ai.commandPool = *pool_;
+    command_buffer_ai.level = level;
+    command_buffer_ai.commandBufferCount = std::max(
+        kMinAllocationCount, static_cast<std::uint32_t>(buffers.size()));
+    auto allocated = device_.allocateCommandBuffers(command_buffer_ai);
+    buffers.insert(buffers.end(), allocated.begin(), allocated.end());
+  }
+  return buffers[command_buffers.used++];
+}
+
+void VulkanCommandPool::Reset() {
+  if (!recycle_) {
+    for (auto command_buffers : {&primaries_, &secondaries_}) {
+      auto&& buffers = command_buffers->buffers;
+      if (!buffers.empty()) {
+        device_.freeCommandBuffers(*pool_, buffers);
+      }
+      buffers.clear();
+      command_buffers->used = 0;
+    }
+    return;
+  }
+
+  // バッファは解放せず、すべて初期状態に戻る
+  device_.resetCommandPool(*pool_, vk::CommandPoolResetFlags());
+  primaries_.used = 0;
+  secondaries_.used = 0;
+}
+
+std::size_t VulkanCommandPool::capacity() const {
+  return primaries_.buffers.size() + secondaries_.buffers.size();
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
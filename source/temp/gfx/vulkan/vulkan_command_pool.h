@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+/**
+ * @brief Command pool recycling its command buffers in bulk
+ *
+ * Allocate() hands out command buffers allocated in earlier frames when
+ * possible, and Reset() makes all of them available again with one
+ * vkResetCommandPool instead of freeing them one by one.
+ *
+ * Not thread safe. Use one pool per recording thread and per frame in
+ * flight, and reset it only after the GPU finished its command buffers.
+ */
+class VulkanCommandPool {
+ public:
+  /**
+   * @param recycle false allocates every command buffer from the driver and
+   *                frees it in Reset(), for comparison in benchmarks
+   */
+  explicit VulkanCommandPool(vk::Device device,
+                             std::uint32_t queue_family_index,
+                             bool recycle = true);
+
+  VulkanCommandPool(const VulkanCommandPool&) = delete;
+  VulkanCommandPool& operator=(const VulkanCommandPool&) = delete;
+
+  VulkanCommandPool(VulkanCommandPool&&) = default;
+  VulkanCommandPool& operator=(VulkanCommandPool&&) = default;
+
+  /**
+   * @brief Command buffer in initial state, valid until Reset()
+   */
+  vk::CommandBuffer Allocate(vk::CommandBufferLevel level);
+
+  /**
+   * @brief Return all command buffers to the pool
+   */
+  void Reset();
+
+  /**
+   * @brief Count of command buffers allocated from the driver so far
+   */
+  std::size_t capacity() const;
+
+ private:
+  struct CommandBuffers {
+    std::vector<vk::CommandBuffer> buffers;
+    std::size_t used = 0;
+  };
+
+  vk::Device device_;
+  bool recycle_;
+  vk::UniqueCommandPool pool_;
+  CommandBuffers primaries_;
+  CommandBuffers secondaries_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,126 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+
+#include "temp/base/assertion.h"
+
+#include "temp/gfx/vulkan/vulkan_compute_pipeline.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+VulkanComputePipeline::VulkanComputePipeline(
+    vk::Device device, const std::vector<std::uint32_t>& spirv,
+    std::uint32_t storage_buffer_count, std::uint32_t push_constant_size)
+    : device_(device),
+      storage_buffer_count_(storage_buffer_count),
+      push_constant_size_(push_constant_size) {
+  std::vector<vk::DescriptorSetLayoutBinding> bindings;
+  for (std::uint32_t i = 0; i < storage_buffer_count; ++i) {
+    bindings.emplace_back(i, vk::DescriptorType::eStorageBuffer, 1,
+                          vk::ShaderStageFlagBits::eCompute);
+  }
+  vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_ci;
+  descriptor_set_layout_ci.bindingCount =
+      static_cast<std::uint32_t>(bindings.size());
+  descriptor_set_layout_ci.pBindings = bindings.data();
+  descriptor_set_layout_ =
+      device.createDescriptorSetLayoutUnique(descriptor_set_layout_ci);
+
+  vk::PushConstantRange push_constant_range(
+      vk::ShaderStageFlagBits::eCompute, 0, push_constant_size);
+  vk::PipelineLayoutCreateInfo pipeline_layout_ci;
+  pipeline_layout_ci.setLayoutCount = 1;
+  pipeline_layout_ci.pSetLayouts = &descriptor_set_layout_.get();
+  if (push_constant_size > 0) {
+    pipeline_layout_ci.pushConstantRangeCount = 1;
+    pipeline_layout_ci.pPushConstantRanges = &push_constant_range;
+  }
+  pipeline_layout_ = device.createPipelineLayoutUnique(pipeline_layout_ci);
+
+  vk::ShaderModuleCreateInfo shader_module_ci;
+  shader_module_ci.codeSize = spirv.size() * sizeof(std::uint32_t);
+  shader_module_ci.pCode = spirv.data();
+  // パイプラインを作った後は要らない
+  auto shader_module = device.createShaderModuleUnique(shader_module_ci);
+
+  vk::ComputePipelineCreateInfo pipeline_ci;
+  pipeline_ci.stage.stage = vk::ShaderStageFlagBits::eCompute;
+  pipeline_ci.stage.module = *shader_module;
+  pipeline_ci.stage.pName = "main";
+  pipeline_ci.layout = *pipeline_layout_;
+  pipeline_ = device.createComputePipelineUnique(vk::PipelineCache(),
+                                                 pipeline_ci);
+
+  // 記述子の数が 0 のプールは作れない
+  vk::DescriptorPoolSize pool_size(vk::DescriptorType::eStorageBuffer,
+                                   std::max(1u, storage_buffer_count) *
+                                       kMaxDescriptorSets);
+  vk::DescriptorPoolCreateInfo descriptor_pool_ci;
+  descriptor_pool_ci.flags =
+      vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet;
+  descriptor_pool_ci.maxSets = kMaxDescriptorSets;
+  descriptor_pool_ci.poolSizeCount = 1;
+  descriptor_pool_ci.pPoolSizes = &pool_size;
+  descriptor_pool_ = device.createDescriptorPoolUnique(descriptor_pool_ci);
+}
+
+vk::UniqueDescriptorSet VulkanComputePipeline::CreateDescriptorSet(
+    const std::vector<vk::DescriptorBufferInfo>& buffers) const {
+  TEMP_ASSERT(buffers.size() == storage_buffer_count_,
+              "buffers must match bindings");
+  vk::DescriptorSetAllocateInfo descriptor_set_ai;
+  descriptor_set_ai.descriptorPool = *descriptor_pool_;
+  descriptor_set_ai.descriptorSetCount = 1;
+  descriptor_set_ai.pSetLayouts = &descriptor_set_layout_.get();
+  auto descriptor_sets =
+      device_.allocateDescriptorSetsUnique(descriptor_set_ai);
+
+  std::vector<vk::WriteDescriptorSet> writes;
+  for (std::uint32_t i = 0; i < storage_buffer_count_; ++i) {
+    vk::WriteDescriptorSet write;
+    write.dstSet = *descriptor_sets[0];
+    write.dstBinding = i;
+    write.descriptorCount = 1;
+    write.descriptorType = vk::DescriptorType::eStorageBuffer;
+    write.pBufferInfo = &buffers[i];
+    writes.emplace_back(write);
+  }
+  device_.updateDescriptorSets(writes, nullptr);
+  return std::move(descriptor_sets[0]);
+}
+
+void VulkanComputePipeline::Dispatch(vk::CommandBuffer command_buffer,
+                                     vk::DescriptorSet descriptor_set,
+                                     const void* push_constants,
+                                     const vk::Extent3D& group_count) const {
+  command_buffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline_);
+  command_buffer.bindDescriptorSets(vk::PipelineBindPoint::eCompute,
+                                    *pipeline_layout_, 0, descriptor_set,
+                                    nullptr);
+  if (push_constant_size_ > 0) {
+    command_buffer.pushConstants(*pipeline_layout_,
+                                 vk::ShaderStageFlagBits::eCompute, 0,
+                                 push_constant_size_, push_constants);
+  }
+  command_buffer.dispatch(group_count.width, group_count.height,
+                          group_count.depth);
+}
+
+vk::Pipeline VulkanComputePipeline::pipeline() const { return *pipeline_; }
+
+vk::PipelineLayout VulkanComputePipeline::pipeline_layout() const {
+  return *pipeline_layout_;
+}
+
+vk::DescriptorSetLayout VulkanComputePipeline::descriptor_set_layout() const {
+  return *descriptor_set_layout_;
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+/**
+ * @brief Compute shader with the layout of its resources
+ *
+ * The shader reads and writes storage buffers at bindings 0 to
+ * storage_buffer_count - 1 of descriptor set 0, and may take push constants
+ * of push_constant_size bytes.
+ */
+class VulkanComputePipeline {
+ public:
+  static constexpr std::uint32_t kMaxDescriptorSets = 64;
+
+  /**
+   * @param spirv SPIR-V code of shader with entry point "main"
+   */
+  explicit VulkanComputePipeline(vk::Device device,
+                                 const std::vector<std::uint32_t>& spirv,
+                                 std::uint32_t storage_buffer_count,
+                                 std::uint32_t push_constant_size = 0);
+
+  VulkanComputePipeline(const VulkanComputePipeline&) = delete;
+  VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+
+  VulkanComputePipeline(VulkanComputePipeline&&) = default;
+  VulkanComputePipeline& operator=(VulkanComputePipeline&&) = default;
+
+  /**
+   * @brief Descriptor set binding buffers in order of bindings
+   *
+   * At most kMaxDescriptorSets sets are alive at once.
+   */
+  vk::UniqueDescriptorSet CreateDescriptorSet(
+      const std::vector<vk::DescriptorBufferInfo>& buffers) const;
+
+  /**
+   * @brief Record binding pipeline, descriptor set and push constants, and
+   * dispatching group_count workgroups
+   *
+   * @param push_constants push_constant_size bytes, null if size is 0
+   */
+  void Dispatch(vk::CommandBuffer command_buffer,
+                vk::DescriptorSet descriptor_set, const void* push_constants,
+                const vk::Extent3D& group_count) const;
+
+  vk::Pipeline pipeline() const;
+  vk::PipelineLayout pipeline_layout() const;
+  vk::DescriptorSetLayout descriptor_set_layout() const;
+
+ private:
+  vk::Device device_;
+  std::uint32_t storage_buffer_count_;
+  std::uint32_t push_constant_size_;
+  vk::UniqueDescriptorSetLayout descriptor_set_layout_;
+  vk::UniquePipelineLayout pipeline_layout_;
+  vk::UniquePipeline pipeline_;
+  vk::UniqueDescriptorPool descriptor_pool_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,211 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <limits>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_compute_queue.h"
+#include "temp/gfx/vulkan/vulkan_device.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+VulkanComputeQueue::VulkanComputeQueue(const VulkanDevice& device)
+    : device_(&device) {
+  if (!device.timeline_semaphore_enabled()) {
+    TEMP_LOG_ERROR("VK_KHR_timeline_semaphore is not supported.");
+    std::abort();
+  }
+
+  auto&& queue_index_table = device.queue_index_table();
+  auto&& queue_table = device.queue_table();
+  auto graphics_queue_family =
+      static_cast<std::uint32_t>(device.graphics_queue_index());
+  auto graphics_queue = queue_table.at(vk::QueueFlagBits::eGraphics);
+
+  // コンピュートのファミリーがなければグラフィックスキューで順に実行する
+  auto iter = queue_index_table.find(vk::QueueFlagBits::eCompute);
+  async_ = iter != queue_index_table.end() &&
+           iter->second != device.graphics_queue_index();
+  if (async_) {
+    queue_family_index_ = static_cast<std::uint32_t>(iter->second);
+    CreateLane(queue_family_index_, queue_table.at(vk::QueueFlagBits::eCompute),
+               &compute_);
+  } else {
+    queue_family_index_ = graphics_queue_family;
+    CreateLane(queue_family_index_, graphics_queue, &compute_);
+  }
+  CreateLane(graphics_queue_family, graphics_queue, &graphics_);
+}
+
+VulkanComputeQueue::~VulkanComputeQueue() {
+  // コマンドバッファを解放する前に、提出したものがすべて終わるのを待つ
+  WaitLane(compute_, compute_.value);
+  WaitLane(graphics_, graphics_.value);
+}
+
+std::uint64_t VulkanComputeQueue::Submit(
+    const std::function<void(vk::CommandBuffer)>& record,
+    std::uint64_t graphics_mark) {
+  TEMP_ASSERT(graphics_mark <= graphics_.value,
+              "graphics_mark must be returned by SignalGraphics()");
+  Recycle(&compute_);
+
+  auto command_buffer = BeginCommandBuffer(&compute_);
+  record(*command_buffer);
+  command_buffer->end();
+
+  // 印までの描画の結果を読み書きするので、すべてのステージを待たせる
+  return SubmitToLane(&compute_, std::move(command_buffer),
+                      *graphics_.semaphore, graphics_mark,
+                      vk::PipelineStageFlagBits::eAllCommands);
+}
+
+std::uint64_t VulkanComputeQueue::SignalGraphics() {
+  Recycle(&graphics_);
+  return SubmitToLane(&graphics_, vk::UniqueCommandBuffer(), vk::Semaphore(),
+                      0, vk::PipelineStageFlags());
+}
+
+void VulkanComputeQueue::WaitOnGraphicsQueue(std::uint64_t ticket,
+                                             vk::PipelineStageFlags stages) {
+  TEMP_ASSERT(ticket <= compute_.value, "ticket must be submitted");
+  Recycle(&graphics_);
+
+  // セマフォの待機は同じバッチにしか効かないので、後から提出される描画にも
+  // 依存関係が続くようにバリアを置く
+  auto command_buffer = BeginCommandBuffer(&graphics_);
+  vk::MemoryBarrier barrier;
+  barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+  barrier.dstAccessMask =
+      vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+  command_buffer->pipelineBarrier(stages, stages, vk::DependencyFlags(),
+                                  barrier, nullptr, nullptr);
+  command_buffer->end();
+
+  SubmitToLane(&graphics_, std::move(command_buffer), *compute_.semaphore,
+               ticket, stages);
+}
+
+bool VulkanComputeQueue::IsCompleted(std::uint64_t ticket) const {
+  return device_->device().getSemaphoreCounterValueKHR(
+             *compute_.semaphore, device_->dispatcher()) >= ticket;
+}
+
+void VulkanComputeQueue::Wait(std::uint64_t ticket) const {
+  TEMP_ASSERT(ticket <= compute_.value, "ticket must be submitted");
+  WaitLane(compute_, ticket);
+}
+
+bool VulkanComputeQueue::async() const { return async_; }
+
+std::uint32_t VulkanComputeQueue::queue_family_index() const {
+  return queue_family_index_;
+}
+
+void VulkanComputeQueue::CreateLane(std::uint32_t queue_family_index,
+                                    vk::Queue queue, Lane* lane) {
+  auto vk_device = device_->device();
+  lane->queue = queue;
+
+  vk::CommandPoolCreateInfo command_pool_ci;
+  command_pool_ci.flags = vk::CommandPoolCreateFlagBits::eTransient |
+                          vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+  command_pool_ci.queueFamilyIndex = queue_family_index;
+  lane->command_pool = vk_device.createCommandPoolUnique(command_pool_ci);
+
+  vk::SemaphoreTypeCreateInfoKHR semaphore_type_ci;
+  semaphore_type_ci.semaphoreType = vk::SemaphoreType::eTimeline;
+  semaphore_type_ci.initialValue = 0;
+  vk::SemaphoreCreateInfo semaphore_ci;
+  semaphore_ci.pNext = &semaphore_type_ci;
+  lane->semaphore = vk_device.createSemaphoreUnique(semaphore_ci);
+}
+
+vk::UniqueCommandBuffer VulkanComputeQueue::BeginCommandBuffer(Lane* lane) {
+  vk::UniqueCommandBuffer command_buffer;
+  if (!lane->free_command_buffers.empty()) {
+    command_buffer = std::move(lane->free_command_buffers.back());
+    lane->free_command_buffers.pop_back();
+  } else {
+    vk::CommandBufferAllocateInfo command_buffer_ai;
+    command_buffer_ai.commandPool = *lane->command_pool;
+    command_buffer_ai.level = vk::CommandBufferLevel::ePrimary;
+    command_buffer_ai.commandBufferCount = 1;
+    command_buffer = std::move(
+        device_->device().allocateCommandBuffersUnique(command_buffer_ai)[0]);
+  }
+
+  vk::CommandBufferBeginInfo command_buffer_bi;
+  command_buffer_bi.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  command_buffer->begin(command_buffer_bi);
+  return command_buffer;
+}
+
+std::uint64_t VulkanComputeQueue::SubmitToLane(
+    Lane* lane, vk::UniqueCommandBuffer command_buffer,
+    vk::Semaphore wait_semaphore, std::uint64_t wait_value,
+    vk::PipelineStageFlags wait_stages) {
+  auto signal_value = lane->value + 1;
+
+  vk::TimelineSemaphoreSubmitInfoKHR timeline_si;
+  timeline_si.signalSemaphoreValueCount = 1;
+  timeline_si.pSignalSemaphoreValues = &signal_value;
+
+  vk::SubmitInfo submit_info;
+  submit_info.pNext = &timeline_si;
+  submit_info.signalSemaphoreCount = 1;
+  submit_info.pSignalSemaphores = &lane->semaphore.get();
+  if (wait_value > 0) {
+    timeline_si.waitSemaphoreValueCount = 1;
+    timeline_si.pWaitSemaphoreValues = &wait_value;
+    submit_info.waitSemaphoreCount = 1;
+    submit_info.pWaitSemaphores = &wait_semaphore;
+    submit_info.pWaitDstStageMask = &wait_stages;
+  }
+  if (command_buffer) {
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &command_buffer.get();
+  }
+  lane->queue.submit(submit_info, vk::Fence());
+
+  lane->value = signal_value;
+  if (command_buffer) {
+    lane->batches.emplace_back(Batch{std::move(command_buffer), signal_value});
+  }
+  return signal_value;
+}
+
+void VulkanComputeQueue::Recycle(Lane* lane) {
+  if (lane->batches.empty()) {
+    return;
+  }
+  auto completed = device_->device().getSemaphoreCounterValueKHR(
+      *lane->semaphore, device_->dispatcher());
+  while (!lane->batches.empty() &&
+         lane->batches.front().value <= completed) {
+    lane->free_command_buffers.emplace_back(
+        std::move(lane->batches.front().command_buffer));
+    lane->batches.pop_front();
+  }
+}
+
+void VulkanComputeQueue::WaitLane(const Lane& lane,
+                                  std::uint64_t value) const {
+  vk::SemaphoreWaitInfoKHR wait_info;
+  wait_info.semaphoreCount = 1;
+  wait_info.pSemaphores = &lane.semaphore.get();
+  wait_info.pValues = &value;
+  device_->device().waitSemaphoresKHR(
+      wait_info, std::numeric_limits<std::uint64_t>::max(),
+      device_->dispatcher());
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Submission of compute work overlapping with rendering
+ *
+ * Batches run on a queue family without graphics when the device has one,
+ * so simulation, culling or post-processing of one frame overlaps with
+ * rasterization of another. Completion is tracked by a timeline semaphore
+ * whose value is the ticket of the last finished batch, and the order with
+ * the graphics queue is given by tickets in both directions:
+ * SignalGraphics() marks the rendering submitted so far, Submit() waits for
+ * such a mark, and WaitOnGraphicsQueue() makes later rendering wait for a
+ * batch.
+ *
+ * Buffers and images written on one queue and read on the other must be
+ * created with vk::SharingMode::eConcurrent, since no ownership is
+ * transferred. Requires VK_KHR_timeline_semaphore. Not thread safe.
+ */
+class VulkanComputeQueue {
+ public:
+  explicit VulkanComputeQueue(const VulkanDevice& device);
+  ~VulkanComputeQueue();
+
+  VulkanComputeQueue(const VulkanComputeQueue&) = delete;
+  VulkanComputeQueue& operator=(const VulkanComputeQueue&) = delete;
+
+  /**
+   * @brief Record commands and submit them to the compute queue
+   *
+   * @param graphics_mark value from SignalGraphics() to wait for, 0 waits
+   *                      for nothing
+   * @return ticket of the batch
+   */
+  std::uint64_t Submit(const std::function<void(vk::CommandBuffer)>& record,
+                       std::uint64_t graphics_mark = 0);
+
+  /**
+   * @brief Mark the work submitted to the graphics queue so far
+   *
+   * @return value passed to Submit() to run after the work
+   */
+  std::uint64_t SignalGraphics();
+
+  /**
+   * @brief Make work submitted to the graphics queue from now on wait for
+   * batch of ticket
+   *
+   * @param stages stages of the graphics queue consuming the results
+   */
+  void WaitOnGraphicsQueue(std::uint64_t ticket,
+                           vk::PipelineStageFlags stages =
+                               vk::PipelineStageFlagBits::eAllCommands);
+
+  bool IsCompleted(std::uint64_t ticket) const;
+
+  /**
+   * @brief Block until batch of ticket finishes
+   */
+  void Wait(std::uint64_t ticket) const;
+
+  /**
+   * @brief Whether batches run on a queue apart from the graphics queue
+   */
+  bool async() const;
+
+  std::uint32_t queue_family_index() const;
+
+ private:
+  struct Batch {
+    vk::UniqueCommandBuffer command_buffer;
+    std::uint64_t value;
+  };
+
+  /**
+   * @brief Queue with timeline semaphore signaled by each batch
+   */
+  struct Lane {
+    vk::Queue queue;
+    vk::UniqueCommandPool command_pool;
+    vk::UniqueSemaphore semaphore;
+    // 最後に提出したバッチがシグナルする値
+    std::uint64_t value = 0;
+    std::deque<Batch> batches;
+    std::vector<vk::UniqueCommandBuffer> free_command_buffers;
+  };
+
+  void CreateLane(std::uint32_t queue_family_index, vk::Queue queue,
+                  Lane* lane);
+
+  vk::UniqueCommandBuffer BeginCommandBuffer(Lane* lane);
+
+  /**
+   * @brief Submit command buffer, which may be null, signaling next value
+   *
+   * @param wait_value value of wait_semaphore to wait for, 0 waits nothing
+   */
+  std::uint64_t SubmitToLane(Lane* lane,
+                             vk::UniqueCommandBuffer command_buffer,
+                             vk::Semaphore wait_semaphore,
+                             std::uint64_t wait_value,
+                             vk::PipelineStageFlags wait_stages);
+
+  /**
+   * @brief Return command buffers of finished batches to lane
+   */
+  void Recycle(Lane* lane);
+
+  void WaitLane(const Lane& lane, std::uint64_t value) const;
+
+  const VulkanDevice* device_;
+  std::uint32_t queue_family_index_;
+  bool async_;
+  // チケットはこのレーンの値
+  Lane compute_;
+  // 値は SignalGraphics() の印
+  Lane graphics_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,126 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_descriptor_allocator.h"
+#include "temp/gfx/vulkan/vulkan_device.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+namespace {
+struct PoolRatio {
+  vk::DescriptorType type;
+  std::uint32_t count_per_set;
+};
+
+// セットあたりの記述子の数の見積もり。レイアウトのキャッシュが受け付ける
+// 種類をすべて含める
+const PoolRatio kPoolRatios[] = {
+    {vk::DescriptorType::eUniformBuffer, 2},
+    {vk::DescriptorType::eUniformBufferDynamic, 1},
+    {vk::DescriptorType::eStorageBuffer, 2},
+    {vk::DescriptorType::eStorageBufferDynamic, 1},
+    {vk::DescriptorType::eCombinedImageSampler, 4},
+    {vk::DescriptorType::eSampledImage, 2},
+    {vk::DescriptorType::eSampler, 1},
+    {vk::DescriptorType::eStorageImage, 1},
+    {vk::DescriptorType::eUniformTexelBuffer, 1},
+    {vk::DescriptorType::eStorageTexelBuffer, 1},
+    {vk::DescriptorType::eInputAttachment, 1},
+};
+}  // namespace
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(
+    const VulkanDevice& device, std::uint32_t frame_count)
+    : device_(&device), frames_(frame_count) {
+  TEMP_ASSERT(frame_count > 0, "frame_count must be positive");
+}
+
+void VulkanDescriptorAllocator::BeginFrame(std::uint32_t frame_index) {
+  TEMP_ASSERT(frame_index < frames_.size(), "frame_index is out of range");
+  current_frame_ = frame_index;
+
+  auto&& pools = frames_[current_frame_].pools;
+  for (auto&& pool : pools) {
+    device_->device().resetDescriptorPool(*pool);
+    free_pools_.emplace_back(std::move(pool));
+  }
+  pools.clear();
+}
+
+vk::DescriptorSet VulkanDescriptorAllocator::Allocate(
+    const DescriptorSetLayoutInfo& layout) {
+  auto&& pools = frames_[current_frame_].pools;
+  if (pools.empty()) {
+    AddPool();
+  }
+
+  vk::DescriptorSetAllocateInfo descriptor_set_ai;
+  descriptor_set_ai.descriptorSetCount = 1;
+  descriptor_set_ai.pSetLayouts = &layout.layout;
+  vk::DescriptorSet set;
+
+  // 使い切ったプールは次のフレームまで置いておき、新しいプールで一度だけ
+  // やり直す
+  for (int i = 0; i < 2; ++i) {
+    descriptor_set_ai.descriptorPool = *pools.back();
+    auto result =
+        device_->device().allocateDescriptorSets(&descriptor_set_ai, &set);
+    if (result == vk::Result::eSuccess) {
+      return set;
+    }
+    if (result != vk::Result::eErrorOutOfPoolMemory &&
+        result != vk::Result::eErrorFragmentedPool) {
+      break;
+    }
+    AddPool();
+  }
+
+  TEMP_LOG_ERROR("Failed to allocate descriptor set!");
+  std::abort();
+}
+
+std::size_t VulkanDescriptorAllocator::pool_count() const {
+  auto count = free_pools_.size();
+  for (auto&& frame : frames_) {
+    count += frame.pools.size();
+  }
+  return count;
+}
+
+void VulkanDescriptorAllocator::AddPool() {
+  auto&& pools = frames_[current_frame_].pools;
+  if (!free_pools_.empty()) {
+    pools.emplace_back(std::move(free_pools_.back()));
+    free_pools_.pop_back();
+    return;
+  }
+
+  std::vector<vk::DescriptorPoolSize> pool_sizes;
+  for (auto&& ratio : kPoolRatios) {
+    pool_sizes.emplace_back(ratio.type,
+                            ratio.count_per_set * next_pool_set_count_);
+  }
+  vk::DescriptorPoolCreateInfo descriptor_pool_ci;
+  descriptor_pool_ci.maxSets = next_pool_set_count_;
+  descriptor_pool_ci.poolSizeCount =
+      static_cast<std::uint32_t>(pool_sizes.size());
+  descriptor_pool_ci.pPoolSizes = pool_sizes.data();
+  pools.emplace_back(
+      device_->device().createDescriptorPoolUnique(descriptor_pool_ci));
+
+  // 足りなくなるほど使うなら、次はもっと大きいプールを作る
+  next_pool_set_count_ = std::min(next_pool_set_count_ * 2, kMaxPoolSetCount);
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "temp/gfx/vulkan/vulkan_descriptor_set_layout_cache.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Allocator of descriptor sets living for one frame
+ *
+ * Every frame in flight has its own pools. BeginFrame() resets all pools of
+ * the frame at once instead of freeing sets one by one, so the sets of
+ * frames still executing on the GPU stay intact. When a pool runs out,
+ * another is taken from the reset pools or created twice as large as the
+ * previous one, up to kMaxPoolSetCount sets. Not thread safe.
+ */
+class VulkanDescriptorAllocator {
+ public:
+  static constexpr std::uint32_t kInitialPoolSetCount = 64;
+  static constexpr std::uint32_t kMaxPoolSetCount = 4096;
+
+  /**
+   * @param frame_count count of frames in flight
+   */
+  explicit VulkanDescriptorAllocator(const VulkanDevice& device,
+                                     std::uint32_t frame_count);
+
+  VulkanDescriptorAllocator(const VulkanDescriptorAllocator&) = delete;
+  VulkanDescriptorAllocator& operator=(const VulkanDescriptorAllocator&) =
+      delete;
+
+  /**
+   * @brief Start frame, freeing sets allocated in frame_index before
+   *
+   * Call after the GPU finished the previous frame of frame_index, e.g.
+   * after VulkanSwapChain::AcquireNextImage().
+   */
+  void BeginFrame(std::uint32_t frame_index);
+
+  /**
+   * @brief Allocate set living until the frame begins next time
+   */
+  vk::DescriptorSet Allocate(const DescriptorSetLayoutInfo& layout);
+
+  /**
+   * @brief Count of pools including reset ones
+   */
+  std::size_t pool_count() const;
+
+ private:
+  struct Frame {
+    // 最後のプールから割り当てる
+    std::vector<vk::UniqueDescriptorPool> pools;
+  };
+
+  /**
+   * @brief Add reset or new pool to current frame
+   */
+  void AddPool();
+
+  const VulkanDevice* device_;
+  std::vector<Frame> frames_;
+  std::uint32_t current_frame_ = 0;
+  std::vector<vk::UniqueDescriptorPool> free_pools_;
+  std::uint32_t next_pool_set_count_ = kInitialPoolSetCount;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
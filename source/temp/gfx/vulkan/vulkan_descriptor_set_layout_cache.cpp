@@ -0,0 +1,166 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include "temp/base/assertion.h"
+#include "temp/base/hash.h"
+
+#include "temp/gfx/vulkan/vulkan_descriptor_set_layout_cache.h"
+#include "temp/gfx/vulkan/vulkan_device.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+namespace {
+// 記述子の種類ごとに、データに並べる情報の型
+enum class InfoKind { kImage, kBuffer, kTexelBufferView };
+
+InfoKind GetInfoKind(vk::DescriptorType type) {
+  switch (type) {
+    case vk::DescriptorType::eSampler:
+    case vk::DescriptorType::eCombinedImageSampler:
+    case vk::DescriptorType::eSampledImage:
+    case vk::DescriptorType::eStorageImage:
+    case vk::DescriptorType::eInputAttachment:
+      return InfoKind::kImage;
+    case vk::DescriptorType::eUniformTexelBuffer:
+    case vk::DescriptorType::eStorageTexelBuffer:
+      return InfoKind::kTexelBufferView;
+    case vk::DescriptorType::eUniformBuffer:
+    case vk::DescriptorType::eStorageBuffer:
+    case vk::DescriptorType::eUniformBufferDynamic:
+    case vk::DescriptorType::eStorageBufferDynamic:
+      return InfoKind::kBuffer;
+    default:
+      // 拡張の種類は情報の型も VulkanDescriptorAllocator のプールも違う
+      TEMP_ASSERT(false, "descriptor type is not supported");
+      return InfoKind::kBuffer;
+  }
+}
+
+std::size_t GetInfoSize(InfoKind kind) {
+  switch (kind) {
+    case InfoKind::kImage:
+      return sizeof(vk::DescriptorImageInfo);
+    case InfoKind::kTexelBufferView:
+      return sizeof(vk::BufferView);
+    default:
+      return sizeof(vk::DescriptorBufferInfo);
+  }
+}
+}  // namespace
+
+VulkanDescriptorSetLayoutCache::VulkanDescriptorSetLayoutCache(
+    const VulkanDevice& device)
+    : device_(&device) {}
+
+const DescriptorSetLayoutInfo& VulkanDescriptorSetLayoutCache::GetLayout(
+    const std::vector<vk::DescriptorSetLayoutBinding>& bindings) {
+  auto iter = entries_.find(bindings);
+  if (iter != entries_.end()) {
+    return iter->second.info;
+  }
+
+  auto vk_device = device_->device();
+  Entry entry;
+
+  vk::DescriptorSetLayoutCreateInfo descriptor_set_layout_ci;
+  descriptor_set_layout_ci.bindingCount =
+      static_cast<std::uint32_t>(bindings.size());
+  descriptor_set_layout_ci.pBindings = bindings.data();
+  entry.layout =
+      vk_device.createDescriptorSetLayoutUnique(descriptor_set_layout_ci);
+  entry.info.layout = *entry.layout;
+
+  // 情報はバインディングの順に隙間なく並べる
+  for (auto&& binding : bindings) {
+    TEMP_ASSERT(binding.pImmutableSamplers == nullptr,
+                "immutable samplers are not supported");
+    if (binding.descriptorCount == 0) {
+      continue;
+    }
+    auto stride = GetInfoSize(GetInfoKind(binding.descriptorType));
+    entry.info.entries.emplace_back(binding.binding, 0,
+                                    binding.descriptorCount,
+                                    binding.descriptorType,
+                                    entry.info.data_size, stride);
+    entry.info.data_size += stride * binding.descriptorCount;
+  }
+
+  if (device_->descriptor_update_template_enabled() &&
+      !entry.info.entries.empty()) {
+    vk::DescriptorUpdateTemplateCreateInfoKHR update_template_ci;
+    update_template_ci.descriptorUpdateEntryCount =
+        static_cast<std::uint32_t>(entry.info.entries.size());
+    update_template_ci.pDescriptorUpdateEntries = entry.info.entries.data();
+    update_template_ci.templateType =
+        vk::DescriptorUpdateTemplateType::eDescriptorSet;
+    update_template_ci.descriptorSetLayout = *entry.layout;
+    entry.update_template = vk_device.createDescriptorUpdateTemplateKHRUnique(
+        update_template_ci, nullptr, device_->dispatcher());
+    entry.info.update_template = *entry.update_template;
+  }
+
+  iter = entries_.emplace(bindings, std::move(entry)).first;
+  return iter->second.info;
+}
+
+void VulkanDescriptorSetLayoutCache::UpdateDescriptorSet(
+    vk::DescriptorSet set, const DescriptorSetLayoutInfo& layout,
+    const void* data) const {
+  if (layout.update_template) {
+    device_->device().updateDescriptorSetWithTemplateKHR(
+        set, layout.update_template, data, device_->dispatcher());
+    return;
+  }
+
+  // テンプレートと同じ配置のデータから書き込みを組み立てる
+  auto bytes = static_cast<const std::uint8_t*>(data);
+  std::vector<vk::WriteDescriptorSet> writes;
+  for (auto&& entry : layout.entries) {
+    vk::WriteDescriptorSet write;
+    write.dstSet = set;
+    write.dstBinding = entry.dstBinding;
+    write.dstArrayElement = entry.dstArrayElement;
+    write.descriptorCount = entry.descriptorCount;
+    write.descriptorType = entry.descriptorType;
+    auto info = bytes + entry.offset;
+    switch (GetInfoKind(entry.descriptorType)) {
+      case InfoKind::kImage:
+        write.pImageInfo =
+            reinterpret_cast<const vk::DescriptorImageInfo*>(info);
+        break;
+      case InfoKind::kBuffer:
+        write.pBufferInfo =
+            reinterpret_cast<const vk::DescriptorBufferInfo*>(info);
+        break;
+      case InfoKind::kTexelBufferView:
+        write.pTexelBufferView = reinterpret_cast<const vk::BufferView*>(info);
+        break;
+    }
+    writes.emplace_back(write);
+  }
+  device_->device().updateDescriptorSets(writes, nullptr);
+}
+
+std::size_t VulkanDescriptorSetLayoutCache::layout_count() const {
+  return entries_.size();
+}
+
+std::size_t VulkanDescriptorSetLayoutCache::BindingsHash::operator()(
+    const std::vector<vk::DescriptorSetLayoutBinding>& bindings) const {
+  // ポインタのメンバーがあるので、メンバーごとに足す
+  auto hash = kFnvOffsetBasis;
+  for (auto&& binding : bindings) {
+    HashValue(binding.binding, &hash);
+    HashValue(binding.descriptorType, &hash);
+    HashValue(binding.descriptorCount, &hash);
+    HashValue(static_cast<VkShaderStageFlags>(binding.stageFlags), &hash);
+  }
+  return static_cast<std::size_t>(hash);
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Descriptor set layout with the layout of data updating its sets
+ *
+ * The data holds descriptorCount infos per binding, bindings in order:
+ * vk::DescriptorImageInfo for samplers and images, vk::DescriptorBufferInfo
+ * for buffers and vk::BufferView for texel buffers.
+ */
+struct DescriptorSetLayoutInfo {
+  vk::DescriptorSetLayout layout;
+  // 拡張がなければ無効で、vk::WriteDescriptorSet で更新する
+  vk::DescriptorUpdateTemplateKHR update_template;
+  std::vector<vk::DescriptorUpdateTemplateEntryKHR> entries;
+  std::size_t data_size = 0;
+};
+
+/**
+ * @brief Descriptor set layouts shared by equal bindings
+ *
+ * Each layout has a descriptor update template, so a set is written by one
+ * call with a block of infos instead of building vk::WriteDescriptorSet per
+ * binding. Not thread safe.
+ */
+class VulkanDescriptorSetLayoutCache {
+ public:
+  explicit VulkanDescriptorSetLayoutCache(const VulkanDevice& device);
+
+  VulkanDescriptorSetLayoutCache(const VulkanDescriptorSetLayoutCache&) =
+      delete;
+  VulkanDescriptorSetLayoutCache& operator=(
+      const VulkanDescriptorSetLayoutCache&) = delete;
+
+  /**
+   * @brief Layout of bindings, which have no immutable samplers
+   *
+   * Only the descriptor types of Vulkan 1.0 are supported.
+   * The info lives as long as the cache.
+   */
+  const DescriptorSetLayoutInfo& GetLayout(
+      const std::vector<vk::DescriptorSetLayoutBinding>& bindings);
+
+  /**
+   * @brief Write descriptors of data laid out as layout says to set
+   */
+  void UpdateDescriptorSet(vk::DescriptorSet set,
+                           const DescriptorSetLayoutInfo& layout,
+                           const void* data) const;
+
+  std::size_t layout_count() const;
+
+ private:
+  struct Entry {
+    vk::UniqueDescriptorSetLayout layout;
+    vk::UniqueHandle<vk::DescriptorUpdateTemplateKHR,
+                     vk::DispatchLoaderDynamic>
+        update_template;
+    DescriptorSetLayoutInfo info;
+  };
+
+  struct BindingsHash {
+    std::size_t operator()(
+        const std::vector<vk::DescriptorSetLayoutBinding>& bindings) const;
+  };
+
+  const VulkanDevice* device_;
+  std::unordered_map<std::vector<vk::DescriptorSetLayoutBinding>, Entry,
+                     BindingsHash>
+      entries_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -3,9 +3,13 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include "temp/base/assertion.h"
 #include "temp/base/logger.h"
 
 #include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_memory_allocator.h"
+#include "temp/gfx/vulkan/vulkan_offscreen_swap_chain.h"
+#include "temp/gfx/vulkan/vulkan_render_pass_cache.h"
 #include "temp/gfx/vulkan/vulkan_swap_chain.h"
 #include "temp/gfx/vulkan/vulkan_utility.h"
 
@@ -14,8 +18,9 @@ namespace gfx {
 namespace vulkan {
 
 VulkanDevice::VulkanDevice(const void* window, std::uint32_t window_width,
-                           std::uint32_t window_height) {
-  instance_ = CreateInstance("tempura", "tempura", true);
+                           std::uint32_t window_height)
+    : headless_(window == nullptr) {
+  instance_ = CreateInstance("tempura", "tempura", true, !headless_);
 
   dispatcher_.init(*instance_, reinterpret_cast<PFN_vkGetInstanceProcAddr>(
                                    vkGetInstanceProcAddr));
@@ -39,8 +44,53 @@ VulkanDevice::VulkanDevice(const void* window, std::uint32_t window_width,
   device_memory_properties_ = physical_device_.getMemoryProperties();
   queue_family_properties_ = physical_device_.getQueueFamilyProperties();
 
-  auto device_and_queue_indices =
-      CreateLogicalDevice(physical_device_, queue_family_properties_, false);
+  auto properties2_enabled = IsInstanceExtensionAvailable(
+      VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  memory_budget_enabled_ =
+      properties2_enabled &&
+      IsDeviceExtensionAvailable(physical_device_,
+                                 VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  if (properties2_enabled &&
+      IsDeviceExtensionAvailable(physical_device_,
+                                 VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+    auto features = physical_device_.getFeatures2KHR<
+        vk::PhysicalDeviceFeatures2,
+        vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>(dispatcher_);
+    timeline_semaphore_enabled_ =
+        features.get<vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR>()
+            .timelineSemaphore == VK_TRUE;
+  }
+  descriptor_update_template_enabled_ = IsDeviceExtensionAvailable(
+      physical_device_, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+  if (properties2_enabled &&
+      IsDeviceExtensionAvailable(physical_device_,
+                                 VK_KHR_MAINTENANCE3_EXTENSION_NAME) &&
+      IsDeviceExtensionAvailable(physical_device_,
+                                 VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+    auto features = physical_device_.getFeatures2KHR<
+        vk::PhysicalDeviceFeatures2,
+        vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>(dispatcher_);
+    auto&& indexing =
+        features.get<vk::PhysicalDeviceDescriptorIndexingFeaturesEXT>();
+    descriptor_indexing_enabled_ =
+        indexing.shaderSampledImageArrayNonUniformIndexing == VK_TRUE &&
+        indexing.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+        indexing.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+        indexing.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+        indexing.descriptorBindingPartiallyBound == VK_TRUE &&
+        indexing.runtimeDescriptorArray == VK_TRUE;
+  }
+  dedicated_allocation_enabled_ =
+      IsDeviceExtensionAvailable(
+          physical_device_, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME) &&
+      IsDeviceExtensionAvailable(physical_device_,
+                                 VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+
+  auto device_and_queue_indices = CreateLogicalDevice(
+      physical_device_, queue_family_properties_, false, !headless_,
+      memory_budget_enabled_, timeline_semaphore_enabled_,
+      descriptor_update_template_enabled_, descriptor_indexing_enabled_,
+      dedicated_allocation_enabled_);
 
   device_ = std::move(std::get<0>(device_and_queue_indices));
   if ((VkDevice)(*device_) == VK_NULL_HANDLE) {
@@ -69,7 +119,19 @@ VulkanDevice::VulkanDevice(const void* window, std::uint32_t window_width,
         device_->getQueue(iter->second, 0);
   }
 
-  main_swap_chain_ = std::make_unique<VulkanSwapChain>(*this, window, window_width, window_height);
+  memory_allocator_ = std::make_unique<VulkanMemoryAllocator>(
+      physical_device_, *device_, device_memory_properties_, dispatcher_,
+      memory_budget_enabled_, dedicated_allocation_enabled_);
+
+  render_pass_cache_ = std::make_unique<VulkanRenderPassCache>(*device_);
+
+  if (!headless_) {
+    main_swap_chain_ = std::make_unique<VulkanSwapChain>(
+        *this, window, window_width, window_height);
+  } else if (window_width > 0 && window_height > 0) {
+    main_swap_chain_ = std::make_unique<VulkanOffscreenSwapChain>(
+        *this, window_width, window_height);
+  }
 }
 
 VulkanDevice::~VulkanDevice() {}
@@ -102,6 +164,10 @@ std::vector<vk::Format> VulkanDevice::GetSupportedDepthFormats() const {
 
 std::unique_ptr<SwapChain> VulkanDevice::CreateSwapChain(
     const void* window, std::uint32_t width, std::uint32_t height) const {
+  if (window == nullptr) {
+    return std::make_unique<VulkanOffscreenSwapChain>(*this, width, height);
+  }
+  TEMP_ASSERT(!headless_, "headless device can't present to window");
   return std::make_unique<VulkanSwapChain>(*this, window, width, height);
 }
 
@@ -117,6 +183,33 @@ vk::PhysicalDevice VulkanDevice::physical_device() const {
 
 vk::Device VulkanDevice::device() const { return *device_; }
 
+const vk::PhysicalDeviceMemoryProperties& VulkanDevice::memory_properties()
+    const {
+  return device_memory_properties_;
+}
+
+bool VulkanDevice::headless() const { return headless_; }
+
+bool VulkanDevice::timeline_semaphore_enabled() const {
+  return timeline_semaphore_enabled_;
+}
+
+bool VulkanDevice::descriptor_update_template_enabled() const {
+  return descriptor_update_template_enabled_;
+}
+
+bool VulkanDevice::descriptor_indexing_enabled() const {
+  return descriptor_indexing_enabled_;
+}
+
+VulkanMemoryAllocator& VulkanDevice::memory_allocator() const {
+  return *memory_allocator_;
+}
+
+VulkanRenderPassCache& VulkanDevice::render_pass_cache() const {
+  return *render_pass_cache_;
+}
+
 const std::map<vk::QueueFlagBits, int>& VulkanDevice::queue_index_table()
     const {
   return queue_index_table_;
@@ -12,8 +12,18 @@ namespace temp {
 namespace gfx {
 namespace vulkan {
 
+class VulkanMemoryAllocator;
+class VulkanRenderPassCache;
 class VulkanSwapChain;
 
+/**
+ * @brief Vulkan device
+ *
+ * A device created without window is headless: it needs neither display nor
+ * surface extensions, so it runs on software implementations such as
+ * lavapipe. Its swap chains are VulkanOffscreenSwapChain, and the main one
+ * is created only when the size is not zero.
+ */
 class VulkanDevice : public Device {
  public:
   VulkanDevice() : VulkanDevice(nullptr, 0, 0) {}
@@ -42,11 +52,43 @@ class VulkanDevice : public Device {
   vk::Instance instance() const;
   vk::PhysicalDevice physical_device() const;
   vk::Device device() const;
+  const vk::PhysicalDeviceMemoryProperties& memory_properties() const;
+  bool headless() const;
+
+  /**
+   * @brief Whether VK_KHR_timeline_semaphore is enabled
+   *
+   * Its functions are called through dispatcher().
+   */
+  bool timeline_semaphore_enabled() const;
+
+  /**
+   * @brief Whether VK_KHR_descriptor_update_template is enabled
+   *
+   * Its functions are called through dispatcher().
+   */
+  bool descriptor_update_template_enabled() const;
+
+  /**
+   * @brief Whether VK_EXT_descriptor_indexing is enabled with features for
+   * bindless arrays updated after bind
+   */
+  bool descriptor_indexing_enabled() const;
+
+  VulkanMemoryAllocator& memory_allocator() const;
+
+  /**
+   * @brief Render passes and framebuffers shared by swap chains
+   */
+  VulkanRenderPassCache& render_pass_cache() const;
+
   const std::map<vk::QueueFlagBits, int>& queue_index_table() const;
   int graphics_queue_index() const;
   const std::map<vk::QueueFlagBits, vk::Queue>& queue_table() const;
 
  private:
+  bool headless_;
+
   vk::DispatchLoaderDynamic dispatcher_;
 
   vk::UniqueInstance instance_;
@@ -68,6 +110,16 @@ class VulkanDevice : public Device {
   vk::UniqueHandle<vk::DebugUtilsMessengerEXT, vk::DispatchLoaderDynamic>
       messenger_;
 
+  bool memory_budget_enabled_ = false;
+  bool timeline_semaphore_enabled_ = false;
+  bool descriptor_update_template_enabled_ = false;
+  bool descriptor_indexing_enabled_ = false;
+  bool dedicated_allocation_enabled_ = false;
+  // スワップチェインのイメージを解放してから破棄する
+  std::unique_ptr<VulkanMemoryAllocator> memory_allocator_;
+  // スワップチェインのフレームバッファを解放してから破棄する
+  std::unique_ptr<VulkanRenderPassCache> render_pass_cache_;
+
   std::unique_ptr<VulkanSwapChain> main_swap_chain_;
 };
 }  // namespace vulkan
@@ -0,0 +1,373 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_memory_allocator.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+namespace {
+const vk::DeviceSize kSmallHeapSize = 1024ull * 1024 * 1024;
+
+bool IsHostVisible(const vk::MemoryType& type) {
+  return static_cast<bool>(type.propertyFlags &
+                           vk::MemoryPropertyFlagBits::eHostVisible);
+}
+
+bool IsNonCoherent(const vk::MemoryType& type) {
+  return IsHostVisible(type) &&
+         !(type.propertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent);
+}
+
+// 外部と共有するイメージや大きなレンダーターゲットなど、ドライバが専用の
+// メモリを求めるか勧めるリソース
+bool WantsDedicatedMemory(
+    const vk::MemoryDedicatedRequirementsKHR& requirements) {
+  return requirements.requiresDedicatedAllocation == VK_TRUE ||
+         requirements.prefersDedicatedAllocation == VK_TRUE;
+}
+}  // namespace
+
+void VulkanMemoryAllocator::Deleter::operator()(Allocation* allocation) const {
+  if (allocator_ != nullptr) {
+    allocator_->Free(allocation);
+  }
+  delete allocation;
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(
+    vk::PhysicalDevice physical_device, vk::Device device,
+    const vk::PhysicalDeviceMemoryProperties& memory_properties,
+    const vk::DispatchLoaderDynamic& dispatcher, bool memory_budget_enabled,
+    bool dedicated_allocation_enabled)
+    : physical_device_(physical_device),
+      device_(device),
+      dispatcher_(dispatcher),
+      memory_budget_enabled_(memory_budget_enabled),
+      dedicated_allocation_enabled_(dedicated_allocation_enabled),
+      memory_properties_(memory_properties),
+      non_coherent_atom_size_(
+          physical_device.getProperties().limits.nonCoherentAtomSize) {
+  heap_usages_.resize(memory_properties_.memoryHeapCount, 0);
+
+  // メモリタイプとリソースの種類の組ごとにプールを持つ
+  for (std::uint32_t i = 0; i < memory_properties_.memoryTypeCount; ++i) {
+    auto heap_index = memory_properties_.memoryTypes[i].heapIndex;
+    auto heap_size = memory_properties_.memoryHeaps[heap_index].size;
+    // 小さいヒープを少数のブロックで使い切らないようにする
+    auto block_size = heap_size <= kSmallHeapSize
+                          ? std::min(kDefaultBlockSize, heap_size / 8)
+                          : kDefaultBlockSize;
+    for (int j = 0; j < 2; ++j) {
+      pools_.emplace_back(Pool{i, block_size, {}});
+    }
+  }
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+  for (auto&& pool : pools_) {
+    for (auto&& block : pool.blocks) {
+      if (block->allocator.allocation_count() > 0) {
+        TEMP_LOG_WARNING("Device memory is destroyed before freed. count: ",
+                         block->allocator.allocation_count());
+      }
+    }
+  }
+  if (dedicated_count_ > 0) {
+    TEMP_LOG_WARNING("Dedicated device memory is not freed. count: ",
+                     dedicated_count_);
+  }
+}
+
+auto VulkanMemoryAllocator::Allocate(const vk::MemoryRequirements& requirements,
+                                     ResourceType resource_type,
+                                     vk::MemoryPropertyFlags required,
+                                     vk::MemoryPropertyFlags preferred,
+                                     bool dedicated) -> UniqueAllocation {
+  return AllocateForResource(requirements, resource_type, required, preferred,
+                             dedicated, nullptr);
+}
+
+auto VulkanMemoryAllocator::AllocateBufferMemory(
+    vk::Buffer buffer, vk::MemoryPropertyFlags required,
+    vk::MemoryPropertyFlags preferred) -> UniqueAllocation {
+  vk::MemoryRequirements requirements;
+  auto dedicated = false;
+  vk::MemoryDedicatedAllocateInfoKHR dedicated_ai;
+  dedicated_ai.buffer = buffer;
+  if (dedicated_allocation_enabled_) {
+    auto chain = device_.getBufferMemoryRequirements2KHR<
+        vk::MemoryRequirements2KHR, vk::MemoryDedicatedRequirementsKHR>(
+        vk::BufferMemoryRequirementsInfo2KHR(buffer), dispatcher_);
+    requirements = chain.get<vk::MemoryRequirements2KHR>().memoryRequirements;
+    dedicated =
+        WantsDedicatedMemory(chain.get<vk::MemoryDedicatedRequirementsKHR>());
+  } else {
+    requirements = device_.getBufferMemoryRequirements(buffer);
+  }
+
+  auto allocation = AllocateForResource(
+      requirements, ResourceType::kLinear, required, preferred, dedicated,
+      dedicated_allocation_enabled_ ? &dedicated_ai : nullptr);
+  device_.bindBufferMemory(buffer, allocation->memory, allocation->offset);
+  return allocation;
+}
+
+auto VulkanMemoryAllocator::AllocateImageMemory(
+    vk::Image image, vk::MemoryPropertyFlags required,
+    vk::MemoryPropertyFlags preferred) -> UniqueAllocation {
+  vk::MemoryRequirements requirements;
+  auto dedicated = false;
+  vk::MemoryDedicatedAllocateInfoKHR dedicated_ai;
+  dedicated_ai.image = image;
+  if (dedicated_allocation_enabled_) {
+    auto chain = device_.getImageMemoryRequirements2KHR<
+        vk::MemoryRequirements2KHR, vk::MemoryDedicatedRequirementsKHR>(
+        vk::ImageMemoryRequirementsInfo2KHR(image), dispatcher_);
+    requirements = chain.get<vk::MemoryRequirements2KHR>().memoryRequirements;
+    dedicated =
+        WantsDedicatedMemory(chain.get<vk::MemoryDedicatedRequirementsKHR>());
+  } else {
+    requirements = device_.getImageMemoryRequirements(image);
+  }
+
+  auto allocation = AllocateForResource(
+      requirements, ResourceType::kOptimal, required, preferred, dedicated,
+      dedicated_allocation_enabled_ ? &dedicated_ai : nullptr);
+  device_.bindImageMemory(image, allocation->memory, allocation->offset);
+  return allocation;
+}
+
+auto VulkanMemoryAllocator::GetStatistics() const -> Statistics {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Statistics statistics;
+  statistics.dedicated_count = dedicated_count_;
+  statistics.allocation_count = dedicated_count_;
+  statistics.block_bytes = dedicated_bytes_;
+  statistics.used_bytes = dedicated_bytes_;
+
+  vk::DeviceSize free_bytes = 0;
+  vk::DeviceSize largest_sum = 0;
+  for (auto&& pool : pools_) {
+    for (auto&& block : pool.blocks) {
+      auto&& allocator = block->allocator;
+      auto largest = allocator.LargestFreeSize();
+      ++statistics.block_count;
+      statistics.allocation_count += allocator.allocation_count();
+      statistics.block_bytes += allocator.size();
+      statistics.used_bytes += allocator.used_size();
+      statistics.largest_free_bytes =
+          std::max(statistics.largest_free_bytes, largest);
+      free_bytes += allocator.free_size();
+      largest_sum += largest;
+    }
+  }
+  if (free_bytes > 0) {
+    statistics.fragmentation =
+        1.0f - static_cast<float>(static_cast<double>(largest_sum) /
+                                  static_cast<double>(free_bytes));
+  }
+  return statistics;
+}
+
+auto VulkanMemoryAllocator::GetHeapBudgets() const
+    -> std::vector<HeapBudget> {
+  std::vector<HeapBudget> budgets(memory_properties_.memoryHeapCount);
+  if (memory_budget_enabled_) {
+    auto chain = physical_device_.getMemoryProperties2KHR<
+        vk::PhysicalDeviceMemoryProperties2,
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT>(dispatcher_);
+    auto&& budget_properties =
+        chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    for (std::size_t i = 0; i < budgets.size(); ++i) {
+      budgets[i].usage = budget_properties.heapUsage[i];
+      budgets[i].budget = budget_properties.heapBudget[i];
+    }
+    return budgets;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (std::size_t i = 0; i < budgets.size(); ++i) {
+    budgets[i].usage = heap_usages_[i];
+    budgets[i].budget = memory_properties_.memoryHeaps[i].size * 8 / 10;
+  }
+  return budgets;
+}
+
+auto VulkanMemoryAllocator::AllocateForResource(
+    const vk::MemoryRequirements& requirements, ResourceType resource_type,
+    vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred,
+    bool dedicated, const vk::MemoryDedicatedAllocateInfoKHR* dedicated_ai)
+    -> UniqueAllocation {
+  auto index =
+      FindMemoryType(requirements.memoryTypeBits, required, preferred);
+  if (index < 0) {
+    TEMP_LOG_ERROR("Not found memory type. flags: ",
+                   static_cast<std::uint32_t>(required));
+    std::abort();
+  }
+  auto memory_type_index = static_cast<std::uint32_t>(index);
+  auto&& memory_type = memory_properties_.memoryTypes[memory_type_index];
+
+  // 非コヒーレントなメモリはフラッシュの単位で分ける
+  auto size = requirements.size;
+  auto alignment = requirements.alignment;
+  if (IsNonCoherent(memory_type)) {
+    alignment = std::max(alignment, non_coherent_atom_size_);
+    auto atom = non_coherent_atom_size_;
+    size = (size + atom - 1) & ~(atom - 1);
+  }
+
+  UniqueAllocation allocation(new Allocation{}, Deleter(this));
+  allocation->size = size;
+  allocation->memory_type_index = memory_type_index;
+  allocation->resource_type = resource_type;
+  allocation->handle = TlsfAllocator::kInvalidHandle;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto&& pool = GetPool(memory_type_index, resource_type);
+
+  if (dedicated || size > pool.block_size / 2) {
+    // リソース専用のメモリは要求と同じ大きさでなければならない
+    if (dedicated_ai != nullptr) {
+      size = requirements.size;
+      allocation->size = size;
+    }
+    void* mapped = nullptr;
+    allocation->dedicated_memory =
+        AllocateDeviceMemory(memory_type_index, size, &mapped, dedicated_ai);
+    allocation->memory = *allocation->dedicated_memory;
+    allocation->offset = 0;
+    allocation->mapped = mapped;
+    ++dedicated_count_;
+    dedicated_bytes_ += size;
+    return allocation;
+  }
+
+  TlsfAllocator::Allocation range;
+  Block* block = nullptr;
+  for (auto&& b : pool.blocks) {
+    if (b->allocator.Allocate(size, alignment, &range)) {
+      block = b.get();
+      break;
+    }
+  }
+
+  if (block == nullptr) {
+    void* mapped = nullptr;
+    auto memory = AllocateDeviceMemory(memory_type_index, pool.block_size,
+                                       &mapped, nullptr);
+    pool.blocks.emplace_back(std::make_unique<Block>(
+        Block{std::move(memory), mapped, TlsfAllocator(pool.block_size)}));
+    block = pool.blocks.back().get();
+    auto succeeded = block->allocator.Allocate(size, alignment, &range);
+    TEMP_ASSERT(succeeded, "allocation must fit in empty block");
+    (void)succeeded;
+  }
+
+  allocation->memory = *block->memory;
+  allocation->offset = range.offset;
+  allocation->handle = range.handle;
+  allocation->mapped =
+      block->mapped != nullptr
+          ? static_cast<std::uint8_t*>(block->mapped) + range.offset
+          : nullptr;
+  return allocation;
+}
+
+void VulkanMemoryAllocator::Free(Allocation* allocation) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto heap_index =
+      memory_properties_.memoryTypes[allocation->memory_type_index].heapIndex;
+
+  if (allocation->dedicated_memory) {
+    if (allocation->mapped != nullptr) {
+      device_.unmapMemory(*allocation->dedicated_memory);
+    }
+    allocation->dedicated_memory.reset();
+    heap_usages_[heap_index] -= allocation->size;
+    --dedicated_count_;
+    dedicated_bytes_ -= allocation->size;
+    return;
+  }
+
+  auto&& pool =
+      GetPool(allocation->memory_type_index, allocation->resource_type);
+  auto iter = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+                           [allocation](const std::unique_ptr<Block>& block) {
+                             return *block->memory == allocation->memory;
+                           });
+  TEMP_ASSERT(iter != pool.blocks.end(), "allocation must be in pool");
+  auto&& block = *iter;
+  block->allocator.Free(allocation->handle);
+  if (block->allocator.allocation_count() > 0) {
+    return;
+  }
+
+  // 確保と解放を繰り返してもドライバを呼ばないように、空のブロックを1つ残す
+  auto empty_count = std::count_if(
+      pool.blocks.begin(), pool.blocks.end(),
+      [](const std::unique_ptr<Block>& block) {
+        return block->allocator.allocation_count() == 0;
+      });
+  if (empty_count > 1) {
+    if (block->mapped != nullptr) {
+      device_.unmapMemory(*block->memory);
+    }
+    heap_usages_[heap_index] -= block->allocator.size();
+    pool.blocks.erase(iter);
+  }
+}
+
+int VulkanMemoryAllocator::FindMemoryType(
+    std::uint32_t type_bits, vk::MemoryPropertyFlags required,
+    vk::MemoryPropertyFlags preferred) const {
+  auto find = [&](vk::MemoryPropertyFlags flags) {
+    for (std::uint32_t i = 0; i < memory_properties_.memoryTypeCount; ++i) {
+      if ((type_bits & (1u << i)) &&
+          (memory_properties_.memoryTypes[i].propertyFlags & flags) == flags) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  };
+  auto index = find(required | preferred);
+  return index >= 0 ? index : find(required);
+}
+
+auto VulkanMemoryAllocator::GetPool(std::uint32_t memory_type_index,
+                                    ResourceType resource_type) -> Pool& {
+  auto offset = resource_type == ResourceType::kLinear ? 0 : 1;
+  return pools_[memory_type_index * 2 + offset];
+}
+
+vk::UniqueDeviceMemory VulkanMemoryAllocator::AllocateDeviceMemory(
+    std::uint32_t memory_type_index, vk::DeviceSize size, void** mapped,
+    const vk::MemoryDedicatedAllocateInfoKHR* dedicated_ai) {
+  vk::MemoryAllocateInfo memory_ai;
+  memory_ai.pNext = dedicated_ai;
+  memory_ai.allocationSize = size;
+  memory_ai.memoryTypeIndex = memory_type_index;
+  auto memory = device_.allocateMemoryUnique(memory_ai);
+
+  // マップは重いので、解放までマップしたままにする
+  auto&& memory_type = memory_properties_.memoryTypes[memory_type_index];
+  *mapped = IsHostVisible(memory_type)
+                ? device_.mapMemory(*memory, 0, VK_WHOLE_SIZE)
+                : nullptr;
+
+  heap_usages_[memory_type.heapIndex] += size;
+  return memory;
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
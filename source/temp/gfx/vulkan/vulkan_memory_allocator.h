@@ -0,0 +1,201 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "temp/gfx/tlsf_allocator.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+/**
+ * @brief Device memory allocator suballocating large blocks
+ *
+ * Drivers limit the count of vkAllocateMemory calls and each call is slow,
+ * so resources share blocks of kDefaultBlockSize bytes (an eighth of heaps
+ * up to 1 GiB) managed by TlsfAllocator. Blocks of host visible memory stay
+ * mapped while they live. Allocations larger than half of a block get their
+ * own vkDeviceMemory, and so do buffers and images for which the driver
+ * requires or prefers a dedicated allocation.
+ *
+ * Buffers and linear images never share a block with optimal images, so
+ * bufferImageGranularity doesn't need to be honored between neighbors.
+ *
+ * Thread safe.
+ */
+class VulkanMemoryAllocator {
+ public:
+  static constexpr vk::DeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+
+  enum class ResourceType {
+    kLinear,   ///< buffers and images with linear tiling
+    kOptimal,  ///< images with optimal tiling
+  };
+
+  struct Allocation {
+    vk::DeviceMemory memory;
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+    /// null unless memory is host visible
+    void* mapped;
+
+    // 解放時に使う
+    std::uint32_t memory_type_index;
+    ResourceType resource_type;
+    TlsfAllocator::Handle handle;
+    vk::UniqueDeviceMemory dedicated_memory;
+  };
+
+  class Deleter {
+   public:
+    Deleter() = default;
+    explicit Deleter(VulkanMemoryAllocator* allocator)
+        : allocator_(allocator) {}
+    void operator()(Allocation* allocation) const;
+
+   private:
+    VulkanMemoryAllocator* allocator_ = nullptr;
+  };
+
+  using UniqueAllocation = std::unique_ptr<Allocation, Deleter>;
+
+  struct Statistics {
+    std::size_t block_count = 0;
+    std::size_t dedicated_count = 0;
+    std::size_t allocation_count = 0;
+    /// bytes allocated from the driver
+    vk::DeviceSize block_bytes = 0;
+    /// bytes handed out to resources
+    vk::DeviceSize used_bytes = 0;
+    vk::DeviceSize largest_free_bytes = 0;
+    /// 1 - sum of largest free ranges of blocks / free bytes
+    float fragmentation = 0.0f;
+  };
+
+  struct HeapBudget {
+    /// bytes used by this process, by all allocators if reported by driver
+    vk::DeviceSize usage = 0;
+    /// bytes this process can use without paging
+    vk::DeviceSize budget = 0;
+  };
+
+  /**
+   * @param memory_budget_enabled whether VK_EXT_memory_budget is enabled
+   * @param dedicated_allocation_enabled whether
+   * VK_KHR_get_memory_requirements2 and VK_KHR_dedicated_allocation are
+   * enabled
+   */
+  explicit VulkanMemoryAllocator(
+      vk::PhysicalDevice physical_device, vk::Device device,
+      const vk::PhysicalDeviceMemoryProperties& memory_properties,
+      const vk::DispatchLoaderDynamic& dispatcher, bool memory_budget_enabled,
+      bool dedicated_allocation_enabled);
+  ~VulkanMemoryAllocator();
+
+  VulkanMemoryAllocator(const VulkanMemoryAllocator&) = delete;
+  VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator&) = delete;
+
+  /**
+   * @brief Allocate memory of type having required and, if possible,
+   * preferred flags
+   *
+   * Aborts if no memory type has required flags. vk::SystemError is thrown
+   * when the heap is exhausted.
+   *
+   * @param dedicated allocate vkDeviceMemory only for this allocation
+   */
+  UniqueAllocation Allocate(const vk::MemoryRequirements& requirements,
+                            ResourceType resource_type,
+                            vk::MemoryPropertyFlags required,
+                            vk::MemoryPropertyFlags preferred =
+                                vk::MemoryPropertyFlags(),
+                            bool dedicated = false);
+
+  /**
+   * @brief Allocate and bind memory for buffer
+   */
+  UniqueAllocation AllocateBufferMemory(
+      vk::Buffer buffer, vk::MemoryPropertyFlags required,
+      vk::MemoryPropertyFlags preferred = vk::MemoryPropertyFlags());
+
+  /**
+   * @brief Allocate and bind memory for image with optimal tiling
+   */
+  UniqueAllocation AllocateImageMemory(
+      vk::Image image, vk::MemoryPropertyFlags required,
+      vk::MemoryPropertyFlags preferred = vk::MemoryPropertyFlags());
+
+  Statistics GetStatistics() const;
+
+  /**
+   * @brief Usage and budget of each memory heap
+   *
+   * Without VK_EXT_memory_budget, usage counts only memory of this allocator
+   * and budget is 80% of heap size.
+   */
+  std::vector<HeapBudget> GetHeapBudgets() const;
+
+ private:
+  struct Block {
+    vk::UniqueDeviceMemory memory;
+    void* mapped;
+    TlsfAllocator allocator;
+  };
+
+  struct Pool {
+    std::uint32_t memory_type_index;
+    vk::DeviceSize block_size;
+    std::vector<std::unique_ptr<Block>> blocks;
+  };
+
+  /**
+   * @brief Allocate() for one resource
+   *
+   * @param dedicated_ai chained to vkAllocateMemory when the allocation gets
+   * its own vkDeviceMemory, or null
+   */
+  UniqueAllocation AllocateForResource(
+      const vk::MemoryRequirements& requirements, ResourceType resource_type,
+      vk::MemoryPropertyFlags required, vk::MemoryPropertyFlags preferred,
+      bool dedicated, const vk::MemoryDedicatedAllocateInfoKHR* dedicated_ai);
+
+  void Free(Allocation* allocation);
+
+  int FindMemoryType(std::uint32_t type_bits, vk::MemoryPropertyFlags required,
+                     vk::MemoryPropertyFlags preferred) const;
+
+  Pool& GetPool(std::uint32_t memory_type_index, ResourceType resource_type);
+
+  /**
+   * @brief Allocate vkDeviceMemory mapped if host visible
+   *
+   * @param dedicated_ai resource owning the memory alone, or null
+   */
+  vk::UniqueDeviceMemory AllocateDeviceMemory(
+      std::uint32_t memory_type_index, vk::DeviceSize size, void** mapped,
+      const vk::MemoryDedicatedAllocateInfoKHR* dedicated_ai);
+
+  vk::PhysicalDevice physical_device_;
+  vk::Device device_;
+  vk::DispatchLoaderDynamic dispatcher_;
+  bool memory_budget_enabled_;
+  bool dedicated_allocation_enabled_;
+  vk::PhysicalDeviceMemoryProperties memory_properties_;
+  vk::DeviceSize non_coherent_atom_size_;
+
+  mutable std::mutex mutex_;
+  std::vector<Pool> pools_;
+  std::size_t dedicated_count_ = 0;
+  vk::DeviceSize dedicated_bytes_ = 0;
+  // ヒープごとにドライバから確保したバイト数
+  std::vector<vk::DeviceSize> heap_usages_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -0,0 +1,298 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <cstring>
+#include <limits>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_offscreen_swap_chain.h"
+#include "temp/gfx/vulkan/vulkan_utility.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+namespace {
+// Color32Bit と同じバイト順で、カラーアタッチメントとしての対応が必須の形式
+const vk::Format kColorFormat = vk::Format::eR8G8B8A8Unorm;
+
+vk::ImageSubresourceRange ColorSubresourceRange() {
+  vk::ImageSubresourceRange range;
+  range.aspectMask = vk::ImageAspectFlagBits::eColor;
+  range.levelCount = 1;
+  range.layerCount = 1;
+  return range;
+}
+}  // namespace
+
+VulkanOffscreenSwapChain::VulkanOffscreenSwapChain(const VulkanDevice& device,
+                                                   std::uint32_t width,
+                                                   std::uint32_t height,
+                                                   std::uint32_t frame_count) {
+  auto vk_device = device.device();
+
+  // 基底クラスの color_format() と width(), height() はここから読まれる
+  swap_chain_ci_.imageFormat = kColorFormat;
+  swap_chain_ci_.imageExtent = vk::Extent2D(width, height);
+
+  vk::CommandPoolCreateInfo command_pool_ci;
+  command_pool_ci.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+  command_pool_ci.queueFamilyIndex = device.graphics_queue_index();
+  command_pool_ = vk_device.createCommandPoolUnique(command_pool_ci);
+
+  vk::CommandBufferAllocateInfo command_buffer_ai;
+  command_buffer_ai.commandPool = *command_pool_;
+  command_buffer_ai.level = vk::CommandBufferLevel::ePrimary;
+  command_buffer_ai.commandBufferCount = 1;
+  command_buffer_ =
+      std::move(vk_device.allocateCommandBuffersUnique(command_buffer_ai)[0]);
+
+  fence_ = vk_device.createFenceUnique(vk::FenceCreateInfo());
+
+  // 同じ形式のオフスクリーンのスワップチェインはレンダーパスを共有する
+  render_pass_cache_ = &device.render_pass_cache();
+  render_pass_ = render_pass_cache_->GetRenderPass(RenderPassState::Color(
+      kColorFormat, vk::ImageLayout::eTransferSrcOptimal));
+
+  frames_ = CreateFrames(vk_device, frame_count, false);
+
+  CreateImages(device);
+}
+
+VulkanOffscreenSwapChain::~VulkanOffscreenSwapChain() {
+  // 実行中のフレームが描画しているイメージを解放しないように待つ
+  WaitForFrames();
+  // ビューとフレームバッファはイメージより先に破棄する
+  ReleaseFrameBuffers();
+  images_.clear();
+}
+
+void VulkanOffscreenSwapChain::Present(const Device* device) {
+  TEMP_ASSERT(device->api_type() == ApiType::kVulkan,
+              "device must be VulkanDevice");
+  auto temp_device = static_cast<const VulkanDevice*>(device);
+
+  if (!acquired_) {
+    AcquireNextImage(temp_device->device());
+  }
+  // 描画がなくてもフェンスをシグナルさせる
+  if (!submitted_) {
+    Submit(*temp_device, {});
+  }
+
+  if (readback_enabled_) {
+    ReadBack(*temp_device);
+  }
+
+  AdvanceFrame();
+}
+
+void VulkanOffscreenSwapChain::Resize(const Device* device,
+                                      std::uint32_t width,
+                                      std::uint32_t height) {
+  TEMP_ASSERT(device->api_type() == ApiType::kVulkan,
+              "device must be VulkanDevice");
+  auto tvk_device = static_cast<const VulkanDevice*>(device);
+
+  tvk_device->device().waitIdle();
+
+  ReleaseFrameBuffers();
+  images_.clear();
+  color_images_.clear();
+  color_memories_.clear();
+
+  // 読み戻し用のバッファは次の Present() で作り直す
+  readback_data_ = nullptr;
+  readback_buffer_.reset();
+  readback_memory_.reset();
+  readback_pixels_.clear();
+
+  // 待機後なのでフェンスはすべてシグナル状態で、フレームは作り直さなくてよい
+  swap_chain_ci_.imageExtent = vk::Extent2D(width, height);
+  CreateImages(*tvk_device);
+}
+
+std::uint32_t VulkanOffscreenSwapChain::AcquireNextImage(
+    const vk::Device vk_device) {
+  TEMP_ASSERT(!acquired_, "image is already acquired in this frame");
+
+  // イメージはフレームごとに1枚なので、フレームのフェンスだけ待てばよい
+  vk_device.waitForFences(*frames_[current_frame_].fence, VK_TRUE,
+                          std::numeric_limits<std::uint64_t>::max());
+  current_image_ = current_frame_;
+  acquired_ = true;
+  return current_image_;
+}
+
+bool VulkanOffscreenSwapChain::readback_enabled() const {
+  return readback_enabled_;
+}
+
+void VulkanOffscreenSwapChain::set_readback_enabled(bool enabled) {
+  readback_enabled_ = enabled;
+}
+
+const std::vector<Color32Bit>& VulkanOffscreenSwapChain::readback_pixels()
+    const {
+  return readback_pixels_;
+}
+
+void VulkanOffscreenSwapChain::CreateImages(const VulkanDevice& device) {
+  auto vk_device = device.device();
+
+  vk::ImageCreateInfo image_ci;
+  image_ci.imageType = vk::ImageType::e2D;
+  image_ci.format = kColorFormat;
+  image_ci.extent = vk::Extent3D(width(), height(), 1);
+  image_ci.mipLevels = 1;
+  image_ci.arrayLayers = 1;
+  image_ci.samples = vk::SampleCountFlagBits::e1;
+  image_ci.tiling = vk::ImageTiling::eOptimal;
+  image_ci.usage = vk::ImageUsageFlagBits::eColorAttachment |
+                   vk::ImageUsageFlagBits::eTransferSrc;
+  image_ci.sharingMode = vk::SharingMode::eExclusive;
+  image_ci.initialLayout = vk::ImageLayout::eUndefined;
+
+  vk::ImageViewCreateInfo image_view_ci;
+  image_view_ci.format = kColorFormat;
+  image_view_ci.subresourceRange = ColorSubresourceRange();
+  image_view_ci.viewType = vk::ImageViewType::e2D;
+
+  for (std::uint32_t i = 0; i < frame_count(); ++i) {
+    auto image = vk_device.createImageUnique(image_ci);
+    auto memory = device.memory_allocator().AllocateImageMemory(
+        *image, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    image_view_ci.image = *image;
+    auto view = vk_device.createImageViewUnique(image_view_ci);
+    images_.emplace_back(Image{*image, std::move(view), vk::Fence()});
+    color_images_.emplace_back(std::move(image));
+    color_memories_.emplace_back(std::move(memory));
+  }
+
+  // 描画前に読み戻してもよいように、描画の外でのレイアウトにしておく
+  ExecuteCommands(device, [this](vk::CommandBuffer command_buffer) {
+    std::vector<vk::ImageMemoryBarrier> barriers;
+    for (auto&& image : images_) {
+      vk::ImageMemoryBarrier barrier;
+      barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+      barrier.oldLayout = vk::ImageLayout::eUndefined;
+      barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+      barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+      barrier.image = image.image;
+      barrier.subresourceRange = ColorSubresourceRange();
+      barriers.emplace_back(barrier);
+    }
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                   vk::PipelineStageFlagBits::eTransfer,
+                                   vk::DependencyFlags(), nullptr, nullptr,
+                                   barriers);
+  });
+
+  CreateFrameBuffers();
+}
+
+void VulkanOffscreenSwapChain::CreateReadbackBuffer(
+    const VulkanDevice& device) {
+  auto vk_device = device.device();
+
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = sizeof(Color32Bit) * width() * height();
+  buffer_ci.usage = vk::BufferUsageFlagBits::eTransferDst;
+  buffer_ci.sharingMode = vk::SharingMode::eExclusive;
+  readback_buffer_ = vk_device.createBufferUnique(buffer_ci);
+
+  // CPU から読むので、キャッシュされるメモリがあればそちらを使う
+  // ホストから見えるメモリはアロケータがマップしたままにしている
+  readback_memory_ = device.memory_allocator().AllocateBufferMemory(
+      *readback_buffer_,
+      vk::MemoryPropertyFlagBits::eHostVisible |
+          vk::MemoryPropertyFlagBits::eHostCoherent,
+      vk::MemoryPropertyFlagBits::eHostCached);
+  readback_data_ = readback_memory_->mapped;
+}
+
+void VulkanOffscreenSwapChain::ReadBack(const VulkanDevice& device) {
+  if (!readback_buffer_) {
+    CreateReadbackBuffer(device);
+  }
+
+  auto image = current_image().image;
+  ExecuteCommands(device, [this, image](vk::CommandBuffer command_buffer) {
+    // レンダーパスの書き込みを待つ。レイアウトは終了時に変わっている
+    vk::ImageMemoryBarrier image_barrier;
+    image_barrier.srcAccessMask = vk::AccessFlagBits::eColorAttachmentWrite;
+    image_barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    image_barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    image_barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    image_barrier.image = image;
+    image_barrier.subresourceRange = ColorSubresourceRange();
+    command_buffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr,
+        nullptr, image_barrier);
+
+    vk::BufferImageCopy region;
+    region.imageSubresource.aspectMask = vk::ImageAspectFlagBits::eColor;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = vk::Extent3D(width(), height(), 1);
+    command_buffer.copyImageToBuffer(image,
+                                     vk::ImageLayout::eTransferSrcOptimal,
+                                     *readback_buffer_, region);
+
+    vk::BufferMemoryBarrier buffer_barrier;
+    buffer_barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    buffer_barrier.dstAccessMask = vk::AccessFlagBits::eHostRead;
+    buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    buffer_barrier.buffer = *readback_buffer_;
+    buffer_barrier.size = VK_WHOLE_SIZE;
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                   vk::PipelineStageFlagBits::eHost,
+                                   vk::DependencyFlags(), nullptr,
+                                   buffer_barrier, nullptr);
+  });
+
+  readback_pixels_.resize(width() * height());
+  std::memcpy(readback_pixels_.data(), readback_data_,
+              sizeof(Color32Bit) * readback_pixels_.size());
+}
+
+void VulkanOffscreenSwapChain::ExecuteCommands(
+    const VulkanDevice& device,
+    const std::function<void(vk::CommandBuffer)>& record) {
+  command_buffer_->reset(vk::CommandBufferResetFlags());
+
+  vk::CommandBufferBeginInfo command_buffer_bi;
+  command_buffer_bi.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  command_buffer_->begin(command_buffer_bi);
+  record(*command_buffer_);
+  command_buffer_->end();
+
+  auto&& iter = device.queue_table().find(vk::QueueFlagBits::eGraphics);
+  TEMP_ASSERT(iter != device.queue_table().end(),
+              "queue_table must contain graphics queue");
+  auto&& graphics_queue = iter->second;
+
+  vk::SubmitInfo submit_info;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &command_buffer_.get();
+  graphics_queue.submit(submit_info, *fence_);
+
+  auto vk_device = device.device();
+  vk_device.waitForFences(*fence_, VK_TRUE,
+                          std::numeric_limits<std::uint64_t>::max());
+  vk_device.resetFences(*fence_);
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
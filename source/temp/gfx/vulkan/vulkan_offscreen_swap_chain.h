@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "temp/gfx/color.h"
+#include "temp/gfx/vulkan/vulkan_memory_allocator.h"
+#include "temp/gfx/vulkan/vulkan_swap_chain.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+/**
+ * @brief Swap chain rendering into images it owns, without window
+ *
+ * There is one image per frame in flight. Present() copies the presented
+ * image to host memory when readback is enabled. Outside render passes the
+ * images are in eTransferSrcOptimal layout. Frames have no semaphores
+ * because nothing waits for a display.
+ */
+class VulkanOffscreenSwapChain : public VulkanSwapChain {
+ public:
+  explicit VulkanOffscreenSwapChain(
+      const VulkanDevice& device, std::uint32_t width, std::uint32_t height,
+      std::uint32_t frame_count = kDefaultFrameCount);
+  ~VulkanOffscreenSwapChain();
+
+  VulkanOffscreenSwapChain(const VulkanOffscreenSwapChain&) = delete;
+  VulkanOffscreenSwapChain& operator=(const VulkanOffscreenSwapChain&) =
+      delete;
+
+  VulkanOffscreenSwapChain(VulkanOffscreenSwapChain&&) = delete;
+  VulkanOffscreenSwapChain& operator=(VulkanOffscreenSwapChain&&) = delete;
+
+  void Present(const Device* device) override;
+
+  void Resize(const Device* device, std::uint32_t width,
+              std::uint32_t height) override;
+
+  std::uint32_t AcquireNextImage(const vk::Device vk_device) override;
+
+  bool readback_enabled() const;
+
+  /**
+   * @brief Copy images to host memory on Present()
+   *
+   * Present() waits for the copy, so this is meant for batch rendering and
+   * tests rather than interactive frame rates.
+   */
+  void set_readback_enabled(bool enabled);
+
+  /**
+   * @brief Pixels of the image presented last, rows from top to bottom
+   *
+   * Empty until an image is presented with readback enabled.
+   */
+  const std::vector<Color32Bit>& readback_pixels() const;
+
+ private:
+  void CreateImages(const VulkanDevice& device);
+
+  void CreateReadbackBuffer(const VulkanDevice& device);
+
+  void ReadBack(const VulkanDevice& device);
+
+  /**
+   * @brief Record commands and wait until graphics queue executes them
+   */
+  void ExecuteCommands(const VulkanDevice& device,
+                       const std::function<void(vk::CommandBuffer)>& record);
+
+  std::vector<vk::UniqueImage> color_images_;
+  std::vector<VulkanMemoryAllocator::UniqueAllocation> color_memories_;
+  vk::UniqueCommandPool command_pool_;
+  vk::UniqueCommandBuffer command_buffer_;
+  vk::UniqueFence fence_;
+  bool readback_enabled_ = false;
+  vk::UniqueBuffer readback_buffer_;
+  VulkanMemoryAllocator::UniqueAllocation readback_memory_;
+  const void* readback_data_ = nullptr;
+  std::vector<Color32Bit> readback_pixels_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
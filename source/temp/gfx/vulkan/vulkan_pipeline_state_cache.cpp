@@ -0,0 +1,372 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "temp/base/hash.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_pipeline_state_cache.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+namespace {
+const std::uint32_t kFileMagic = 0x43535054;  // "TPSC"
+const std::uint32_t kFileVersion = 1;
+
+/**
+ * @brief Header in front of vk::PipelineCache data in file
+ *
+ * The driver checks the header of its own data too, but it may crash on
+ * data from another driver, so the file is checked before handing it over.
+ */
+struct FileHeader {
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint32_t vendor_id;
+  std::uint32_t device_id;
+  std::uint32_t driver_version;
+  std::uint8_t pipeline_cache_uuid[VK_UUID_SIZE];
+  std::uint64_t data_size;
+  std::uint64_t data_hash;
+};
+
+FileHeader MakeFileHeader(const vk::PhysicalDeviceProperties& properties) {
+  FileHeader header;
+  // パディングもファイルに書かれるので消しておく
+  std::memset(&header, 0, sizeof(header));
+  header.magic = kFileMagic;
+  header.version = kFileVersion;
+  header.vendor_id = properties.vendorID;
+  header.device_id = properties.deviceID;
+  header.driver_version = properties.driverVersion;
+  std::memcpy(header.pipeline_cache_uuid, properties.pipelineCacheUUID,
+              VK_UUID_SIZE);
+  return header;
+}
+
+vk::UniqueShaderModule CreateShaderModule(
+    vk::Device device, const std::vector<std::uint32_t>& code) {
+  vk::ShaderModuleCreateInfo shader_module_ci;
+  shader_module_ci.codeSize = code.size() * sizeof(std::uint32_t);
+  shader_module_ci.pCode = code.data();
+  return device.createShaderModuleUnique(shader_module_ci);
+}
+}  // namespace
+
+bool GraphicsPipelineState::operator==(
+    const GraphicsPipelineState& other) const {
+  return vertex_shader == other.vertex_shader &&
+         fragment_shader == other.fragment_shader &&
+         vertex_bindings == other.vertex_bindings &&
+         vertex_attributes == other.vertex_attributes &&
+         topology == other.topology && polygon_mode == other.polygon_mode &&
+         cull_mode == other.cull_mode && front_face == other.front_face &&
+         samples == other.samples && depth_test == other.depth_test &&
+         depth_write == other.depth_write &&
+         depth_compare_op == other.depth_compare_op &&
+         blend_attachments == other.blend_attachments &&
+         layout == other.layout && render_pass == other.render_pass &&
+         subpass == other.subpass;
+}
+
+bool GraphicsPipelineState::operator!=(
+    const GraphicsPipelineState& other) const {
+  return !(*this == other);
+}
+
+std::uint64_t GraphicsPipelineState::Hash() const {
+  // Vulkan の構造体はすべて 4 バイトのメンバーで、パディングがない
+  auto hash = kFnvOffsetBasis;
+  HashVector(vertex_shader, &hash);
+  HashVector(fragment_shader, &hash);
+  HashVector(vertex_bindings, &hash);
+  HashVector(vertex_attributes, &hash);
+  HashValue(topology, &hash);
+  HashValue(polygon_mode, &hash);
+  HashValue(static_cast<VkCullModeFlags>(cull_mode), &hash);
+  HashValue(front_face, &hash);
+  HashValue(samples, &hash);
+  HashValue(depth_test, &hash);
+  HashValue(depth_write, &hash);
+  HashValue(depth_compare_op, &hash);
+  HashVector(blend_attachments, &hash);
+  HashValue(static_cast<VkPipelineLayout>(layout), &hash);
+  HashValue(static_cast<VkRenderPass>(render_pass), &hash);
+  HashValue(subpass, &hash);
+  return hash;
+}
+
+VulkanPipelineStateCache::VulkanPipelineStateCache(
+    const VulkanDevice& device, const std::string& file_path,
+    std::size_t worker_count)
+    : device_(&device),
+      file_path_(file_path),
+      properties_(device.physical_device().getProperties()) {
+  auto data = LoadCacheData();
+  loaded_ = !data.empty();
+
+  vk::PipelineCacheCreateInfo pipeline_cache_ci;
+  pipeline_cache_ci.initialDataSize = data.size();
+  pipeline_cache_ci.pInitialData = data.data();
+  pipeline_cache_ =
+      device.device().createPipelineCacheUnique(pipeline_cache_ci);
+
+  if (worker_count > 0) {
+    thread_pool_ = std::make_unique<ThreadPool>(worker_count);
+  }
+}
+
+VulkanPipelineStateCache::~VulkanPipelineStateCache() {
+  // デストラクタから例外を投げないように、失敗したエントリは無視する
+  for (auto&& pair : entries_) {
+    if (pair.second.compiled.valid()) {
+      pair.second.compiled.wait();
+    }
+  }
+  if (!file_path_.empty()) {
+    Save();
+  }
+}
+
+vk::Pipeline VulkanPipelineStateCache::GetPipeline(
+    const GraphicsPipelineState& state) {
+  auto iter = entries_.find(state);
+  if (iter == entries_.end()) {
+    // 作成に失敗したときに空のエントリを残さない
+    auto pipeline = CreatePipeline(state);
+    iter = entries_.emplace(state, Entry()).first;
+    iter->second.pipeline = std::move(pipeline);
+  } else if (iter->second.compiled.valid()) {
+    // ワーカーで投げられた例外はここで投げ直す
+    iter->second.compiled.get();
+  }
+  return *iter->second.pipeline;
+}
+
+void VulkanPipelineStateCache::Prepare(const GraphicsPipelineState& state) {
+  if (entries_.find(state) != entries_.end()) {
+    return;
+  }
+  if (!thread_pool_) {
+    auto pipeline = CreatePipeline(state);
+    entries_.emplace(state, Entry()).first->second.pipeline =
+        std::move(pipeline);
+    return;
+  }
+  auto iter = entries_.emplace(state, Entry()).first;
+
+  auto key = &iter->first;
+  auto entry = &iter->second;
+  entry->compiled =
+      thread_pool_
+          ->enqueue([this, key, entry]() {
+            entry->pipeline = CreatePipeline(*key);
+          })
+          .share();
+}
+
+vk::Pipeline VulkanPipelineStateCache::FindPipeline(
+    const GraphicsPipelineState& state) const {
+  auto iter = entries_.find(state);
+  if (iter == entries_.end()) {
+    return vk::Pipeline();
+  }
+  auto&& compiled = iter->second.compiled;
+  if (compiled.valid()) {
+    if (compiled.wait_for(std::chrono::seconds(0)) !=
+        std::future_status::ready) {
+      return vk::Pipeline();
+    }
+    // 失敗したエントリは準備完了とせず、例外を投げ直す
+    compiled.get();
+  }
+  return *iter->second.pipeline;
+}
+
+void VulkanPipelineStateCache::WaitForCompilation() const {
+  for (auto&& pair : entries_) {
+    if (pair.second.compiled.valid()) {
+      pair.second.compiled.get();
+    }
+  }
+}
+
+bool VulkanPipelineStateCache::Save() const {
+  if (file_path_.empty()) {
+    return false;
+  }
+  auto data = device_->device().getPipelineCacheData(*pipeline_cache_);
+  auto header = MakeFileHeader(properties_);
+  header.data_size = data.size();
+  header.data_hash = kFnvOffsetBasis;
+  HashBytes(data.data(), data.size(), &header.data_hash);
+
+  // 書き込み途中で終了しても元のファイルが壊れないように、別名で書いてから
+  // 置き換える
+  auto temp_path = file_path_ + ".tmp";
+  {
+    std::ofstream fs(temp_path, std::ios::binary | std::ios::trunc);
+    if (!fs.is_open()) {
+      TEMP_LOG_WARNING("Failed to open pipeline cache file! : ", temp_path);
+      return false;
+    }
+    fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fs.write(reinterpret_cast<const char*>(data.data()), data.size());
+    if (!fs) {
+      TEMP_LOG_WARNING("Failed to write pipeline cache file! : ", temp_path);
+      return false;
+    }
+  }
+  std::remove(file_path_.c_str());
+  if (std::rename(temp_path.c_str(), file_path_.c_str()) != 0) {
+    TEMP_LOG_WARNING("Failed to rename pipeline cache file! : ", temp_path);
+    return false;
+  }
+  return true;
+}
+
+std::size_t VulkanPipelineStateCache::pipeline_count() const {
+  return entries_.size();
+}
+
+bool VulkanPipelineStateCache::loaded() const { return loaded_; }
+
+std::size_t VulkanPipelineStateCache::StateHash::operator()(
+    const GraphicsPipelineState& state) const {
+  return static_cast<std::size_t>(state.Hash());
+}
+
+std::vector<std::uint8_t> VulkanPipelineStateCache::LoadCacheData() const {
+  if (file_path_.empty()) {
+    return std::vector<std::uint8_t>();
+  }
+  // 初回の起動ではファイルがないのが普通なので、エラーにしない
+  std::ifstream fs(file_path_, std::ios::binary);
+  if (!fs.is_open()) {
+    return std::vector<std::uint8_t>();
+  }
+
+  FileHeader header;
+  fs.read(reinterpret_cast<char*>(&header), sizeof(header));
+  auto expected = MakeFileHeader(properties_);
+  if (!fs || header.magic != expected.magic ||
+      header.version != expected.version ||
+      header.vendor_id != expected.vendor_id ||
+      header.device_id != expected.device_id ||
+      header.driver_version != expected.driver_version ||
+      std::memcmp(header.pipeline_cache_uuid, expected.pipeline_cache_uuid,
+                  VK_UUID_SIZE) != 0) {
+    TEMP_LOG_INFO("Pipeline cache file is for another device or driver. : ",
+                  file_path_);
+    return std::vector<std::uint8_t>();
+  }
+
+  // 壊れたサイズのまま確保しないよう、先にファイルの残りと比べる
+  auto data_begin = fs.tellg();
+  fs.seekg(0, std::ios::end);
+  auto remaining = static_cast<std::uint64_t>(fs.tellg() - data_begin);
+  fs.seekg(data_begin);
+  if (!fs || header.data_size != remaining) {
+    TEMP_LOG_WARNING("Pipeline cache file is broken! : ", file_path_);
+    return std::vector<std::uint8_t>();
+  }
+
+  std::vector<std::uint8_t> data(static_cast<std::size_t>(header.data_size));
+  fs.read(reinterpret_cast<char*>(data.data()), data.size());
+  auto data_hash = kFnvOffsetBasis;
+  HashBytes(data.data(), data.size(), &data_hash);
+  if (!fs || data_hash != header.data_hash) {
+    TEMP_LOG_WARNING("Pipeline cache file is broken! : ", file_path_);
+    return std::vector<std::uint8_t>();
+  }
+  return data;
+}
+
+vk::UniquePipeline VulkanPipelineStateCache::CreatePipeline(
+    const GraphicsPipelineState& state) const {
+  auto vk_device = device_->device();
+  auto vertex_module = CreateShaderModule(vk_device, state.vertex_shader);
+  auto fragment_module = CreateShaderModule(vk_device, state.fragment_shader);
+
+  vk::PipelineShaderStageCreateInfo shader_stages[2];
+  shader_stages[0].stage = vk::ShaderStageFlagBits::eVertex;
+  shader_stages[0].module = *vertex_module;
+  shader_stages[0].pName = "main";
+  shader_stages[1].stage = vk::ShaderStageFlagBits::eFragment;
+  shader_stages[1].module = *fragment_module;
+  shader_stages[1].pName = "main";
+
+  vk::PipelineVertexInputStateCreateInfo vertex_input_ci;
+  vertex_input_ci.vertexBindingDescriptionCount =
+      static_cast<std::uint32_t>(state.vertex_bindings.size());
+  vertex_input_ci.pVertexBindingDescriptions = state.vertex_bindings.data();
+  vertex_input_ci.vertexAttributeDescriptionCount =
+      static_cast<std::uint32_t>(state.vertex_attributes.size());
+  vertex_input_ci.pVertexAttributeDescriptions =
+      state.vertex_attributes.data();
+
+  vk::PipelineInputAssemblyStateCreateInfo input_assembly_ci;
+  input_assembly_ci.topology = state.topology;
+
+  // 大きさは動的ステートで決める
+  vk::PipelineViewportStateCreateInfo viewport_state_ci;
+  viewport_state_ci.viewportCount = 1;
+  viewport_state_ci.scissorCount = 1;
+
+  vk::PipelineRasterizationStateCreateInfo rasterization_ci;
+  rasterization_ci.polygonMode = state.polygon_mode;
+  rasterization_ci.cullMode = state.cull_mode;
+  rasterization_ci.frontFace = state.front_face;
+  rasterization_ci.lineWidth = 1.0f;
+
+  vk::PipelineMultisampleStateCreateInfo multisample_ci;
+  multisample_ci.rasterizationSamples = state.samples;
+
+  vk::PipelineDepthStencilStateCreateInfo depth_stencil_ci;
+  depth_stencil_ci.depthTestEnable = state.depth_test;
+  depth_stencil_ci.depthWriteEnable = state.depth_write;
+  depth_stencil_ci.depthCompareOp = state.depth_compare_op;
+
+  vk::PipelineColorBlendStateCreateInfo color_blend_ci;
+  color_blend_ci.attachmentCount =
+      static_cast<std::uint32_t>(state.blend_attachments.size());
+  color_blend_ci.pAttachments = state.blend_attachments.data();
+
+  vk::DynamicState dynamic_states[] = {vk::DynamicState::eViewport,
+                                       vk::DynamicState::eScissor};
+  vk::PipelineDynamicStateCreateInfo dynamic_state_ci;
+  dynamic_state_ci.dynamicStateCount = 2;
+  dynamic_state_ci.pDynamicStates = dynamic_states;
+
+  vk::GraphicsPipelineCreateInfo pipeline_ci;
+  pipeline_ci.stageCount = 2;
+  pipeline_ci.pStages = shader_stages;
+  pipeline_ci.pVertexInputState = &vertex_input_ci;
+  pipeline_ci.pInputAssemblyState = &input_assembly_ci;
+  pipeline_ci.pViewportState = &viewport_state_ci;
+  pipeline_ci.pRasterizationState = &rasterization_ci;
+  pipeline_ci.pMultisampleState = &multisample_ci;
+  pipeline_ci.pDepthStencilState = &depth_stencil_ci;
+  pipeline_ci.pColorBlendState = &color_blend_ci;
+  pipeline_ci.pDynamicState = &dynamic_state_ci;
+  pipeline_ci.layout = state.layout;
+  pipeline_ci.renderPass = state.render_pass;
+  pipeline_ci.subpass = state.subpass;
+
+  // vk::PipelineCache は内部で同期されるので、ワーカーから同時に使える
+  return vk_device.createGraphicsPipelineUnique(*pipeline_cache_,
+                                                pipeline_ci);
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,148 @@
+#pragma once
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "temp/base/thread_pool.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Full description of graphics pipeline
+ *
+ * Viewport and scissor are dynamic states, so pipelines do not depend on
+ * the size of render targets. Shader entry points are "main".
+ */
+struct GraphicsPipelineState {
+  std::vector<std::uint32_t> vertex_shader;
+  std::vector<std::uint32_t> fragment_shader;
+  std::vector<vk::VertexInputBindingDescription> vertex_bindings;
+  std::vector<vk::VertexInputAttributeDescription> vertex_attributes;
+  vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+  vk::PolygonMode polygon_mode = vk::PolygonMode::eFill;
+  vk::CullModeFlags cull_mode = vk::CullModeFlagBits::eBack;
+  vk::FrontFace front_face = vk::FrontFace::eClockwise;
+  vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+  bool depth_test = false;
+  bool depth_write = false;
+  vk::CompareOp depth_compare_op = vk::CompareOp::eLessOrEqual;
+  // カラーアタッチメントごとのブレンド
+  std::vector<vk::PipelineColorBlendAttachmentState> blend_attachments;
+  vk::PipelineLayout layout;
+  vk::RenderPass render_pass;
+  std::uint32_t subpass = 0;
+
+  bool operator==(const GraphicsPipelineState& other) const;
+  bool operator!=(const GraphicsPipelineState& other) const;
+
+  /**
+   * @brief FNV-1a hash of all members
+   */
+  std::uint64_t Hash() const;
+};
+
+/**
+ * @brief Cache of graphics pipelines keyed by their full state
+ *
+ * Each state is compiled once per cache. The driver's vk::PipelineCache
+ * behind the pipelines is loaded from file_path and written back on
+ * destruction, so compilation is cheaper from the second run. The file is
+ * discarded when it was written by another device or driver version.
+ *
+ * Prepare() compiles pipelines on worker threads, so loading screens can
+ * hide compilation. An exception thrown while compiling on a worker is
+ * rethrown by the methods returning or waiting for that pipeline, the same
+ * as when compiling on the calling thread. The methods themselves are not
+ * thread safe.
+ */
+class VulkanPipelineStateCache {
+ public:
+  /**
+   * @param file_path file persisting the cache, empty keeps it in memory
+   * @param worker_count threads compiling pipelines passed to Prepare(),
+   *                     0 compiles them on the calling thread
+   */
+  explicit VulkanPipelineStateCache(const VulkanDevice& device,
+                                    const std::string& file_path = "",
+                                    std::size_t worker_count = 1);
+  ~VulkanPipelineStateCache();
+
+  VulkanPipelineStateCache(const VulkanPipelineStateCache&) = delete;
+  VulkanPipelineStateCache& operator=(const VulkanPipelineStateCache&) =
+      delete;
+
+  /**
+   * @brief Pipeline of state, compiled now or waited for if not yet
+   */
+  vk::Pipeline GetPipeline(const GraphicsPipelineState& state);
+
+  /**
+   * @brief Start compiling pipeline of state in background
+   */
+  void Prepare(const GraphicsPipelineState& state);
+
+  /**
+   * @brief Pipeline of state if compiled, null otherwise without blocking
+   */
+  vk::Pipeline FindPipeline(const GraphicsPipelineState& state) const;
+
+  /**
+   * @brief Block until pipelines passed to Prepare() are compiled
+   */
+  void WaitForCompilation() const;
+
+  /**
+   * @brief Write cache to file_path
+   *
+   * @return false if path is empty or writing fails
+   */
+  bool Save() const;
+
+  std::size_t pipeline_count() const;
+
+  /**
+   * @brief Whether the cache started from data in file_path
+   */
+  bool loaded() const;
+
+ private:
+  struct Entry {
+    // ワーカーが pipeline を書き終えたら準備完了になる
+    std::shared_future<void> compiled;
+    vk::UniquePipeline pipeline;
+  };
+
+  struct StateHash {
+    std::size_t operator()(const GraphicsPipelineState& state) const;
+  };
+
+  /**
+   * @brief Data of vk::PipelineCache in file, empty if it is not usable
+   */
+  std::vector<std::uint8_t> LoadCacheData() const;
+
+  vk::UniquePipeline CreatePipeline(const GraphicsPipelineState& state) const;
+
+  const VulkanDevice* device_;
+  std::string file_path_;
+  vk::PhysicalDeviceProperties properties_;
+  bool loaded_ = false;
+  vk::UniquePipelineCache pipeline_cache_;
+  // ノードのアドレスは変わらないので、ワーカーはエントリを直接書く
+  std::unordered_map<GraphicsPipelineState, Entry, StateHash> entries_;
+  // エントリより先に破棄してコンパイル中のタスクを終わらせる
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
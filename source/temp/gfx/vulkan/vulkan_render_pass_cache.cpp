@@ -0,0 +1,189 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+
+#include "temp/base/hash.h"
+
+#include "temp/gfx/vulkan/vulkan_render_pass_cache.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+RenderPassState RenderPassState::Color(vk::Format format,
+                                       vk::ImageLayout final_layout) {
+  vk::AttachmentDescription color_attachment;
+  color_attachment.format = format;
+  color_attachment.samples = vk::SampleCountFlagBits::e1;
+  color_attachment.loadOp = vk::AttachmentLoadOp::eClear;
+  color_attachment.storeOp = vk::AttachmentStoreOp::eStore;
+  color_attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
+  color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
+  color_attachment.initialLayout = vk::ImageLayout::eUndefined;
+  color_attachment.finalLayout = final_layout;
+
+  RenderPassState state;
+  state.color_attachments.push_back(color_attachment);
+  return state;
+}
+
+bool RenderPassState::operator==(const RenderPassState& other) const {
+  return color_attachments == other.color_attachments &&
+         depth_stencil_attachment == other.depth_stencil_attachment;
+}
+
+bool RenderPassState::operator!=(const RenderPassState& other) const {
+  return !(*this == other);
+}
+
+std::uint64_t RenderPassState::Hash() const {
+  // vk::AttachmentDescription はすべて 4 バイトのメンバーで、パディングがない
+  auto hash = kFnvOffsetBasis;
+  HashVector(color_attachments, &hash);
+  HashValue(depth_stencil_attachment, &hash);
+  return hash;
+}
+
+bool FramebufferState::operator==(const FramebufferState& other) const {
+  return render_pass == other.render_pass &&
+         attachments == other.attachments && width == other.width &&
+         height == other.height && layers == other.layers;
+}
+
+bool FramebufferState::operator!=(const FramebufferState& other) const {
+  return !(*this == other);
+}
+
+std::uint64_t FramebufferState::Hash() const {
+  auto hash = kFnvOffsetBasis;
+  HashValue(static_cast<VkRenderPass>(render_pass), &hash);
+  HashValue(attachments.size(), &hash);
+  for (auto&& view : attachments) {
+    HashValue(static_cast<VkImageView>(view), &hash);
+  }
+  HashValue(width, &hash);
+  HashValue(height, &hash);
+  HashValue(layers, &hash);
+  return hash;
+}
+
+VulkanRenderPassCache::VulkanRenderPassCache(vk::Device device)
+    : device_(device) {}
+
+vk::RenderPass VulkanRenderPassCache::GetRenderPass(
+    const RenderPassState& state) {
+  auto iter = render_passes_.find(state);
+  if (iter != render_passes_.end()) {
+    return *iter->second;
+  }
+
+  auto color_count =
+      static_cast<std::uint32_t>(state.color_attachments.size());
+  auto has_depth_stencil =
+      state.depth_stencil_attachment.format != vk::Format::eUndefined;
+
+  std::vector<vk::AttachmentDescription> attachments =
+      state.color_attachments;
+  std::vector<vk::AttachmentReference> color_refs;
+  for (std::uint32_t i = 0; i < color_count; ++i) {
+    color_refs.emplace_back(i, vk::ImageLayout::eColorAttachmentOptimal);
+  }
+  vk::AttachmentReference depth_stencil_ref(
+      color_count, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+  vk::SubpassDescription subpass;
+  subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
+  subpass.colorAttachmentCount = color_count;
+  subpass.pColorAttachments = color_refs.data();
+
+  // 前の描画の書き込みが終わってからアタッチメントに書く
+  vk::SubpassDependency subpass_dependency;
+  subpass_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+  subpass_dependency.dstSubpass = 0;
+  subpass_dependency.srcStageMask =
+      vk::PipelineStageFlagBits::eColorAttachmentOutput;
+  subpass_dependency.dstStageMask =
+      vk::PipelineStageFlagBits::eColorAttachmentOutput;
+  subpass_dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead |
+                                     vk::AccessFlagBits::eColorAttachmentWrite;
+  if (has_depth_stencil) {
+    attachments.push_back(state.depth_stencil_attachment);
+    subpass.pDepthStencilAttachment = &depth_stencil_ref;
+    subpass_dependency.srcStageMask |=
+        vk::PipelineStageFlagBits::eLateFragmentTests;
+    subpass_dependency.dstStageMask |=
+        vk::PipelineStageFlagBits::eEarlyFragmentTests;
+    subpass_dependency.srcAccessMask |=
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+    subpass_dependency.dstAccessMask |=
+        vk::AccessFlagBits::eDepthStencilAttachmentRead |
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+  }
+
+  vk::RenderPassCreateInfo render_pass_ci;
+  render_pass_ci.attachmentCount =
+      static_cast<std::uint32_t>(attachments.size());
+  render_pass_ci.pAttachments = attachments.data();
+  render_pass_ci.subpassCount = 1;
+  render_pass_ci.pSubpasses = &subpass;
+  render_pass_ci.dependencyCount = 1;
+  render_pass_ci.pDependencies = &subpass_dependency;
+
+  auto render_pass = device_.createRenderPassUnique(render_pass_ci);
+  auto handle = *render_pass;
+  render_passes_.emplace(state, std::move(render_pass));
+  return handle;
+}
+
+vk::Framebuffer VulkanRenderPassCache::GetFramebuffer(
+    const FramebufferState& state) {
+  auto iter = framebuffers_.find(state);
+  if (iter != framebuffers_.end()) {
+    return *iter->second;
+  }
+
+  vk::FramebufferCreateInfo framebuffer_ci;
+  framebuffer_ci.renderPass = state.render_pass;
+  framebuffer_ci.attachmentCount =
+      static_cast<std::uint32_t>(state.attachments.size());
+  framebuffer_ci.pAttachments = state.attachments.data();
+  framebuffer_ci.width = state.width;
+  framebuffer_ci.height = state.height;
+  framebuffer_ci.layers = state.layers;
+
+  auto framebuffer = device_.createFramebufferUnique(framebuffer_ci);
+  auto handle = *framebuffer;
+  framebuffers_.emplace(state, std::move(framebuffer));
+  return handle;
+}
+
+void VulkanRenderPassCache::ReleaseImageViews(
+    const std::vector<vk::ImageView>& views) {
+  for (auto iter = framebuffers_.begin(); iter != framebuffers_.end();) {
+    auto&& attachments = iter->first.attachments;
+    auto stale = std::any_of(
+        attachments.begin(), attachments.end(), [&views](vk::ImageView view) {
+          return std::find(views.begin(), views.end(), view) != views.end();
+        });
+    if (stale) {
+      iter = framebuffers_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+std::size_t VulkanRenderPassCache::render_pass_count() const {
+  return render_passes_.size();
+}
+
+std::size_t VulkanRenderPassCache::framebuffer_count() const {
+  return framebuffers_.size();
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
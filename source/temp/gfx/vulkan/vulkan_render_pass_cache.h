@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+/**
+ * @brief Attachments of render pass with one subpass
+ */
+struct RenderPassState {
+  std::vector<vk::AttachmentDescription> color_attachments;
+  // format が eUndefined ならデプスステンシルなし
+  vk::AttachmentDescription depth_stencil_attachment;
+
+  /**
+   * @brief State clearing and storing one color attachment
+   *
+   * @param final_layout layout of the attachment after the render pass
+   */
+  static RenderPassState Color(vk::Format format,
+                               vk::ImageLayout final_layout);
+
+  bool operator==(const RenderPassState& other) const;
+  bool operator!=(const RenderPassState& other) const;
+
+  std::uint64_t Hash() const;
+};
+
+struct FramebufferState {
+  vk::RenderPass render_pass;
+  // カラー、デプスステンシルの順
+  std::vector<vk::ImageView> attachments;
+  std::uint32_t width = 0;
+  std::uint32_t height = 0;
+  std::uint32_t layers = 1;
+
+  bool operator==(const FramebufferState& other) const;
+  bool operator!=(const FramebufferState& other) const;
+
+  std::uint64_t Hash() const;
+};
+
+/**
+ * @brief Render passes and framebuffers shared by equal states
+ *
+ * Render passes live as long as the cache, since there are only a few
+ * combinations of attachments. Framebuffers are destroyed by
+ * ReleaseImageViews() when their views go away, so targets recreated on
+ * resize do not leave stale framebuffers behind. Not thread safe.
+ */
+class VulkanRenderPassCache {
+ public:
+  explicit VulkanRenderPassCache(vk::Device device);
+
+  VulkanRenderPassCache(const VulkanRenderPassCache&) = delete;
+  VulkanRenderPassCache& operator=(const VulkanRenderPassCache&) = delete;
+
+  vk::RenderPass GetRenderPass(const RenderPassState& state);
+
+  vk::Framebuffer GetFramebuffer(const FramebufferState& state);
+
+  /**
+   * @brief Destroy framebuffers attaching any of views
+   *
+   * Call before destroying the views, after the GPU finished with them.
+   */
+  void ReleaseImageViews(const std::vector<vk::ImageView>& views);
+
+  std::size_t render_pass_count() const;
+  std::size_t framebuffer_count() const;
+
+ private:
+  template <class T>
+  struct StateHash {
+    std::size_t operator()(const T& state) const {
+      return static_cast<std::size_t>(state.Hash());
+    }
+  };
+
+  vk::Device device_;
+  std::unordered_map<RenderPassState, vk::UniqueRenderPass,
+                     StateHash<RenderPassState>>
+      render_passes_;
+  // レンダーパスより先に破棄する
+  std::unordered_map<FramebufferState, vk::UniqueFramebuffer,
+                     StateHash<FramebufferState>>
+      framebuffers_;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
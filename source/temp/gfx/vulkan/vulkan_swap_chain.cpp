@@ -1,6 +1,8 @@
 #include "temp/base/define.h"
 #ifdef TEMP_GFX_API_VULKAN
 
+#include <limits>
+
 #include "temp/base/assertion.h"
 #include "temp/base/logger.h"
 
@@ -24,94 +26,45 @@ std::vector<VulkanSwapChain::Image> CreateSwapChainImages(
   image_view_ci.subresourceRange.layerCount = 1;
   image_view_ci.viewType = vk::ImageViewType::e2D;
 
-  vk::SemaphoreCreateInfo semaphore_ci;
-  vk::FenceCreateInfo fence_ci;
-
   std::vector<Image> images;
   auto swap_chain_images = device.getSwapchainImagesKHR(swap_chain);
   for (auto image : swap_chain_images) {
     image_view_ci.image = image;
     auto view = device.createImageViewUnique(image_view_ci);
-    auto acquire_image_semaphore = device.createSemaphoreUnique(semaphore_ci);
-    auto render_semaphore = device.createSemaphoreUnique(semaphore_ci);
-    // auto fence = device.createFenceUnique(fence_ci);
-    auto fence = vk::UniqueFence();
-    images.emplace_back(Image{image, std::move(view),
-                              std::move(acquire_image_semaphore),
-                              std::move(render_semaphore), std::move(fence)});
+    images.emplace_back(Image{image, std::move(view), vk::Fence()});
   }
   return images;
 }
 
-vk::UniqueRenderPass CreateRenderPass(const vk::Device vk_device,
-                                      vk::Format color_format) {
-  vk::AttachmentDescription color_attachment;
-  color_attachment.format = color_format;
-  color_attachment.samples = vk::SampleCountFlagBits::e1;
-  color_attachment.loadOp = vk::AttachmentLoadOp::eClear;
-  color_attachment.storeOp = vk::AttachmentStoreOp::eStore;
-  color_attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
-  color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-  color_attachment.initialLayout = vk::ImageLayout::eUndefined;
-  color_attachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
-
-  vk::AttachmentReference color_attachment_ref;
-  color_attachment_ref.attachment = 0;
-  color_attachment_ref.layout = vk::ImageLayout::eColorAttachmentOptimal;
-
-  vk::SubpassDescription subpass;
-  subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
-  subpass.colorAttachmentCount = 1;
-  subpass.pColorAttachments = &color_attachment_ref;
-
-  vk::RenderPassCreateInfo render_pass_ci;
-  vk::SubpassDependency subpass_dependency;
-  subpass_dependency.dstSubpass = 0;
-  subpass_dependency.srcStageMask =
-      vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  subpass_dependency.srcAccessMask = vk::AccessFlagBits();
-  subpass_dependency.dstStageMask =
-      vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  subpass_dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead |
-                                     vk::AccessFlagBits::eColorAttachmentWrite;
-  render_pass_ci.attachmentCount = 1;
-  render_pass_ci.pAttachments = &color_attachment;
-  render_pass_ci.subpassCount = 1;
-  render_pass_ci.pSubpasses = &subpass;
-  render_pass_ci.dependencyCount = 1;
-  render_pass_ci.pDependencies = &subpass_dependency;
-  return vk_device.createRenderPassUnique(render_pass_ci);
-}
+}  // namespace
 
-std::vector<vk::UniqueFramebuffer> CreateFrameBuffers(
-    const vk::Device vk_device,
-    const std::vector<VulkanSwapChain::Image>& images,
-    vk::RenderPass render_pass, std::uint32_t width, std::uint32_t height) {
-  std::vector<vk::UniqueFramebuffer> frame_buffers;
-
-  auto image_count = images.size();
-  for (auto&& image : images) {
-    vk::ImageView attachments[] = {*image.view};
-
-    vk::FramebufferCreateInfo frame_buffer_ci;
-    frame_buffer_ci.renderPass = render_pass;
-    frame_buffer_ci.attachmentCount = 1;
-    frame_buffer_ci.pAttachments = attachments;
-    frame_buffer_ci.width = width;
-    frame_buffer_ci.height = height;
-    frame_buffer_ci.layers = 1;
-
-    frame_buffers.emplace_back(
-        vk_device.createFramebufferUnique(frame_buffer_ci));
-  }
+std::vector<VulkanSwapChain::Frame> VulkanSwapChain::CreateFrames(
+    vk::Device device, std::uint32_t frame_count, bool with_semaphores) {
+  TEMP_ASSERT(frame_count > 0 && frame_count <= kMaxFrameCount,
+              "frame_count must be in [1, kMaxFrameCount]");
 
-  return std::move(frame_buffers);
+  vk::SemaphoreCreateInfo semaphore_ci;
+  // 最初のフレームで待たないように、シグナル状態で作る
+  vk::FenceCreateInfo fence_ci;
+  fence_ci.flags = vk::FenceCreateFlagBits::eSignaled;
+
+  std::vector<Frame> frames;
+  for (std::uint32_t i = 0; i < frame_count; ++i) {
+    Frame frame;
+    if (with_semaphores) {
+      frame.acquire_image_semaphore =
+          device.createSemaphoreUnique(semaphore_ci);
+      frame.render_semaphore = device.createSemaphoreUnique(semaphore_ci);
+    }
+    frame.fence = device.createFenceUnique(fence_ci);
+    frames.emplace_back(std::move(frame));
+  }
+  return frames;
 }
 
-}  // namespace
-
 VulkanSwapChain::VulkanSwapChain(const VulkanDevice& device, const void* window,
-                                 std::uint32_t width, std::uint32_t height) {
+                                 std::uint32_t width, std::uint32_t height,
+                                 std::uint32_t frame_count) {
   auto vk_instance = device.instance();
   auto vk_physical_device = device.physical_device();
   auto vk_device = device.device();
@@ -132,32 +85,74 @@ VulkanSwapChain::VulkanSwapChain(const VulkanDevice& device, const void* window,
   images_ = CreateSwapChainImages(vk_device, *swap_chain_,
                                   swap_chain_ci_.imageFormat);
 
-  render_pass_ = CreateRenderPass(vk_device, swap_chain_ci_.imageFormat);
+  render_pass_cache_ = &device.render_pass_cache();
+  render_pass_ = render_pass_cache_->GetRenderPass(RenderPassState::Color(
+      swap_chain_ci_.imageFormat, vk::ImageLayout::ePresentSrcKHR));
+
+  CreateFrameBuffers();
+
+  frames_ = CreateFrames(vk_device, frame_count, true);
+}
 
-  frame_buffers_ =
-      CreateFrameBuffers(vk_device, images_, *render_pass_, width, height);
+VulkanSwapChain::~VulkanSwapChain() {
+  WaitForFrames();
+  ReleaseFrameBuffers();
 }
 
 void VulkanSwapChain::Present(const Device* device) {
   TEMP_ASSERT(device->api_type() == ApiType::kVulkan,
               "device must be VulkanDevice");
   auto temp_device = static_cast<const VulkanDevice*>(device);
-  auto vk_device = temp_device->device();
 
-  auto image_index = AcquireNextImage(vk_device);
+  if (!acquired_) {
+    AcquireNextImage(temp_device->device());
+  }
+  // 描画がなくても render_semaphore をシグナルして、取得のセマフォを消費する
+  if (!submitted_) {
+    Submit(*temp_device, {});
+  }
 
   vk::PresentInfoKHR present_info;
   present_info.waitSemaphoreCount = 1;
-  present_info.pWaitSemaphores = &current_image().render_semaphore.get();
+  present_info.pWaitSemaphores = &current_frame().render_semaphore.get();
   present_info.swapchainCount = 1;
   present_info.pSwapchains = &(*swap_chain_);
-  present_info.pImageIndices = &image_index;
+  present_info.pImageIndices = &current_image_;
 
-  auto&& iter = temp_device->queue_table().find(vk::QueueFlagBits::eGraphics);
-  TEMP_ASSERT(iter != temp_device->queue_table().end(),
-              "queue_table must contain graphics queue");
-  auto&& graphics_queue = iter->second;
-  graphics_queue.presentKHR(present_info);
+  GetGraphicsQueue(*temp_device).presentKHR(present_info);
+
+  AdvanceFrame();
+}
+
+void VulkanSwapChain::Submit(
+    const VulkanDevice& device,
+    const std::vector<vk::CommandBuffer>& command_buffers) {
+  TEMP_ASSERT(acquired_ && !submitted_,
+              "Submit must be called once after AcquireNextImage");
+  auto&& frame = frames_[current_frame_];
+
+  // フェンスはキューに積む直前にだけリセットするので、待って戻らないことはない
+  device.device().resetFences(*frame.fence);
+
+  vk::PipelineStageFlags wait_stage =
+      vk::PipelineStageFlagBits::eColorAttachmentOutput;
+  vk::SubmitInfo submit_info;
+  if (frame.acquire_image_semaphore) {
+    submit_info.waitSemaphoreCount = 1;
+    submit_info.pWaitSemaphores = &frame.acquire_image_semaphore.get();
+    submit_info.pWaitDstStageMask = &wait_stage;
+  }
+  submit_info.commandBufferCount =
+      static_cast<std::uint32_t>(command_buffers.size());
+  submit_info.pCommandBuffers = command_buffers.data();
+  if (frame.render_semaphore) {
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &frame.render_semaphore.get();
+  }
+  GetGraphicsQueue(device).submit(submit_info, *frame.fence);
+
+  images_[current_image_].fence = *frame.fence;
+  submitted_ = true;
 }
 
 void VulkanSwapChain::Resize(const Device* device, std::uint32_t width,
@@ -180,39 +175,26 @@ void VulkanSwapChain::Resize(const Device* device, std::uint32_t width,
     swapchain_extent = surf_caps.currentExtent;
   }
 
-  swap_chain_ci_.imageExtent = surf_caps.currentExtent;
+  swap_chain_ci_.imageExtent = swapchain_extent;
   swap_chain_ci_.oldSwapchain = *swap_chain_;
 
-  auto old_image_count = vk_device.getSwapchainImagesKHR(*swap_chain_).size();
+  // 古いスワップチェーンのイメージを参照するものを先に破棄する
+  ReleaseFrameBuffers();
+  images_.clear();
 
   swap_chain_ = vk_device.createSwapchainKHRUnique(swap_chain_ci_);
-  if (swap_chain_ci_.oldSwapchain != vk::SwapchainKHR()) {
-    for (auto&& image : images_) {
-      image.view.reset();
-    }
-  }
-
-  auto images = vk_device.getSwapchainImagesKHR(*swap_chain_);
-  if (images.size() != old_image_count) {
-    std::vector<vk::Fence> fences;
-    for (auto&& image : images_) {
-      fences.emplace_back(*image.fence);
-    }
-
-    vk_device.waitForFences(fences, true,
-                            std::numeric_limits<std::uint64_t>::max());
+  swap_chain_ci_.oldSwapchain = vk::SwapchainKHR();
 
-    for (auto&& image : images_) {
-      image.fence = vk_device.createFenceUnique(vk::FenceCreateInfo());
-    }
+  images_ = CreateSwapChainImages(vk_device, *swap_chain_,
+                                  swap_chain_ci_.imageFormat);
 
-    images_ = CreateSwapChainImages(vk_device, *swap_chain_,
-                                    swap_chain_ci_.imageFormat);
+  CreateFrameBuffers();
 
-    frame_buffers_ =
-        CreateFrameBuffers(vk_device, images_, *render_pass_,
-                           swapchain_extent.width, swapchain_extent.height);
-  }
+  // 取得したまま提示していないセマフォが残らないように作り直す
+  frames_ = CreateFrames(vk_device, frame_count(), true);
+  current_frame_ = 0;
+  acquired_ = false;
+  submitted_ = false;
 }
 
 std::uint32_t VulkanSwapChain::width() const {
@@ -231,6 +213,18 @@ const std::uint32_t VulkanSwapChain::image_count() const {
   return static_cast<std::uint32_t>(images_.size());
 }
 
+std::uint32_t VulkanSwapChain::frame_count() const {
+  return static_cast<std::uint32_t>(frames_.size());
+}
+
+std::uint32_t VulkanSwapChain::current_frame_index() const {
+  return current_frame_;
+}
+
+const VulkanSwapChain::Frame& VulkanSwapChain::current_frame() const {
+  return frames_[current_frame_];
+}
+
 const VulkanSwapChain::Image& VulkanSwapChain::image(int index) const {
   return images_[index];
 }
@@ -239,12 +233,40 @@ const VulkanSwapChain::Image& VulkanSwapChain::current_image() const {
   return images_[current_image_];
 }
 
+std::vector<vk::ImageView> VulkanSwapChain::image_views() const {
+  std::vector<vk::ImageView> views;
+  for (auto&& image : images_) {
+    views.emplace_back(*image.view);
+  }
+  return views;
+}
+
+void VulkanSwapChain::CreateFrameBuffers() {
+  FramebufferState state;
+  state.render_pass = render_pass_;
+  state.width = width();
+  state.height = height();
+  for (auto&& image : images_) {
+    state.attachments = {*image.view};
+    frame_buffers_.emplace_back(render_pass_cache_->GetFramebuffer(state));
+  }
+}
+
+void VulkanSwapChain::ReleaseFrameBuffers() {
+  // 派生クラスのデストラクタで解放済みのことがある
+  if (frame_buffers_.empty()) {
+    return;
+  }
+  render_pass_cache_->ReleaseImageViews(image_views());
+  frame_buffers_.clear();
+}
+
 const vk::Framebuffer VulkanSwapChain::frame_buffer(int index) const {
-  return *frame_buffers_[index];
+  return frame_buffers_[index];
 }
 
 const vk::Framebuffer VulkanSwapChain::current_frame_buffer() const {
-  return *frame_buffers_[current_image_];
+  return frame_buffers_[current_image_];
 }
 
 vk::Format VulkanSwapChain::color_format() const {
@@ -256,23 +278,64 @@ vk::SwapchainKHR VulkanSwapChain::swap_chain() const {
 }
 
 const vk::RenderPass VulkanSwapChain::render_pass() const {
-  return *render_pass_;
+  return render_pass_;
 }
 
 std::uint32_t VulkanSwapChain::AcquireNextImage(const vk::Device vk_device) {
+  TEMP_ASSERT(!acquired_, "image is already acquired in this frame");
+  auto&& frame = frames_[current_frame_];
+
+  // frame_count 前のフレームの GPU 処理を待ち、CPU が先行しすぎないようにする
+  vk_device.waitForFences(*frame.fence, VK_TRUE,
+                          std::numeric_limits<std::uint64_t>::max());
+
   auto result_value = vk_device.acquireNextImageKHR(
       *swap_chain_, std::numeric_limits<uint64_t>::max(),
-      *images_[current_image_].acquire_image_semaphore,
-      *images_[current_image_].fence);
+      *frame.acquire_image_semaphore, vk::Fence());
 
   auto result = result_value.result;
   if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
     throw std::error_code(result);
   }
   current_image_ = result_value.value;
+
+  // イメージは別のフレームでまだ使われていることがある
+  auto&& image_fence = images_[current_image_].fence;
+  if (image_fence && image_fence != *frame.fence) {
+    vk_device.waitForFences(image_fence, VK_TRUE,
+                            std::numeric_limits<std::uint64_t>::max());
+  }
+
+  acquired_ = true;
   return current_image_;
 }
 
+vk::Queue VulkanSwapChain::GetGraphicsQueue(const VulkanDevice& device) const {
+  auto&& iter = device.queue_table().find(vk::QueueFlagBits::eGraphics);
+  TEMP_ASSERT(iter != device.queue_table().end(),
+              "queue_table must contain graphics queue");
+  return iter->second;
+}
+
+void VulkanSwapChain::WaitForFrames() const {
+  if (frames_.empty()) {
+    return;
+  }
+  // 提出していないフレームのフェンスはシグナル状態のまま
+  std::vector<vk::Fence> fences;
+  for (auto&& frame : frames_) {
+    fences.push_back(*frame.fence);
+  }
+  frames_.front().fence.getOwner().waitForFences(
+      fences, VK_TRUE, std::numeric_limits<std::uint64_t>::max());
+}
+
+void VulkanSwapChain::AdvanceFrame() {
+  current_frame_ = (current_frame_ + 1) % frame_count();
+  acquired_ = false;
+  submitted_ = false;
+}
+
 }  // namespace vulkan
 }  // namespace gfx
 }  // namespace temp
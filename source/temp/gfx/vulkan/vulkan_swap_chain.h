@@ -1,32 +1,52 @@
 #pragma once
+#include <cstdint>
+#include <vector>
+
 #include <vulkan/vulkan.hpp>
 
 #include "temp/gfx/swap_chain.h"
 #include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_render_pass_cache.h"
 
 namespace temp {
 namespace gfx {
 namespace vulkan {
 
+/**
+ * @brief Swap chain presenting to window with frames in flight
+ *
+ * A frame is AcquireNextImage(), Submit() and Present(). The
+ * synchronization objects belong to frames, not to images: the CPU records
+ * frame N + 1 while the GPU executes frame N, and AcquireNextImage() waits
+ * only for the frame submitted frame_count() frames before.
+ */
 class VulkanSwapChain : public SwapChain {
  public:
+  static const std::uint32_t kDefaultFrameCount = 2;
+  static const std::uint32_t kMaxFrameCount = 3;
+
   struct Image {
     vk::Image image;
     vk::UniqueImageView view;
+    vk::Fence fence;  // 最後にこのイメージに描画したフレームのフェンス
+  };
+
+  struct Frame {
     vk::UniqueSemaphore acquire_image_semaphore;
     vk::UniqueSemaphore render_semaphore;
-    vk::UniqueFence fence;
+    vk::UniqueFence fence;  // 提出した描画が終わるとシグナルされる
   };
 
   explicit VulkanSwapChain(const VulkanDevice& device, const void* window,
-                           std::uint32_t width, std::uint32_t height);
-  ~VulkanSwapChain() = default;
+                           std::uint32_t width, std::uint32_t height,
+                           std::uint32_t frame_count = kDefaultFrameCount);
+  ~VulkanSwapChain();
 
   VulkanSwapChain(const VulkanSwapChain&) = delete;
   VulkanSwapChain& operator=(const VulkanSwapChain&) = delete;
 
-  VulkanSwapChain(VulkanSwapChain&&) = default;
-  VulkanSwapChain& operator=(VulkanSwapChain&&) = default;
+  VulkanSwapChain(VulkanSwapChain&&) = delete;
+  VulkanSwapChain& operator=(VulkanSwapChain&&) = delete;
 
   ApiType api_type() const override { return ApiType::kVulkan; }
 
@@ -40,6 +60,15 @@ class VulkanSwapChain : public SwapChain {
 
   std::uint32_t current_image_index() const;
 
+  /**
+   * @brief Count of frames in flight
+   */
+  std::uint32_t frame_count() const;
+
+  std::uint32_t current_frame_index() const;
+
+  const Frame& current_frame() const;
+
   const std::uint32_t image_count() const;
 
   const Image& image(int index) const;
@@ -56,9 +85,57 @@ class VulkanSwapChain : public SwapChain {
 
   const vk::RenderPass render_pass() const;
 
-  std::uint32_t AcquireNextImage(const vk::Device vk_device);
+  /**
+   * @brief Start frame by acquiring image to render
+   *
+   * Waits until the GPU finishes the frame that used the same
+   * synchronization objects, frame_count() frames before.
+   */
+  virtual std::uint32_t AcquireNextImage(const vk::Device vk_device);
+
+  /**
+   * @brief Submit command buffers rendering to current image
+   *
+   * Called once per frame between AcquireNextImage() and Present(). The
+   * submission waits for the image to be acquired and signals the fence of
+   * the frame.
+   */
+  void Submit(const VulkanDevice& device,
+              const std::vector<vk::CommandBuffer>& command_buffers);
+
+ protected:
+  // 派生クラスが surface を使わずにイメージを用意するためのもの
+  VulkanSwapChain() = default;
+
+  static std::vector<Frame> CreateFrames(vk::Device device,
+                                         std::uint32_t frame_count,
+                                         bool with_semaphores);
+
+  std::vector<vk::ImageView> image_views() const;
+
+  /**
+   * @brief Block until the GPU finishes all submitted frames
+   *
+   * Call before destroying objects the frames may still use.
+   */
+  void WaitForFrames() const;
+
+  /**
+   * @brief Get framebuffers of images from render_pass_cache_
+   */
+  void CreateFrameBuffers();
+
+  /**
+   * @brief Let render_pass_cache_ destroy framebuffers of images
+   *
+   * Call before destroying the image views.
+   */
+  void ReleaseFrameBuffers();
+
+  vk::Queue GetGraphicsQueue(const VulkanDevice& device) const;
+
+  void AdvanceFrame();
 
- private:
   vk::UniqueSurfaceKHR surface_;
   vk::Format color_format_;
   vk::ColorSpaceKHR color_space_;
@@ -66,8 +143,14 @@ class VulkanSwapChain : public SwapChain {
   vk::UniqueSwapchainKHR swap_chain_;
   std::uint32_t current_image_ = 0;
   std::vector<Image> images_;
-  vk::UniqueRenderPass render_pass_;
-  std::vector<vk::UniqueFramebuffer> frame_buffers_;
+  // レンダーパスとフレームバッファはデバイスのキャッシュが持つ
+  VulkanRenderPassCache* render_pass_cache_ = nullptr;
+  vk::RenderPass render_pass_;
+  std::vector<vk::Framebuffer> frame_buffers_;
+  std::vector<Frame> frames_;
+  std::uint32_t current_frame_ = 0;
+  bool acquired_ = false;
+  bool submitted_ = false;
 };
 
 }  // namespace vulkan
@@ -0,0 +1,426 @@
+#include "temp/base/define.h"
+#ifdef TEMP_GFX_API_VULKAN
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "temp/base/assertion.h"
+#include "temp/base/logger.h"
+
+#include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_uploader.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+namespace {
+// バッファへのコピー元のオフセットに必要な揃え
+const vk::DeviceSize kBufferCopyAlignment = 4;
+// イメージへのコピー元は4とテクセルブロックサイズの倍数でなければならない
+const vk::DeviceSize kImageCopyAlignment = 16;
+
+vk::UniqueCommandPool CreateCommandPool(vk::Device vk_device,
+                                        std::uint32_t queue_family_index) {
+  vk::CommandPoolCreateInfo command_pool_ci;
+  command_pool_ci.flags = vk::CommandPoolCreateFlagBits::eTransient |
+                          vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+  command_pool_ci.queueFamilyIndex = queue_family_index;
+  return vk_device.createCommandPoolUnique(command_pool_ci);
+}
+
+vk::UniqueCommandBuffer AllocateCommandBuffer(vk::Device vk_device,
+                                              vk::CommandPool pool) {
+  vk::CommandBufferAllocateInfo command_buffer_ai;
+  command_buffer_ai.commandPool = pool;
+  command_buffer_ai.level = vk::CommandBufferLevel::ePrimary;
+  command_buffer_ai.commandBufferCount = 1;
+  auto command_buffers =
+      vk_device.allocateCommandBuffersUnique(command_buffer_ai);
+  return std::move(command_buffers[0]);
+}
+
+void BeginCommandBuffer(vk::CommandBuffer command_buffer) {
+  vk::CommandBufferBeginInfo command_buffer_bi;
+  command_buffer_bi.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+  command_buffer.begin(command_buffer_bi);
+}
+}  // namespace
+
+VulkanUploader::VulkanUploader(const VulkanDevice& device,
+                               vk::DeviceSize staging_size)
+    : device_(&device), staging_size_(staging_size) {
+  auto vk_device = device.device();
+  auto&& queue_index_table = device.queue_index_table();
+  auto&& queue_table = device.queue_table();
+
+  graphics_queue_family_ =
+      static_cast<std::uint32_t>(device.graphics_queue_index());
+  graphics_queue_ = queue_table.at(vk::QueueFlagBits::eGraphics);
+
+  // 別のキューを待つにはタイムラインセマフォを使う
+  auto iter = queue_index_table.find(vk::QueueFlagBits::eTransfer);
+  uses_transfer_queue_ = iter != queue_index_table.end() &&
+                         iter->second != device.graphics_queue_index() &&
+                         device.timeline_semaphore_enabled();
+  if (uses_transfer_queue_) {
+    transfer_queue_family_ = static_cast<std::uint32_t>(iter->second);
+    transfer_queue_ = queue_table.at(vk::QueueFlagBits::eTransfer);
+
+    vk::SemaphoreTypeCreateInfoKHR semaphore_type_ci;
+    semaphore_type_ci.semaphoreType = vk::SemaphoreType::eTimeline;
+    semaphore_type_ci.initialValue = 0;
+    vk::SemaphoreCreateInfo semaphore_ci;
+    semaphore_ci.pNext = &semaphore_type_ci;
+    timeline_semaphore_ = vk_device.createSemaphoreUnique(semaphore_ci);
+
+    acquire_command_pool_ =
+        CreateCommandPool(vk_device, graphics_queue_family_);
+  } else {
+    transfer_queue_family_ = graphics_queue_family_;
+    transfer_queue_ = graphics_queue_;
+  }
+  transfer_command_pool_ =
+      CreateCommandPool(vk_device, transfer_queue_family_);
+
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = staging_size;
+  buffer_ci.usage = vk::BufferUsageFlagBits::eTransferSrc;
+  buffer_ci.sharingMode = vk::SharingMode::eExclusive;
+  staging_buffer_ = vk_device.createBufferUnique(buffer_ci);
+  // CPU は書き込むだけなので、キャッシュされないメモリでよい
+  staging_memory_ = device.memory_allocator().AllocateBufferMemory(
+      *staging_buffer_, vk::MemoryPropertyFlagBits::eHostVisible |
+                            vk::MemoryPropertyFlagBits::eHostCoherent);
+
+  auto&& limits = device.physical_device().getProperties().limits;
+  staging_alignment_ =
+      std::max(kImageCopyAlignment, limits.optimalBufferCopyOffsetAlignment);
+}
+
+VulkanUploader::~VulkanUploader() {
+  Flush();
+  while (!in_flight_batches_.empty()) {
+    WaitOldestBatch();
+  }
+}
+
+void VulkanUploader::UploadBuffer(vk::Buffer buffer, vk::DeviceSize offset,
+                                  const void* data, vk::DeviceSize size) {
+  auto bytes = static_cast<const std::uint8_t*>(data);
+  while (size > 0) {
+    auto chunk_size = std::min(size, staging_size_);
+    auto staging_offset = ReserveStaging(chunk_size, kBufferCopyAlignment);
+    std::memcpy(static_cast<std::uint8_t*>(staging_memory_->mapped) +
+                    staging_offset,
+                bytes, chunk_size);
+
+    // 予約でバッチが提出されることがあるので、予約の後に取得する
+    auto&& batch = GetRecordingBatch();
+    vk::BufferCopy region(staging_offset, offset, chunk_size);
+    batch.transfer_command_buffer->copyBuffer(*staging_buffer_, buffer, region);
+
+    vk::BufferMemoryBarrier barrier;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask =
+        vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+    barrier.srcQueueFamilyIndex =
+        uses_transfer_queue_ ? transfer_queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex =
+        uses_transfer_queue_ ? graphics_queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = chunk_size;
+    batch.buffer_barriers.emplace_back(barrier);
+
+    bytes += chunk_size;
+    offset += chunk_size;
+    size -= chunk_size;
+    uploaded_bytes_ += chunk_size;
+  }
+}
+
+void VulkanUploader::UploadImage(vk::Image image,
+                                 const vk::ImageSubresourceLayers& subresource,
+                                 const vk::Extent3D& extent,
+                                 vk::ImageLayout layout, const void* data,
+                                 vk::DeviceSize size) {
+  TEMP_ASSERT(size <= staging_size_, "image must fit in staging buffer");
+  auto staging_offset = ReserveStaging(size, staging_alignment_);
+  std::memcpy(
+      static_cast<std::uint8_t*>(staging_memory_->mapped) + staging_offset,
+      data, size);
+
+  auto&& batch = GetRecordingBatch();
+  auto command_buffer = *batch.transfer_command_buffer;
+
+  vk::ImageSubresourceRange range;
+  range.aspectMask = subresource.aspectMask;
+  range.baseMipLevel = subresource.mipLevel;
+  range.levelCount = 1;
+  range.baseArrayLayer = subresource.baseArrayLayer;
+  range.layerCount = subresource.layerCount;
+
+  vk::ImageMemoryBarrier barrier;
+  barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.oldLayout = vk::ImageLayout::eUndefined;
+  barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = image;
+  barrier.subresourceRange = range;
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe,
+                                 vk::PipelineStageFlagBits::eTransfer,
+                                 vk::DependencyFlags(), nullptr, nullptr,
+                                 barrier);
+
+  vk::BufferImageCopy region;
+  region.bufferOffset = staging_offset;
+  region.imageSubresource = subresource;
+  region.imageExtent = extent;
+  command_buffer.copyBufferToImage(*staging_buffer_, image,
+                                   vk::ImageLayout::eTransferDstOptimal,
+                                   region);
+
+  // レイアウトの変更は解放と取得の両方に同じものを指定する
+  barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+  barrier.dstAccessMask =
+      vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+  barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+  barrier.newLayout = layout;
+  barrier.srcQueueFamilyIndex =
+      uses_transfer_queue_ ? transfer_queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex =
+      uses_transfer_queue_ ? graphics_queue_family_ : VK_QUEUE_FAMILY_IGNORED;
+  batch.image_barriers.emplace_back(barrier);
+
+  uploaded_bytes_ += size;
+}
+
+std::uint64_t VulkanUploader::Flush() {
+  Poll();
+  if (!recording_batch_) {
+    return flushed_ticket_;
+  }
+  auto batch = std::move(recording_batch_);
+  auto command_buffer = *batch->transfer_command_buffer;
+
+  // 転送キューでは dstAccessMask は無視され、取得側で指定したものが使われる
+  auto dst_stage = uses_transfer_queue_
+                       ? vk::PipelineStageFlagBits::eBottomOfPipe
+                       : vk::PipelineStageFlagBits::eAllCommands;
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                 dst_stage, vk::DependencyFlags(), nullptr,
+                                 batch->buffer_barriers,
+                                 batch->image_barriers);
+  command_buffer.end();
+
+  batch->ticket = ++flushed_ticket_;
+
+  vk::SubmitInfo submit_info;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &command_buffer;
+  if (uses_transfer_queue_) {
+    vk::TimelineSemaphoreSubmitInfoKHR timeline_si;
+    timeline_si.signalSemaphoreValueCount = 1;
+    timeline_si.pSignalSemaphoreValues = &batch->ticket;
+    submit_info.pNext = &timeline_si;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &timeline_semaphore_.get();
+    transfer_queue_.submit(submit_info, vk::Fence());
+  } else {
+    // 同じキューなので、後から提出される描画はバリアの後に実行される
+    graphics_queue_.submit(submit_info, *batch->fence);
+    batch->acquired = true;
+    uploaded_ticket_ = batch->ticket;
+  }
+
+  in_flight_batches_.emplace_back(std::move(batch));
+  return flushed_ticket_;
+}
+
+bool VulkanUploader::IsUploaded(std::uint64_t ticket) {
+  TEMP_ASSERT(ticket <= flushed_ticket_, "ticket must be flushed");
+  if (ticket > uploaded_ticket_) {
+    Poll();
+  }
+  return ticket <= uploaded_ticket_;
+}
+
+void VulkanUploader::Wait(std::uint64_t ticket) {
+  TEMP_ASSERT(ticket <= flushed_ticket_, "ticket must be flushed");
+  if (ticket <= uploaded_ticket_) {
+    return;
+  }
+  vk::SemaphoreWaitInfoKHR wait_info;
+  wait_info.semaphoreCount = 1;
+  wait_info.pSemaphores = &timeline_semaphore_.get();
+  wait_info.pValues = &ticket;
+  device_->device().waitSemaphoresKHR(
+      wait_info, std::numeric_limits<std::uint64_t>::max(),
+      device_->dispatcher());
+  Poll();
+}
+
+bool VulkanUploader::uses_transfer_queue() const {
+  return uses_transfer_queue_;
+}
+
+std::uint64_t VulkanUploader::uploaded_bytes() const {
+  return uploaded_bytes_;
+}
+
+auto VulkanUploader::GetRecordingBatch() -> Batch& {
+  if (recording_batch_) {
+    return *recording_batch_;
+  }
+
+  auto vk_device = device_->device();
+  if (!free_batches_.empty()) {
+    recording_batch_ = std::move(free_batches_.back());
+    free_batches_.pop_back();
+  } else {
+    recording_batch_ = std::make_unique<Batch>();
+    recording_batch_->transfer_command_buffer =
+        AllocateCommandBuffer(vk_device, *transfer_command_pool_);
+    if (uses_transfer_queue_) {
+      recording_batch_->acquire_command_buffer =
+          AllocateCommandBuffer(vk_device, *acquire_command_pool_);
+    }
+    recording_batch_->fence =
+        vk_device.createFenceUnique(vk::FenceCreateInfo());
+  }
+
+  auto&& batch = *recording_batch_;
+  batch.buffer_barriers.clear();
+  batch.image_barriers.clear();
+  batch.staging_bytes = 0;
+  batch.acquired = false;
+  BeginCommandBuffer(*batch.transfer_command_buffer);
+  return batch;
+}
+
+vk::DeviceSize VulkanUploader::ReserveStaging(vk::DeviceSize size,
+                                              vk::DeviceSize alignment) {
+  TEMP_ASSERT(size <= staging_size_, "size must fit in staging buffer");
+  vk::DeviceSize offset;
+  while (!TryReserveStaging(size, alignment, &offset)) {
+    // 記録中のバッチが使っている分は、提出して終わるまで空かない
+    if (recording_batch_ && recording_batch_->staging_bytes > 0) {
+      Flush();
+    } else {
+      TEMP_ASSERT(!in_flight_batches_.empty(),
+                  "staging buffer must have space if no batch is in flight");
+      WaitOldestBatch();
+    }
+  }
+  return offset;
+}
+
+bool VulkanUploader::TryReserveStaging(vk::DeviceSize size,
+                                       vk::DeviceSize alignment,
+                                       vk::DeviceSize* offset) {
+  if (staging_used_ == 0) {
+    staging_head_ = 0;
+  }
+  // 空き領域は書き込み位置から始まり、末尾で先頭に戻る
+  auto free_size = staging_size_ - staging_used_;
+  auto aligned = (staging_head_ + alignment - 1) / alignment * alignment;
+  auto consumed = aligned - staging_head_ + size;
+  if (aligned + size > staging_size_) {
+    // 末尾の残りを捨てて先頭から使う
+    aligned = 0;
+    consumed = staging_size_ - staging_head_ + size;
+  }
+  if (consumed > free_size) {
+    return false;
+  }
+
+  GetRecordingBatch().staging_bytes += consumed;
+  staging_used_ += consumed;
+  staging_head_ = aligned + size;
+  *offset = aligned;
+  return true;
+}
+
+void VulkanUploader::SubmitAcquire(Batch& batch) {
+  auto command_buffer = *batch.acquire_command_buffer;
+  BeginCommandBuffer(command_buffer);
+
+  // 解放と同じバリアのアクセスを取得側に合わせる
+  for (auto&& barrier : batch.buffer_barriers) {
+    barrier.srcAccessMask = vk::AccessFlags();
+  }
+  for (auto&& barrier : batch.image_barriers) {
+    barrier.srcAccessMask = vk::AccessFlags();
+  }
+  command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands,
+                                 vk::PipelineStageFlagBits::eAllCommands,
+                                 vk::DependencyFlags(), nullptr,
+                                 batch.buffer_barriers, batch.image_barriers);
+  command_buffer.end();
+
+  // コピーは終わっているので待たないが、解放との依存関係のために指定する
+  vk::PipelineStageFlags wait_stage = vk::PipelineStageFlagBits::eAllCommands;
+  vk::TimelineSemaphoreSubmitInfoKHR timeline_si;
+  timeline_si.waitSemaphoreValueCount = 1;
+  timeline_si.pWaitSemaphoreValues = &batch.ticket;
+
+  vk::SubmitInfo submit_info;
+  submit_info.pNext = &timeline_si;
+  submit_info.waitSemaphoreCount = 1;
+  submit_info.pWaitSemaphores = &timeline_semaphore_.get();
+  submit_info.pWaitDstStageMask = &wait_stage;
+  submit_info.commandBufferCount = 1;
+  submit_info.pCommandBuffers = &command_buffer;
+  graphics_queue_.submit(submit_info, *batch.fence);
+
+  batch.acquired = true;
+  uploaded_ticket_ = std::max(uploaded_ticket_, batch.ticket);
+}
+
+void VulkanUploader::Poll() {
+  auto vk_device = device_->device();
+  if (uses_transfer_queue_) {
+    auto completed = vk_device.getSemaphoreCounterValueKHR(
+        *timeline_semaphore_, device_->dispatcher());
+    for (auto&& batch : in_flight_batches_) {
+      if (batch->ticket > completed) {
+        break;
+      }
+      if (!batch->acquired) {
+        SubmitAcquire(*batch);
+      }
+    }
+  }
+
+  // 提出した順に終わるので、先頭から回収する
+  while (!in_flight_batches_.empty()) {
+    auto&& batch = in_flight_batches_.front();
+    if (!batch->acquired ||
+        vk_device.getFenceStatus(*batch->fence) != vk::Result::eSuccess) {
+      break;
+    }
+    vk_device.resetFences(*batch->fence);
+    staging_used_ -= batch->staging_bytes;
+    free_batches_.emplace_back(std::move(batch));
+    in_flight_batches_.pop_front();
+  }
+}
+
+void VulkanUploader::WaitOldestBatch() {
+  auto&& batch = *in_flight_batches_.front();
+  if (!batch.acquired) {
+    Wait(batch.ticket);
+  }
+  device_->device().waitForFences(*batch.fence, VK_TRUE,
+                                  std::numeric_limits<std::uint64_t>::max());
+  Poll();
+}
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
+
+#endif
@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <vulkan/vulkan.hpp>
+
+#include "temp/gfx/vulkan/vulkan_memory_allocator.h"
+
+namespace temp {
+namespace gfx {
+namespace vulkan {
+
+class VulkanDevice;
+
+/**
+ * @brief Uploader copying host data to buffers and images through staging
+ *
+ * Data is copied into a persistently mapped staging ring buffer, and the
+ * copy commands are batched until Flush(). When the device has a transfer
+ * queue family apart from graphics and supports timeline semaphores, the
+ * batches run on the transfer queue while the graphics queue keeps
+ * rendering. Ownership of the resources is released to the graphics queue
+ * family, and the acquiring barriers are submitted to the graphics queue
+ * after the copies complete, so rendering never waits for uploads.
+ * Otherwise the batches run on the graphics queue.
+ *
+ * Not thread safe. It submits to the graphics queue, so use it on the
+ * thread submitting rendering.
+ */
+class VulkanUploader {
+ public:
+  static constexpr vk::DeviceSize kDefaultStagingSize = 32ull * 1024 * 1024;
+
+  explicit VulkanUploader(const VulkanDevice& device,
+                          vk::DeviceSize staging_size = kDefaultStagingSize);
+  ~VulkanUploader();
+
+  VulkanUploader(const VulkanUploader&) = delete;
+  VulkanUploader& operator=(const VulkanUploader&) = delete;
+
+  /**
+   * @brief Copy size bytes of data to buffer at offset
+   *
+   * Data larger than the staging buffer is split into several copies.
+   */
+  void UploadBuffer(vk::Buffer buffer, vk::DeviceSize offset,
+                    const void* data, vk::DeviceSize size);
+
+  /**
+   * @brief Replace mip level of image with tightly packed texels
+   *
+   * The previous contents of the level are discarded, and the level is in
+   * layout once uploaded. size must fit in the staging buffer, and the
+   * texel block size of the format must divide 16.
+   */
+  void UploadImage(vk::Image image,
+                   const vk::ImageSubresourceLayers& subresource,
+                   const vk::Extent3D& extent, vk::ImageLayout layout,
+                   const void* data, vk::DeviceSize size);
+
+  /**
+   * @brief Submit the copies recorded since the last Flush()
+   *
+   * @return ticket passed to IsUploaded() and Wait()
+   */
+  std::uint64_t Flush();
+
+  /**
+   * @brief Whether graphics queue submissions made from now on see the data
+   * of flushed ticket
+   */
+  bool IsUploaded(std::uint64_t ticket);
+
+  /**
+   * @brief Block until IsUploaded(ticket)
+   */
+  void Wait(std::uint64_t ticket);
+
+  /**
+   * @brief Whether copies run on the transfer queue
+   */
+  bool uses_transfer_queue() const;
+
+  std::uint64_t uploaded_bytes() const;
+
+ private:
+  struct Batch {
+    vk::UniqueCommandBuffer transfer_command_buffer;
+    vk::UniqueCommandBuffer acquire_command_buffer;
+    // 最後の提出が終わるとシグナルされる
+    vk::UniqueFence fence;
+    // 転送キューでは解放、グラフィックスキューでは取得に使う
+    std::vector<vk::BufferMemoryBarrier> buffer_barriers;
+    std::vector<vk::ImageMemoryBarrier> image_barriers;
+    std::uint64_t ticket = 0;
+    vk::DeviceSize staging_bytes = 0;
+    bool acquired = false;
+  };
+
+  Batch& GetRecordingBatch();
+
+  /**
+   * @brief Reserve range of staging buffer, flushing and waiting if full
+   *
+   * @return offset in staging buffer
+   */
+  vk::DeviceSize ReserveStaging(vk::DeviceSize size,
+                                vk::DeviceSize alignment);
+
+  bool TryReserveStaging(vk::DeviceSize size, vk::DeviceSize alignment,
+                         vk::DeviceSize* offset);
+
+  void SubmitAcquire(Batch& batch);
+
+  /**
+   * @brief Acquire ownership for finished copies and recycle finished batches
+   */
+  void Poll();
+
+  void WaitOldestBatch();
+
+  const VulkanDevice* device_;
+  vk::Queue transfer_queue_;
+  vk::Queue graphics_queue_;
+  std::uint32_t transfer_queue_family_;
+  std::uint32_t graphics_queue_family_;
+  bool uses_transfer_queue_;
+
+  vk::UniqueCommandPool transfer_command_pool_;
+  vk::UniqueCommandPool acquire_command_pool_;
+  // チケットまでのコピーが終わるとその値になる
+  vk::UniqueSemaphore timeline_semaphore_;
+
+  vk::UniqueBuffer staging_buffer_;
+  VulkanMemoryAllocator::UniqueAllocation staging_memory_;
+  vk::DeviceSize staging_size_;
+  vk::DeviceSize staging_alignment_;
+  // リングバッファの書き込み位置と使用中のバイト数
+  vk::DeviceSize staging_head_ = 0;
+  vk::DeviceSize staging_used_ = 0;
+
+  std::unique_ptr<Batch> recording_batch_;
+  std::deque<std::unique_ptr<Batch>> in_flight_batches_;
+  std::vector<std::unique_ptr<Batch>> free_batches_;
+
+  std::uint64_t flushed_ticket_ = 0;
+  std::uint64_t uploaded_ticket_ = 0;
+  std::uint64_t uploaded_bytes_ = 0;
+};
+
+}  // namespace vulkan
+}  // namespace gfx
+}  // namespace temp
@@ -2,6 +2,7 @@
 #ifdef TEMP_GFX_API_VULKAN
 
 #include <algorithm>
+#include <cstdlib>
 #include <map>
 #include <set>
 #include <sstream>
@@ -98,40 +99,71 @@ VkBool32 MessageCallback(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
 
 }  // namespace
 
+bool IsInstanceExtensionAvailable(const char* extension_name) {
+  static std::set<std::string> available = [] {
+    std::set<std::string> result;
+    for (auto&& properties : vk::enumerateInstanceExtensionProperties()) {
+      result.insert(properties.extensionName);
+    }
+    return result;
+  }();
+  return available.count(extension_name) != 0;
+}
+
+bool IsDeviceExtensionAvailable(const vk::PhysicalDevice& physical_device,
+                                const char* extension_name) {
+  auto extensions = physical_device.enumerateDeviceExtensionProperties();
+  return std::any_of(extensions.begin(), extensions.end(),
+                     [extension_name](const vk::ExtensionProperties& p) {
+                       return std::string(p.extensionName) == extension_name;
+                     });
+}
+
 vk::UniqueInstance CreateInstance(const std::string& app_name,
                                   const std::string& engine_name,
-                                  bool enabled_validation) {
+                                  bool enabled_validation,
+                                  bool enabled_surface) {
   vk::ApplicationInfo appInfo = {};
   appInfo.pApplicationName = app_name.c_str();
   appInfo.pEngineName = engine_name.c_str();
   appInfo.apiVersion = kApiVersion;
 
-  std::vector<const char*> instanceExtensions = {VK_KHR_SURFACE_EXTENSION_NAME};
+  std::vector<const char*> instanceExtensions;
 
   // Enable surface extensions depending on os
+  // ヘッドレスではディスプレイのない環境でも作れるように要求しない
+  if (enabled_surface) {
+    instanceExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
 #if defined(_WIN32)
-  instanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_ANDROID_KHR)
-  instanceExtensions.push_back(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_KHR_ANDROID_SURFACE_EXTENSION_NAME);
 #elif defined(_DIRECT2DISPLAY)
-  instanceExtensions.push_back(VK_KHR_DISPLAY_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_KHR_DISPLAY_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_WAYLAND_KHR)
-  instanceExtensions.push_back(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_KHR_WAYLAND_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_XCB_KHR)
-  instanceExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_KHR_XCB_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_IOS_MVK)
-  instanceExtensions.push_back(VK_MVK_IOS_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_MVK_IOS_SURFACE_EXTENSION_NAME);
 #elif defined(VK_USE_PLATFORM_MACOS_MVK)
-  instanceExtensions.push_back(VK_MVK_MACOS_SURFACE_EXTENSION_NAME);
+    instanceExtensions.push_back(VK_MVK_MACOS_SURFACE_EXTENSION_NAME);
 #endif
+  }
+  if (enabled_validation) {
+    instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+  }
+  // VK_EXT_memory_budget でヒープの使用量を問い合わせるのに使う
+  if (IsInstanceExtensionAvailable(
+          VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME)) {
+    instanceExtensions.push_back(
+        VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+  }
 
   vk::InstanceCreateInfo instanceCreateInfo = {};
   instanceCreateInfo.pNext = NULL;
   instanceCreateInfo.pApplicationInfo = &appInfo;
   if (instanceExtensions.size() > 0) {
-    if (enabled_validation) {
-      instanceExtensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
-    }
     instanceCreateInfo.enabledExtensionCount =
         (uint32_t)instanceExtensions.size();
     instanceCreateInfo.ppEnabledExtensionNames = instanceExtensions.data();
@@ -200,6 +232,10 @@ vk::UniqueSurfaceKHR CreateWindowSurface(const vk::Instance& instance,
   vk::MacOSSurfaceCreateInfoMVK info;
   info.pView = window;
   return instance.createMacOSSurfaceMVKUnique(info, nullptr);
+#else
+  // ウィンドウのない環境ではヘッドレスのデバイスだけを使う
+  TEMP_LOG_ERROR("Window surface is not supported on this platform.");
+  std::abort();
 #endif
 }
 
@@ -207,7 +243,10 @@ std::tuple<vk::UniqueDevice, std::map<vk::QueueFlagBits, int>>
 CreateLogicalDevice(
     const vk::PhysicalDevice& physical_device,
     const std::vector<vk::QueueFamilyProperties>& queue_family_properties,
-    bool enabled_debug_marker) {
+    bool enabled_debug_marker, bool enabled_swap_chain,
+    bool enabled_memory_budget, bool enabled_timeline_semaphore,
+    bool enabled_descriptor_update_template,
+    bool enabled_descriptor_indexing, bool enabled_dedicated_allocation) {
   std::map<vk::QueueFlagBits, int> queue_index_table;
   for (int i = 0; i < queue_family_properties.size(); ++i) {
     auto& properties = queue_family_properties[i];
@@ -230,6 +269,28 @@ CreateLogicalDevice(
     }
   }
 
+  // 描画と並行して実行できるように、グラフィックスのないファミリーを優先する
+  for (int i = 0; i < queue_family_properties.size(); ++i) {
+    auto& properties = queue_family_properties[i];
+    if (properties.queueCount > 0 &&
+        properties.queueFlags & vk::QueueFlagBits::eCompute &&
+        !(properties.queueFlags & vk::QueueFlagBits::eGraphics)) {
+      queue_index_table[vk::QueueFlagBits::eCompute] = i;
+      break;
+    }
+  }
+  // 描画と並行してコピーできるように、転送専用のファミリーがあればそれを使う
+  for (int i = 0; i < queue_family_properties.size(); ++i) {
+    auto& properties = queue_family_properties[i];
+    if (properties.queueCount > 0 &&
+        properties.queueFlags & vk::QueueFlagBits::eTransfer &&
+        !(properties.queueFlags &
+          (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))) {
+      queue_index_table[vk::QueueFlagBits::eTransfer] = i;
+      break;
+    }
+  }
+
   if (queue_index_table.find(vk::QueueFlagBits::eGraphics) ==
       queue_index_table.end()) {
     TEMP_LOG_ERROR("Not found queue family.");
@@ -298,13 +359,39 @@ CreateLogicalDevice(
   auto device_extension_properties =
       physical_device.enumerateDeviceExtensionProperties();
 
-  std::vector<const char*> device_extensions = {
-      VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+  std::vector<const char*> device_extensions;
+  if (enabled_swap_chain) {
+    device_extensions.emplace_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+  }
 
   if (enabled_debug_marker) {
     device_extensions.emplace_back(VK_EXT_DEBUG_MARKER_EXTENSION_NAME);
   }
 
+  if (enabled_memory_budget) {
+    device_extensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+  }
+
+  if (enabled_timeline_semaphore) {
+    device_extensions.emplace_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+  }
+
+  if (enabled_descriptor_update_template) {
+    device_extensions.emplace_back(
+        VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME);
+  }
+
+  if (enabled_descriptor_indexing) {
+    device_extensions.emplace_back(VK_KHR_MAINTENANCE3_EXTENSION_NAME);
+    device_extensions.emplace_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+  }
+
+  if (enabled_dedicated_allocation) {
+    device_extensions.emplace_back(
+        VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME);
+    device_extensions.emplace_back(VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME);
+  }
+
   auto end = std::remove_if(
       device_extensions.begin(), device_extensions.end(),
       [&device_extension_properties](auto& n) {
@@ -321,6 +408,40 @@ CreateLogicalDevice(
   device_create_info.enabledExtensionCount = static_cast<uint32_t>(device_extensions.size());
   device_create_info.ppEnabledExtensionNames = device_extensions.data();
 
+  auto is_enabled = [&device_extensions](const char* name) {
+    return std::find_if(device_extensions.begin(), device_extensions.end(),
+                        [name](const char* n) {
+                          return std::string(n) == name;
+                        }) != device_extensions.end();
+  };
+
+  // 拡張だけでなく機能も有効にしないと使えない
+  vk::PhysicalDeviceTimelineSemaphoreFeaturesKHR timeline_semaphore_features;
+  timeline_semaphore_features.timelineSemaphore = VK_TRUE;
+  if (is_enabled(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+    timeline_semaphore_features.pNext =
+        const_cast<void*>(device_create_info.pNext);
+    device_create_info.pNext = &timeline_semaphore_features;
+  }
+
+  // バインドレスのテクスチャとバッファの配列に要るものだけ有効にする
+  vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptor_indexing_features;
+  descriptor_indexing_features.shaderSampledImageArrayNonUniformIndexing =
+      VK_TRUE;
+  descriptor_indexing_features.descriptorBindingSampledImageUpdateAfterBind =
+      VK_TRUE;
+  descriptor_indexing_features.descriptorBindingStorageBufferUpdateAfterBind =
+      VK_TRUE;
+  descriptor_indexing_features.descriptorBindingUpdateUnusedWhilePending =
+      VK_TRUE;
+  descriptor_indexing_features.descriptorBindingPartiallyBound = VK_TRUE;
+  descriptor_indexing_features.runtimeDescriptorArray = VK_TRUE;
+  if (is_enabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+    descriptor_indexing_features.pNext =
+        const_cast<void*>(device_create_info.pNext);
+    device_create_info.pNext = &descriptor_indexing_features;
+  }
+
   auto device = physical_device.createDeviceUnique(device_create_info);
   return std::forward_as_tuple(std::move(device), queue_index_table);
 }
@@ -415,6 +536,18 @@ vk::SwapchainCreateInfoKHR SetupSwapchainCreateInfo(
 
   return create_info;
 }
+
+int FindMemoryTypeIndex(
+    const vk::PhysicalDeviceMemoryProperties& memory_properties,
+    std::uint32_t type_bits, vk::MemoryPropertyFlags flags) {
+  for (std::uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+    if ((type_bits & (1u << i)) != 0 &&
+        (memory_properties.memoryTypes[i].propertyFlags & flags) == flags) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
 }  // namespace vulkan
 }  // namespace gfx
 }  // namespace temp
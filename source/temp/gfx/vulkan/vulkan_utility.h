@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <tuple>
 #include <vector>
@@ -10,9 +11,15 @@ namespace temp {
 namespace gfx {
 namespace vulkan {
 
+bool IsInstanceExtensionAvailable(const char* extension_name);
+
+bool IsDeviceExtensionAvailable(const vk::PhysicalDevice& physical_device,
+                                const char* extension_name);
+
 vk::UniqueInstance CreateInstance(const std::string& app_name,
                                   const std::string& engine_name,
-                                  bool enabled_validation);
+                                  bool enabled_validation,
+                                  bool enabled_surface);
 
 vk::UniqueHandle<vk::DebugUtilsMessengerEXT, vk::DispatchLoaderDynamic>
 SetupDebugging(const vk::Instance& instance,
@@ -30,13 +37,25 @@ std::tuple<vk::UniqueDevice, std::map<vk::QueueFlagBits, int>>
 CreateLogicalDevice(
     const vk::PhysicalDevice& physical_device,
     const std::vector<vk::QueueFamilyProperties>& queue_family_properties,
-    bool enabled_debug_marker);
+    bool enabled_debug_marker, bool enabled_swap_chain,
+    bool enabled_memory_budget, bool enabled_timeline_semaphore,
+    bool enabled_descriptor_update_template,
+    bool enabled_descriptor_indexing, bool enabled_dedicated_allocation);
 
 vk::SwapchainCreateInfoKHR SetupSwapchainCreateInfo(
     vk::PhysicalDevice physical_device, int graphics_queue_index,
     vk::SurfaceKHR surface, const vk::Extent2D& extent,
     vk::SwapchainKHR old_swap_chain);
 
+/**
+ * @brief Find memory type allowed by type_bits that has all of flags
+ *
+ * @return index of memory type, -1 if not found
+ */
+int FindMemoryTypeIndex(
+    const vk::PhysicalDeviceMemoryProperties& memory_properties,
+    std::uint32_t type_bits, vk::MemoryPropertyFlags flags);
+
 }  // namespace vulkan
 }  // namespace gfx
 }  // namespace temp
\ No newline at end of file
@@ -0,0 +1,787 @@
+﻿#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <limits>
+
+#include "temp/base/cpu_feature.h"
+
+#include "temp/math/batch.h"
+#include "temp/math/bounds_functions.h"
+#include "temp/math/matrix44_functions.h"
+#include "temp/math/quaternion_wide.h"
+#include "temp/math/simd.h"
+
+#if defined(TEMP_MATH_SIMD_SSE)
+#define TEMP_MATH_BATCH_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TEMP_TARGET_AVX2
+#define TEMP_TARGET_AVX512
+#else
+#define TEMP_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TEMP_TARGET_AVX512 __attribute__((target("avx2,fma,avx512f")))
+#endif
+#endif
+
+namespace temp {
+namespace math {
+
+static_assert(sizeof(Vector3) == sizeof(float) * 3,
+              "Vector3 must be tightly packed");
+
+namespace {
+
+using TransformAoSFunc = void (*)(const Vector3*, std::size_t,
+                                  const Matrix44&, Vector3*);
+using TransformSoAFunc = void (*)(const float*, const float*, const float*,
+                                  std::size_t, const Matrix44&, float*, float*,
+                                  float*);
+
+// Bounds in SoA layout. Spheres use radii, boxes use the extents.
+struct BoundsSoA {
+  const float* xs;
+  const float* ys;
+  const float* zs;
+  const float* radii;
+  const float* extent_xs;
+  const float* extent_ys;
+  const float* extent_zs;
+};
+
+using CullFunc = void (*)(const Frustum&, const BoundsSoA&, std::size_t,
+                          std::uint32_t*);
+
+// Bounds per visibility word
+constexpr std::size_t kCullWordBits = 32;
+
+// Bounds converted to SoA at a time by the AoS entry points
+constexpr std::size_t kCullChunk = kCullWordBits * 8;
+
+// Lane count of the wide type kernels, fixed at compile time. Without a
+// SIMD backend they fall back to the scalar functions.
+#if defined(TEMP_MATH_SIMD_SSE) && defined(__AVX512F__)
+constexpr std::size_t kWideLanes = 16;
+#elif defined(TEMP_MATH_SIMD_SSE) && defined(__AVX__)
+constexpr std::size_t kWideLanes = 8;
+#else
+constexpr std::size_t kWideLanes = 4;
+#endif
+
+using WideFloat = Wide<float, kWideLanes>;
+using WideVector3 = Vector3Wide<float, kWideLanes>;
+using WideQuaternion = QuaternionWide<float, kWideLanes>;
+
+template <class WideFunc, class ScalarFunc>
+void blendQuaternions(const Quaternion* lhs, const Quaternion* rhs,
+                      std::size_t count, float t, Quaternion* results,
+                      WideFunc wide_func, ScalarFunc scalar_func) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  WideFloat wide_t(t);
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    auto l = WideQuaternion::load(lhs + i);
+    auto r = WideQuaternion::load(rhs + i);
+    wide_func(l, r, wide_t).store(results + i);
+  }
+#else
+  (void)wide_func;
+#endif
+  for (; i < count; ++i) {
+    results[i] = scalar_func(lhs[i], rhs[i], t);
+  }
+}
+
+struct Kernels {
+  SimdLevel level;
+  TransformAoSFunc transform_aos;
+  TransformSoAFunc transform_soa;
+  CullFunc cull_spheres;
+  CullFunc cull_aabbs;
+};
+
+Matrix44 rotationMatrix(const Quaternion& q) {
+  // Same result as q * v * conjugated(q), also for non unit quaternions.
+  float x2 = q.x() * q.x();
+  float y2 = q.y() * q.y();
+  float z2 = q.z() * q.z();
+  float w2 = q.w() * q.w();
+
+  float xy = q.x() * q.y();
+  float xz = q.x() * q.z();
+  float yz = q.y() * q.z();
+  float wx = q.w() * q.x();
+  float wy = q.w() * q.y();
+  float wz = q.w() * q.z();
+
+  return Matrix44(w2 + x2 - y2 - z2, 2 * (xy - wz), 2 * (xz + wy), 0,  //
+                  2 * (xy + wz), w2 - x2 + y2 - z2, 2 * (yz - wx), 0,  //
+                  2 * (xz - wy), 2 * (yz + wx), w2 - x2 - y2 + z2, 0,  //
+                  0, 0, 0, 1);
+}
+
+void transformSoATail(const float* xs, const float* ys, const float* zs,
+                      std::size_t begin, std::size_t count,
+                      const Matrix44& mat, float* result_xs, float* result_ys,
+                      float* result_zs) {
+  for (auto i = begin; i < count; ++i) {
+    auto x = xs[i];
+    auto y = ys[i];
+    auto z = zs[i];
+    result_xs[i] = mat[0][0] * x + mat[0][1] * y + mat[0][2] * z + mat[0][3];
+    result_ys[i] = mat[1][0] * x + mat[1][1] * y + mat[1][2] * z + mat[1][3];
+    result_zs[i] = mat[2][0] * x + mat[2][1] * y + mat[2][2] * z + mat[2][3];
+  }
+}
+
+void transformAoSScalar(const Vector3* points, std::size_t count,
+                        const Matrix44& mat, Vector3* results) {
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = transform(points[i], mat);
+  }
+}
+
+#if !defined(TEMP_MATH_SIMD)
+void transformSoAScalar(const float* xs, const float* ys, const float* zs,
+                        std::size_t count, const Matrix44& mat,
+                        float* result_xs, float* result_ys, float* result_zs) {
+  transformSoATail(xs, ys, zs, 0, count, mat, result_xs, result_ys, result_zs);
+}
+#endif
+
+// Writes the words from begin / kCullWordBits, begin is a multiple of it.
+template <bool kSphere>
+void cullTail(const Frustum& frustum, const BoundsSoA& bounds,
+              std::size_t begin, std::size_t count,
+              std::uint32_t* visibility) {
+  for (auto i = begin; i < count; i += kCullWordBits) {
+    std::uint32_t bits = 0;
+    auto end = std::min(count, i + kCullWordBits);
+    for (auto j = i; j < end; ++j) {
+      Vector3 c(bounds.xs[j], bounds.ys[j], bounds.zs[j]);
+      bool visible =
+          kSphere ? intersects(frustum, Sphere{c, bounds.radii[j]})
+                  : intersects(frustum, Aabb::fromCenterExtent(
+                                            c, Vector3(bounds.extent_xs[j],
+                                                       bounds.extent_ys[j],
+                                                       bounds.extent_zs[j])));
+      bits |= (visible ? 1u : 0u) << (j - i);
+    }
+    visibility[i / kCullWordBits] = bits;
+  }
+}
+
+template <bool kSphere>
+void cullScalar(const Frustum& frustum, const BoundsSoA& bounds,
+                std::size_t count, std::uint32_t* visibility) {
+  cullTail<kSphere>(frustum, bounds, 0, count, visibility);
+}
+
+#if defined(TEMP_MATH_SIMD)
+void transformSoAFloat4(const float* xs, const float* ys, const float* zs,
+                        std::size_t count, const Matrix44& mat,
+                        float* result_xs, float* result_ys, float* result_zs) {
+  simd::Float4 m[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = simd::splat(mat[r][c]);
+    }
+  }
+
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto x = simd::loadUnaligned(xs + i);
+    auto y = simd::loadUnaligned(ys + i);
+    auto z = simd::loadUnaligned(zs + i);
+    float* results[] = {result_xs, result_ys, result_zs};
+    for (int r = 0; r < 3; ++r) {
+      auto v = simd::madd(
+          m[r][0], x, simd::madd(m[r][1], y, simd::madd(m[r][2], z, m[r][3])));
+      simd::storeUnaligned(results[r] + i, v);
+    }
+  }
+  transformSoATail(xs, ys, zs, i, count, mat, result_xs, result_ys, result_zs);
+}
+
+template <bool kSphere>
+void cullFloat4(const Frustum& frustum, const BoundsSoA& bounds,
+                std::size_t count, std::uint32_t* visibility) {
+  constexpr int kPlanes = Frustum::kPlaneCount;
+  simd::Float4 nx[kPlanes], ny[kPlanes], nz[kPlanes], d[kPlanes];
+  simd::Float4 ax[kPlanes], ay[kPlanes], az[kPlanes];
+  for (int p = 0; p < kPlanes; ++p) {
+    const auto& n = frustum.planes[p].normal;
+    nx[p] = simd::splat(n.x());
+    ny[p] = simd::splat(n.y());
+    nz[p] = simd::splat(n.z());
+    d[p] = simd::splat(frustum.planes[p].distance);
+    ax[p] = simd::splat(std::abs(n.x()));
+    ay[p] = simd::splat(std::abs(n.y()));
+    az[p] = simd::splat(std::abs(n.z()));
+  }
+  auto zero = simd::splat(0.0f);
+  auto max_float = simd::splat(std::numeric_limits<float>::max());
+  // 球は半径を x の広がりとして読む
+  auto extent_xs = kSphere ? bounds.radii : bounds.extent_xs;
+
+  std::size_t i = 0;
+  for (; i + kCullWordBits <= count; i += kCullWordBits) {
+    std::uint32_t bits = 0;
+    for (std::size_t k = 0; k < kCullWordBits; k += 4) {
+      auto j = i + k;
+      auto x = simd::loadUnaligned(bounds.xs + j);
+      auto y = simd::loadUnaligned(bounds.ys + j);
+      auto z = simd::loadUnaligned(bounds.zs + j);
+      auto ex = simd::loadUnaligned(extent_xs + j);
+      auto ey = kSphere ? ex : simd::loadUnaligned(bounds.extent_ys + j);
+      auto ez = kSphere ? ex : simd::loadUnaligned(bounds.extent_zs + j);
+      // 全平面での (符号付き距離 + 半径) の最小値が負なら外側
+      auto nearest = max_float;
+      for (int p = 0; p < kPlanes; ++p) {
+        auto dist = simd::madd(
+            nx[p], x, simd::madd(ny[p], y, simd::madd(nz[p], z, d[p])));
+        if (!kSphere) {
+          dist = simd::madd(
+              ax[p], ex, simd::madd(ay[p], ey, simd::madd(az[p], ez, dist)));
+        }
+        nearest = simd::min(nearest, dist);
+      }
+      if (kSphere) {
+        nearest = simd::add(nearest, ex);
+      }
+      bits |= simd::maskBits(simd::cmpLe(zero, nearest)) << k;
+    }
+    visibility[i / kCullWordBits] = bits;
+  }
+  cullTail<kSphere>(frustum, bounds, i, count, visibility);
+}
+#endif
+
+#if defined(TEMP_MATH_BATCH_X86)
+//----------------------------------------
+// AVX2
+//----------------------------------------
+TEMP_TARGET_AVX2 void transformSoAAvx2(const float* xs, const float* ys,
+                                       const float* zs, std::size_t count,
+                                       const Matrix44& mat, float* result_xs,
+                                       float* result_ys, float* result_zs) {
+  __m256 m[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = _mm256_set1_ps(mat[r][c]);
+    }
+  }
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto x = _mm256_loadu_ps(xs + i);
+    auto y = _mm256_loadu_ps(ys + i);
+    auto z = _mm256_loadu_ps(zs + i);
+    float* results[] = {result_xs, result_ys, result_zs};
+    for (int r = 0; r < 3; ++r) {
+      auto v = _mm256_fmadd_ps(
+          m[r][0], x,
+          _mm256_fmadd_ps(m[r][1], y, _mm256_fmadd_ps(m[r][2], z, m[r][3])));
+      _mm256_storeu_ps(results[r] + i, v);
+    }
+  }
+  transformSoATail(xs, ys, zs, i, count, mat, result_xs, result_ys, result_zs);
+}
+
+TEMP_TARGET_AVX2 void transformAoSAvx2(const Vector3* points,
+                                       std::size_t count, const Matrix44& mat,
+                                       Vector3* results) {
+  __m256 m[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = _mm256_set1_ps(mat[r][c]);
+    }
+  }
+
+  auto src = reinterpret_cast<const float*>(points);
+  auto dst = reinterpret_cast<float*>(results);
+
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    // Each 128 bit lane deinterleaves 4 points:
+    // [x0 y0 z0 x1] [y1 z1 x2 y2] [z2 x3 y3 z3] -> [x0..x3] [y0..y3] [z0..z3]
+    auto p = src + i * 3;
+    auto m03 = _mm256_castps128_ps256(_mm_loadu_ps(p + 0));
+    auto m14 = _mm256_castps128_ps256(_mm_loadu_ps(p + 4));
+    auto m25 = _mm256_castps128_ps256(_mm_loadu_ps(p + 8));
+    m03 = _mm256_insertf128_ps(m03, _mm_loadu_ps(p + 12), 1);
+    m14 = _mm256_insertf128_ps(m14, _mm_loadu_ps(p + 16), 1);
+    m25 = _mm256_insertf128_ps(m25, _mm_loadu_ps(p + 20), 1);
+
+    auto xy = _mm256_shuffle_ps(m14, m25, _MM_SHUFFLE(2, 1, 3, 2));
+    auto yz = _mm256_shuffle_ps(m03, m14, _MM_SHUFFLE(1, 0, 2, 1));
+    auto x = _mm256_shuffle_ps(m03, xy, _MM_SHUFFLE(2, 0, 3, 0));
+    auto y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+    auto z = _mm256_shuffle_ps(yz, m25, _MM_SHUFFLE(3, 0, 3, 1));
+
+    __m256 t[3];
+    for (int r = 0; r < 3; ++r) {
+      t[r] = _mm256_fmadd_ps(
+          m[r][0], x,
+          _mm256_fmadd_ps(m[r][1], y, _mm256_fmadd_ps(m[r][2], z, m[r][3])));
+    }
+
+    auto rxy = _mm256_shuffle_ps(t[0], t[1], _MM_SHUFFLE(2, 0, 2, 0));
+    auto ryz = _mm256_shuffle_ps(t[1], t[2], _MM_SHUFFLE(3, 1, 3, 1));
+    auto rzx = _mm256_shuffle_ps(t[2], t[0], _MM_SHUFFLE(3, 1, 2, 0));
+    auto r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+    auto r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+    auto r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+
+    auto q = dst + i * 3;
+    _mm_storeu_ps(q + 0, _mm256_castps256_ps128(r03));
+    _mm_storeu_ps(q + 4, _mm256_castps256_ps128(r14));
+    _mm_storeu_ps(q + 8, _mm256_castps256_ps128(r25));
+    _mm_storeu_ps(q + 12, _mm256_extractf128_ps(r03, 1));
+    _mm_storeu_ps(q + 16, _mm256_extractf128_ps(r14, 1));
+    _mm_storeu_ps(q + 20, _mm256_extractf128_ps(r25, 1));
+  }
+  transformAoSScalar(points + i, count - i, mat, results + i);
+}
+
+template <bool kSphere>
+TEMP_TARGET_AVX2 void cullAvx2(const Frustum& frustum,
+                               const BoundsSoA& bounds, std::size_t count,
+                               std::uint32_t* visibility) {
+  constexpr int kPlanes = Frustum::kPlaneCount;
+  __m256 nx[kPlanes], ny[kPlanes], nz[kPlanes], d[kPlanes];
+  __m256 ax[kPlanes], ay[kPlanes], az[kPlanes];
+  for (int p = 0; p < kPlanes; ++p) {
+    const auto& n = frustum.planes[p].normal;
+    nx[p] = _mm256_set1_ps(n.x());
+    ny[p] = _mm256_set1_ps(n.y());
+    nz[p] = _mm256_set1_ps(n.z());
+    d[p] = _mm256_set1_ps(frustum.planes[p].distance);
+    ax[p] = _mm256_set1_ps(std::abs(n.x()));
+    ay[p] = _mm256_set1_ps(std::abs(n.y()));
+    az[p] = _mm256_set1_ps(std::abs(n.z()));
+  }
+  auto zero = _mm256_setzero_ps();
+  auto max_float = _mm256_set1_ps(std::numeric_limits<float>::max());
+  // 球は半径を x の広がりとして読む
+  auto extent_xs = kSphere ? bounds.radii : bounds.extent_xs;
+
+  std::size_t i = 0;
+  for (; i + kCullWordBits <= count; i += kCullWordBits) {
+    std::uint32_t bits = 0;
+    for (std::size_t k = 0; k < kCullWordBits; k += 8) {
+      auto j = i + k;
+      auto x = _mm256_loadu_ps(bounds.xs + j);
+      auto y = _mm256_loadu_ps(bounds.ys + j);
+      auto z = _mm256_loadu_ps(bounds.zs + j);
+      auto ex = _mm256_loadu_ps(extent_xs + j);
+      auto ey = kSphere ? ex : _mm256_loadu_ps(bounds.extent_ys + j);
+      auto ez = kSphere ? ex : _mm256_loadu_ps(bounds.extent_zs + j);
+      auto nearest = max_float;
+      for (int p = 0; p < kPlanes; ++p) {
+        auto dist = _mm256_fmadd_ps(
+            nx[p], x,
+            _mm256_fmadd_ps(ny[p], y, _mm256_fmadd_ps(nz[p], z, d[p])));
+        if (!kSphere) {
+          dist = _mm256_fmadd_ps(
+              ax[p], ex,
+              _mm256_fmadd_ps(ay[p], ey, _mm256_fmadd_ps(az[p], ez, dist)));
+        }
+        nearest = _mm256_min_ps(nearest, dist);
+      }
+      if (kSphere) {
+        nearest = _mm256_add_ps(nearest, ex);
+      }
+      auto mask = _mm256_cmp_ps(nearest, zero, _CMP_GE_OQ);
+      bits |= (std::uint32_t)_mm256_movemask_ps(mask) << k;
+    }
+    visibility[i / kCullWordBits] = bits;
+  }
+  cullTail<kSphere>(frustum, bounds, i, count, visibility);
+}
+
+//----------------------------------------
+// AVX-512
+//----------------------------------------
+struct PermuteTable {
+  // Gather x, y or z of 16 points from three registers of interleaved data.
+  alignas(64) std::int32_t load_ab[3][16];
+  alignas(64) std::int32_t load_c[3][16];
+  // Scatter x, y and z of 16 points back to three interleaved registers.
+  alignas(64) std::int32_t store_xy[3][16];
+  alignas(64) std::int32_t store_z[3][16];
+
+  PermuteTable() {
+    for (int c = 0; c < 3; ++c) {
+      for (int i = 0; i < 16; ++i) {
+        int k = 3 * i + c;
+        load_ab[c][i] = k < 32 ? k : 0;
+        load_c[c][i] = k < 32 ? i : 16 + (k - 32);
+      }
+    }
+    for (int o = 0; o < 3; ++o) {
+      for (int j = 0; j < 16; ++j) {
+        int g = 16 * o + j;
+        int point = g / 3;
+        int c = g % 3;
+        store_xy[o][j] = c < 2 ? c * 16 + point : 0;
+        store_z[o][j] = c < 2 ? j : 16 + point;
+      }
+    }
+  }
+};
+
+const PermuteTable& permuteTable() {
+  static const PermuteTable table;
+  return table;
+}
+
+TEMP_TARGET_AVX512 void transformSoAAvx512(const float* xs, const float* ys,
+                                           const float* zs, std::size_t count,
+                                           const Matrix44& mat,
+                                           float* result_xs, float* result_ys,
+                                           float* result_zs) {
+  __m512 m[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = _mm512_set1_ps(mat[r][c]);
+    }
+  }
+
+  float* results[] = {result_xs, result_ys, result_zs};
+  for (std::size_t i = 0; i < count; i += 16) {
+    auto rest = count - i;
+    __mmask16 mask =
+        rest >= 16 ? (__mmask16)0xffff : (__mmask16)((1u << rest) - 1);
+    auto x = _mm512_maskz_loadu_ps(mask, xs + i);
+    auto y = _mm512_maskz_loadu_ps(mask, ys + i);
+    auto z = _mm512_maskz_loadu_ps(mask, zs + i);
+    for (int r = 0; r < 3; ++r) {
+      auto v = _mm512_fmadd_ps(
+          m[r][0], x,
+          _mm512_fmadd_ps(m[r][1], y, _mm512_fmadd_ps(m[r][2], z, m[r][3])));
+      _mm512_mask_storeu_ps(results[r] + i, mask, v);
+    }
+  }
+}
+
+TEMP_TARGET_AVX512 void transformAoSAvx512(const Vector3* points,
+                                           std::size_t count,
+                                           const Matrix44& mat,
+                                           Vector3* results) {
+  __m512 m[3][4];
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = _mm512_set1_ps(mat[r][c]);
+    }
+  }
+
+  auto&& table = permuteTable();
+  __m512i load_ab[3], load_c[3], store_xy[3], store_z[3];
+  for (int c = 0; c < 3; ++c) {
+    load_ab[c] = _mm512_load_si512(table.load_ab[c]);
+    load_c[c] = _mm512_load_si512(table.load_c[c]);
+    store_xy[c] = _mm512_load_si512(table.store_xy[c]);
+    store_z[c] = _mm512_load_si512(table.store_z[c]);
+  }
+
+  auto src = reinterpret_cast<const float*>(points);
+  auto dst = reinterpret_cast<float*>(results);
+
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto p = src + i * 3;
+    auto a = _mm512_loadu_ps(p + 0);
+    auto b = _mm512_loadu_ps(p + 16);
+    auto c = _mm512_loadu_ps(p + 32);
+
+    __m512 v[3];
+    for (int k = 0; k < 3; ++k) {
+      auto ab = _mm512_permutex2var_ps(a, load_ab[k], b);
+      v[k] = _mm512_permutex2var_ps(ab, load_c[k], c);
+    }
+
+    __m512 t[3];
+    for (int r = 0; r < 3; ++r) {
+      t[r] = _mm512_fmadd_ps(
+          m[r][0], v[0],
+          _mm512_fmadd_ps(m[r][1], v[1],
+                          _mm512_fmadd_ps(m[r][2], v[2], m[r][3])));
+    }
+
+    auto q = dst + i * 3;
+    for (int o = 0; o < 3; ++o) {
+      auto xy = _mm512_permutex2var_ps(t[0], store_xy[o], t[1]);
+      _mm512_storeu_ps(q + 16 * o,
+                       _mm512_permutex2var_ps(xy, store_z[o], t[2]));
+    }
+  }
+  transformAoSAvx2(points + i, count - i, mat, results + i);
+}
+
+template <bool kSphere>
+TEMP_TARGET_AVX512 void cullAvx512(const Frustum& frustum,
+                                   const BoundsSoA& bounds, std::size_t count,
+                                   std::uint32_t* visibility) {
+  constexpr int kPlanes = Frustum::kPlaneCount;
+  __m512 nx[kPlanes], ny[kPlanes], nz[kPlanes], d[kPlanes];
+  __m512 ax[kPlanes], ay[kPlanes], az[kPlanes];
+  for (int p = 0; p < kPlanes; ++p) {
+    const auto& n = frustum.planes[p].normal;
+    nx[p] = _mm512_set1_ps(n.x());
+    ny[p] = _mm512_set1_ps(n.y());
+    nz[p] = _mm512_set1_ps(n.z());
+    d[p] = _mm512_set1_ps(frustum.planes[p].distance);
+    ax[p] = _mm512_set1_ps(std::abs(n.x()));
+    ay[p] = _mm512_set1_ps(std::abs(n.y()));
+    az[p] = _mm512_set1_ps(std::abs(n.z()));
+  }
+  auto zero = _mm512_setzero_ps();
+  auto max_float = _mm512_set1_ps(std::numeric_limits<float>::max());
+  // 球は半径を x の広がりとして読む
+  auto extent_xs = kSphere ? bounds.radii : bounds.extent_xs;
+
+  for (std::size_t i = 0; i < count; i += kCullWordBits) {
+    std::uint32_t bits = 0;
+    for (std::size_t k = 0; k < kCullWordBits && i + k < count; k += 16) {
+      auto j = i + k;
+      auto rest = count - j;
+      __mmask16 load_mask =
+          rest >= 16 ? (__mmask16)0xffff : (__mmask16)((1u << rest) - 1);
+      auto x = _mm512_maskz_loadu_ps(load_mask, bounds.xs + j);
+      auto y = _mm512_maskz_loadu_ps(load_mask, bounds.ys + j);
+      auto z = _mm512_maskz_loadu_ps(load_mask, bounds.zs + j);
+      auto ex = _mm512_maskz_loadu_ps(load_mask, extent_xs + j);
+      auto ey = kSphere ? ex
+                        : _mm512_maskz_loadu_ps(load_mask,
+                                                bounds.extent_ys + j);
+      auto ez = kSphere ? ex
+                        : _mm512_maskz_loadu_ps(load_mask,
+                                                bounds.extent_zs + j);
+      auto nearest = max_float;
+      for (int p = 0; p < kPlanes; ++p) {
+        auto dist = _mm512_fmadd_ps(
+            nx[p], x,
+            _mm512_fmadd_ps(ny[p], y, _mm512_fmadd_ps(nz[p], z, d[p])));
+        if (!kSphere) {
+          dist = _mm512_fmadd_ps(
+              ax[p], ex,
+              _mm512_fmadd_ps(ay[p], ey, _mm512_fmadd_ps(az[p], ez, dist)));
+        }
+        nearest = _mm512_mask_min_ps(nearest, load_mask, nearest, dist);
+      }
+      if (kSphere) {
+        nearest = _mm512_add_ps(nearest, ex);
+      }
+      auto mask = _mm512_mask_cmp_ps_mask(load_mask, nearest, zero,
+                                          _CMP_GE_OQ);
+      bits |= (std::uint32_t)mask << k;
+    }
+    visibility[i / kCullWordBits] = bits;
+  }
+}
+#endif
+
+// Kernels of level, false when the build or the running CPU lacks it.
+bool makeKernels(SimdLevel level, Kernels* result) {
+  switch (level) {
+#if defined(TEMP_MATH_BATCH_X86)
+    case SimdLevel::kAvx512:
+      if (!GetCpuFeatures().avx512f) {
+        return false;
+      }
+      *result = Kernels{level, transformAoSAvx512, transformSoAAvx512,
+                        cullAvx512<true>, cullAvx512<false>};
+      return true;
+    case SimdLevel::kAvx2:
+      if (!GetCpuFeatures().avx2 || !GetCpuFeatures().fma) {
+        return false;
+      }
+      *result = Kernels{level, transformAoSAvx2, transformSoAAvx2,
+                        cullAvx2<true>, cullAvx2<false>};
+      return true;
+#endif
+#if defined(TEMP_MATH_SIMD)
+    case SimdLevel::kFloat4:
+      *result = Kernels{level, transformAoSScalar, transformSoAFloat4,
+                        cullFloat4<true>, cullFloat4<false>};
+      return true;
+#else
+    case SimdLevel::kScalar:
+      *result = Kernels{level, transformAoSScalar, transformSoAScalar,
+                        cullScalar<true>, cullScalar<false>};
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+Kernels selectKernels() {
+  Kernels result{};
+  for (auto level : {SimdLevel::kAvx512, SimdLevel::kAvx2, SimdLevel::kFloat4,
+                     SimdLevel::kScalar}) {
+    if (makeKernels(level, &result)) {
+      break;
+    }
+  }
+  return result;
+}
+
+Kernels& kernels() {
+  static Kernels kernels = selectKernels();
+  return kernels;
+}
+
+}  // namespace
+
+SimdLevel batchSimdLevel() { return kernels().level; }
+
+bool setBatchSimdLevel(SimdLevel level) {
+  Kernels result{};
+  if (!makeKernels(level, &result)) {
+    return false;
+  }
+  kernels() = result;
+  return true;
+}
+
+void transformPoints(const Vector3* points, std::size_t count,
+                     const Matrix44& mat, Vector3* results) {
+  kernels().transform_aos(points, count, mat, results);
+}
+
+void transformPoints(const float* xs, const float* ys, const float* zs,
+                     std::size_t count, const Matrix44& mat, float* result_xs,
+                     float* result_ys, float* result_zs) {
+  kernels().transform_soa(xs, ys, zs, count, mat, result_xs, result_ys,
+                          result_zs);
+}
+
+void rotatePoints(const Vector3* points, std::size_t count,
+                  const Quaternion& quat, Vector3* results) {
+  kernels().transform_aos(points, count, rotationMatrix(quat), results);
+}
+
+void rotatePoints(const float* xs, const float* ys, const float* zs,
+                  std::size_t count, const Quaternion& quat, float* result_xs,
+                  float* result_ys, float* result_zs) {
+  kernels().transform_soa(xs, ys, zs, count, rotationMatrix(quat), result_xs,
+                          result_ys, result_zs);
+}
+
+void rotatePoints(const Vector3* points, const Quaternion* quats,
+                  std::size_t count, Vector3* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    auto p = WideVector3::load(points + i);
+    auto q = WideQuaternion::load(quats + i);
+    rotate(p, q).store(results + i);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = rotate(points[i], quats[i]);
+  }
+}
+
+void nlerp(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+           float t, Quaternion* results) {
+  blendQuaternions(
+      lhs, rhs, count, t, results,
+      [](const WideQuaternion& l, const WideQuaternion& r,
+         const WideFloat& t) { return nlerp(l, r, t); },
+      [](const Quaternion& l, const Quaternion& r, float t) {
+        return nlerp(l, r, t);
+      });
+}
+
+void slerp(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+           float t, Quaternion* results) {
+  // acos and sin have no wide version, so this stays scalar.
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = slerp(lhs[i], rhs[i], t);
+  }
+}
+
+void slerpFast(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+               float t, Quaternion* results) {
+  blendQuaternions(
+      lhs, rhs, count, t, results,
+      [](const WideQuaternion& l, const WideQuaternion& r,
+         const WideFloat& t) { return slerpFast(l, r, t); },
+      [](const Quaternion& l, const Quaternion& r, float t) {
+        return slerpFast(l, r, t);
+      });
+}
+
+void scaleRotationTranslation(const Vector3* scales,
+                              const Quaternion* rotations,
+                              const Vector3* translations, std::size_t count,
+                              Matrix44* results) {
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = Matrix44::scaleRotationTranslation(scales[i], rotations[i],
+                                                    translations[i]);
+  }
+}
+
+void decompose(const Matrix44* matrices, std::size_t count,
+               TransformComponents* results) {
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = decompose(matrices[i]);
+  }
+}
+
+void cullSpheres(const Frustum& frustum, const Sphere* spheres,
+                 std::size_t count, std::uint32_t* visibility) {
+  float xs[kCullChunk], ys[kCullChunk], zs[kCullChunk], radii[kCullChunk];
+  BoundsSoA bounds{xs, ys, zs, radii, nullptr, nullptr, nullptr};
+  for (std::size_t i = 0; i < count; i += kCullChunk) {
+    auto n = std::min(kCullChunk, count - i);
+    for (std::size_t j = 0; j < n; ++j) {
+      const auto& sphere = spheres[i + j];
+      xs[j] = sphere.center.x();
+      ys[j] = sphere.center.y();
+      zs[j] = sphere.center.z();
+      radii[j] = sphere.radius;
+    }
+    kernels().cull_spheres(frustum, bounds, n, visibility + i / kCullWordBits);
+  }
+}
+
+void cullSpheres(const Frustum& frustum, const float* xs, const float* ys,
+                 const float* zs, const float* radii, std::size_t count,
+                 std::uint32_t* visibility) {
+  BoundsSoA bounds{xs, ys, zs, radii, nullptr, nullptr, nullptr};
+  kernels().cull_spheres(frustum, bounds, count, visibility);
+}
+
+void cullAabbs(const Frustum& frustum, const Aabb* aabbs, std::size_t count,
+               std::uint32_t* visibility) {
+  float xs[kCullChunk], ys[kCullChunk], zs[kCullChunk];
+  float exs[kCullChunk], eys[kCullChunk], ezs[kCullChunk];
+  BoundsSoA bounds{xs, ys, zs, nullptr, exs, eys, ezs};
+  for (std::size_t i = 0; i < count; i += kCullChunk) {
+    auto n = std::min(kCullChunk, count - i);
+    for (std::size_t j = 0; j < n; ++j) {
+      const auto& aabb = aabbs[i + j];
+      auto c = center(aabb);
+      auto e = extent(aabb);
+      xs[j] = c.x(), ys[j] = c.y(), zs[j] = c.z();
+      exs[j] = e.x(), eys[j] = e.y(), ezs[j] = e.z();
+    }
+    kernels().cull_aabbs(frustum, bounds, n, visibility + i / kCullWordBits);
+  }
+}
+
+void cullAabbs(const Frustum& frustum, const float* center_xs,
+               const float* center_ys, const float* center_zs,
+               const float* extent_xs, const float* extent_ys,
+               const float* extent_zs, std::size_t count,
+               std::uint32_t* visibility) {
+  BoundsSoA bounds{center_xs, center_ys, center_zs, nullptr,
+                   extent_xs, extent_ys, extent_zs};
+  kernels().cull_aabbs(frustum, bounds, count, visibility);
+}
+
+}  // namespace math
+}  // namespace temp
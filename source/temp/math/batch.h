@@ -0,0 +1,197 @@
+﻿/**
+ * @file batch.h
+ * @brief Batched transform and culling kernels for bulk processing
+ *
+ * The kernels pick the widest instruction set available on the running CPU
+ * (AVX-512, AVX2, then the compile time 4-wide backend of simd.h).
+ * Input and output may be the same array.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "temp/math/bounds.h"
+#include "temp/math/matrix44.h"
+#include "temp/math/matrix44_functions.h"
+#include "temp/math/quaternion.h"
+#include "temp/math/quaternion_functions.h"
+#include "temp/math/vector3.h"
+
+namespace temp {
+namespace math {
+
+enum class SimdLevel {
+  kScalar,
+  kFloat4,
+  kAvx2,
+  kAvx512,
+};
+
+/**
+ * @brief Get the instruction set used by the batch kernels
+ *
+ * @return SimdLevel
+ */
+SimdLevel batchSimdLevel();
+
+/**
+ * @brief Make the batch kernels use the given instruction set
+ *
+ * Meant for testing and benchmarking the kernels against each other.
+ * kScalar is only available in builds without a SIMD backend, where kFloat4
+ * is not. Must not be called while kernels run on other threads.
+ *
+ * @param level instruction set to use
+ * @return false if the build or the running CPU does not support level
+ */
+bool setBatchSimdLevel(SimdLevel level);
+
+/**
+ * @brief Transform points (w = 1) by matrix
+ *
+ * @param points source points
+ * @param count count of points
+ * @param mat transform matrix
+ * @param results destination of transformed points
+ */
+void transformPoints(const Vector3* points, std::size_t count,
+                     const Matrix44& mat, Vector3* results);
+
+/**
+ * @brief Transform points stored as separate x, y and z arrays
+ */
+void transformPoints(const float* xs, const float* ys, const float* zs,
+                     std::size_t count, const Matrix44& mat, float* result_xs,
+                     float* result_ys, float* result_zs);
+
+/**
+ * @brief Rotate points by quaternion
+ *
+ * @param points source points
+ * @param count count of points
+ * @param quat rotation
+ * @param results destination of rotated points
+ */
+void rotatePoints(const Vector3* points, std::size_t count,
+                  const Quaternion& quat, Vector3* results);
+
+/**
+ * @brief Rotate points stored as separate x, y and z arrays
+ */
+void rotatePoints(const float* xs, const float* ys, const float* zs,
+                  std::size_t count, const Quaternion& quat, float* result_xs,
+                  float* result_ys, float* result_zs);
+
+/**
+ * @brief Rotate each point by its own quaternion
+ *
+ * @param points source points
+ * @param quats rotations, one per point
+ * @param count count of points
+ * @param results destination of rotated points
+ */
+void rotatePoints(const Vector3* points, const Quaternion* quats,
+                  std::size_t count, Vector3* results);
+
+/**
+ * @brief nlerp between two arrays of quaternions with a common weight
+ *
+ * Unlike the point kernels these use the wide types of wide.h, so the lane
+ * count is fixed at compile time.
+ *
+ * @param lhs quaternions at t = 0
+ * @param rhs quaternions at t = 1
+ * @param count count of quaternions
+ * @param t interpolation weight
+ * @param results destination of interpolated quaternions
+ */
+void nlerp(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+           float t, Quaternion* results);
+
+/**
+ * @brief slerp between two arrays of quaternions with a common weight
+ */
+void slerp(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+           float t, Quaternion* results);
+
+/**
+ * @brief slerpFast between two arrays of quaternions with a common weight
+ */
+void slerpFast(const Quaternion* lhs, const Quaternion* rhs, std::size_t count,
+               float t, Quaternion* results);
+
+/**
+ * @brief Build matrices from arrays of scale, rotation and translation
+ *
+ * Each result is the same as Matrix44::scaleRotationTranslation.
+ *
+ * @param scales source scales
+ * @param rotations source rotations
+ * @param translations source translations
+ * @param count count of transforms
+ * @param results destination of matrices
+ */
+void scaleRotationTranslation(const Vector3* scales,
+                              const Quaternion* rotations,
+                              const Vector3* translations, std::size_t count,
+                              Matrix44* results);
+
+/**
+ * @brief Decompose matrices into scale, rotation and translation
+ *
+ * @param matrices source matrices
+ * @param count count of matrices
+ * @param results destination of components, see decompose(Matrix44)
+ */
+void decompose(const Matrix44* matrices, std::size_t count,
+               TransformComponents* results);
+
+/**
+ * @brief Test spheres against frustum
+ *
+ * Bit (i % 32) of visibility[i / 32] is set when sphere i passes
+ * intersects(Frustum, Sphere). (count + 31) / 32 words are written and the
+ * unused bits of the last word are cleared.
+ *
+ * @param frustum frustum with normalized planes, see extractFrustum
+ * @param spheres source spheres
+ * @param count count of spheres
+ * @param visibility destination of visibility bits
+ */
+void cullSpheres(const Frustum& frustum, const Sphere* spheres,
+                 std::size_t count, std::uint32_t* visibility);
+
+/**
+ * @brief Test spheres stored as separate center and radius arrays
+ *
+ * This layout is the fastest one, the others are converted to it.
+ */
+void cullSpheres(const Frustum& frustum, const float* xs, const float* ys,
+                 const float* zs, const float* radii, std::size_t count,
+                 std::uint32_t* visibility);
+
+/**
+ * @brief Test boxes against frustum
+ *
+ * The bit layout is the same as cullSpheres.
+ *
+ * @param frustum frustum with normalized planes, see extractFrustum
+ * @param aabbs source boxes
+ * @param count count of boxes
+ * @param visibility destination of visibility bits
+ */
+void cullAabbs(const Frustum& frustum, const Aabb* aabbs, std::size_t count,
+               std::uint32_t* visibility);
+
+/**
+ * @brief Test boxes stored as separate center and half size arrays
+ */
+void cullAabbs(const Frustum& frustum, const float* center_xs,
+               const float* center_ys, const float* center_zs,
+               const float* extent_xs, const float* extent_ys,
+               const float* extent_zs, std::size_t count,
+               std::uint32_t* visibility);
+
+}  // namespace math
+}  // namespace temp
@@ -0,0 +1,134 @@
+﻿/**
+ * @file bounds.h
+ * @brief Bounding volumes and planes for culling and spatial queries
+ */
+#pragma once
+
+#include <array>
+#include <sstream>
+#include <string>
+
+#include "temp/math/vector3.h"
+#include "temp/math/vector3_functions.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+/**
+ * @brief Axis aligned bounding box
+ */
+template <class T>
+struct AabbBase {
+  Vector3Base<T> min;
+  Vector3Base<T> max;
+
+  /**
+   * @brief Make box from center and half size
+   */
+  static constexpr AabbBase fromCenterExtent(const Vector3Base<T>& center,
+                                             const Vector3Base<T>& extent);
+
+  std::string toString() const;
+};
+
+/**
+ * @brief Bounding sphere
+ */
+template <class T>
+struct SphereBase {
+  Vector3Base<T> center;
+  T radius;
+
+  std::string toString() const;
+};
+
+/**
+ * @brief Plane of points p where dot(normal, p) + distance == 0
+ *
+ * The side the normal points to is positive (inside).
+ */
+template <class T>
+struct PlaneBase {
+  Vector3Base<T> normal;
+  T distance;
+
+  std::string toString() const;
+};
+
+/**
+ * @brief Half line from origin along direction
+ *
+ * Distances along the ray are measured in units of direction, so they are
+ * world distances when direction is normalized.
+ */
+template <class T>
+struct RayBase {
+  Vector3Base<T> origin;
+  Vector3Base<T> direction;
+};
+
+/**
+ * @brief Six planes whose normals point into the view volume
+ */
+template <class T>
+struct FrustumBase {
+  enum PlaneIndex {
+    kLeft,
+    kRight,
+    kBottom,
+    kTop,
+    kNear,
+    kFar,
+    kPlaneCount,
+  };
+
+  std::array<PlaneBase<T>, kPlaneCount> planes;
+};
+
+using Aabb = AabbBase<float>;
+using Aabb_64b = AabbBase<double>;
+using Sphere = SphereBase<float>;
+using Sphere_64b = SphereBase<double>;
+using Plane = PlaneBase<float>;
+using Plane_64b = PlaneBase<double>;
+using Ray = RayBase<float>;
+using Ray_64b = RayBase<double>;
+using Frustum = FrustumBase<float>;
+using Frustum_64b = FrustumBase<double>;
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T>
+constexpr AabbBase<T> AabbBase<T>::fromCenterExtent(
+    const Vector3Base<T>& center, const Vector3Base<T>& extent) {
+  return AabbBase<T>{center - extent, center + extent};
+}
+
+template <class T>
+std::string AabbBase<T>::toString() const {
+  std::stringstream ss;
+  ss << "Aabb(" << min.toString() << ", " << max.toString() << ")";
+  return ss.str();
+}
+
+template <class T>
+std::string SphereBase<T>::toString() const {
+  std::stringstream ss;
+  ss << "Sphere(" << center.toString() << ", " << radius << ")";
+  return ss.str();
+}
+
+template <class T>
+std::string PlaneBase<T>::toString() const {
+  std::stringstream ss;
+  ss << "Plane(" << normal.toString() << ", " << distance << ")";
+  return ss.str();
+}
+
+}  // namespace math
+}  // namespace temp
@@ -0,0 +1,337 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "temp/math/bounds.h"
+#include "temp/math/matrix44.h"
+#include "temp/math/matrix44_functions.h"
+#include "temp/math/vector3_functions.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const AabbBase<T>& aabb);
+
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const SphereBase<T>& sphere);
+
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const PlaneBase<T>& plane);
+
+/**
+ * @brief Scale plane so that its normal has unit length
+ *
+ * A plane with zero normal is returned as is.
+ */
+template <class T>
+PlaneBase<T> normalize(const PlaneBase<T>& plane);
+
+/**
+ * @brief Signed distance from plane, positive on the normal side
+ *
+ * The result is scaled by the normal length unless the plane is normalized.
+ */
+template <class T>
+constexpr T signedDistance(const PlaneBase<T>& plane,
+                           const Vector3Base<T>& point);
+
+template <class T>
+constexpr Vector3Base<T> center(const AabbBase<T>& aabb);
+
+/**
+ * @brief Half size of box
+ */
+template <class T>
+constexpr Vector3Base<T> extent(const AabbBase<T>& aabb);
+
+/**
+ * @brief Surface area of box, the cost metric of SAH
+ */
+template <class T>
+constexpr T surfaceArea(const AabbBase<T>& aabb);
+
+/**
+ * @brief Smallest box containing both boxes
+ */
+template <class T>
+constexpr AabbBase<T> merge(const AabbBase<T>& lhs, const AabbBase<T>& rhs);
+
+template <class T>
+constexpr bool contains(const AabbBase<T>& aabb, const Vector3Base<T>& point);
+
+template <class T>
+constexpr bool intersects(const AabbBase<T>& lhs, const AabbBase<T>& rhs);
+
+template <class T>
+constexpr bool intersects(const SphereBase<T>& lhs, const SphereBase<T>& rhs);
+
+template <class T>
+constexpr bool intersects(const AabbBase<T>& aabb,
+                          const SphereBase<T>& sphere);
+
+/**
+ * @brief Distance along ray to where it enters box
+ *
+ * @return T 0 when origin is inside, infinity when the ray misses
+ */
+template <class T>
+T intersectDistance(const RayBase<T>& ray, const AabbBase<T>& aabb);
+
+/**
+ * @brief Distance along ray to where it enters sphere
+ *
+ * @return T 0 when origin is inside, infinity when the ray misses
+ */
+template <class T>
+T intersectDistance(const RayBase<T>& ray, const SphereBase<T>& sphere);
+
+/**
+ * @brief Box that bounds the transformed box
+ *
+ * @param aabb source box
+ * @param mat affine matrix whose last row is (0, 0, 0, 1)
+ * @return AabbBase<T>
+ */
+template <class T>
+AabbBase<T> transform(const AabbBase<T>& aabb, const Matrix44Base<T>& mat);
+
+/**
+ * @brief Extract frustum planes from view projection matrix
+ *
+ * Expects clip space depth in [0, w] (Vulkan/Direct3D), which also holds
+ * for reversed depth. The planes are normalized; a degenerate plane (the far
+ * plane of an infinite projection) is kept as zero so it never culls.
+ *
+ * @param view_proj projection * view, transforming column vectors
+ * @return FrustumBase<T>
+ */
+template <class T>
+FrustumBase<T> extractFrustum(const Matrix44Base<T>& view_proj);
+
+/**
+ * @brief Conservative sphere visibility test
+ *
+ * @return false Sphere is entirely outside one of the planes
+ */
+template <class T>
+constexpr bool intersects(const FrustumBase<T>& frustum,
+                          const SphereBase<T>& sphere);
+
+/**
+ * @brief Conservative box visibility test
+ *
+ * @return false Box is entirely outside one of the planes
+ */
+template <class T>
+constexpr bool intersects(const FrustumBase<T>& frustum,
+                          const AabbBase<T>& aabb);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const AabbBase<T>& aabb) {
+  stream << aabb.toString();
+  return stream;
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const SphereBase<T>& sphere) {
+  stream << sphere.toString();
+  return stream;
+}
+
+template <class T>
+std::ostream& operator<<(std::ostream& stream, const PlaneBase<T>& plane) {
+  stream << plane.toString();
+  return stream;
+}
+
+template <class T>
+PlaneBase<T> normalize(const PlaneBase<T>& plane) {
+  T length = std::sqrt(squared_magnitude(plane.normal));
+  if (length == 0) {
+    return plane;
+  }
+  T inv_length = 1 / length;
+  return PlaneBase<T>{plane.normal * inv_length, plane.distance * inv_length};
+}
+
+template <class T>
+constexpr T signedDistance(const PlaneBase<T>& plane,
+                           const Vector3Base<T>& point) {
+  return dot(plane.normal, point) + plane.distance;
+}
+
+template <class T>
+constexpr Vector3Base<T> center(const AabbBase<T>& aabb) {
+  return (aabb.min + aabb.max) * 0.5f;
+}
+
+template <class T>
+constexpr Vector3Base<T> extent(const AabbBase<T>& aabb) {
+  return (aabb.max - aabb.min) * 0.5f;
+}
+
+template <class T>
+constexpr T surfaceArea(const AabbBase<T>& aabb) {
+  auto d = aabb.max - aabb.min;
+  return 2 * (d.x() * d.y() + d.y() * d.z() + d.z() * d.x());
+}
+
+template <class T>
+constexpr AabbBase<T> merge(const AabbBase<T>& lhs, const AabbBase<T>& rhs) {
+  return AabbBase<T>{Vector3Base<T>(std::min(lhs.min.x(), rhs.min.x()),
+                                    std::min(lhs.min.y(), rhs.min.y()),
+                                    std::min(lhs.min.z(), rhs.min.z())),
+                     Vector3Base<T>(std::max(lhs.max.x(), rhs.max.x()),
+                                    std::max(lhs.max.y(), rhs.max.y()),
+                                    std::max(lhs.max.z(), rhs.max.z()))};
+}
+
+template <class T>
+constexpr bool contains(const AabbBase<T>& aabb, const Vector3Base<T>& point) {
+  return aabb.min.x() <= point.x() && point.x() <= aabb.max.x() &&
+         aabb.min.y() <= point.y() && point.y() <= aabb.max.y() &&
+         aabb.min.z() <= point.z() && point.z() <= aabb.max.z();
+}
+
+template <class T>
+constexpr bool intersects(const AabbBase<T>& lhs, const AabbBase<T>& rhs) {
+  return lhs.min.x() <= rhs.max.x() && rhs.min.x() <= lhs.max.x() &&
+         lhs.min.y() <= rhs.max.y() && rhs.min.y() <= lhs.max.y() &&
+         lhs.min.z() <= rhs.max.z() && rhs.min.z() <= lhs.max.z();
+}
+
+template <class T>
+constexpr bool intersects(const SphereBase<T>& lhs, const SphereBase<T>& rhs) {
+  T r = lhs.radius + rhs.radius;
+  return squared_magnitude(lhs.center - rhs.center) <= r * r;
+}
+
+template <class T>
+constexpr bool intersects(const AabbBase<T>& aabb,
+                          const SphereBase<T>& sphere) {
+  // 箱の中で球の中心に最も近い点との距離
+  T d = 0;
+  for (int i = 0; i < 3; ++i) {
+    T c = sphere.center[i];
+    T v = c < aabb.min[i] ? aabb.min[i] - c
+                          : (c > aabb.max[i] ? c - aabb.max[i] : 0);
+    d += v * v;
+  }
+  return d <= sphere.radius * sphere.radius;
+}
+
+template <class T>
+T intersectDistance(const RayBase<T>& ray, const AabbBase<T>& aabb) {
+  // スラブ法: 各軸の2平面の間にいる区間の共通部分をとる
+  T t_min = 0;
+  T t_max = std::numeric_limits<T>::infinity();
+  for (int i = 0; i < 3; ++i) {
+    T o = ray.origin[i];
+    T d = ray.direction[i];
+    if (d == 0) {
+      if (o < aabb.min[i] || o > aabb.max[i]) {
+        return std::numeric_limits<T>::infinity();
+      }
+      continue;
+    }
+    T inv_d = 1 / d;
+    T t0 = (aabb.min[i] - o) * inv_d;
+    T t1 = (aabb.max[i] - o) * inv_d;
+    t_min = std::max(t_min, std::min(t0, t1));
+    t_max = std::min(t_max, std::max(t0, t1));
+  }
+  return t_min <= t_max ? t_min : std::numeric_limits<T>::infinity();
+}
+
+template <class T>
+T intersectDistance(const RayBase<T>& ray, const SphereBase<T>& sphere) {
+  auto m = ray.origin - sphere.center;
+  T c = squared_magnitude(m) - sphere.radius * sphere.radius;
+  if (c <= 0) {
+    return 0;
+  }
+  T a = squared_magnitude(ray.direction);
+  T b = dot(m, ray.direction);
+  T discriminant = b * b - a * c;
+  if (b >= 0 || discriminant < 0 || a == 0) {
+    return std::numeric_limits<T>::infinity();
+  }
+  return (-b - std::sqrt(discriminant)) / a;
+}
+
+template <class T>
+AabbBase<T> transform(const AabbBase<T>& aabb, const Matrix44Base<T>& mat) {
+  // 中心を変換し、半径は行列の絶対値で広げる
+  auto c = center(aabb);
+  auto e = extent(aabb);
+  Vector3Base<T> new_center;
+  Vector3Base<T> new_extent;
+  for (int r = 0; r < 3; ++r) {
+    new_center[r] = mat[r][0] * c.x() + mat[r][1] * c.y() +
+                    mat[r][2] * c.z() + mat[r][3];
+    new_extent[r] = std::abs(mat[r][0]) * e.x() + std::abs(mat[r][1]) * e.y() +
+                    std::abs(mat[r][2]) * e.z();
+  }
+  return AabbBase<T>{new_center - new_extent, new_center + new_extent};
+}
+
+template <class T>
+FrustumBase<T> extractFrustum(const Matrix44Base<T>& view_proj) {
+  // クリップ座標 (x, y, z, w) が -w <= x, y <= w, 0 <= z <= w を満たす範囲
+  auto plane = [](const Vector4Base<T>& row) {
+    return normalize(PlaneBase<T>{Vector3Base<T>(row.x(), row.y(), row.z()),
+                                  row.w()});
+  };
+  const auto& m = view_proj;
+  FrustumBase<T> frustum;
+  frustum.planes[FrustumBase<T>::kLeft] = plane(m[3] + m[0]);
+  frustum.planes[FrustumBase<T>::kRight] = plane(m[3] - m[0]);
+  frustum.planes[FrustumBase<T>::kBottom] = plane(m[3] + m[1]);
+  frustum.planes[FrustumBase<T>::kTop] = plane(m[3] - m[1]);
+  frustum.planes[FrustumBase<T>::kNear] = plane(m[2]);
+  frustum.planes[FrustumBase<T>::kFar] = plane(m[3] - m[2]);
+  return frustum;
+}
+
+template <class T>
+constexpr bool intersects(const FrustumBase<T>& frustum,
+                          const SphereBase<T>& sphere) {
+  for (const auto& plane : frustum.planes) {
+    if (signedDistance(plane, sphere.center) < -sphere.radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T>
+constexpr bool intersects(const FrustumBase<T>& frustum,
+                          const AabbBase<T>& aabb) {
+  auto c = center(aabb);
+  auto e = extent(aabb);
+  for (const auto& plane : frustum.planes) {
+    // 法線方向への箱の半径
+    const auto& n = plane.normal;
+    T r = (n.x() < 0 ? -n.x() : n.x()) * e.x() +
+          (n.y() < 0 ? -n.y() : n.y()) * e.y() +
+          (n.z() < 0 ? -n.z() : n.z()) * e.z();
+    if (signedDistance(plane, c) < -r) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace math
+}  // namespace temp
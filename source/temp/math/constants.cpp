@@ -1,19 +0,0 @@
-﻿#include "temp/math/constants.h"
-
-namespace temp {
-namespace math {
-
-const float kPi = ConstantsBase<float>::kPi;
-const float kPi_2 = ConstantsBase<float>::kPi_2;
-const float kPi_4 = ConstantsBase<float>::kPi_4;
-const float k_1_Pi = ConstantsBase<float>::k_1_Pi;
-const float k_2_Pi = ConstantsBase<float>::k_1_Pi;
-
-const double kPi_64b = ConstantsBase<float>::kPi;
-const double kPi_2_64b = ConstantsBase<double>::kPi_2;
-const double kPi_4_64b = ConstantsBase<double>::kPi_4;
-const double k_1_Pi_64b = ConstantsBase<double>::k_1_Pi;
-const double k_2_Pi_64b = ConstantsBase<double>::k_2_Pi;
-
-}
-}
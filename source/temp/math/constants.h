@@ -15,19 +15,21 @@ class ConstantsBase {
   static constexpr T kPi_4 = (T)M_PI_4;
   static constexpr T k_1_Pi = (T)M_1_PI;
   static constexpr T k_2_Pi = (T)M_2_PI;
+  static constexpr T kDegToRad = (T)(M_PI / 180.0);
+  static constexpr T kRadToDeg = (T)(180.0 / M_PI);
 };
 
-extern const float kPi;
-extern const float kPi_2;
-extern const float kPi_4;
-extern const float k_1_Pi;
-extern const float k_2_Pi;
+inline constexpr float kPi = ConstantsBase<float>::kPi;
+inline constexpr float kPi_2 = ConstantsBase<float>::kPi_2;
+inline constexpr float kPi_4 = ConstantsBase<float>::kPi_4;
+inline constexpr float k_1_Pi = ConstantsBase<float>::k_1_Pi;
+inline constexpr float k_2_Pi = ConstantsBase<float>::k_2_Pi;
 
-extern const double kPi_64b;
-extern const double kPi_2_64b;
-extern const double kPi_4_64b;
-extern const double k_1_Pi_64b;
-extern const double k_2_Pi_64b;
+inline constexpr double kPi_64b = ConstantsBase<double>::kPi;
+inline constexpr double kPi_2_64b = ConstantsBase<double>::kPi_2;
+inline constexpr double kPi_4_64b = ConstantsBase<double>::kPi_4;
+inline constexpr double k_1_Pi_64b = ConstantsBase<double>::k_1_Pi;
+inline constexpr double k_2_Pi_64b = ConstantsBase<double>::k_2_Pi;
 
 }  // namespace math
 }  // namespace temp
\ No newline at end of file
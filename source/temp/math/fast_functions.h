@@ -0,0 +1,293 @@
+﻿/**
+ * @file fast_functions.h
+ * @brief Polynomial approximations of transcendental functions
+ *
+ * The functions in temp::math::fast take float or Wide<float, N> and trade
+ * accuracy for speed: there is no errno, no special handling of NaN and
+ * infinity, and the domain is limited as documented on each function.
+ * The max errors are measured against double precision <cmath> by the
+ * "fast_" test suite.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "temp/math/simd.h"
+#include "temp/math/wide.h"
+
+namespace temp {
+namespace math {
+namespace fast {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+/**
+ * @brief Sine, absolute error below 2e-7 for |x| <= 8192
+ */
+template <class T>
+T sin(const T& x);
+
+/**
+ * @brief Cosine, absolute error below 2e-7 for |x| <= 8192
+ */
+template <class T>
+T cos(const T& x);
+
+/**
+ * @brief sin(x) and cos(x) sharing the range reduction
+ */
+template <class T>
+void sincos(const T& x, T* s, T* c);
+
+/**
+ * @brief Angle of (x, y) in [-pi, pi], absolute error below 1e-5
+ *
+ * atan2(0, 0) is 0.
+ */
+template <class T>
+T atan2(const T& y, const T& x);
+
+/**
+ * @brief Arc cosine for x in [-1, 1], absolute error below 5e-7
+ */
+template <class T>
+T acos(const T& x);
+
+/**
+ * @brief 1 / sqrt(x) for positive normal x, relative error below 5e-7
+ */
+template <class T>
+T rsqrt(const T& x);
+
+/**
+ * @brief e^x, relative error below 4e-7
+ *
+ * x is clamped to [-87.3, 88.3] so the result is always a normal number.
+ */
+template <class T>
+T exp(const T& x);
+
+/**
+ * @brief Natural logarithm for positive normal x, error below 3e-7
+ *
+ * The error is absolute for results in [-1, 1] and relative elsewhere.
+ */
+template <class T>
+T log(const T& x);
+
+// Lane operations of Wide (wide.h) for float, so that the functions above
+// accept both.
+float select(bool mask, float a, float b);
+float madd(float a, float b, float c);
+float min(float a, float b);
+float max(float a, float b);
+float sqrt(float v);
+float abs(float v);
+float round(float v);
+float ldexp(float v, float e);
+float exponent(float v);
+float mantissa(float v);
+float rsqrtEstimate(float v);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+inline float select(bool mask, float a, float b) {
+  // 条件分岐にすると予測が外れやすいので、ビット演算で選ぶ
+  std::uint32_t bits_a, bits_b;
+  std::memcpy(&bits_a, &a, sizeof(bits_a));
+  std::memcpy(&bits_b, &b, sizeof(bits_b));
+  auto m = 0u - static_cast<std::uint32_t>(mask);
+  auto bits = (bits_a & m) | (bits_b & ~m);
+  float r;
+  std::memcpy(&r, &bits, sizeof(r));
+  return r;
+}
+
+inline float madd(float a, float b, float c) { return a * b + c; }
+
+inline float min(float a, float b) { return a < b ? a : b; }
+
+inline float max(float a, float b) { return a < b ? b : a; }
+
+inline float sqrt(float v) { return std::sqrt(v); }
+
+inline float abs(float v) { return std::abs(v); }
+
+inline float round(float v) {
+#if defined(TEMP_MATH_SIMD_SSE)
+  return static_cast<float>(_mm_cvt_ss2si(_mm_set_ss(v)));
+#else
+  // 1.5 * 2^23 を足すと小数部が丸めで落ちる (|v| < 2^22)
+  const float kMagic = 12582912.0f;
+  return (v + kMagic) - kMagic;
+#endif
+}
+
+inline float ldexp(float v, float e) {
+  auto bits = static_cast<std::uint32_t>(static_cast<std::int32_t>(e) + 127)
+              << 23;
+  float scale;
+  std::memcpy(&scale, &bits, sizeof(scale));
+  return v * scale;
+}
+
+inline float exponent(float v) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return static_cast<float>(static_cast<std::int32_t>((bits >> 23) & 0xff) -
+                            127);
+}
+
+inline float mantissa(float v) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  bits = (bits & 0x007fffff) | 0x3f800000;
+  float m;
+  std::memcpy(&m, &bits, sizeof(m));
+  return m;
+}
+
+inline float rsqrtEstimate(float v) {
+#if defined(TEMP_MATH_SIMD_SSE)
+  return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(v)));
+#else
+  return 1.0f / std::sqrt(v);
+#endif
+}
+
+template <class T>
+T sin(const T& x) {
+  T s, c;
+  sincos(x, &s, &c);
+  return s;
+}
+
+template <class T>
+T cos(const T& x) {
+  T s, c;
+  sincos(x, &s, &c);
+  return c;
+}
+
+template <class T>
+void sincos(const T& x, T* s, T* c) {
+  // x = k * pi/2 + r, |r| <= pi/4。pi/2 を3つに分けて誤差なく引く (Cody-Waite)
+  T k = round(x * T(0.63661977236758134f));
+  T r = madd(k, T(-1.5703125f), x);
+  r = madd(k, T(-4.8375129699707031e-4f), r);
+  r = madd(k, T(-7.5497899548918822e-8f), r);
+
+  // Cephes sinf/cosf の多項式
+  T r2 = r * r;
+  T sp = madd(r2, T(-1.9515295891e-4f), T(8.3321608736e-3f));
+  sp = madd(r2, sp, T(-1.6666654611e-1f));
+  sp = madd(r2 * r, sp, r);
+  T cp = madd(r2, T(2.443315711809948e-5f), T(-1.388731625493765e-3f));
+  cp = madd(r2, cp, T(4.166664568298827e-2f));
+  cp = madd(r2 * r2, cp, madd(r2, T(-0.5f), T(1.0f)));
+
+  // k mod 4 で象限を選ぶ
+  T q = k - T(4.0f) * round(madd(k, T(0.25f), T(-0.375f)));
+  auto odd = (q == T(1.0f)) | (q == T(3.0f));
+  auto sin_negative = q >= T(2.0f);
+  auto cos_negative = (q == T(1.0f)) | (q == T(2.0f));
+  T sv = select(odd, cp, sp);
+  T cv = select(odd, sp, cp);
+  *s = select(sin_negative, -sv, sv);
+  *c = select(cos_negative, -cv, cv);
+}
+
+template <class T>
+T atan2(const T& y, const T& x) {
+  T ax = abs(x);
+  T ay = abs(y);
+  T mn = min(ax, ay);
+  T mx = max(ax, ay);
+  // (0, 0) は 0/0 になるので 0 に置き換える
+  T t = select(mx == T(0.0f), T(0.0f), mn / mx);
+
+  // [0, 1] での atan のミニマックス近似
+  T t2 = t * t;
+  T p = madd(t2, T(-0.01172120f), T(0.05265332f));
+  p = madd(t2, p, T(-0.11643287f));
+  p = madd(t2, p, T(0.19354346f));
+  p = madd(t2, p, T(-0.33262347f));
+  p = madd(t2, p, T(0.99997726f));
+  T a = p * t;
+
+  a = select(ay > ax, T(1.57079637f) - a, a);
+  a = select(x < T(0.0f), T(3.14159274f) - a, a);
+  return select(y < T(0.0f), -a, a);
+}
+
+template <class T>
+T acos(const T& x) {
+  // Abramowitz and Stegun 4.4.46
+  T ax = abs(x);
+  T p = madd(ax, T(-0.0012624911f), T(0.0066700901f));
+  p = madd(ax, p, T(-0.0170881256f));
+  p = madd(ax, p, T(0.0308918810f));
+  p = madd(ax, p, T(-0.0501743046f));
+  p = madd(ax, p, T(0.0889789874f));
+  p = madd(ax, p, T(-0.2145988016f));
+  p = madd(ax, p, T(1.5707963050f));
+  T a = p * sqrt(max(T(1.0f) - ax, T(0.0f)));
+  return select(x < T(0.0f), T(3.14159274f) - a, a);
+}
+
+template <class T>
+T rsqrt(const T& x) {
+  // 推定値をニュートン法で1回改善する
+  T e = rsqrtEstimate(x);
+  return e * madd(x * T(-0.5f), e * e, T(1.5f));
+}
+
+template <class T>
+T exp(const T& x) {
+  // e^x = 2^k * e^r, |r| <= ln2/2
+  T v = min(max(x, T(-87.3f)), T(88.3f));
+  T k = round(v * T(1.44269504088896341f));
+  T r = madd(k, T(-0.693359375f), v);
+  r = madd(k, T(2.12194440e-4f), r);
+
+  // Cephes expf の多項式
+  T p = madd(r, T(1.9875691500e-4f), T(1.3981999507e-3f));
+  p = madd(r, p, T(8.3334519073e-3f));
+  p = madd(r, p, T(4.1665795894e-2f));
+  p = madd(r, p, T(1.6666665459e-1f));
+  p = madd(r, p, T(5.0000001201e-1f));
+  p = madd(r * r, p, r + T(1.0f));
+  return ldexp(p, k);
+}
+
+template <class T>
+T log(const T& x) {
+  // x = 2^e * m, m in [sqrt(1/2), sqrt(2))
+  T e = exponent(x);
+  T m = mantissa(x);
+  auto large = m > T(1.41421356f);
+  e = select(large, e + T(1.0f), e);
+  T f = select(large, m * T(0.5f), m) - T(1.0f);
+
+  // Cephes logf の多項式
+  T z = f * f;
+  T p = madd(f, T(7.0376836292e-2f), T(-1.1514610310e-1f));
+  p = madd(f, p, T(1.1676998740e-1f));
+  p = madd(f, p, T(-1.2420140846e-1f));
+  p = madd(f, p, T(1.4249322787e-1f));
+  p = madd(f, p, T(-1.6668057665e-1f));
+  p = madd(f, p, T(2.0000714765e-1f));
+  p = madd(f, p, T(-2.4999993993e-1f));
+  p = madd(f, p, T(3.3333331174e-1f));
+  T y = madd(e, T(-2.12194440e-4f), p * f * z);
+  y = madd(z, T(-0.5f), y);
+  return madd(e, T(0.693359375f), f + y);
+}
+
+}  // namespace fast
+}  // namespace math
+}  // namespace temp
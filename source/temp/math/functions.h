@@ -19,7 +19,7 @@ namespace math {
  * @return false The difference between lhs and rhs is larger than epsilon
  */
 template <class T>
-bool approximately(T lhs, T rhs);
+constexpr bool approximately(T lhs, T rhs);
 
 /**
  * @brief Convert radian to degree
@@ -29,7 +29,7 @@ bool approximately(T lhs, T rhs);
  * @return T
  */
 template <class T>
-T radianToDegree(T radian);
+constexpr T radianToDegree(T radian);
 
 /**
  * @brief Convart degree to radian
@@ -39,26 +39,26 @@ T radianToDegree(T radian);
  * @return T
  */
 template <class T>
-T degreeToRadian(T degree);
+constexpr T degreeToRadian(T degree);
 
 //----------------------------------------
 // implementation
 //----------------------------------------
 template <class T>
-bool approximately(T lhs, T rhs) {
-  return std::abs(lhs - rhs) <= std::numeric_limits<T>::epsilon();
+constexpr bool approximately(T lhs, T rhs) {
+  // std::absはconstexprではないので自前で絶対値をとる
+  T diff = lhs < rhs ? rhs - lhs : lhs - rhs;
+  return diff <= std::numeric_limits<T>::epsilon();
 }
 
 template <class T>
-T radianToDegree(T radian) {
-  static const T rad2deg = (T)180 / ConstantsBase<T>::kPi;
-  return rad2deg * radian;
+constexpr T radianToDegree(T radian) {
+  return ConstantsBase<T>::kRadToDeg * radian;
 }
 
 template <class T>
-T degreeToRadian(T degree) {
-  static const T deg2rad = ConstantsBase<T>::kPi / (T)180;
-  return deg2rad * degree;
+constexpr T degreeToRadian(T degree) {
+  return ConstantsBase<T>::kDegToRad * degree;
 }
 
 }  // namespace math
@@ -25,6 +25,7 @@
 
 #include "temp/math/constants.h"
 #include "temp/math/quaternion.h"
+#include "temp/math/simd.h"
 #include "temp/math/vector3.h"
 #include "temp/math/vector4.h"
 
@@ -59,15 +60,16 @@ class Matrix44Base {
    * @param translation
    * @return Matrix44Base
    */
-  static Matrix44Base scaleRotationTranslation(  //
+  static constexpr Matrix44Base scaleRotationTranslation(  //
       const Vector3Base<T>& scale,               //
       const QuaternionBase<T>& rotation,         //
       const Vector3Base<T>& translation);
 
  public:
-  Matrix44Base();
-  explicit Matrix44Base(RowType row0, RowType row1, RowType row2, RowType row3);
-  explicit Matrix44Base(T _00, T _01, T _02, T _03,  //
+  constexpr Matrix44Base();
+  constexpr explicit Matrix44Base(RowType row0, RowType row1, RowType row2,
+                                  RowType row3);
+  constexpr explicit Matrix44Base(T _00, T _01, T _02, T _03,  //
                         T _10, T _11, T _12, T _13,  //
                         T _20, T _21, T _22, T _23,  //
                         T _30, T _31, T _32, T _33);
@@ -82,23 +84,23 @@ class Matrix44Base {
 
   std::string toString() const;
 
-  RowType& operator[](std::size_t index);
-  const RowType& operator[](std::size_t index) const;
+  constexpr RowType& operator[](std::size_t index);
+  constexpr const RowType& operator[](std::size_t index) const;
 
-  RowType row(std::size_t index) const;
-  ColType col(std::size_t index) const;
+  constexpr RowType row(std::size_t index) const;
+  constexpr ColType col(std::size_t index) const;
 
-  bool operator==(const Matrix44Base& rhs) const;
-  bool operator!=(const Matrix44Base& rhs) const;
+  constexpr bool operator==(const Matrix44Base& rhs) const;
+  constexpr bool operator!=(const Matrix44Base& rhs) const;
 
-  Matrix44Base operator+() const;
-  Matrix44Base operator-() const;
+  constexpr Matrix44Base operator+() const;
+  constexpr Matrix44Base operator-() const;
 
-  Matrix44Base& operator+=(const Matrix44Base& rhs);
-  Matrix44Base& operator-=(const Matrix44Base& rhs);
-  Matrix44Base& operator*=(float rhs);
-  Matrix44Base& operator*=(const Matrix44Base rhs);
-  Matrix44Base& operator/=(float rhs);
+  constexpr Matrix44Base& operator+=(const Matrix44Base& rhs);
+  constexpr Matrix44Base& operator-=(const Matrix44Base& rhs);
+  constexpr Matrix44Base& operator*=(float rhs);
+  constexpr Matrix44Base& operator*=(const Matrix44Base rhs);
+  constexpr Matrix44Base& operator/=(float rhs);
 
  private:
   std::array<Vector4Base<T>, kRows> rows_;
@@ -111,16 +113,10 @@ using Matrix44_64bit = Matrix44Base<double>;
 // implementation
 //----------------------------------------
 template <class T>
-Matrix44Base<T> Matrix44Base<T>::scaleRotationTranslation(  //
+constexpr Matrix44Base<T> Matrix44Base<T>::scaleRotationTranslation(  //
     const Vector3Base<T>& scale,                            //
     const QuaternionBase<T>& rotation,                      //
     const Vector3Base<T>& translation) {
-  auto s = Matrix44Base<T>(  //
-      scale.x(), 0, 0, 0,    //
-      0, scale.y(), 0, 0,    //
-      0, 0, scale.z(), 0,    //
-      0, 0, 0, 1);
-
   T x2 = rotation.x() * rotation.x();
   T y2 = rotation.y() * rotation.y();
   T z2 = rotation.z() * rotation.z();
@@ -142,64 +138,53 @@ Matrix44Base<T> Matrix44Base<T>::scaleRotationTranslation(  //
   T m21 = (2 * yz) - (2 * wx);
   T m22 = 1 - (2 * x2) - (2 * y2);
 
-  auto r = Matrix44Base<T>(  //
-      m00, m01, m02, 0,      //
-      m10, m11, m12, 0,      //
-      m20, m21, m22, 0,      //
+  // 回転 * スケール + 平行移動 を行列積を使わずに直接組み立てる
+  T sx = scale.x();
+  T sy = scale.y();
+  T sz = scale.z();
+  return Matrix44Base<T>(                             //
+      m00 * sx, m01 * sy, m02 * sz, translation.x(),  //
+      m10 * sx, m11 * sy, m12 * sz, translation.y(),  //
+      m20 * sx, m21 * sy, m22 * sz, translation.z(),  //
       0, 0, 0, 1);
-
-  auto t = Matrix44Base<T>(      //
-      0, 0, 0, translation.x(),  //
-      0, 0, 0, translation.y(),  //
-      0, 0, 0, translation.z(),  //
-      0, 0, 0, 0);
-
-  return t + (r * s);
 }
 
 template <class T>
-const Matrix44Base<T> Matrix44Base<T>::kZero = Matrix44Base<T>();
+constexpr Matrix44Base<T> Matrix44Base<T>::kZero = Matrix44Base<T>();
 
 template <class T>
-const Matrix44Base<T> Matrix44Base<T>::kIdentity =
+constexpr Matrix44Base<T> Matrix44Base<T>::kIdentity =
     Matrix44Base<T>(1, 0, 0, 0,   //
                     0, 1, 0, 0,   //
                     0, 0, 1, 0,   //
                     0, 0, 0, 1);  //
 
 template <class T>
-const Matrix44Base<T> Matrix44Base<T>::kNanMat =  //
+constexpr Matrix44Base<T> Matrix44Base<T>::kNanMat =  //
     Matrix44Base<T>(kNan, kNan, kNan, kNan,       //
                     kNan, kNan, kNan, kNan,       //
                     kNan, kNan, kNan, kNan,       //
                     kNan, kNan, kNan, kNan);      //
 
 template <class T>
-Matrix44Base<T>::Matrix44Base()
+constexpr Matrix44Base<T>::Matrix44Base()
     : Matrix44Base(0, 0, 0, 0,  //
                    0, 0, 0, 0,  //
                    0, 0, 0, 0,  //
                    0, 0, 0, 0) {}
 
 template <class T>
-Matrix44Base<T>::Matrix44Base(RowType row0, RowType row1, RowType row2,
-                              RowType row3) {
-  rows_[0] = row0;
-  rows_[1] = row1;
-  rows_[2] = row2;
-  rows_[3] = row3;
-}
+constexpr Matrix44Base<T>::Matrix44Base(RowType row0, RowType row1,
+                                        RowType row2, RowType row3)
+    : rows_{row0, row1, row2, row3} {}
 
 template <class T>
-Matrix44Base<T>::Matrix44Base(T _00, T _01, T _02, T _03,  //
-                              T _10, T _11, T _12, T _13,  //
-                              T _20, T _21, T _22, T _23,  //
-                              T _30, T _31, T _32, T _33) {
-  rows_[0][0] = _00, rows_[0][1] = _01, rows_[0][2] = _02, rows_[0][3] = _03;
-  rows_[1][0] = _10, rows_[1][1] = _11, rows_[1][2] = _12, rows_[1][3] = _13;
-  rows_[2][0] = _20, rows_[2][1] = _21, rows_[2][2] = _22, rows_[2][3] = _23;
-  rows_[3][0] = _30, rows_[3][1] = _31, rows_[3][2] = _32, rows_[3][3] = _33;
-}
+constexpr Matrix44Base<T>::Matrix44Base(T _00, T _01, T _02, T _03,  //
+                                        T _10, T _11, T _12, T _13,  //
+                                        T _20, T _21, T _22, T _23,  //
+                                        T _30, T _31, T _32, T _33)
+    : rows_{RowType(_00, _01, _02, _03), RowType(_10, _11, _12, _13),
+            RowType(_20, _21, _22, _23), RowType(_30, _31, _32, _33)} {}
 
 template <class T>
 typename Matrix44Base<T>::iterator Matrix44Base<T>::begin() {
@@ -227,28 +212,28 @@ std::string Matrix44Base<T>::toString() const {
 }
 
 template <class T>
-typename Matrix44Base<T>::RowType& Matrix44Base<T>::operator[](
+constexpr typename Matrix44Base<T>::RowType& Matrix44Base<T>::operator[](
     std::size_t index) {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return rows_[index];
 }
 
 template <class T>
-const typename Matrix44Base<T>::RowType& Matrix44Base<T>::operator[](
+constexpr const typename Matrix44Base<T>::RowType& Matrix44Base<T>::operator[](
     std::size_t index) const {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return rows_[index];
 }
 
 template <class T>
-typename Matrix44Base<T>::RowType Matrix44Base<T>::row(
+constexpr typename Matrix44Base<T>::RowType Matrix44Base<T>::row(
     std::size_t index) const {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return rows_[index];
 }
 
 template <class T>
-typename Matrix44Base<T>::ColType Matrix44Base<T>::col(
+constexpr typename Matrix44Base<T>::ColType Matrix44Base<T>::col(
     std::size_t index) const {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return ColType(rows_[0][index], rows_[1][index], rows_[2][index],
@@ -256,7 +241,7 @@ typename Matrix44Base<T>::ColType Matrix44Base<T>::col(
 }
 
 template <class T>
-bool Matrix44Base<T>::operator==(const Matrix44Base<T>& rhs) const {
+constexpr bool Matrix44Base<T>::operator==(const Matrix44Base<T>& rhs) const {
   for (auto i = 0; i < kRows; ++i) {
     if (rows_[i] != rhs[i]) return false;
   }
@@ -264,22 +249,23 @@ bool Matrix44Base<T>::operator==(const Matrix44Base<T>& rhs) const {
 }
 
 template <class T>
-bool Matrix44Base<T>::operator!=(const Matrix44Base<T>& rhs) const {
+constexpr bool Matrix44Base<T>::operator!=(const Matrix44Base<T>& rhs) const {
   return !(*this == rhs);
 }
 
 template <class T>
-Matrix44Base<T> Matrix44Base<T>::operator+() const {
+constexpr Matrix44Base<T> Matrix44Base<T>::operator+() const {
   return *this;
 }
 
 template <class T>
-Matrix44Base<T> Matrix44Base<T>::operator-() const {
+constexpr Matrix44Base<T> Matrix44Base<T>::operator-() const {
   return Matrix44Base(-rows_[0], -rows_[1], -rows_[2], -rows_[3]);
 }
 
 template <class T>
-Matrix44Base<T>& Matrix44Base<T>::operator+=(const Matrix44Base& rhs) {
+constexpr Matrix44Base<T>& Matrix44Base<T>::operator+=(
+    const Matrix44Base& rhs) {
   for (auto i = 0; i < kRows; ++i) {
     rows_[i] += rhs[i];
   }
@@ -287,7 +273,8 @@ Matrix44Base<T>& Matrix44Base<T>::operator+=(const Matrix44Base& rhs) {
 }
 
 template <class T>
-Matrix44Base<T>& Matrix44Base<T>::operator-=(const Matrix44Base<T>& rhs) {
+constexpr Matrix44Base<T>& Matrix44Base<T>::operator-=(
+    const Matrix44Base<T>& rhs) {
   for (auto i = 0; i < kRows; ++i) {
     rows_[i] -= rhs[i];
   }
@@ -295,7 +282,7 @@ Matrix44Base<T>& Matrix44Base<T>::operator-=(const Matrix44Base<T>& rhs) {
 }
 
 template <class T>
-Matrix44Base<T>& Matrix44Base<T>::operator*=(float rhs) {
+constexpr Matrix44Base<T>& Matrix44Base<T>::operator*=(float rhs) {
   for (auto i = 0; i < kRows; ++i) {
     rows_[i] *= rhs;
   }
@@ -303,7 +290,8 @@ Matrix44Base<T>& Matrix44Base<T>::operator*=(float rhs) {
 }
 
 template <class T>
-Matrix44Base<T>& Matrix44Base<T>::operator*=(const Matrix44Base<T> rhs) {
+constexpr Matrix44Base<T>& Matrix44Base<T>::operator*=(
+    const Matrix44Base<T> rhs) {
   T _00 = dot(rows_[0], rhs.col(0));
   T _01 = dot(rows_[0], rhs.col(1));
   T _02 = dot(rows_[0], rhs.col(2));
@@ -332,8 +320,30 @@ Matrix44Base<T>& Matrix44Base<T>::operator*=(const Matrix44Base<T> rhs) {
   return *this;
 }
 
+#if defined(TEMP_MATH_SIMD)
+template <>
+inline Matrix44Base<float>& Matrix44Base<float>::operator*=(
+    const Matrix44Base<float> rhs) {
+  // Each result row is a linear combination of the rows of rhs, so no column
+  // gather is needed.
+  auto r0 = simd::load(rhs.rows_[0].data());
+  auto r1 = simd::load(rhs.rows_[1].data());
+  auto r2 = simd::load(rhs.rows_[2].data());
+  auto r3 = simd::load(rhs.rows_[3].data());
+  for (std::size_t i = 0; i < kRows; ++i) {
+    auto a = simd::load(rows_[i].data());
+    auto r = simd::mul(simd::broadcast<0>(a), r0);
+    r = simd::madd(simd::broadcast<1>(a), r1, r);
+    r = simd::madd(simd::broadcast<2>(a), r2, r);
+    r = simd::madd(simd::broadcast<3>(a), r3, r);
+    simd::store(rows_[i].data(), r);
+  }
+  return *this;
+}
+#endif
+
 template <class T>
-Matrix44Base<T>& Matrix44Base<T>::operator/=(float rhs) {
+constexpr Matrix44Base<T>& Matrix44Base<T>::operator/=(float rhs) {
   TEMP_ASSERT(rhs != 0.0f, "rhs must not be zero");
   for (auto i = 0; i < kRows; ++i) {
     rows_[i] /= rhs;
@@ -1,6 +1,10 @@
 ﻿#pragma once
 #include <cmath>
 #include "temp/math/matrix44.h"
+#include "temp/math/quaternion_functions.h"
+#include "temp/math/simd.h"
+#include "temp/math/vector3_functions.h"
+#include "temp/math/vector4_functions.h"
 
 namespace temp {
 namespace math {
@@ -13,45 +17,158 @@ template <class T>
 std::ostream& operator<<(std::ostream& stream, const Matrix44Base<T>& mat);
 
 template <class T>
-Matrix44Base<T> operator+(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator+(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs);
 
 template <class T>
-Matrix44Base<T> operator-(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator-(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs);
 
 template <class T>
-Matrix44Base<T> operator*(const Matrix44Base<T>& lhs, float rhs);
+constexpr Matrix44Base<T> operator*(const Matrix44Base<T>& lhs, float rhs);
 
 template <class T>
-Matrix44Base<T> operator*(float lhs, const Matrix44Base<T>& rhs);
+constexpr Matrix44Base<T> operator*(float lhs, const Matrix44Base<T>& rhs);
 
 template <class T>
-Matrix44Base<T> operator*(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator*(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs);
 
 template <class T>
-Vector4Base<T> operator*(const Matrix44Base<T>& lhs, const Vector4Base<T>& rhs);
+constexpr Vector4Base<T> operator*(const Matrix44Base<T>& lhs,
+                                   const Vector4Base<T>& rhs);
 
 template <class T>
-Matrix44Base<T> operator/(const Matrix44Base<T>& lhs, float rhs);
+constexpr Matrix44Base<T> operator/(const Matrix44Base<T>& lhs, float rhs);
 
 template <class T>
-T cofactor(const Matrix44Base<T>& mat, std::size_t row, std::size_t col);
+constexpr T cofactor(const Matrix44Base<T>& mat, std::size_t row,
+                     std::size_t col);
 
 template <class T>
-T determinant(const Matrix44Base<T>& mat);
+constexpr T determinant(const Matrix44Base<T>& mat);
 
 template <class T>
-Matrix44Base<T> inverse(const Matrix44Base<T>& mat);
+constexpr Matrix44Base<T> inverse(const Matrix44Base<T>& mat);
+
+/**
+ * @brief Inverse of affine matrix whose last row is (0, 0, 0, 1)
+ *
+ * @param mat scale, rotation and translation matrix
+ * @return Matrix44Base<T> kNanMat if the matrix is singular
+ */
+template <class T>
+constexpr Matrix44Base<T> inverseAffine(const Matrix44Base<T>& mat);
+
+/**
+ * @brief Inverse of rotation and translation matrix without scale
+ *
+ * @param mat matrix whose upper 3x3 is orthonormal
+ * @return Matrix44Base<T>
+ */
+template <class T>
+constexpr Matrix44Base<T> inverseOrthonormal(const Matrix44Base<T>& mat);
 
 template <class T>
-Matrix44Base<T> transpose(const Matrix44Base<T>& mat);
+constexpr Matrix44Base<T> transpose(const Matrix44Base<T>& mat);
 
 template <class T>
-Vector3Base<T> transform(const Vector3Base<T>& vec3,
+constexpr Vector3Base<T> transform(const Vector3Base<T>& vec3,
                          const Matrix44Base<T>& mat);
 
+/**
+ * @brief Components of Matrix44Base::scaleRotationTranslation
+ */
+template <class T>
+struct TransformComponentsBase {
+  Vector3Base<T> scale;
+  QuaternionBase<T> rotation;
+  Vector3Base<T> translation;
+};
+
+using TransformComponents = TransformComponentsBase<float>;
+
+/**
+ * @brief Split matrix into scale, rotation and translation
+ *
+ * Inverse of Matrix44Base::scaleRotationTranslation. Shear is not
+ * recoverable, and a negative determinant is folded into scale.x().
+ *
+ * @param mat affine matrix whose last row is (0, 0, 0, 1)
+ * @return TransformComponentsBase<T>
+ */
+template <class T>
+TransformComponentsBase<T> decompose(const Matrix44Base<T>& mat);
+
+// Camera matrices are left handed: the view looks down +z with +y up, and
+// clip space depth is [0, w] as in Vulkan and Direct3D. Clip space +y is
+// up, so Vulkan needs a negative viewport height (or a flipped y row).
+//
+// The ReversedZ variants map near to depth 1 and far to depth 0, which
+// spreads float precision evenly over distance when used with a float depth
+// buffer and a greater depth test.
+
+/**
+ * @brief View matrix looking from eye at target
+ *
+ * @param eye camera position
+ * @param target point to look at, must differ from eye
+ * @param up approximate up direction, must not be parallel to the view
+ * @return Matrix44Base<T>
+ */
+template <class T>
+Matrix44Base<T> lookAt(const Vector3Base<T>& eye, const Vector3Base<T>& target,
+                       const Vector3Base<T>& up);
+
+/**
+ * @brief View matrix of camera placed by rotation and position
+ *
+ * Inverse of the camera transform, whose +z axis is the view direction.
+ */
+template <class T>
+constexpr Matrix44Base<T> viewFromTransform(const QuaternionBase<T>& rotation,
+                                            const Vector3Base<T>& position);
+
+/**
+ * @brief Perspective projection
+ *
+ * @param fov_y vertical field of view in radians
+ * @param aspect width / height
+ * @param near_z distance to near plane, > 0
+ * @param far_z distance to far plane, > near_z
+ * @return Matrix44Base<T>
+ */
+template <class T>
+Matrix44Base<T> perspective(T fov_y, T aspect, T near_z, T far_z);
+
+template <class T>
+Matrix44Base<T> perspectiveReversedZ(T fov_y, T aspect, T near_z, T far_z);
+
+/**
+ * @brief Perspective projection whose far plane is at infinity
+ */
+template <class T>
+Matrix44Base<T> perspectiveInfinite(T fov_y, T aspect, T near_z);
+
+template <class T>
+Matrix44Base<T> perspectiveInfiniteReversedZ(T fov_y, T aspect, T near_z);
+
+/**
+ * @brief Orthographic projection centered on the view axis
+ *
+ * @param width width of view volume
+ * @param height height of view volume
+ * @param near_z distance to near plane
+ * @param far_z distance to far plane, != near_z
+ * @return Matrix44Base<T>
+ */
+template <class T>
+constexpr Matrix44Base<T> orthographic(T width, T height, T near_z, T far_z);
+
+template <class T>
+constexpr Matrix44Base<T> orthographicReversedZ(T width, T height, T near_z,
+                                                T far_z);
+
 //----------------------------------------
 // implementation
 //----------------------------------------
@@ -62,49 +179,67 @@ std::ostream& operator<<(std::ostream& stream, const Matrix44Base<T>& mat) {
 }
 
 template <class T>
-Matrix44Base<T> operator+(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator+(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs) {
   return Matrix44Base<T>(lhs) += rhs;
 }
 
 template <class T>
-Matrix44Base<T> operator-(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator-(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs) {
   return Matrix44Base<T>(lhs) -= rhs;
 }
 
 template <class T>
-Matrix44Base<T> operator*(const Matrix44Base<T>& lhs, float rhs) {
+constexpr Matrix44Base<T> operator*(const Matrix44Base<T>& lhs, float rhs) {
   return Matrix44Base<T>(lhs) *= rhs;
 }
 
 template <class T>
-Matrix44Base<T> operator*(float lhs, const Matrix44Base<T>& rhs) {
+constexpr Matrix44Base<T> operator*(float lhs, const Matrix44Base<T>& rhs) {
   return rhs * lhs;
 }
 
 template <class T>
-Matrix44Base<T> operator*(const Matrix44Base<T>& lhs,
+constexpr Matrix44Base<T> operator*(const Matrix44Base<T>& lhs,
                           const Matrix44Base<T>& rhs) {
   return Matrix44Base<T>(lhs) *= rhs;
 }
 
 template <class T>
-Vector4Base<T> operator*(const Matrix44Base<T>& lhs,
+constexpr Vector4Base<T> operator*(const Matrix44Base<T>& lhs,
                          const Vector4Base<T>& rhs) {
   return Vector4Base<T>(dot(lhs.row(0), rhs), dot(lhs.row(1), rhs),
                         dot(lhs.row(2), rhs), dot(lhs.row(3), rhs));
 }
 
+#if defined(TEMP_MATH_SIMD)
+template <>
+inline Vector4Base<float> operator*(const Matrix44Base<float>& lhs,
+                                    const Vector4Base<float>& rhs) {
+  auto v = simd::load(rhs.data());
+  auto m0 = simd::mul(simd::load(lhs[0].data()), v);
+  auto m1 = simd::mul(simd::load(lhs[1].data()), v);
+  auto m2 = simd::mul(simd::load(lhs[2].data()), v);
+  auto m3 = simd::mul(simd::load(lhs[3].data()), v);
+  simd::transpose(m0, m1, m2, m3);
+  Vector4Base<float> result;
+  simd::store(result.data(),
+              simd::add(simd::add(m0, m1), simd::add(m2, m3)));
+  return result;
+}
+#endif
+
 template <class T>
-Matrix44Base<T> operator/(const Matrix44Base<T>& lhs, float rhs) {
+constexpr Matrix44Base<T> operator/(const Matrix44Base<T>& lhs, float rhs) {
   return Matrix44Base<T>(lhs) /= rhs;
 }
 
 template <class T>
-T cofactor(const Matrix44Base<T>& mat, std::size_t row, std::size_t col) {
-  static const auto kRows = Matrix44Base<T>::kRows;
-  static const auto kCols = Matrix44Base<T>::kCols;
+constexpr T cofactor(const Matrix44Base<T>& mat, std::size_t row,
+                     std::size_t col) {
+  constexpr auto kRows = Matrix44Base<T>::kRows;
+  constexpr auto kCols = Matrix44Base<T>::kCols;
 
   T m[3][3] = {};  // row行とcol列を取り除いた3x3行列
   int i = 0;
@@ -140,8 +275,8 @@ T cofactor(const Matrix44Base<T>& mat, std::size_t row, std::size_t col) {
 }
 
 template <class T>
-T determinant(const Matrix44Base<T>& mat) {
-  static const auto kRows = Matrix44Base<T>::kRows;
+constexpr T determinant(const Matrix44Base<T>& mat) {
+  constexpr auto kRows = Matrix44Base<T>::kRows;
 
   // 余因子から行列式を求める
   T d = 0;
@@ -153,29 +288,236 @@ T determinant(const Matrix44Base<T>& mat) {
 }
 
 template <class T>
-Matrix44Base<T> inverse(const Matrix44Base<T>& mat) {
-  static const auto kRows = Matrix44Base<T>::kRows;
-  static const auto kCols = Matrix44Base<T>::kCols;
+constexpr Matrix44Base<T> inverse(const Matrix44Base<T>& mat) {
+  const auto& m = mat;
+
+  // 上2行(s)と下2行(c)の2x2小行列式
+  T s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+  T s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+  T s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+  T s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+  T s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+  T s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+  T c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+  T c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+  T c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+  T c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+  T c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+  T c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+
+  T d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  if (d == 0) {
+    // 正則行列でなければ、Nan行列を返す
+    return Matrix44Base<T>::kNanMat;
+  }
+
+  T inv_d = 1 / d;
+  return Matrix44Base<T>(
+      (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv_d,
+      (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv_d,
+      (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv_d,
+      (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv_d,
+
+      (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv_d,
+      (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv_d,
+      (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv_d,
+      (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv_d,
+
+      (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv_d,
+      (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv_d,
+      (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv_d,
+      (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv_d,
+
+      (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv_d,
+      (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv_d,
+      (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv_d,
+      (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv_d);
+}
+
+#if defined(TEMP_MATH_SIMD)
+namespace simd {
+// 2x2 row major matrices packed as (m00, m01, m10, m11)
+
+/// a * b
+inline Float4 mat2Mul(Float4 a, Float4 b) {
+  return madd(a, shuffle<0, 3, 0, 3>(b, b),
+              mul(shuffle<1, 0, 3, 2>(a, a), shuffle<2, 1, 2, 1>(b, b)));
+}
+
+/// adjugate(a) * b
+inline Float4 mat2AdjMul(Float4 a, Float4 b) {
+  return sub(mul(shuffle<3, 3, 0, 0>(a, a), b),
+             mul(shuffle<1, 1, 2, 2>(a, a), shuffle<2, 3, 0, 1>(b, b)));
+}
 
-  auto d = determinant(mat);
+/// a * adjugate(b)
+inline Float4 mat2MulAdj(Float4 a, Float4 b) {
+  return sub(mul(a, shuffle<3, 0, 3, 0>(b, b)),
+             mul(shuffle<1, 0, 3, 2>(a, a), shuffle<2, 1, 2, 1>(b, b)));
+}
+}  // namespace simd
+
+template <>
+inline Matrix44Base<float> inverse(const Matrix44Base<float>& mat) {
+  // 2x2の小行列に分割してブロック行列の逆行列を求める
+  //   | A B |
+  //   | C D |
+  auto r0 = simd::load(mat[0].data());
+  auto r1 = simd::load(mat[1].data());
+  auto r2 = simd::load(mat[2].data());
+  auto r3 = simd::load(mat[3].data());
+
+  auto a = simd::shuffle<0, 1, 0, 1>(r0, r1);
+  auto b = simd::shuffle<2, 3, 2, 3>(r0, r1);
+  auto c = simd::shuffle<0, 1, 0, 1>(r2, r3);
+  auto d = simd::shuffle<2, 3, 2, 3>(r2, r3);
+
+  // (|A|, |B|, |C|, |D|)
+  auto det_sub = simd::sub(simd::mul(simd::shuffle<0, 2, 0, 2>(r0, r2),
+                                     simd::shuffle<1, 3, 1, 3>(r1, r3)),
+                           simd::mul(simd::shuffle<1, 3, 1, 3>(r0, r2),
+                                     simd::shuffle<0, 2, 0, 2>(r1, r3)));
+  auto det_a = simd::broadcast<0>(det_sub);
+  auto det_b = simd::broadcast<1>(det_sub);
+  auto det_c = simd::broadcast<2>(det_sub);
+  auto det_d = simd::broadcast<3>(det_sub);
+
+  // A#, D# は余因子行列
+  auto d_c = simd::mat2AdjMul(d, c);
+  auto a_b = simd::mat2AdjMul(a, b);
+  auto x = simd::sub(simd::mul(det_d, a), simd::mat2Mul(b, d_c));
+  auto w = simd::sub(simd::mul(det_a, d), simd::mat2Mul(c, a_b));
+  auto y = simd::sub(simd::mul(det_b, c), simd::mat2MulAdj(d, a_b));
+  auto z = simd::sub(simd::mul(det_c, b), simd::mat2MulAdj(a, d_c));
+
+  // |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+  auto tr = simd::hsum(simd::mul(a_b, simd::shuffle<0, 2, 1, 3>(d_c, d_c)));
+  auto det_m =
+      simd::sub(simd::madd(det_a, det_d, simd::mul(det_b, det_c)), tr);
+  if (simd::get<0>(det_m) == 0.0f) {
+    // 正則行列でなければ、Nan行列を返す
+    return Matrix44Base<float>::kNanMat;
+  }
+
+  auto r_det = simd::div(simd::set(1.0f, -1.0f, -1.0f, 1.0f), det_m);
+  x = simd::mul(x, r_det);
+  y = simd::mul(y, r_det);
+  z = simd::mul(z, r_det);
+  w = simd::mul(w, r_det);
+
+  // 小行列の余因子をとりながら行に並べ直す
+  Matrix44Base<float> result;
+  simd::store(result[0].data(), simd::shuffle<3, 1, 3, 1>(x, y));
+  simd::store(result[1].data(), simd::shuffle<2, 0, 2, 0>(x, y));
+  simd::store(result[2].data(), simd::shuffle<3, 1, 3, 1>(z, w));
+  simd::store(result[3].data(), simd::shuffle<2, 0, 2, 0>(z, w));
+  return result;
+}
+#endif
+
+template <class T>
+constexpr Matrix44Base<T> inverseAffine(const Matrix44Base<T>& mat) {
+  const auto& m = mat;
+
+  // 左上3x3の余因子行列
+  T i00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  T i01 = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+  T i02 = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+  T i10 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  T i11 = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+  T i12 = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+  T i20 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  T i21 = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+  T i22 = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+
+  T d = m[0][0] * i00 + m[1][0] * i01 + m[2][0] * i02;
   if (d == 0) {
     // 正則行列でなければ、Nan行列を返す
     return Matrix44Base<T>::kNanMat;
   }
 
-  // 余因子行列から逆行列を求める
-  Matrix44Base<T> cofactorMatrix;
-  for (int r = 0; r < kRows; ++r) {
-    for (int c = 0; c < kCols; ++c) {
-      cofactorMatrix[c][r] = cofactor(mat, r, c);
-    }
+  T inv_d = 1 / d;
+  i00 *= inv_d, i01 *= inv_d, i02 *= inv_d;
+  i10 *= inv_d, i11 *= inv_d, i12 *= inv_d;
+  i20 *= inv_d, i21 *= inv_d, i22 *= inv_d;
+
+  T tx = m[0][3];
+  T ty = m[1][3];
+  T tz = m[2][3];
+  return Matrix44Base<T>(                                //
+      i00, i01, i02, -(i00 * tx + i01 * ty + i02 * tz),  //
+      i10, i11, i12, -(i10 * tx + i11 * ty + i12 * tz),  //
+      i20, i21, i22, -(i20 * tx + i21 * ty + i22 * tz),  //
+      0, 0, 0, 1);
+}
+
+#if defined(TEMP_MATH_SIMD)
+template <>
+inline Matrix44Base<float> inverseAffine(const Matrix44Base<float>& mat) {
+  // 列ベクトルの外積が左上3x3の余因子行列の行になる
+  auto c0 = simd::load(mat[0].data());
+  auto c1 = simd::load(mat[1].data());
+  auto c2 = simd::load(mat[2].data());
+  auto t = simd::set(0.0f, 0.0f, 0.0f, 1.0f);
+  simd::transpose(c0, c1, c2, t);
+
+  auto cross = [](simd::Float4 a, simd::Float4 b) {
+    return simd::sub(
+        simd::mul(simd::shuffle<1, 2, 0, 3>(a, a),
+                  simd::shuffle<2, 0, 1, 3>(b, b)),
+        simd::mul(simd::shuffle<2, 0, 1, 3>(a, a),
+                  simd::shuffle<1, 2, 0, 3>(b, b)));
+  };
+  auto i0 = cross(c1, c2);
+  auto i1 = cross(c2, c0);
+  auto i2 = cross(c0, c1);
+
+  auto d = simd::hsum(simd::mul(c0, i0));
+  if (simd::get<0>(d) == 0.0f) {
+    // 正則行列でなければ、Nan行列を返す
+    return Matrix44Base<float>::kNanMat;
   }
+  auto inv_d = simd::div(simd::splat(1.0f), d);
+  i0 = simd::mul(i0, inv_d);
+  i1 = simd::mul(i1, inv_d);
+  i2 = simd::mul(i2, inv_d);
+
+  // 平行移動 -(M^-1 t) を求めて4列目に入れる
+  auto i3 = simd::splat(0.0f);
+  simd::transpose(i0, i1, i2, i3);
+  i3 = simd::neg(simd::madd(
+      i0, simd::broadcast<0>(t),
+      simd::madd(i1, simd::broadcast<1>(t),
+                 simd::mul(i2, simd::broadcast<2>(t)))));
+  simd::transpose(i0, i1, i2, i3);
+
+  Matrix44Base<float> result;
+  simd::store(result[0].data(), i0);
+  simd::store(result[1].data(), i1);
+  simd::store(result[2].data(), i2);
+  simd::store(result[3].data(), simd::set(0.0f, 0.0f, 0.0f, 1.0f));
+  return result;
+}
+#endif
 
-  return cofactorMatrix / d;
+template <class T>
+constexpr Matrix44Base<T> inverseOrthonormal(const Matrix44Base<T>& mat) {
+  const auto& m = mat;
+
+  // 回転部分は転置、平行移動は転置した回転で戻す
+  T tx = m[0][3];
+  T ty = m[1][3];
+  T tz = m[2][3];
+  return Matrix44Base<T>(
+      m[0][0], m[1][0], m[2][0], -(m[0][0] * tx + m[1][0] * ty + m[2][0] * tz),
+      m[0][1], m[1][1], m[2][1], -(m[0][1] * tx + m[1][1] * ty + m[2][1] * tz),
+      m[0][2], m[1][2], m[2][2], -(m[0][2] * tx + m[1][2] * ty + m[2][2] * tz),
+      0, 0, 0, 1);
 }
 
 template <class T>
-Matrix44Base<T> transpose(const Matrix44Base<T>& mat) {
+constexpr Matrix44Base<T> transpose(const Matrix44Base<T>& mat) {
   return Matrix44Base<T>(mat[0][0], mat[1][0], mat[2][0], mat[3][0],  //
                          mat[0][1], mat[1][1], mat[2][1], mat[3][1],  //
                          mat[0][2], mat[1][2], mat[2][2], mat[3][2],  //
@@ -183,10 +525,187 @@ Matrix44Base<T> transpose(const Matrix44Base<T>& mat) {
 }
 
 template <class T>
-Vector3Base<T> transform(const Vector3Base<T>& vec3,
+constexpr Vector3Base<T> transform(const Vector3Base<T>& vec3,
                          const Matrix44Base<T>& mat) {
   auto result = mat * Vector4Base<T>(vec3, 1);
   return Vector3Base<T>(result.x(), result.y(), result.z());
 }
+
+#if defined(TEMP_MATH_SIMD)
+template <>
+inline Vector3Base<float> transform(const Vector3Base<float>& vec3,
+                                    const Matrix44Base<float>& mat) {
+  // Only the first three rows contribute to the result.
+  auto v = simd::set(vec3.x(), vec3.y(), vec3.z(), 1.0f);
+  auto m0 = simd::mul(simd::load(mat[0].data()), v);
+  auto m1 = simd::mul(simd::load(mat[1].data()), v);
+  auto m2 = simd::mul(simd::load(mat[2].data()), v);
+  auto m3 = simd::splat(0.0f);
+  simd::transpose(m0, m1, m2, m3);
+  auto r = simd::add(simd::add(m0, m1), simd::add(m2, m3));
+  Vector4Base<float> result;
+  simd::store(result.data(), r);
+  return Vector3Base<float>(result.x(), result.y(), result.z());
+}
+#endif
+
+template <class T>
+TransformComponentsBase<T> decompose(const Matrix44Base<T>& mat) {
+  const auto& m = mat;
+  TransformComponentsBase<T> result;
+  result.translation = Vector3Base<T>(m[0][3], m[1][3], m[2][3]);
+
+  // 各列の長さがスケール
+  T sx = std::sqrt(m[0][0] * m[0][0] + m[1][0] * m[1][0] + m[2][0] * m[2][0]);
+  T sy = std::sqrt(m[0][1] * m[0][1] + m[1][1] * m[1][1] + m[2][1] * m[2][1]);
+  T sz = std::sqrt(m[0][2] * m[0][2] + m[1][2] * m[1][2] + m[2][2] * m[2][2]);
+  T d = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+        m[1][0] * (m[0][1] * m[2][2] - m[0][2] * m[2][1]) +
+        m[2][0] * (m[0][1] * m[1][2] - m[0][2] * m[1][1]);
+  if (d < 0) {
+    sx = -sx;
+  }
+  result.scale = Vector3Base<T>(sx, sy, sz);
+  if (sx == 0 || sy == 0 || sz == 0) {
+    result.rotation = QuaternionBase<T>(0, 0, 0, 1);
+    return result;
+  }
+
+  // スケールを除いた回転行列 (scaleRotationTranslationと同じ並び)
+  T inv_sx = 1 / sx;
+  T inv_sy = 1 / sy;
+  T inv_sz = 1 / sz;
+  T r00 = m[0][0] * inv_sx, r01 = m[0][1] * inv_sy, r02 = m[0][2] * inv_sz;
+  T r10 = m[1][0] * inv_sx, r11 = m[1][1] * inv_sy, r12 = m[1][2] * inv_sz;
+  T r20 = m[2][0] * inv_sx, r21 = m[2][1] * inv_sy, r22 = m[2][2] * inv_sz;
+
+  // 絶対値が最大の成分から求めて桁落ちを避ける
+  T trace = r00 + r11 + r22;
+  T x, y, z, w;
+  if (trace > 0) {
+    T s = std::sqrt(trace + 1) * 2;  // 4w
+    T inv_s = 1 / s;
+    w = s / 4;
+    x = (r12 - r21) * inv_s;
+    y = (r20 - r02) * inv_s;
+    z = (r01 - r10) * inv_s;
+  } else if (r00 > r11 && r00 > r22) {
+    T s = std::sqrt(1 + r00 - r11 - r22) * 2;  // 4x
+    T inv_s = 1 / s;
+    w = (r12 - r21) * inv_s;
+    x = s / 4;
+    y = (r01 + r10) * inv_s;
+    z = (r20 + r02) * inv_s;
+  } else if (r11 > r22) {
+    T s = std::sqrt(1 + r11 - r00 - r22) * 2;  // 4y
+    T inv_s = 1 / s;
+    w = (r20 - r02) * inv_s;
+    x = (r01 + r10) * inv_s;
+    y = s / 4;
+    z = (r12 + r21) * inv_s;
+  } else {
+    T s = std::sqrt(1 + r22 - r00 - r11) * 2;  // 4z
+    T inv_s = 1 / s;
+    w = (r01 - r10) * inv_s;
+    x = (r20 + r02) * inv_s;
+    y = (r12 + r21) * inv_s;
+    z = s / 4;
+  }
+  result.rotation = QuaternionBase<T>(x, y, z, w);
+  return result;
+}
+
+template <class T>
+Matrix44Base<T> lookAt(const Vector3Base<T>& eye, const Vector3Base<T>& target,
+                       const Vector3Base<T>& up) {
+  auto f = normalize(target - eye);
+  auto r = normalize(cross(up, f));
+  auto u = cross(f, r);
+  return Matrix44Base<T>(                 //
+      r.x(), r.y(), r.z(), -dot(r, eye),  //
+      u.x(), u.y(), u.z(), -dot(u, eye),  //
+      f.x(), f.y(), f.z(), -dot(f, eye),  //
+      0, 0, 0, 1);
+}
+
+template <class T>
+constexpr Matrix44Base<T> viewFromTransform(const QuaternionBase<T>& rotation,
+                                            const Vector3Base<T>& position) {
+  // カメラの各軸がビュー行列の行になる
+  auto r = rotate(Vector3Base<T>(1, 0, 0), rotation);
+  auto u = rotate(Vector3Base<T>(0, 1, 0), rotation);
+  auto f = rotate(Vector3Base<T>(0, 0, 1), rotation);
+  return Matrix44Base<T>(                      //
+      r.x(), r.y(), r.z(), -dot(r, position),  //
+      u.x(), u.y(), u.z(), -dot(u, position),  //
+      f.x(), f.y(), f.z(), -dot(f, position),  //
+      0, 0, 0, 1);
+}
+
+template <class T>
+Matrix44Base<T> perspective(T fov_y, T aspect, T near_z, T far_z) {
+  // z_clip = a * z + b, w_clip = z
+  T y_scale = 1 / std::tan(fov_y / 2);
+  T a = far_z / (far_z - near_z);
+  return Matrix44Base<T>(         //
+      y_scale / aspect, 0, 0, 0,  //
+      0, y_scale, 0, 0,           //
+      0, 0, a, -a * near_z,       //
+      0, 0, 1, 0);
+}
+
+template <class T>
+Matrix44Base<T> perspectiveReversedZ(T fov_y, T aspect, T near_z, T far_z) {
+  T y_scale = 1 / std::tan(fov_y / 2);
+  T a = near_z / (far_z - near_z);
+  return Matrix44Base<T>(         //
+      y_scale / aspect, 0, 0, 0,  //
+      0, y_scale, 0, 0,           //
+      0, 0, -a, a * far_z,        //
+      0, 0, 1, 0);
+}
+
+template <class T>
+Matrix44Base<T> perspectiveInfinite(T fov_y, T aspect, T near_z) {
+  // perspective の far_z -> ∞ の極限
+  T y_scale = 1 / std::tan(fov_y / 2);
+  return Matrix44Base<T>(         //
+      y_scale / aspect, 0, 0, 0,  //
+      0, y_scale, 0, 0,           //
+      0, 0, 1, -near_z,           //
+      0, 0, 1, 0);
+}
+
+template <class T>
+Matrix44Base<T> perspectiveInfiniteReversedZ(T fov_y, T aspect, T near_z) {
+  // depth = near_z / z
+  T y_scale = 1 / std::tan(fov_y / 2);
+  return Matrix44Base<T>(         //
+      y_scale / aspect, 0, 0, 0,  //
+      0, y_scale, 0, 0,           //
+      0, 0, 0, near_z,            //
+      0, 0, 1, 0);
+}
+
+template <class T>
+constexpr Matrix44Base<T> orthographic(T width, T height, T near_z, T far_z) {
+  T inv_depth = 1 / (far_z - near_z);
+  return Matrix44Base<T>(                    //
+      2 / width, 0, 0, 0,                    //
+      0, 2 / height, 0, 0,                   //
+      0, 0, inv_depth, -near_z * inv_depth,  //
+      0, 0, 0, 1);
+}
+
+template <class T>
+constexpr Matrix44Base<T> orthographicReversedZ(T width, T height, T near_z,
+                                                T far_z) {
+  T inv_depth = 1 / (far_z - near_z);
+  return Matrix44Base<T>(                   //
+      2 / width, 0, 0, 0,                   //
+      0, 2 / height, 0, 0,                  //
+      0, 0, -inv_depth, far_z * inv_depth,  //
+      0, 0, 0, 1);
+}
 }  // namespace math
 }  // namespace temp
\ No newline at end of file
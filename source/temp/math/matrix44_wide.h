@@ -0,0 +1,182 @@
+﻿/**
+ * @file matrix44_wide.h
+ * @brief N 4x4 matrices stored one lane per matrix (AoSoA)
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <array>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/matrix44.h"
+#include "temp/math/vector3_wide.h"
+#include "temp/math/wide.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+template <class T, std::size_t N>
+class Matrix44Wide {
+ public:
+  using WideType = Wide<T, N>;
+  using ScalarType = Matrix44Base<T>;
+  using RowType = std::array<WideType, 4>;
+
+  static const std::size_t kRows = 4;
+  static const std::size_t kCols = 4;
+  static constexpr std::size_t kWidth = N;
+
+  /**
+   * @brief Load N consecutive matrices stored as Matrix44Base (AoS)
+   */
+  static Matrix44Wide load(const ScalarType* matrices);
+
+  Matrix44Wide();
+  explicit Matrix44Wide(const ScalarType& mat);
+
+  Matrix44Wide(const Matrix44Wide&) = default;
+  Matrix44Wide& operator=(const Matrix44Wide&) = default;
+  ~Matrix44Wide() = default;
+
+ public:
+  /**
+   * @brief Store N matrices to consecutive Matrix44Base (AoS)
+   */
+  void store(ScalarType* matrices) const;
+
+  ScalarType lane(std::size_t index) const;
+
+  RowType& operator[](std::size_t index);
+  const RowType& operator[](std::size_t index) const;
+
+  Matrix44Wide& operator*=(const Matrix44Wide& rhs);
+
+ private:
+  std::array<RowType, kRows> rows_;
+};
+
+using Matrix44x4 = Matrix44Wide<float, 4>;
+using Matrix44x8 = Matrix44Wide<float, 8>;
+using Matrix44x16 = Matrix44Wide<float, 16>;
+
+template <class T, std::size_t N>
+Matrix44Wide<T, N> operator*(const Matrix44Wide<T, N>& lhs,
+                             const Matrix44Wide<T, N>& rhs);
+
+/**
+ * @brief Transform points (w = 1) lane by lane
+ */
+template <class T, std::size_t N>
+Vector3Wide<T, N> transform(const Vector3Wide<T, N>& vec3,
+                            const Matrix44Wide<T, N>& mat);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T, std::size_t N>
+Matrix44Wide<T, N> Matrix44Wide<T, N>::load(const ScalarType* matrices) {
+  Matrix44Wide result;
+  alignas(sizeof(T) * N) T lanes[N];
+  for (std::size_t r = 0; r < kRows; ++r) {
+    for (std::size_t c = 0; c < kCols; ++c) {
+      for (std::size_t i = 0; i < N; ++i) {
+        lanes[i] = matrices[i][r][c];
+      }
+      result.rows_[r][c] = WideType::load(lanes);
+    }
+  }
+  return result;
+}
+
+template <class T, std::size_t N>
+Matrix44Wide<T, N>::Matrix44Wide() : rows_{} {}
+
+template <class T, std::size_t N>
+Matrix44Wide<T, N>::Matrix44Wide(const ScalarType& mat) {
+  for (std::size_t r = 0; r < kRows; ++r) {
+    for (std::size_t c = 0; c < kCols; ++c) {
+      rows_[r][c] = WideType(mat[r][c]);
+    }
+  }
+}
+
+template <class T, std::size_t N>
+void Matrix44Wide<T, N>::store(ScalarType* matrices) const {
+  alignas(sizeof(T) * N) T lanes[N];
+  for (std::size_t r = 0; r < kRows; ++r) {
+    for (std::size_t c = 0; c < kCols; ++c) {
+      rows_[r][c].store(lanes);
+      for (std::size_t i = 0; i < N; ++i) {
+        matrices[i][r][c] = lanes[i];
+      }
+    }
+  }
+}
+
+template <class T, std::size_t N>
+typename Matrix44Wide<T, N>::ScalarType Matrix44Wide<T, N>::lane(
+    std::size_t index) const {
+  TEMP_ASSERT(index < N, "index must be less than lane count");
+  ScalarType result;
+  for (std::size_t r = 0; r < kRows; ++r) {
+    for (std::size_t c = 0; c < kCols; ++c) {
+      result[r][c] = rows_[r][c][index];
+    }
+  }
+  return result;
+}
+
+template <class T, std::size_t N>
+typename Matrix44Wide<T, N>::RowType& Matrix44Wide<T, N>::operator[](
+    std::size_t index) {
+  TEMP_ASSERT(index < kRows, "index must be less than kRows");
+  return rows_[index];
+}
+
+template <class T, std::size_t N>
+const typename Matrix44Wide<T, N>::RowType& Matrix44Wide<T, N>::operator[](
+    std::size_t index) const {
+  TEMP_ASSERT(index < kRows, "index must be less than kRows");
+  return rows_[index];
+}
+
+template <class T, std::size_t N>
+Matrix44Wide<T, N>& Matrix44Wide<T, N>::operator*=(const Matrix44Wide& rhs) {
+  for (auto& row : rows_) {
+    RowType result;
+    for (std::size_t c = 0; c < kCols; ++c) {
+      result[c] = madd(row[0], rhs.rows_[0][c],
+                       madd(row[1], rhs.rows_[1][c],
+                            madd(row[2], rhs.rows_[2][c],
+                                 row[3] * rhs.rows_[3][c])));
+    }
+    row = result;
+  }
+  return *this;
+}
+
+template <class T, std::size_t N>
+Matrix44Wide<T, N> operator*(const Matrix44Wide<T, N>& lhs,
+                             const Matrix44Wide<T, N>& rhs) {
+  return Matrix44Wide<T, N>(lhs) *= rhs;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> transform(const Vector3Wide<T, N>& vec3,
+                            const Matrix44Wide<T, N>& mat) {
+  Wide<T, N> result[3];
+  for (std::size_t r = 0; r < 3; ++r) {
+    const auto& row = mat[r];
+    result[r] = madd(row[0], vec3.x(),
+                     madd(row[1], vec3.y(), madd(row[2], vec3.z(), row[3])));
+  }
+  return Vector3Wide<T, N>(result[0], result[1], result[2]);
+}
+
+}  // namespace math
+}  // namespace temp
@@ -0,0 +1,768 @@
+﻿#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+
+#include "temp/base/cpu_feature.h"
+
+#include "temp/math/packing.h"
+#include "temp/math/quaternion_wide.h"
+#include "temp/math/simd.h"
+#include "temp/math/vector3_functions.h"
+#include "temp/math/vector3_wide.h"
+
+#if defined(TEMP_MATH_SIMD_SSE)
+#define TEMP_MATH_PACKING_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TEMP_TARGET_F16C
+#define TEMP_TARGET_AVX512
+#else
+#define TEMP_TARGET_F16C __attribute__((target("avx,f16c")))
+#define TEMP_TARGET_AVX512 __attribute__((target("avx2,fma,avx512f")))
+#endif
+#endif
+
+namespace temp {
+namespace math {
+
+static_assert(sizeof(Vector2) == sizeof(float) * 2 &&
+                  sizeof(Vector3) == sizeof(float) * 3 &&
+                  sizeof(Vector4) == sizeof(float) * 4,
+              "vectors must be tightly packed");
+static_assert(sizeof(Half2) == 4 && sizeof(Half3) == 6 && sizeof(Half4) == 8,
+              "halves must be tightly packed");
+static_assert(sizeof(Snorm16x2) == 4 && sizeof(Snorm16x3) == 6 &&
+                  sizeof(Snorm16x4) == 8,
+              "snorms must be tightly packed");
+
+namespace {
+
+using FloatToHalfFunc = void (*)(const float*, std::size_t, std::uint16_t*);
+using HalfToFloatFunc = void (*)(const std::uint16_t*, std::size_t, float*);
+
+struct HalfKernels {
+  FloatToHalfFunc float_to_half;
+  HalfToFloatFunc half_to_float;
+};
+
+// Lane count of the wide type kernels, same as batch.cpp
+#if defined(TEMP_MATH_SIMD_SSE) && defined(__AVX512F__)
+constexpr std::size_t kWideLanes = 16;
+#elif defined(TEMP_MATH_SIMD_SSE) && defined(__AVX__)
+constexpr std::size_t kWideLanes = 8;
+#else
+constexpr std::size_t kWideLanes = 4;
+#endif
+
+using WideFloat = Wide<float, kWideLanes>;
+using WideVector3 = Vector3Wide<float, kWideLanes>;
+using WideQuaternion = QuaternionWide<float, kWideLanes>;
+
+constexpr float kSnorm16Max = 32767.0f;
+constexpr float kInvSqrt2 = 0.707106781186547524f;
+
+void floatToHalfScalar(const float* values, std::size_t count,
+                       std::uint16_t* results) {
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = floatToHalf(values[i]);
+  }
+}
+
+void halfToFloatScalar(const std::uint16_t* halves, std::size_t count,
+                       float* results) {
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = halfToFloat(halves[i]);
+  }
+}
+
+#if defined(TEMP_MATH_PACKING_X86)
+TEMP_TARGET_F16C void floatToHalfF16c(const float* values, std::size_t count,
+                                      std::uint16_t* results) {
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto halves =
+        _mm256_cvtps_ph(_mm256_loadu_ps(values + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), halves);
+  }
+  floatToHalfScalar(values + i, count - i, results + i);
+}
+
+TEMP_TARGET_F16C void halfToFloatF16c(const std::uint16_t* halves,
+                                      std::size_t count, float* results) {
+  std::size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(halves + i));
+    _mm256_storeu_ps(results + i, _mm256_cvtph_ps(h));
+  }
+  halfToFloatScalar(halves + i, count - i, results + i);
+}
+
+TEMP_TARGET_AVX512 void floatToHalfAvx512(const float* values,
+                                          std::size_t count,
+                                          std::uint16_t* results) {
+  // マスクなしの形は GCC で未初期化の警告が出るので、全要素のマスクで
+  // ゼロマスクの形を使う
+  const __mmask16 kAll = 0xffff;
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto halves = _mm512_maskz_cvtps_ph(
+        kAll, _mm512_loadu_ps(values + i),
+        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i), halves);
+  }
+  floatToHalfScalar(values + i, count - i, results + i);
+}
+
+TEMP_TARGET_AVX512 void halfToFloatAvx512(const std::uint16_t* halves,
+                                          std::size_t count, float* results) {
+  const __mmask16 kAll = 0xffff;
+  std::size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(halves + i));
+    _mm512_storeu_ps(results + i, _mm512_maskz_cvtph_ps(kAll, h));
+  }
+  halfToFloatScalar(halves + i, count - i, results + i);
+}
+#endif
+
+#if defined(TEMP_MATH_SIMD_NEON) && defined(__aarch64__)
+void floatToHalfNeon(const float* values, std::size_t count,
+                     std::uint16_t* results) {
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto halves = vcvt_f16_f32(vld1q_f32(values + i));
+    vst1_u16(results + i, vreinterpret_u16_f16(halves));
+  }
+  floatToHalfScalar(values + i, count - i, results + i);
+}
+
+void halfToFloatNeon(const std::uint16_t* halves, std::size_t count,
+                     float* results) {
+  std::size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto h = vreinterpret_f16_u16(vld1_u16(halves + i));
+    vst1q_f32(results + i, vcvt_f32_f16(h));
+  }
+  halfToFloatScalar(halves + i, count - i, results + i);
+}
+#endif
+
+HalfKernels selectHalfKernels() {
+#if defined(TEMP_MATH_PACKING_X86)
+  auto&& features = GetCpuFeatures();
+  if (features.avx512f) {
+    return HalfKernels{floatToHalfAvx512, halfToFloatAvx512};
+  }
+  if (features.f16c) {
+    return HalfKernels{floatToHalfF16c, halfToFloatF16c};
+  }
+#endif
+#if defined(TEMP_MATH_SIMD_NEON) && defined(__aarch64__)
+  return HalfKernels{floatToHalfNeon, halfToFloatNeon};
+#else
+  return HalfKernels{floatToHalfScalar, halfToFloatScalar};
+#endif
+}
+
+const HalfKernels& halfKernels() {
+  static const HalfKernels kernels = selectHalfKernels();
+  return kernels;
+}
+
+float signNotZero(float v) { return v >= 0.0f ? 1.0f : -1.0f; }
+
+// Octahedral mapping before quantization, |u| + |v| <= 1
+void octahedralEncode(const Vector3& n, float* u, float* v) {
+  float inv = 1.0f / (std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()));
+  float x = n.x() * inv;
+  float y = n.y() * inv;
+  if (n.z() < 0.0f) {
+    // 下半球は対角線で折り返す
+    *u = (1.0f - std::abs(y)) * signNotZero(x);
+    *v = (1.0f - std::abs(x)) * signNotZero(y);
+  } else {
+    *u = x;
+    *v = y;
+  }
+}
+
+Vector3 octahedralDecode(float u, float v) {
+  float z = 1.0f - std::abs(u) - std::abs(v);
+  float t = std::max(-z, 0.0f);
+  Vector3 n(u + (u >= 0.0f ? -t : t), v + (v >= 0.0f ? -t : t), z);
+  return n / std::sqrt(n.x() * n.x() + n.y() * n.y() + n.z() * n.z());
+}
+
+// Bit layout of the smallest-three encodings
+template <class Packed>
+struct QuaternionLayout;
+
+template <>
+struct QuaternionLayout<PackedQuaternion32> {
+  static constexpr int kBits = 10;
+  static PackedQuaternion32 pack(std::uint32_t index,
+                                 const std::uint32_t* values) {
+    return PackedQuaternion32{index << 30 | values[0] << 20 | values[1] << 10 |
+                              values[2]};
+  }
+  static std::uint32_t unpack(const PackedQuaternion32& packed,
+                              std::uint32_t* values) {
+    values[0] = (packed.bits >> 20) & 0x3ff;
+    values[1] = (packed.bits >> 10) & 0x3ff;
+    values[2] = packed.bits & 0x3ff;
+    return packed.bits >> 30;
+  }
+};
+
+template <>
+struct QuaternionLayout<PackedQuaternion48> {
+  static constexpr int kBits = 15;
+  // インデックスは先頭2語の最上位ビットに入れる
+  static PackedQuaternion48 pack(std::uint32_t index,
+                                 const std::uint32_t* values) {
+    return PackedQuaternion48{
+        {static_cast<std::uint16_t>((index >> 1) << 15 | values[0]),
+         static_cast<std::uint16_t>((index & 1) << 15 | values[1]),
+         static_cast<std::uint16_t>(values[2])}};
+  }
+  static std::uint32_t unpack(const PackedQuaternion48& packed,
+                              std::uint32_t* values) {
+    values[0] = packed.bits[0] & 0x7fffu;
+    values[1] = packed.bits[1] & 0x7fffu;
+    values[2] = packed.bits[2] & 0x7fffu;
+    return (packed.bits[0] >> 15) << 1 | packed.bits[1] >> 15;
+  }
+};
+
+template <>
+struct QuaternionLayout<PackedQuaternion64> {
+  static constexpr int kBits = 20;
+  static PackedQuaternion64 pack(std::uint32_t index,
+                                 const std::uint32_t* values) {
+    return PackedQuaternion64{(std::uint64_t)index << 62 |
+                              (std::uint64_t)values[0] << 40 |
+                              (std::uint64_t)values[1] << 20 | values[2]};
+  }
+  static std::uint32_t unpack(const PackedQuaternion64& packed,
+                              std::uint32_t* values) {
+    values[0] = (std::uint32_t)(packed.bits >> 40) & 0xfffff;
+    values[1] = (std::uint32_t)(packed.bits >> 20) & 0xfffff;
+    values[2] = (std::uint32_t)packed.bits & 0xfffff;
+    return (std::uint32_t)(packed.bits >> 62);
+  }
+};
+
+template <class Packed>
+constexpr float quantizedMax() {
+  return (float)((1u << QuaternionLayout<Packed>::kBits) - 1);
+}
+
+// Component in [-1/sqrt(2), 1/sqrt(2)] to [0, quantizedMax]
+template <class Packed>
+float quantize(float v) {
+  float t = v * kInvSqrt2 + 0.5f;
+  return std::nearbyint(std::min(std::max(t, 0.0f), 1.0f) *
+                        quantizedMax<Packed>());
+}
+
+template <class Packed>
+float dequantize(std::uint32_t v) {
+  constexpr float kScale = 2.0f * kInvSqrt2 / quantizedMax<Packed>();
+  return (float)v * kScale - kInvSqrt2;
+}
+
+template <class Packed>
+Packed packQuaternion(const Quaternion& q) {
+  float c[4] = {q.x(), q.y(), q.z(), q.w()};
+  std::uint32_t index = 0;
+  for (std::uint32_t i = 1; i < 4; ++i) {
+    if (std::abs(c[i]) > std::abs(c[index])) {
+      index = i;
+    }
+  }
+  // 落とす成分が正になるように符号をそろえる
+  float sign = c[index] < 0.0f ? -1.0f : 1.0f;
+  std::uint32_t values[3];
+  for (std::uint32_t i = 0, j = 0; i < 4; ++i) {
+    if (i != index) {
+      values[j++] = (std::uint32_t)quantize<Packed>(c[i] * sign);
+    }
+  }
+  return QuaternionLayout<Packed>::pack(index, values);
+}
+
+Quaternion placeLargest(std::uint32_t index, float a, float b, float c) {
+  float d = std::sqrt(std::max(1.0f - a * a - b * b - c * c, 0.0f));
+  switch (index) {
+    case 0:
+      return Quaternion(d, a, b, c);
+    case 1:
+      return Quaternion(a, d, b, c);
+    case 2:
+      return Quaternion(a, b, d, c);
+    default:
+      return Quaternion(a, b, c, d);
+  }
+}
+
+template <class Packed>
+Quaternion unpackQuaternion(const Packed& packed) {
+  std::uint32_t values[3];
+  auto index = QuaternionLayout<Packed>::unpack(packed, values);
+  return placeLargest(index, dequantize<Packed>(values[0]),
+                      dequantize<Packed>(values[1]),
+                      dequantize<Packed>(values[2]));
+}
+
+template <class Packed>
+void packQuaternions(const Quaternion* quats, std::size_t count,
+                     Packed* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  // 最大成分の選択と量子化をレーンごとに行い、ビットの詰め込みだけ逐次行う
+  alignas(64) float indices[kWideLanes];
+  alignas(64) float values[3][kWideLanes];
+  const WideFloat kZero(0.0f);
+  const WideFloat kOne(1.0f);
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    auto q = WideQuaternion::load(quats + i);
+    const WideFloat c[4] = {q.x(), q.y(), q.z(), q.w()};
+    WideFloat index = kZero;
+    WideFloat largest = abs(c[0]);
+    WideFloat value = c[0];
+    for (int k = 1; k < 4; ++k) {
+      auto a = abs(c[k]);
+      auto m = a > largest;
+      index = select(m, WideFloat((float)k), index);
+      largest = select(m, a, largest);
+      value = select(m, c[k], value);
+    }
+    auto sign = select(value < kZero, -kOne, kOne);
+    const WideFloat others[3] = {
+        select(index == kZero, c[1], c[0]),
+        select(index <= kOne, c[2], c[1]),
+        select(index <= WideFloat(2.0f), c[3], c[2]),
+    };
+    index.store(indices);
+    for (int k = 0; k < 3; ++k) {
+      auto t = others[k] * sign * WideFloat(kInvSqrt2) + WideFloat(0.5f);
+      t = min(max(t, kZero), kOne) * WideFloat(quantizedMax<Packed>());
+      round(t).store(values[k]);
+    }
+    for (std::size_t j = 0; j < kWideLanes; ++j) {
+      const std::uint32_t v[3] = {(std::uint32_t)values[0][j],
+                                  (std::uint32_t)values[1][j],
+                                  (std::uint32_t)values[2][j]};
+      results[i + j] =
+          QuaternionLayout<Packed>::pack((std::uint32_t)indices[j], v);
+    }
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = packQuaternion<Packed>(quats[i]);
+  }
+}
+
+template <class Packed>
+void unpackQuaternions(const Packed* packed, std::size_t count,
+                       Quaternion* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  alignas(64) float indices[kWideLanes];
+  alignas(64) float values[3][kWideLanes];
+  const WideFloat kZero(0.0f);
+  const WideFloat kScale(2.0f * kInvSqrt2 / quantizedMax<Packed>());
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    for (std::size_t j = 0; j < kWideLanes; ++j) {
+      std::uint32_t v[3];
+      indices[j] = (float)QuaternionLayout<Packed>::unpack(packed[i + j], v);
+      values[0][j] = (float)v[0];
+      values[1][j] = (float)v[1];
+      values[2][j] = (float)v[2];
+    }
+    auto index = WideFloat::load(indices);
+    auto a = WideFloat::load(values[0]) * kScale - WideFloat(kInvSqrt2);
+    auto b = WideFloat::load(values[1]) * kScale - WideFloat(kInvSqrt2);
+    auto c = WideFloat::load(values[2]) * kScale - WideFloat(kInvSqrt2);
+    auto d = sqrt(max(WideFloat(1.0f) - a * a - b * b - c * c, kZero));
+    auto is0 = index == kZero;
+    auto is1 = index == WideFloat(1.0f);
+    auto is2 = index == WideFloat(2.0f);
+    auto is3 = index == WideFloat(3.0f);
+    WideQuaternion(select(is0, d, a), select(is0, a, select(is1, d, b)),
+                   select(is3, c, select(is2, d, b)), select(is3, d, c))
+        .store(results + i);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = unpackQuaternion(packed[i]);
+  }
+}
+
+}  // namespace
+
+std::uint16_t floatToHalf(float value) {
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  auto sign = (bits >> 16) & 0x8000u;
+  auto abs_bits = bits & 0x7fffffffu;
+
+  if (abs_bits >= 0x7f800000u) {
+    // 無限大とNaN
+    auto nan = abs_bits > 0x7f800000u ? 0x200u : 0u;
+    return (std::uint16_t)(sign | 0x7c00u | nan);
+  }
+  if (abs_bits >= 0x477ff000u) {
+    // 65520以上は丸めると無限大
+    return (std::uint16_t)(sign | 0x7c00u);
+  }
+  if (abs_bits < 0x38800000u) {
+    // halfの非正規化数。0.5を足すと仮数部の下位ビットに丸めた値が残る
+    float abs_value;
+    std::memcpy(&abs_value, &abs_bits, sizeof(abs_value));
+    abs_value += 0.5f;
+    std::memcpy(&abs_bits, &abs_value, sizeof(abs_bits));
+    return (std::uint16_t)(sign | (abs_bits - 0x3f000000u));
+  }
+  // 指数のバイアスを付け替え、仮数部を最近接偶数に丸める
+  auto odd = (abs_bits >> 13) & 1u;
+  abs_bits += 0xc8000fffu + odd;
+  return (std::uint16_t)(sign | (abs_bits >> 13));
+}
+
+float halfToFloat(std::uint16_t half) {
+  auto sign = (std::uint32_t)(half & 0x8000u) << 16;
+  auto bits = (std::uint32_t)(half & 0x7fffu) << 13;
+  auto exponent = bits & 0x0f800000u;
+  bits += (127 - 15) << 23;
+  float value;
+  if (exponent == 0x0f800000u) {
+    // 無限大とNaN
+    bits += (128 - 16) << 23;
+    std::memcpy(&value, &bits, sizeof(value));
+  } else if (exponent == 0) {
+    // 非正規化数は指数を1足してから2^-14を引く
+    bits += 1 << 23;
+    std::memcpy(&value, &bits, sizeof(value));
+    value -= 6.103515625e-05f;
+  } else {
+    std::memcpy(&value, &bits, sizeof(value));
+  }
+  std::uint32_t result;
+  std::memcpy(&result, &value, sizeof(result));
+  result |= sign;
+  std::memcpy(&value, &result, sizeof(value));
+  return value;
+}
+
+Half2 packHalf(const Vector2& v) {
+  return Half2{floatToHalf(v.x()), floatToHalf(v.y())};
+}
+
+Half3 packHalf(const Vector3& v) {
+  return Half3{floatToHalf(v.x()), floatToHalf(v.y()), floatToHalf(v.z())};
+}
+
+Half4 packHalf(const Vector4& v) {
+  return Half4{floatToHalf(v.x()), floatToHalf(v.y()), floatToHalf(v.z()),
+               floatToHalf(v.w())};
+}
+
+Vector2 unpackHalf(const Half2& h) {
+  return Vector2(halfToFloat(h.x), halfToFloat(h.y));
+}
+
+Vector3 unpackHalf(const Half3& h) {
+  return Vector3(halfToFloat(h.x), halfToFloat(h.y), halfToFloat(h.z));
+}
+
+Vector4 unpackHalf(const Half4& h) {
+  return Vector4(halfToFloat(h.x), halfToFloat(h.y), halfToFloat(h.z),
+                 halfToFloat(h.w));
+}
+
+std::int16_t floatToSnorm16(float value) {
+  auto clamped = std::min(std::max(value, -1.0f), 1.0f);
+  return (std::int16_t)std::nearbyint(clamped * kSnorm16Max);
+}
+
+float snorm16ToFloat(std::int16_t snorm) {
+  // -32768 も -1 になる
+  return std::max((float)snorm * (1.0f / kSnorm16Max), -1.0f);
+}
+
+Snorm16x2 packSnorm16(const Vector2& v) {
+  return Snorm16x2{floatToSnorm16(v.x()), floatToSnorm16(v.y())};
+}
+
+Snorm16x3 packSnorm16(const Vector3& v) {
+  return Snorm16x3{floatToSnorm16(v.x()), floatToSnorm16(v.y()),
+                   floatToSnorm16(v.z())};
+}
+
+Snorm16x4 packSnorm16(const Vector4& v) {
+  return Snorm16x4{floatToSnorm16(v.x()), floatToSnorm16(v.y()),
+                   floatToSnorm16(v.z()), floatToSnorm16(v.w())};
+}
+
+Vector2 unpackSnorm16(const Snorm16x2& s) {
+  return Vector2(snorm16ToFloat(s.x), snorm16ToFloat(s.y));
+}
+
+Vector3 unpackSnorm16(const Snorm16x3& s) {
+  return Vector3(snorm16ToFloat(s.x), snorm16ToFloat(s.y),
+                 snorm16ToFloat(s.z));
+}
+
+Vector4 unpackSnorm16(const Snorm16x4& s) {
+  return Vector4(snorm16ToFloat(s.x), snorm16ToFloat(s.y),
+                 snorm16ToFloat(s.z), snorm16ToFloat(s.w));
+}
+
+Snorm16x2 packOctahedral(const Vector3& normal) {
+  float u, v;
+  octahedralEncode(normal, &u, &v);
+  return Snorm16x2{floatToSnorm16(u), floatToSnorm16(v)};
+}
+
+Vector3 unpackOctahedral(const Snorm16x2& encoded) {
+  return octahedralDecode(snorm16ToFloat(encoded.x),
+                          snorm16ToFloat(encoded.y));
+}
+
+PackedQuaternion32 packQuaternion32(const Quaternion& q) {
+  return packQuaternion<PackedQuaternion32>(q);
+}
+
+PackedQuaternion48 packQuaternion48(const Quaternion& q) {
+  return packQuaternion<PackedQuaternion48>(q);
+}
+
+PackedQuaternion64 packQuaternion64(const Quaternion& q) {
+  return packQuaternion<PackedQuaternion64>(q);
+}
+
+Quaternion unpackQuaternion(const PackedQuaternion32& packed) {
+  return unpackQuaternion<PackedQuaternion32>(packed);
+}
+
+Quaternion unpackQuaternion(const PackedQuaternion48& packed) {
+  return unpackQuaternion<PackedQuaternion48>(packed);
+}
+
+Quaternion unpackQuaternion(const PackedQuaternion64& packed) {
+  return unpackQuaternion<PackedQuaternion64>(packed);
+}
+
+void floatToHalf(const float* values, std::size_t count,
+                 std::uint16_t* results) {
+  halfKernels().float_to_half(values, count, results);
+}
+
+void halfToFloat(const std::uint16_t* halves, std::size_t count,
+                 float* results) {
+  halfKernels().half_to_float(halves, count, results);
+}
+
+void packHalf(const Vector2* vectors, std::size_t count, Half2* results) {
+  floatToHalf(reinterpret_cast<const float*>(vectors), count * 2,
+              reinterpret_cast<std::uint16_t*>(results));
+}
+
+void packHalf(const Vector3* vectors, std::size_t count, Half3* results) {
+  floatToHalf(reinterpret_cast<const float*>(vectors), count * 3,
+              reinterpret_cast<std::uint16_t*>(results));
+}
+
+void packHalf(const Vector4* vectors, std::size_t count, Half4* results) {
+  floatToHalf(reinterpret_cast<const float*>(vectors), count * 4,
+              reinterpret_cast<std::uint16_t*>(results));
+}
+
+void unpackHalf(const Half2* halves, std::size_t count, Vector2* results) {
+  halfToFloat(reinterpret_cast<const std::uint16_t*>(halves), count * 2,
+              reinterpret_cast<float*>(results));
+}
+
+void unpackHalf(const Half3* halves, std::size_t count, Vector3* results) {
+  halfToFloat(reinterpret_cast<const std::uint16_t*>(halves), count * 3,
+              reinterpret_cast<float*>(results));
+}
+
+void unpackHalf(const Half4* halves, std::size_t count, Vector4* results) {
+  halfToFloat(reinterpret_cast<const std::uint16_t*>(halves), count * 4,
+              reinterpret_cast<float*>(results));
+}
+
+void floatToSnorm16(const float* values, std::size_t count,
+                    std::int16_t* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  const auto kMin = _mm_set1_ps(-1.0f);
+  const auto kMax = _mm_set1_ps(1.0f);
+  const auto kScale = _mm_set1_ps(kSnorm16Max);
+  for (; i + 8 <= count; i += 8) {
+    auto lo = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i), kMin), kMax);
+    auto hi = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(values + i + 4), kMin), kMax);
+    auto packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, kScale)),
+                                  _mm_cvtps_epi32(_mm_mul_ps(hi, kScale)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), packed);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = floatToSnorm16(values[i]);
+  }
+}
+
+void snorm16ToFloat(const std::int16_t* snorms, std::size_t count,
+                    float* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD_SSE)
+  const auto kMin = _mm_set1_ps(-1.0f);
+  const auto kScale = _mm_set1_ps(1.0f / kSnorm16Max);
+  for (; i + 8 <= count; i += 8) {
+    auto s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(snorms + i));
+    // 符号拡張: 上位16ビットに置いてから算術シフトする
+    auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+    auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+    _mm_storeu_ps(results + i,
+                  _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(lo), kScale), kMin));
+    _mm_storeu_ps(results + i + 4,
+                  _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(hi), kScale), kMin));
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = snorm16ToFloat(snorms[i]);
+  }
+}
+
+void packSnorm16(const Vector2* vectors, std::size_t count,
+                 Snorm16x2* results) {
+  floatToSnorm16(reinterpret_cast<const float*>(vectors), count * 2,
+                 reinterpret_cast<std::int16_t*>(results));
+}
+
+void packSnorm16(const Vector3* vectors, std::size_t count,
+                 Snorm16x3* results) {
+  floatToSnorm16(reinterpret_cast<const float*>(vectors), count * 3,
+                 reinterpret_cast<std::int16_t*>(results));
+}
+
+void packSnorm16(const Vector4* vectors, std::size_t count,
+                 Snorm16x4* results) {
+  floatToSnorm16(reinterpret_cast<const float*>(vectors), count * 4,
+                 reinterpret_cast<std::int16_t*>(results));
+}
+
+void unpackSnorm16(const Snorm16x2* snorms, std::size_t count,
+                   Vector2* results) {
+  snorm16ToFloat(reinterpret_cast<const std::int16_t*>(snorms), count * 2,
+                 reinterpret_cast<float*>(results));
+}
+
+void unpackSnorm16(const Snorm16x3* snorms, std::size_t count,
+                   Vector3* results) {
+  snorm16ToFloat(reinterpret_cast<const std::int16_t*>(snorms), count * 3,
+                 reinterpret_cast<float*>(results));
+}
+
+void unpackSnorm16(const Snorm16x4* snorms, std::size_t count,
+                   Vector4* results) {
+  snorm16ToFloat(reinterpret_cast<const std::int16_t*>(snorms), count * 4,
+                 reinterpret_cast<float*>(results));
+}
+
+void packOctahedral(const Vector3* normals, std::size_t count,
+                    Snorm16x2* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  // レーンごとに写像し、u, v を交互に並べてから量子化する
+  alignas(64) float us[kWideLanes];
+  alignas(64) float vs[kWideLanes];
+  float uvs[kWideLanes * 2];
+  const WideFloat kZero(0.0f);
+  const WideFloat kOne(1.0f);
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    auto n = WideVector3::load(normals + i);
+    auto inv = kOne / (abs(n.x()) + abs(n.y()) + abs(n.z()));
+    auto x = n.x() * inv;
+    auto y = n.y() * inv;
+    auto lower = n.z() < kZero;
+    auto folded_x = (kOne - abs(y)) * select(x >= kZero, kOne, -kOne);
+    auto folded_y = (kOne - abs(x)) * select(y >= kZero, kOne, -kOne);
+    select(lower, folded_x, x).store(us);
+    select(lower, folded_y, y).store(vs);
+    for (std::size_t j = 0; j < kWideLanes; ++j) {
+      uvs[j * 2] = us[j];
+      uvs[j * 2 + 1] = vs[j];
+    }
+    floatToSnorm16(uvs, kWideLanes * 2,
+                   reinterpret_cast<std::int16_t*>(results + i));
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = packOctahedral(normals[i]);
+  }
+}
+
+void unpackOctahedral(const Snorm16x2* encoded, std::size_t count,
+                      Vector3* results) {
+  std::size_t i = 0;
+#if defined(TEMP_MATH_SIMD)
+  float uvs[kWideLanes * 2];
+  alignas(64) float us[kWideLanes];
+  alignas(64) float vs[kWideLanes];
+  const WideFloat kZero(0.0f);
+  for (; i + kWideLanes <= count; i += kWideLanes) {
+    snorm16ToFloat(reinterpret_cast<const std::int16_t*>(encoded + i),
+                   kWideLanes * 2, uvs);
+    for (std::size_t j = 0; j < kWideLanes; ++j) {
+      us[j] = uvs[j * 2];
+      vs[j] = uvs[j * 2 + 1];
+    }
+    auto u = WideFloat::load(us);
+    auto v = WideFloat::load(vs);
+    auto z = WideFloat(1.0f) - abs(u) - abs(v);
+    auto t = max(-z, kZero);
+    auto x = u + select(u >= kZero, -t, t);
+    auto y = v + select(v >= kZero, -t, t);
+    normalize(WideVector3(x, y, z)).store(results + i);
+  }
+#endif
+  for (; i < count; ++i) {
+    results[i] = unpackOctahedral(encoded[i]);
+  }
+}
+
+void packQuaternion32(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion32* results) {
+  packQuaternions(quats, count, results);
+}
+
+void packQuaternion48(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion48* results) {
+  packQuaternions(quats, count, results);
+}
+
+void packQuaternion64(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion64* results) {
+  packQuaternions(quats, count, results);
+}
+
+void unpackQuaternion(const PackedQuaternion32* packed, std::size_t count,
+                      Quaternion* results) {
+  unpackQuaternions(packed, count, results);
+}
+
+void unpackQuaternion(const PackedQuaternion48* packed, std::size_t count,
+                      Quaternion* results) {
+  unpackQuaternions(packed, count, results);
+}
+
+void unpackQuaternion(const PackedQuaternion64* packed, std::size_t count,
+                      Quaternion* results) {
+  unpackQuaternions(packed, count, results);
+}
+
+}  // namespace math
+}  // namespace temp
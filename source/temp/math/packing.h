@@ -0,0 +1,187 @@
+﻿/**
+ * @file packing.h
+ * @brief Compact encodings of vectors, normals and rotations
+ *
+ * IEEE half floats and 16 bit signed normalized values halve the size of
+ * float vectors, octahedral encoding stores a unit vector in 4 bytes, and
+ * smallest-three compression stores a rotation in 4, 6 or 8 bytes.
+ *
+ * The array versions produce the same results as the single value ones.
+ * Half conversion uses F16C or AVX-512 when the running CPU supports it.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "temp/math/matrix44.h"  // quaternion.h は単体でインクルードできない
+#include "temp/math/quaternion.h"
+#include "temp/math/vector2.h"
+#include "temp/math/vector3.h"
+#include "temp/math/vector4.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+struct Half2 {
+  std::uint16_t x, y;
+};
+
+struct Half3 {
+  std::uint16_t x, y, z;
+};
+
+struct Half4 {
+  std::uint16_t x, y, z, w;
+};
+
+/// Value v in [-1, 1] stored as round(v * 32767)
+struct Snorm16x2 {
+  std::int16_t x, y;
+};
+
+struct Snorm16x3 {
+  std::int16_t x, y, z;
+};
+
+struct Snorm16x4 {
+  std::int16_t x, y, z, w;
+};
+
+/// Smallest-three quaternion: 2 bit index and 3 x 10 bits
+struct PackedQuaternion32 {
+  std::uint32_t bits;
+};
+
+/// Smallest-three quaternion: 2 bit index and 3 x 15 bits
+struct PackedQuaternion48 {
+  std::uint16_t bits[3];
+};
+
+/// Smallest-three quaternion: 2 bit index and 3 x 20 bits
+struct PackedQuaternion64 {
+  std::uint64_t bits;
+};
+
+/**
+ * @brief Convert float to IEEE half, rounding to nearest even
+ *
+ * Values too large for half become infinity.
+ */
+std::uint16_t floatToHalf(float value);
+
+float halfToFloat(std::uint16_t half);
+
+Half2 packHalf(const Vector2& v);
+Half3 packHalf(const Vector3& v);
+Half4 packHalf(const Vector4& v);
+Vector2 unpackHalf(const Half2& h);
+Vector3 unpackHalf(const Half3& h);
+Vector4 unpackHalf(const Half4& h);
+
+/**
+ * @brief Convert float to snorm16, clamping to [-1, 1]
+ */
+std::int16_t floatToSnorm16(float value);
+
+float snorm16ToFloat(std::int16_t snorm);
+
+Snorm16x2 packSnorm16(const Vector2& v);
+Snorm16x3 packSnorm16(const Vector3& v);
+Snorm16x4 packSnorm16(const Vector4& v);
+Vector2 unpackSnorm16(const Snorm16x2& s);
+Vector3 unpackSnorm16(const Snorm16x3& s);
+Vector4 unpackSnorm16(const Snorm16x4& s);
+
+/**
+ * @brief Encode unit vector by octahedral mapping
+ *
+ * The angular error of the round trip is below 0.005 degrees.
+ *
+ * @param normal non zero vector, need not be normalized
+ */
+Snorm16x2 packOctahedral(const Vector3& normal);
+
+/**
+ * @brief Decode octahedral encoding to unit vector
+ */
+Vector3 unpackOctahedral(const Snorm16x2& encoded);
+
+/**
+ * @brief Compress unit quaternion by dropping its largest component
+ *
+ * The remaining components lie in [-1/sqrt(2), 1/sqrt(2)] and are quantized
+ * uniformly. The sign is chosen so that the dropped component is positive,
+ * so unpacking may return -q, which is the same rotation.
+ *
+ * Max component error: 2e-3 (32 bit), 6e-5 (48 bit), 2e-6 (64 bit).
+ */
+PackedQuaternion32 packQuaternion32(const Quaternion& q);
+PackedQuaternion48 packQuaternion48(const Quaternion& q);
+PackedQuaternion64 packQuaternion64(const Quaternion& q);
+Quaternion unpackQuaternion(const PackedQuaternion32& packed);
+Quaternion unpackQuaternion(const PackedQuaternion48& packed);
+Quaternion unpackQuaternion(const PackedQuaternion64& packed);
+
+/**
+ * @brief Convert array of floats to halves
+ *
+ * @param values source values
+ * @param count count of values
+ * @param results destination of halves
+ */
+void floatToHalf(const float* values, std::size_t count,
+                 std::uint16_t* results);
+
+void halfToFloat(const std::uint16_t* halves, std::size_t count,
+                 float* results);
+
+void packHalf(const Vector2* vectors, std::size_t count, Half2* results);
+void packHalf(const Vector3* vectors, std::size_t count, Half3* results);
+void packHalf(const Vector4* vectors, std::size_t count, Half4* results);
+void unpackHalf(const Half2* halves, std::size_t count, Vector2* results);
+void unpackHalf(const Half3* halves, std::size_t count, Vector3* results);
+void unpackHalf(const Half4* halves, std::size_t count, Vector4* results);
+
+void floatToSnorm16(const float* values, std::size_t count,
+                    std::int16_t* results);
+
+void snorm16ToFloat(const std::int16_t* snorms, std::size_t count,
+                    float* results);
+
+void packSnorm16(const Vector2* vectors, std::size_t count,
+                 Snorm16x2* results);
+void packSnorm16(const Vector3* vectors, std::size_t count,
+                 Snorm16x3* results);
+void packSnorm16(const Vector4* vectors, std::size_t count,
+                 Snorm16x4* results);
+void unpackSnorm16(const Snorm16x2* snorms, std::size_t count,
+                   Vector2* results);
+void unpackSnorm16(const Snorm16x3* snorms, std::size_t count,
+                   Vector3* results);
+void unpackSnorm16(const Snorm16x4* snorms, std::size_t count,
+                   Vector4* results);
+
+void packOctahedral(const Vector3* normals, std::size_t count,
+                    Snorm16x2* results);
+void unpackOctahedral(const Snorm16x2* encoded, std::size_t count,
+                      Vector3* results);
+
+void packQuaternion32(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion32* results);
+void packQuaternion48(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion48* results);
+void packQuaternion64(const Quaternion* quats, std::size_t count,
+                      PackedQuaternion64* results);
+void unpackQuaternion(const PackedQuaternion32* packed, std::size_t count,
+                      Quaternion* results);
+void unpackQuaternion(const PackedQuaternion48* packed, std::size_t count,
+                      Quaternion* results);
+void unpackQuaternion(const PackedQuaternion64* packed, std::size_t count,
+                      Quaternion* results);
+
+}  // namespace math
+}  // namespace temp
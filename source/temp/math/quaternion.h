@@ -31,8 +31,8 @@ class QuaternionBase {
 
   static QuaternionBase axisAngle(const Vector3Base<T>& axis, T degree);
 
-  QuaternionBase();
-  explicit QuaternionBase(T x, T y, T z, T w);
+  constexpr QuaternionBase();
+  constexpr explicit QuaternionBase(T x, T y, T z, T w);
 
   QuaternionBase(const QuaternionBase&) = default;
   QuaternionBase& operator=(const QuaternionBase&) = default;
@@ -44,25 +44,25 @@ class QuaternionBase {
 
   std::string toString() const;
 
-  T& operator[](std::size_t index);
-  T operator[](std::size_t index) const;
-
-  T& x();
-  T x() const;
-  T& y();
-  T y() const;
-  T& z();
-  T z() const;
-  T& w();
-  T w() const;
-
-  bool operator==(const QuaternionBase& rhs) const;
-  bool operator!=(const QuaternionBase& rhs) const;
-  QuaternionBase operator+() const;
-  QuaternionBase operator-() const;
-  QuaternionBase& operator*=(T rhs);
-  QuaternionBase& operator*=(const QuaternionBase& rhs);
-  QuaternionBase& operator/=(T rhs);
+  constexpr T& operator[](std::size_t index);
+  constexpr T operator[](std::size_t index) const;
+
+  constexpr T& x();
+  constexpr T x() const;
+  constexpr T& y();
+  constexpr T y() const;
+  constexpr T& z();
+  constexpr T z() const;
+  constexpr T& w();
+  constexpr T w() const;
+
+  constexpr bool operator==(const QuaternionBase& rhs) const;
+  constexpr bool operator!=(const QuaternionBase& rhs) const;
+  constexpr QuaternionBase operator+() const;
+  constexpr QuaternionBase operator-() const;
+  constexpr QuaternionBase& operator*=(T rhs);
+  constexpr QuaternionBase& operator*=(const QuaternionBase& rhs);
+  constexpr QuaternionBase& operator/=(T rhs);
 
  private:
   std::array<T, 4> elements_;
@@ -72,8 +72,8 @@ using Quaternion = QuaternionBase<float>;
 using Quaternion_64b = QuaternionBase<double>;
 
 template <class T>
-const QuaternionBase<T> QuaternionBase<T>::kIdentity = QuaternionBase<T>(0, 0,
-                                                                         0, 1);
+constexpr QuaternionBase<T> QuaternionBase<T>::kIdentity =
+    QuaternionBase<T>(0, 0, 0, 1);
 
 //----------------------------------------
 // implementation
@@ -89,15 +89,12 @@ QuaternionBase<T> QuaternionBase<T>::axisAngle(const Vector3Base<T>& axis,
 }
 
 template <class T>
-QuaternionBase<T>::QuaternionBase() : QuaternionBase((T)0, (T)0, (T)0, (T)0) {}
+constexpr QuaternionBase<T>::QuaternionBase()
+    : QuaternionBase((T)0, (T)0, (T)0, (T)0) {}
 
 template <class T>
-QuaternionBase<T>::QuaternionBase(T x, T y, T z, T w) {
-  elements_[0] = x;
-  elements_[1] = y;
-  elements_[2] = z;
-  elements_[3] = w;
-}
+constexpr QuaternionBase<T>::QuaternionBase(T x, T y, T z, T w)
+    : elements_{x, y, z, w} {}
 
 template <class T>
 typename QuaternionBase<T>::iterator QuaternionBase<T>::begin() {
@@ -117,72 +114,74 @@ std::string QuaternionBase<T>::toString() const {
 }
 
 template <class T>
-T& QuaternionBase<T>::operator[](std::size_t index) {
+constexpr T& QuaternionBase<T>::operator[](std::size_t index) {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return elements_[index];
 }
 
 template <class T>
-T QuaternionBase<T>::operator[](std::size_t index) const {
+constexpr T QuaternionBase<T>::operator[](std::size_t index) const {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return elements_[index];
 }
 
 template <class T>
-T& QuaternionBase<T>::x() {
+constexpr T& QuaternionBase<T>::x() {
   return elements_[0];
 }
 template <class T>
-T QuaternionBase<T>::x() const {
+constexpr T QuaternionBase<T>::x() const {
   return elements_[0];
 }
 template <class T>
-T& QuaternionBase<T>::y() {
+constexpr T& QuaternionBase<T>::y() {
   return elements_[1];
 }
 template <class T>
-T QuaternionBase<T>::y() const {
+constexpr T QuaternionBase<T>::y() const {
   return elements_[1];
 }
 template <class T>
-T& QuaternionBase<T>::z() {
+constexpr T& QuaternionBase<T>::z() {
   return elements_[2];
 }
 template <class T>
-T QuaternionBase<T>::z() const {
+constexpr T QuaternionBase<T>::z() const {
   return elements_[2];
 }
 template <class T>
-T& QuaternionBase<T>::w() {
+constexpr T& QuaternionBase<T>::w() {
   return elements_[3];
 }
 template <class T>
-T QuaternionBase<T>::w() const {
+constexpr T QuaternionBase<T>::w() const {
   return elements_[3];
 }
 
 template <class T>
-bool QuaternionBase<T>::operator==(const QuaternionBase<T>& rhs) const {
+constexpr bool QuaternionBase<T>::operator==(
+    const QuaternionBase<T>& rhs) const {
   return x() == rhs.x() && y() == rhs.y() && z() == rhs.z() && w() == rhs.w();
 }
 
 template <class T>
-bool QuaternionBase<T>::operator!=(const QuaternionBase<T>& rhs) const {
+constexpr bool QuaternionBase<T>::operator!=(
+    const QuaternionBase<T>& rhs) const {
   return !(*this == rhs);
 }
 
 template <class T>
-QuaternionBase<T> QuaternionBase<T>::operator+() const {
+constexpr QuaternionBase<T> QuaternionBase<T>::operator+() const {
   return *this;
 }
 
 template <class T>
-QuaternionBase<T> QuaternionBase<T>::operator-() const {
+constexpr QuaternionBase<T> QuaternionBase<T>::operator-() const {
   return QuaternionBase(-x(), -y(), -z(), -w());
 }
 
 template <class T>
-QuaternionBase<T>& QuaternionBase<T>::operator*=(T rhs) {
+constexpr QuaternionBase<T>& QuaternionBase<T>::operator*=(T rhs) {
   x() *= rhs;
   y() *= rhs;
   z() *= rhs;
@@ -191,7 +190,8 @@ QuaternionBase<T>& QuaternionBase<T>::operator*=(T rhs) {
 }
 
 template <class T>
-QuaternionBase<T>& QuaternionBase<T>::operator*=(const QuaternionBase& rhs) {
+constexpr QuaternionBase<T>& QuaternionBase<T>::operator*=(
+    const QuaternionBase& rhs) {
   auto l_w = w();
   auto l_x = x();
   auto l_y = y();
@@ -204,7 +204,7 @@ QuaternionBase<T>& QuaternionBase<T>::operator*=(const QuaternionBase& rhs) {
 }
 
 template <class T>
-QuaternionBase<T>& QuaternionBase<T>::operator/=(T rhs) {
+constexpr QuaternionBase<T>& QuaternionBase<T>::operator/=(T rhs) {
   x() /= rhs;
   y() /= rhs;
   z() /= rhs;
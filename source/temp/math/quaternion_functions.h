@@ -17,17 +17,17 @@ template <class T>
 std::ostream& operator<<(std::ostream& stream, const QuaternionBase<T>& quat);
 
 template <class T>
-QuaternionBase<T> operator*(const QuaternionBase<T>& lhs, T rhs);
+constexpr QuaternionBase<T> operator*(const QuaternionBase<T>& lhs, T rhs);
 
 template <class T>
-QuaternionBase<T> operator*(T lhs, const QuaternionBase<T>& rhs);
+constexpr QuaternionBase<T> operator*(T lhs, const QuaternionBase<T>& rhs);
 
 template <class T>
-QuaternionBase<T> operator*(const QuaternionBase<T>& lhs,
+constexpr QuaternionBase<T> operator*(const QuaternionBase<T>& lhs,
                             const QuaternionBase<T>& rhs);
 
 template <class T>
-QuaternionBase<T> operator/(const QuaternionBase<T>& lhs, T rhs);
+constexpr QuaternionBase<T> operator/(const QuaternionBase<T>& lhs, T rhs);
 
 template <class T>
 T magnitude(const QuaternionBase<T>& q);
@@ -36,7 +36,7 @@ template <class T>
 QuaternionBase<T> normalize(const QuaternionBase<T>& q);
 
 template <class T>
-QuaternionBase<T> conjugated(const QuaternionBase<T>& q);
+constexpr QuaternionBase<T> conjugated(const QuaternionBase<T>& q);
 
 template <class T>
 QuaternionBase<T> inverse(const QuaternionBase<T>& q);
@@ -45,9 +45,39 @@ template <class T>
 Vector3Base<T> eulerAngles(const QuaternionBase<T>& q);
 
 template <class T>
-Vector3Base<T> rotate(const Vector3Base<T>& vec3,
+constexpr Vector3Base<T> rotate(const Vector3Base<T>& vec3,
                       const QuaternionBase<T>& quat);
 
+template <class T>
+constexpr T dot(const QuaternionBase<T>& lhs, const QuaternionBase<T>& rhs);
+
+/**
+ * @brief Normalized linear interpolation along the shorter arc
+ *
+ * Cheap, but the angular velocity is not constant.
+ */
+template <class T>
+QuaternionBase<T> nlerp(const QuaternionBase<T>& lhs,
+                        const QuaternionBase<T>& rhs, T t);
+
+/**
+ * @brief Spherical linear interpolation along the shorter arc
+ *
+ * lhs and rhs must be unit quaternions.
+ */
+template <class T>
+QuaternionBase<T> slerp(const QuaternionBase<T>& lhs,
+                        const QuaternionBase<T>& rhs, T t);
+
+/**
+ * @brief Approximation of slerp by nlerp with a corrected t
+ *
+ * The angle from slerp is within 0.1 degree for unit quaternions.
+ */
+template <class T>
+QuaternionBase<T> slerpFast(const QuaternionBase<T>& lhs,
+                            const QuaternionBase<T>& rhs, T t);
+
 //----------------------------------------
 // implementation
 //----------------------------------------
@@ -58,23 +88,23 @@ std::ostream& operator<<(std::ostream& stream, const QuaternionBase<T>& quat) {
 }
 
 template <class T>
-QuaternionBase<T> operator*(const QuaternionBase<T>& lhs, T rhs) {
+constexpr QuaternionBase<T> operator*(const QuaternionBase<T>& lhs, T rhs) {
   return QuaternionBase<T>(lhs) *= rhs;
 }
 
 template <class T>
-QuaternionBase<T> operator*(T lhs, const QuaternionBase<T>& rhs) {
+constexpr QuaternionBase<T> operator*(T lhs, const QuaternionBase<T>& rhs) {
   return rhs * lhs;
 }
 
 template <class T>
-QuaternionBase<T> operator*(const QuaternionBase<T>& lhs,
+constexpr QuaternionBase<T> operator*(const QuaternionBase<T>& lhs,
                             const QuaternionBase<T>& rhs) {
   return QuaternionBase<T>(lhs) *= rhs;
 }
 
 template <class T>
-QuaternionBase<T> operator/(const QuaternionBase<T>& lhs, T rhs) {
+constexpr QuaternionBase<T> operator/(const QuaternionBase<T>& lhs, T rhs) {
   return QuaternionBase<T>(lhs) /= rhs;
 }
 
@@ -90,7 +120,7 @@ QuaternionBase<T> normalize(const QuaternionBase<T>& q) {
 }
 
 template <class T>
-QuaternionBase<T> conjugated(const QuaternionBase<T>& q) {
+constexpr QuaternionBase<T> conjugated(const QuaternionBase<T>& q) {
   return QuaternionBase<T>(-q.x(), -q.y(), -q.z(), q.w());
 }
 
@@ -147,11 +177,78 @@ Vector3Base<T> eulerAngles(const QuaternionBase<T>& q) {
 }
 
 template <class T>
-Vector3Base<T> rotate(const Vector3Base<T>& vec3,
+constexpr Vector3Base<T> rotate(const Vector3Base<T>& vec3,
                       const QuaternionBase<T>& quat) {
-  QuaternionBase<T> temp(vec3.x(), vec3.y(), vec3.z(), 0);
-  auto result = quat * temp * conjugated(quat);
-  return Vector3Base<T>(result.x(), result.y(), result.z());
+  // quat * vec3 * conjugated(quat) を展開した形
+  // v * (w^2 - u.u) + u * 2(u.v) + (u x v) * 2w
+  // 単位クォータニオンでなくても元の積と同じ結果になる
+  Vector3Base<T> u(quat.x(), quat.y(), quat.z());
+  T w = quat.w();
+  T uv = u.x() * vec3.x() + u.y() * vec3.y() + u.z() * vec3.z();
+  T uu = u.x() * u.x() + u.y() * u.y() + u.z() * u.z();
+  Vector3Base<T> uxv(u.y() * vec3.z() - u.z() * vec3.y(),
+                     u.z() * vec3.x() - u.x() * vec3.z(),
+                     u.x() * vec3.y() - u.y() * vec3.x());
+  T a = w * w - uu;
+  T b = 2 * uv;
+  T c = 2 * w;
+  return Vector3Base<T>(vec3.x() * a + u.x() * b + uxv.x() * c,
+                        vec3.y() * a + u.y() * b + uxv.y() * c,
+                        vec3.z() * a + u.z() * b + uxv.z() * c);
+}
+
+template <class T>
+constexpr T dot(const QuaternionBase<T>& lhs, const QuaternionBase<T>& rhs) {
+  return lhs.x() * rhs.x() + lhs.y() * rhs.y() + lhs.z() * rhs.z() +
+         lhs.w() * rhs.w();
+}
+
+template <class T>
+QuaternionBase<T> nlerp(const QuaternionBase<T>& lhs,
+                        const QuaternionBase<T>& rhs, T t) {
+  // 短い方の弧を通るように符号をそろえる
+  T s = dot(lhs, rhs) < 0 ? -t : t;
+  T r = 1 - t;
+  return normalize(QuaternionBase<T>(
+      lhs.x() * r + rhs.x() * s, lhs.y() * r + rhs.y() * s,
+      lhs.z() * r + rhs.z() * s, lhs.w() * r + rhs.w() * s));
+}
+
+template <class T>
+QuaternionBase<T> slerp(const QuaternionBase<T>& lhs,
+                        const QuaternionBase<T>& rhs, T t) {
+  T d = dot(lhs, rhs);
+  T sign = 1;
+  if (d < 0) {
+    d = -d;
+    sign = -1;
+  }
+
+  // ほぼ同じ向きならsinが0に近づくので線形補間で代用する
+  if (d > (T)0.9995) {
+    return nlerp(lhs, rhs, t);
+  }
+
+  T theta = std::acos(d);
+  T inv_sin = 1 / std::sin(theta);
+  T r = std::sin((1 - t) * theta) * inv_sin;
+  T s = std::sin(t * theta) * inv_sin * sign;
+  return QuaternionBase<T>(
+      lhs.x() * r + rhs.x() * s, lhs.y() * r + rhs.y() * s,
+      lhs.z() * r + rhs.z() * s, lhs.w() * r + rhs.w() * s);
+}
+
+template <class T>
+QuaternionBase<T> slerpFast(const QuaternionBase<T>& lhs,
+                            const QuaternionBase<T>& rhs, T t) {
+  // nlerpの速度の偏りを cos(theta) の多項式で補正する
+  // (http://zeux.io/2015/07/23/approximating-slerp/)
+  T d = std::abs(dot(lhs, rhs));
+  T a = (T)1.0904 + d * ((T)-3.2452 + d * ((T)3.55645 - d * (T)1.43519));
+  T b = (T)0.848013 + d * ((T)-1.06021 + d * (T)0.215638);
+  T k = a * (t - (T)0.5) * (t - (T)0.5) + b;
+  T corrected = t + t * (t - (T)0.5) * (t - 1) * k;
+  return nlerp(lhs, rhs, corrected);
 }
 
 }  // namespace math
@@ -0,0 +1,368 @@
+﻿/**
+ * @file quaternion_wide.h
+ * @brief N quaternions stored one lane per quaternion (AoSoA)
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <array>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/quaternion.h"
+#include "temp/math/vector3_wide.h"
+#include "temp/math/wide.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+template <class T, std::size_t N>
+class QuaternionWide {
+ public:
+  using WideType = Wide<T, N>;
+  using MaskType = MaskWide<T, N>;
+  using ScalarType = QuaternionBase<T>;
+
+  static constexpr std::size_t kWidth = N;
+
+  /**
+   * @brief Load N consecutive quaternions stored as QuaternionBase (AoS)
+   */
+  static QuaternionWide load(const ScalarType* quaternions);
+
+  QuaternionWide();
+  explicit QuaternionWide(const ScalarType& q);
+  explicit QuaternionWide(const WideType& x, const WideType& y,
+                          const WideType& z, const WideType& w);
+
+  QuaternionWide(const QuaternionWide&) = default;
+  QuaternionWide& operator=(const QuaternionWide&) = default;
+  ~QuaternionWide() = default;
+
+ public:
+  /**
+   * @brief Store N quaternions to consecutive QuaternionBase (AoS)
+   */
+  void store(ScalarType* quaternions) const;
+
+  ScalarType lane(std::size_t index) const;
+
+  WideType& x();
+  const WideType& x() const;
+  WideType& y();
+  const WideType& y() const;
+  WideType& z();
+  const WideType& z() const;
+  WideType& w();
+  const WideType& w() const;
+
+  QuaternionWide operator-() const;
+  QuaternionWide& operator*=(const WideType& rhs);
+  QuaternionWide& operator*=(const QuaternionWide& rhs);
+  QuaternionWide& operator/=(const WideType& rhs);
+
+ private:
+  std::array<WideType, 4> elements_;
+};
+
+using Quaternionx4 = QuaternionWide<float, 4>;
+using Quaternionx8 = QuaternionWide<float, 8>;
+using Quaternionx16 = QuaternionWide<float, 16>;
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> operator*(const QuaternionWide<T, N>& lhs,
+                               const QuaternionWide<T, N>& rhs);
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> operator/(const QuaternionWide<T, N>& lhs,
+                               const Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Wide<T, N> dot(const QuaternionWide<T, N>& lhs,
+               const QuaternionWide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Wide<T, N> magnitude(const QuaternionWide<T, N>& q);
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> normalize(const QuaternionWide<T, N>& q);
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> conjugated(const QuaternionWide<T, N>& q);
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> select(const MaskWide<T, N>& mask,
+                            const QuaternionWide<T, N>& a,
+                            const QuaternionWide<T, N>& b);
+
+/**
+ * @brief Lane-wise nlerp, see nlerp(QuaternionBase)
+ */
+template <class T, std::size_t N>
+QuaternionWide<T, N> nlerp(const QuaternionWide<T, N>& lhs,
+                           const QuaternionWide<T, N>& rhs,
+                           const Wide<T, N>& t);
+
+/**
+ * @brief Lane-wise slerpFast, see slerpFast(QuaternionBase)
+ */
+template <class T, std::size_t N>
+QuaternionWide<T, N> slerpFast(const QuaternionWide<T, N>& lhs,
+                               const QuaternionWide<T, N>& rhs,
+                               const Wide<T, N>& t);
+
+/**
+ * @brief Rotate vectors by quaternions, same as q * v * conjugated(q)
+ */
+template <class T, std::size_t N>
+Vector3Wide<T, N> rotate(const Vector3Wide<T, N>& vec3,
+                         const QuaternionWide<T, N>& quat);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T, std::size_t N>
+QuaternionWide<T, N> QuaternionWide<T, N>::load(
+    const ScalarType* quaternions) {
+  alignas(sizeof(T) * N) T lanes[4][N];
+  for (std::size_t i = 0; i < N; ++i) {
+    lanes[0][i] = quaternions[i].x();
+    lanes[1][i] = quaternions[i].y();
+    lanes[2][i] = quaternions[i].z();
+    lanes[3][i] = quaternions[i].w();
+  }
+  return QuaternionWide(WideType::load(lanes[0]), WideType::load(lanes[1]),
+                        WideType::load(lanes[2]), WideType::load(lanes[3]));
+}
+
+#if defined(TEMP_MATH_SIMD)
+// A quaternion fills one 4-wide register, so four of them are a transpose.
+template <>
+inline QuaternionWide<float, 4> QuaternionWide<float, 4>::load(
+    const ScalarType* quaternions) {
+  static_assert(sizeof(ScalarType) == sizeof(float) * 4,
+                "Quaternion must be tightly packed");
+  auto p = reinterpret_cast<const float*>(quaternions);
+  auto x = simd::loadUnaligned(p);
+  auto y = simd::loadUnaligned(p + 4);
+  auto z = simd::loadUnaligned(p + 8);
+  auto w = simd::loadUnaligned(p + 12);
+  simd::transpose(x, y, z, w);
+  return QuaternionWide(WideType(x), WideType(y), WideType(z), WideType(w));
+}
+
+template <>
+inline void QuaternionWide<float, 4>::store(ScalarType* quaternions) const {
+  auto x = elements_[0].reg();
+  auto y = elements_[1].reg();
+  auto z = elements_[2].reg();
+  auto w = elements_[3].reg();
+  simd::transpose(x, y, z, w);
+  auto p = reinterpret_cast<float*>(quaternions);
+  simd::storeUnaligned(p, x);
+  simd::storeUnaligned(p + 4, y);
+  simd::storeUnaligned(p + 8, z);
+  simd::storeUnaligned(p + 12, w);
+}
+#endif
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>::QuaternionWide() : elements_{} {}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>::QuaternionWide(const ScalarType& q)
+    : elements_{WideType(q.x()), WideType(q.y()), WideType(q.z()),
+                WideType(q.w())} {}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>::QuaternionWide(const WideType& x, const WideType& y,
+                                     const WideType& z, const WideType& w)
+    : elements_{x, y, z, w} {}
+
+template <class T, std::size_t N>
+void QuaternionWide<T, N>::store(ScalarType* quaternions) const {
+  alignas(sizeof(T) * N) T lanes[4][N];
+  for (std::size_t e = 0; e < 4; ++e) {
+    elements_[e].store(lanes[e]);
+  }
+  for (std::size_t i = 0; i < N; ++i) {
+    quaternions[i] =
+        ScalarType(lanes[0][i], lanes[1][i], lanes[2][i], lanes[3][i]);
+  }
+}
+
+template <class T, std::size_t N>
+typename QuaternionWide<T, N>::ScalarType QuaternionWide<T, N>::lane(
+    std::size_t index) const {
+  TEMP_ASSERT(index < N, "index must be less than lane count");
+  return ScalarType(x()[index], y()[index], z()[index], w()[index]);
+}
+
+template <class T, std::size_t N>
+typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::x() {
+  return elements_[0];
+}
+
+template <class T, std::size_t N>
+const typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::x()
+    const {
+  return elements_[0];
+}
+
+template <class T, std::size_t N>
+typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::y() {
+  return elements_[1];
+}
+
+template <class T, std::size_t N>
+const typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::y()
+    const {
+  return elements_[1];
+}
+
+template <class T, std::size_t N>
+typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::z() {
+  return elements_[2];
+}
+
+template <class T, std::size_t N>
+const typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::z()
+    const {
+  return elements_[2];
+}
+
+template <class T, std::size_t N>
+typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::w() {
+  return elements_[3];
+}
+
+template <class T, std::size_t N>
+const typename QuaternionWide<T, N>::WideType& QuaternionWide<T, N>::w()
+    const {
+  return elements_[3];
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> QuaternionWide<T, N>::operator-() const {
+  return QuaternionWide(-x(), -y(), -z(), -w());
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>& QuaternionWide<T, N>::operator*=(const WideType& rhs) {
+  for (auto& e : elements_) e *= rhs;
+  return *this;
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>& QuaternionWide<T, N>::operator*=(
+    const QuaternionWide& rhs) {
+  auto l_w = w();
+  auto l_x = x();
+  auto l_y = y();
+  auto l_z = z();
+  w() = l_w * rhs.w() - l_x * rhs.x() - l_y * rhs.y() - l_z * rhs.z();
+  x() = l_x * rhs.w() + l_w * rhs.x() - l_z * rhs.y() + l_y * rhs.z();
+  y() = l_y * rhs.w() + l_z * rhs.x() + l_w * rhs.y() - l_x * rhs.z();
+  z() = l_z * rhs.w() - l_y * rhs.x() + l_x * rhs.y() + l_w * rhs.z();
+  return *this;
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N>& QuaternionWide<T, N>::operator/=(const WideType& rhs) {
+  for (auto& e : elements_) e /= rhs;
+  return *this;
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> operator*(const QuaternionWide<T, N>& lhs,
+                               const QuaternionWide<T, N>& rhs) {
+  return QuaternionWide<T, N>(lhs) *= rhs;
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> operator/(const QuaternionWide<T, N>& lhs,
+                               const Wide<T, N>& rhs) {
+  return QuaternionWide<T, N>(lhs) /= rhs;
+}
+
+template <class T, std::size_t N>
+Wide<T, N> dot(const QuaternionWide<T, N>& lhs,
+               const QuaternionWide<T, N>& rhs) {
+  return madd(lhs.x(), rhs.x(),
+              madd(lhs.y(), rhs.y(),
+                   madd(lhs.z(), rhs.z(), lhs.w() * rhs.w())));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> magnitude(const QuaternionWide<T, N>& q) {
+  return sqrt(dot(q, q));
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> normalize(const QuaternionWide<T, N>& q) {
+  return q / magnitude(q);
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> conjugated(const QuaternionWide<T, N>& q) {
+  return QuaternionWide<T, N>(-q.x(), -q.y(), -q.z(), q.w());
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> select(const MaskWide<T, N>& mask,
+                            const QuaternionWide<T, N>& a,
+                            const QuaternionWide<T, N>& b) {
+  return QuaternionWide<T, N>(
+      select(mask, a.x(), b.x()), select(mask, a.y(), b.y()),
+      select(mask, a.z(), b.z()), select(mask, a.w(), b.w()));
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> nlerp(const QuaternionWide<T, N>& lhs,
+                           const QuaternionWide<T, N>& rhs,
+                           const Wide<T, N>& t) {
+  using WideType = Wide<T, N>;
+  auto s = select(dot(lhs, rhs) < WideType((T)0), -t, t);
+  auto r = WideType((T)1) - t;
+  return normalize(QuaternionWide<T, N>(madd(lhs.x(), r, rhs.x() * s),
+                                        madd(lhs.y(), r, rhs.y() * s),
+                                        madd(lhs.z(), r, rhs.z() * s),
+                                        madd(lhs.w(), r, rhs.w() * s)));
+}
+
+template <class T, std::size_t N>
+QuaternionWide<T, N> slerpFast(const QuaternionWide<T, N>& lhs,
+                               const QuaternionWide<T, N>& rhs,
+                               const Wide<T, N>& t) {
+  using WideType = Wide<T, N>;
+  auto d = dot(lhs, rhs);
+  d = max(d, -d);
+  auto a = madd(d, madd(d, madd(d, WideType((T)-1.43519), WideType((T)3.55645)),
+                        WideType((T)-3.2452)),
+                WideType((T)1.0904));
+  auto b = madd(d, madd(d, WideType((T)0.215638), WideType((T)-1.06021)),
+                WideType((T)0.848013));
+  auto h = t - WideType((T)0.5);
+  auto k = madd(a * h, h, b);
+  auto corrected = madd(t * h * (t - WideType((T)1)), k, t);
+  return nlerp(lhs, rhs, corrected);
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> rotate(const Vector3Wide<T, N>& vec3,
+                         const QuaternionWide<T, N>& quat) {
+  // q * v * q^* expanded, which also holds for non unit quaternions:
+  // v * (w^2 - u.u) + u * 2(u.v) + (u x v) * 2w
+  Vector3Wide<T, N> u(quat.x(), quat.y(), quat.z());
+  const auto& w = quat.w();
+  auto uv = dot(u, vec3);
+  auto uu = dot(u, u);
+  return vec3 * (w * w - uu) + u * (uv + uv) + cross(u, vec3) * (w + w);
+}
+
+}  // namespace math
+}  // namespace temp
@@ -0,0 +1,454 @@
+﻿#include "temp/math/random.h"
+
+#include <algorithm>
+
+#include "temp/base/cpu_feature.h"
+
+#include "temp/math/simd.h"
+#include "temp/math/wide.h"
+
+#if defined(TEMP_MATH_SIMD_SSE)
+#define TEMP_MATH_RANDOM_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TEMP_TARGET_AVX2
+#else
+#define TEMP_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace temp {
+namespace math {
+
+namespace {
+
+// Lane count of the wide type kernels, same as batch.cpp
+#if defined(TEMP_MATH_SIMD_SSE) && defined(__AVX512F__)
+constexpr std::size_t kWideLanes = 16;
+#elif defined(TEMP_MATH_SIMD_SSE) && defined(__AVX__)
+constexpr std::size_t kWideLanes = 8;
+#else
+constexpr std::size_t kWideLanes = 4;
+#endif
+
+using WideFloat = Wide<float, kWideLanes>;
+
+constexpr std::size_t kLanes = Xoshiro256x8::kLanes;
+using LaneStates = std::uint64_t[4][kLanes];
+
+// 一様乱数と、それを変換する乱数の生成単位
+constexpr std::size_t kChunk = 256;
+constexpr std::size_t kChunkBlocks = kChunk / kLanes;
+
+std::uint64_t rotl(std::uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+std::uint64_t splitMix64(std::uint64_t* state) {
+  auto z = (*state += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+void jumpXoshiro(Xoshiro256* generator, std::uint64_t* state,
+                 const std::uint64_t (&polynomial)[4]) {
+  std::uint64_t s[4] = {};
+  for (auto word : polynomial) {
+    for (int b = 0; b < 64; ++b) {
+      if (word & (std::uint64_t(1) << b)) {
+        for (int i = 0; i < 4; ++i) {
+          s[i] ^= state[i];
+        }
+      }
+      (*generator)();
+    }
+  }
+  std::copy(s, s + 4, state);
+}
+
+constexpr std::uint64_t kPcgMultiplier = 6364136223846793005ull;
+
+// Perlin の grad 関数の16方向
+constexpr float kGradients[16][3] = {
+    {1, 1, 0},  {-1, 1, 0}, {1, -1, 0}, {-1, -1, 0}, {1, 0, 1},  {-1, 0, 1},
+    {1, 0, -1}, {-1, 0, -1}, {0, 1, 1}, {0, -1, 1},  {0, 1, -1}, {0, -1, -1},
+    {1, 1, 0},  {0, -1, 1}, {-1, 1, 0}, {0, -1, -1}};
+
+// std::floor より速い。|v| < 2^31 のみ
+int floorInt(float v) {
+  auto i = static_cast<int>(v);
+  return i - (v < static_cast<float>(i) ? 1 : 0);
+}
+
+float fade(float t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+
+float lerp(float t, float a, float b) { return a + t * (b - a); }
+
+float grad(std::uint8_t hash, float x, float y, float z) {
+  const auto& g = kGradients[hash & 15];
+  return g[0] * x + g[1] * y + g[2] * z;
+}
+
+// 格子点 (x, y, z) を含む立方体の8頂点のハッシュ。順番は頂点の xyz のビット
+void cornerHashes(const std::uint8_t* p, int x, int y, int z,
+                  std::uint8_t* hashes) {
+  int a = p[x] + y;
+  int b = p[x + 1] + y;
+  int aa = p[a] + z;
+  int ab = p[a + 1] + z;
+  int ba = p[b] + z;
+  int bb = p[b + 1] + z;
+  hashes[0] = p[aa];
+  hashes[1] = p[ba];
+  hashes[2] = p[ab];
+  hashes[3] = p[bb];
+  hashes[4] = p[aa + 1];
+  hashes[5] = p[ba + 1];
+  hashes[6] = p[ab + 1];
+  hashes[7] = p[bb + 1];
+}
+
+std::uint64_t nextLane(LaneStates& s, std::size_t i) {
+  auto result = rotl(s[1][i] * 5, 7) * 9;
+  auto t = s[1][i] << 17;
+  s[2][i] ^= s[0][i];
+  s[3][i] ^= s[1][i];
+  s[1][i] ^= s[2][i];
+  s[0][i] ^= s[3][i];
+  s[2][i] ^= t;
+  s[3][i] = rotl(s[3][i], 45);
+  return result;
+}
+
+// 各カーネルは8レーンを blocks 回進め、ブロック b のレーン j の値を
+// results[b * kLanes + j] に置く。命令セットによらず結果は同じ
+using UniformFunc = void (*)(LaneStates&, std::size_t, float*);
+
+#if defined(TEMP_MATH_RANDOM_X86)
+template <int k>
+__m128i rotl(__m128i x) {
+  return _mm_or_si128(_mm_slli_epi64(x, k), _mm_srli_epi64(x, 64 - k));
+}
+
+// 64ビット乗算がないので、5倍と9倍はシフトと加算で求める
+__m128i nextSse2(__m128i* s) {
+  auto x5 = _mm_add_epi64(_mm_slli_epi64(s[1], 2), s[1]);
+  auto r = rotl<7>(x5);
+  auto result = _mm_add_epi64(_mm_slli_epi64(r, 3), r);
+  auto t = _mm_slli_epi64(s[1], 17);
+  s[2] = _mm_xor_si128(s[2], s[0]);
+  s[3] = _mm_xor_si128(s[3], s[1]);
+  s[1] = _mm_xor_si128(s[1], s[2]);
+  s[0] = _mm_xor_si128(s[0], s[3]);
+  s[2] = _mm_xor_si128(s[2], t);
+  s[3] = rotl<45>(s[3]);
+  return result;
+}
+
+void uniformSse2(LaneStates& s, std::size_t blocks, float* results) {
+  const auto kScale = _mm_set1_ps(1.0f / 16777216.0f);
+  for (std::size_t i = 0; i < kLanes; i += 4) {
+    __m128i lo[4];
+    __m128i hi[4];
+    for (int k = 0; k < 4; ++k) {
+      lo[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(s[k] + i));
+      hi[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(s[k] + i + 2));
+    }
+    for (std::size_t b = 0; b < blocks; ++b) {
+      // 各64ビットの上位24ビットを32ビットのレーンに詰める
+      auto a = _mm_shuffle_epi32(_mm_srli_epi64(nextSse2(lo), 40),
+                                 _MM_SHUFFLE(3, 1, 2, 0));
+      auto c = _mm_shuffle_epi32(_mm_srli_epi64(nextSse2(hi), 40),
+                                 _MM_SHUFFLE(3, 1, 2, 0));
+      auto bits = _mm_unpacklo_epi64(a, c);
+      _mm_storeu_ps(results + b * kLanes + i,
+                    _mm_mul_ps(_mm_cvtepi32_ps(bits), kScale));
+    }
+    for (int k = 0; k < 4; ++k) {
+      _mm_store_si128(reinterpret_cast<__m128i*>(s[k] + i), lo[k]);
+      _mm_store_si128(reinterpret_cast<__m128i*>(s[k] + i + 2), hi[k]);
+    }
+  }
+}
+
+template <int k>
+TEMP_TARGET_AVX2 __m256i rotl(__m256i x) {
+  return _mm256_or_si256(_mm256_slli_epi64(x, k),
+                         _mm256_srli_epi64(x, 64 - k));
+}
+
+TEMP_TARGET_AVX2 __m256i nextAvx2(__m256i* s) {
+  auto x5 = _mm256_add_epi64(_mm256_slli_epi64(s[1], 2), s[1]);
+  auto r = rotl<7>(x5);
+  auto result = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+  auto t = _mm256_slli_epi64(s[1], 17);
+  s[2] = _mm256_xor_si256(s[2], s[0]);
+  s[3] = _mm256_xor_si256(s[3], s[1]);
+  s[1] = _mm256_xor_si256(s[1], s[2]);
+  s[0] = _mm256_xor_si256(s[0], s[3]);
+  s[2] = _mm256_xor_si256(s[2], t);
+  s[3] = rotl<45>(s[3]);
+  return result;
+}
+
+TEMP_TARGET_AVX2 void uniformAvx2(LaneStates& s, std::size_t blocks,
+                                  float* results) {
+  const auto kScale = _mm256_set1_ps(1.0f / 16777216.0f);
+  const auto kOrder = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  __m256i lo[4];
+  __m256i hi[4];
+  for (int k = 0; k < 4; ++k) {
+    lo[k] = _mm256_load_si256(reinterpret_cast<const __m256i*>(s[k]));
+    hi[k] = _mm256_load_si256(reinterpret_cast<const __m256i*>(s[k] + 4));
+  }
+  for (std::size_t b = 0; b < blocks; ++b) {
+    // レーン0から3を偶数番目、4から7を奇数番目に詰めてから並べ直す
+    auto a = _mm256_srli_epi64(nextAvx2(lo), 40);
+    auto c = _mm256_slli_epi64(_mm256_srli_epi64(nextAvx2(hi), 40), 32);
+    auto bits = _mm256_permutevar8x32_epi32(_mm256_or_si256(a, c), kOrder);
+    _mm256_storeu_ps(results + b * kLanes,
+                     _mm256_mul_ps(_mm256_cvtepi32_ps(bits), kScale));
+  }
+  for (int k = 0; k < 4; ++k) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(s[k]), lo[k]);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(s[k] + 4), hi[k]);
+  }
+}
+#else
+// 上位24ビットは int32 を経由したほうが変換が速い
+float toUniform(std::uint64_t bits) {
+  return static_cast<float>(static_cast<std::int32_t>(bits >> 40)) *
+         (1.0f / 16777216.0f);
+}
+
+void uniformScalar(LaneStates& s, std::size_t blocks, float* results) {
+  for (std::size_t b = 0; b < blocks; ++b) {
+    for (std::size_t i = 0; i < kLanes; ++i) {
+      results[b * kLanes + i] = toUniform(nextLane(s, i));
+    }
+  }
+}
+#endif
+
+UniformFunc selectUniformKernel() {
+#if defined(TEMP_MATH_RANDOM_X86)
+  if (GetCpuFeatures().avx2) {
+    return uniformAvx2;
+  }
+  return uniformSse2;
+#else
+  return uniformScalar;
+#endif
+}
+
+UniformFunc uniformKernel() {
+  static const UniformFunc kernel = selectUniformKernel();
+  return kernel;
+}
+
+}  // namespace
+
+Xoshiro256::Xoshiro256(std::uint64_t seed) {
+  for (auto& s : state_) {
+    s = splitMix64(&seed);
+  }
+}
+
+auto Xoshiro256::operator()() -> result_type {
+  auto& s = state_;
+  auto result = rotl(s[1] * 5, 7) * 9;
+  auto t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+void Xoshiro256::jump() {
+  static const std::uint64_t kJump[4] = {
+      0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa,
+      0x39abdc4529b1661c};
+  jumpXoshiro(this, state_, kJump);
+}
+
+void Xoshiro256::longJump() {
+  static const std::uint64_t kLongJump[4] = {
+      0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241,
+      0x39109bb02acbe635};
+  jumpXoshiro(this, state_, kLongJump);
+}
+
+Pcg32::Pcg32(std::uint64_t seed, std::uint64_t stream)
+    : state_(0), increment_((stream << 1) | 1) {
+  (*this)();
+  state_ += seed;
+  (*this)();
+}
+
+auto Pcg32::operator()() -> result_type {
+  auto old = state_;
+  state_ = old * kPcgMultiplier + increment_;
+  auto shifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+  auto rotation = static_cast<std::uint32_t>(old >> 59);
+  return (shifted >> rotation) | (shifted << ((0u - rotation) & 31));
+}
+
+void Pcg32::advance(std::uint64_t delta) {
+  // 線形合同法の delta 回分の係数を二乗を繰り返して求める
+  std::uint64_t multiplier = 1;
+  std::uint64_t increment = 0;
+  std::uint64_t current_multiplier = kPcgMultiplier;
+  std::uint64_t current_increment = increment_;
+  for (; delta > 0; delta >>= 1) {
+    if (delta & 1) {
+      multiplier *= current_multiplier;
+      increment = increment * current_multiplier + current_increment;
+    }
+    current_increment = (current_multiplier + 1) * current_increment;
+    current_multiplier *= current_multiplier;
+  }
+  state_ = multiplier * state_ + increment;
+}
+
+Xoshiro256x8::Xoshiro256x8(std::uint64_t seed)
+    : Xoshiro256x8(Xoshiro256(seed)) {}
+
+Xoshiro256x8::Xoshiro256x8(const Xoshiro256& source) {
+  auto generator = source;
+  for (std::size_t lane = 0; lane < kLanes; ++lane) {
+    for (int i = 0; i < 4; ++i) {
+      state_[i][lane] = generator.state_[i];
+    }
+    generator.jump();
+  }
+}
+
+void Xoshiro256x8::next(std::uint64_t* results) {
+  for (std::size_t i = 0; i < kLanes; ++i) {
+    results[i] = nextLane(state_, i);
+  }
+}
+
+void Xoshiro256x8::nextUniform(std::size_t blocks, float* results) {
+  uniformKernel()(state_, blocks, results);
+}
+
+void generateUniform(Xoshiro256x8& generator, std::size_t count,
+                     float* results) {
+  auto blocks = count / kLanes;
+  auto done = blocks * kLanes;
+  generator.nextUniform(blocks, results);
+  if (done < count) {
+    float rest[kLanes];
+    generator.nextUniform(1, rest);
+    std::copy(rest, rest + (count - done), results + done);
+  }
+}
+
+void generateUniform(Xoshiro256x8& generator, float min, float max,
+                     std::size_t count, float* results) {
+  generateUniform(generator, count, results);
+  const float range = max - min;
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = min + range * results[i];
+  }
+}
+
+void generateNormal(Xoshiro256x8& generator, std::size_t count,
+                    float* results) {
+  // 前半と後半の一様乱数の組から Box-Muller で2つずつ作る
+  constexpr std::size_t kHalf = kChunk / 2;
+  alignas(64) float chunk[kChunk];
+  for (std::size_t i = 0; i < count; i += kChunk) {
+    auto n = std::min(kChunk, count - i);
+    auto out = n == kChunk ? results + i : chunk;
+    generator.nextUniform(kChunkBlocks, out);
+    for (std::size_t j = 0; j < kHalf; j += kWideLanes) {
+      // 1 - u は (0, 1] なので log が発散しない
+      auto u1 = WideFloat(1.0f) - WideFloat::load(out + j);
+      auto u2 = WideFloat::load(out + kHalf + j);
+      auto r = sqrt(WideFloat(-2.0f) * fast::log(u1));
+      WideFloat s, c;
+      fast::sincos(WideFloat(2.0f * kPi) * u2, &s, &c);
+      (r * c).store(out + j);
+      (r * s).store(out + kHalf + j);
+    }
+    if (out == chunk) {
+      std::copy(chunk, chunk + n, results + i);
+    }
+  }
+}
+
+void generateOnSphere(Xoshiro256x8& generator, std::size_t count,
+                      Vector3* results) {
+  constexpr std::size_t kPoints = kChunk / 2;
+  alignas(64) float chunk[kChunk];
+  alignas(64) float xs[kPoints];
+  alignas(64) float ys[kPoints];
+  for (std::size_t i = 0; i < count; i += kPoints) {
+    generator.nextUniform(kChunkBlocks, chunk);
+    for (std::size_t j = 0; j < kPoints; j += kWideLanes) {
+      auto z = WideFloat(1.0f) - WideFloat(2.0f) * WideFloat::load(chunk + j);
+      auto r = sqrt(max(WideFloat(1.0f) - z * z, WideFloat(0.0f)));
+      WideFloat s, c;
+      fast::sincos(WideFloat(2.0f * kPi) * WideFloat::load(chunk + kPoints + j),
+                   &s, &c);
+      (r * c).store(xs + j);
+      (r * s).store(ys + j);
+      z.store(chunk + j);
+    }
+    auto n = std::min(kPoints, count - i);
+    for (std::size_t j = 0; j < n; ++j) {
+      results[i + j] = Vector3(xs[j], ys[j], chunk[j]);
+    }
+  }
+}
+
+PerlinNoise::PerlinNoise(std::uint64_t seed) {
+  for (int i = 0; i < 256; ++i) {
+    permutation_[i] = static_cast<std::uint8_t>(i);
+  }
+  Xoshiro256 generator(seed);
+  for (std::uint32_t i = 255; i > 0; --i) {
+    std::swap(permutation_[i], permutation_[uniformInt(generator, i + 1)]);
+  }
+  // 添字の折り返しを省くため2周分並べる
+  std::copy(permutation_, permutation_ + 256, permutation_ + 256);
+}
+
+float PerlinNoise::evaluate(const Vector3& point) const {
+  int ix = floorInt(point.x());
+  int iy = floorInt(point.y());
+  int iz = floorInt(point.z());
+  std::uint8_t h[8];
+  cornerHashes(permutation_, ix & 255, iy & 255, iz & 255, h);
+
+  float x = point.x() - static_cast<float>(ix);
+  float y = point.y() - static_cast<float>(iy);
+  float z = point.z() - static_cast<float>(iz);
+  float u = fade(x);
+  float v = fade(y);
+  float w = fade(z);
+  float x1 = x - 1.0f;
+  float y1 = y - 1.0f;
+  float z1 = z - 1.0f;
+  float near = lerp(v, lerp(u, grad(h[0], x, y, z), grad(h[1], x1, y, z)),
+                    lerp(u, grad(h[2], x, y1, z), grad(h[3], x1, y1, z)));
+  float far = lerp(v, lerp(u, grad(h[4], x, y, z1), grad(h[5], x1, y, z1)),
+                   lerp(u, grad(h[6], x, y1, z1), grad(h[7], x1, y1, z1)));
+  return lerp(w, near, far);
+}
+
+void PerlinNoise::evaluate(const Vector3* points, std::size_t count,
+                           float* results) const {
+  // 表引きが大半を占めるので、補間だけ SIMD にしても速くならない
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = evaluate(points[i]);
+  }
+}
+
+}  // namespace math
+}  // namespace temp
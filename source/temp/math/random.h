@@ -0,0 +1,310 @@
+﻿/**
+ * @file random.h
+ * @brief Reproducible random number generators, samplers and noise
+ *
+ * Unlike the <random> distributions, the values depend only on the seed and
+ * not on the standard library implementation. The samplers use the
+ * approximations of fast_functions.h, so their results are also the same on
+ * every platform as long as the build does not contract to FMA.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "temp/math/constants.h"
+#include "temp/math/fast_functions.h"
+#include "temp/math/matrix44.h"  // quaternion.h は単体でインクルードできない
+#include "temp/math/quaternion.h"
+#include "temp/math/vector3.h"
+#include "temp/math/vector3_functions.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+/**
+ * @brief xoshiro256** generator with period 2^256 - 1
+ *
+ * Satisfies UniformRandomBitGenerator, so it also works with <random>.
+ */
+class Xoshiro256 {
+ public:
+  using result_type = std::uint64_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~result_type(0); }
+
+  /**
+   * @brief Initialize state from seed by SplitMix64
+   */
+  explicit Xoshiro256(std::uint64_t seed = 0);
+
+  result_type operator()();
+
+  /**
+   * @brief Advance 2^128 steps
+   *
+   * Jumping a copy once per thread gives non overlapping streams.
+   */
+  void jump();
+
+  /**
+   * @brief Advance 2^192 steps
+   */
+  void longJump();
+
+ private:
+  friend class Xoshiro256x8;
+
+  std::uint64_t state_[4];
+};
+
+/**
+ * @brief PCG32 (XSH RR) generator with 2^63 selectable streams
+ */
+class Pcg32 {
+ public:
+  using result_type = std::uint32_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return ~result_type(0); }
+
+  explicit Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+  result_type operator()();
+
+  /**
+   * @brief Advance delta steps in O(log delta)
+   */
+  void advance(std::uint64_t delta);
+
+ private:
+  std::uint64_t state_;
+  std::uint64_t increment_;
+};
+
+/**
+ * @brief 8 interleaved xoshiro256** generators for bulk generation
+ *
+ * Lane i starts i jumps after the source generator. The lane count is fixed,
+ * so the sequence is the same whatever SIMD width the CPU has.
+ */
+class Xoshiro256x8 {
+ public:
+  static constexpr std::size_t kLanes = 8;
+
+  explicit Xoshiro256x8(std::uint64_t seed = 0);
+  explicit Xoshiro256x8(const Xoshiro256& source);
+
+  /**
+   * @brief Generate one value per lane
+   */
+  void next(std::uint64_t* results);
+
+  /**
+   * @brief Generate blocks x kLanes uniform floats in [0, 1)
+   *
+   * Value j of each block comes from lane j. Uses AVX2 or SSE2 when the
+   * CPU supports it, with the same results as the scalar code.
+   */
+  void nextUniform(std::size_t blocks, float* results);
+
+ private:
+  alignas(64) std::uint64_t state_[4][kLanes];
+};
+
+/**
+ * @brief Uniform float in [0, 1) with 24 bit resolution
+ */
+template <class Generator>
+float uniformFloat(Generator& generator);
+
+/**
+ * @brief Uniform float in [min, max)
+ */
+template <class Generator>
+float uniformFloat(Generator& generator, float min, float max);
+
+/**
+ * @brief Unbiased uniform integer in [0, bound)
+ */
+template <class Generator>
+std::uint32_t uniformInt(Generator& generator, std::uint32_t bound);
+
+/**
+ * @brief Standard normal distribution by Box-Muller transform
+ */
+template <class Generator>
+float normalFloat(Generator& generator);
+
+/**
+ * @brief Uniform point in the box [min, max)
+ */
+template <class Generator>
+Vector3 uniformVector3(Generator& generator, const Vector3& min,
+                       const Vector3& max);
+
+/**
+ * @brief Uniform unit vector
+ */
+template <class Generator>
+Vector3 uniformOnSphere(Generator& generator);
+
+/**
+ * @brief Uniform unit vector within half_angle radians of axis
+ *
+ * @param axis unit vector
+ * @param half_angle in [0, pi]
+ */
+template <class Generator>
+Vector3 uniformInCone(Generator& generator, const Vector3& axis,
+                      float half_angle);
+
+/**
+ * @brief Uniform rotation (Shoemake)
+ */
+template <class Generator>
+Quaternion uniformRotation(Generator& generator);
+
+// Bulk versions. Values are generated in fixed size blocks and the unused
+// rest of the last block is discarded, so splitting a request into several
+// calls may give different values.
+void generateUniform(Xoshiro256x8& generator, std::size_t count,
+                     float* results);
+void generateUniform(Xoshiro256x8& generator, float min, float max,
+                     std::size_t count, float* results);
+void generateNormal(Xoshiro256x8& generator, std::size_t count,
+                    float* results);
+void generateOnSphere(Xoshiro256x8& generator, std::size_t count,
+                      Vector3* results);
+
+/**
+ * @brief Improved Perlin noise with a permutation shuffled by seed
+ */
+class PerlinNoise {
+ public:
+  explicit PerlinNoise(std::uint64_t seed = 0);
+
+  /**
+   * @brief Noise value in about [-1, 1], 0 at integer coordinates
+   */
+  float evaluate(const Vector3& point) const;
+
+  /**
+   * @brief Evaluate noise at each point
+   *
+   * @param points sample points
+   * @param count count of points
+   * @param results destination of noise values
+   */
+  void evaluate(const Vector3* points, std::size_t count,
+                float* results) const;
+
+ private:
+  std::uint8_t permutation_[512];
+};
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+namespace random_detail {
+template <class Generator>
+std::uint32_t next32(Generator& generator) {
+  if constexpr (sizeof(typename Generator::result_type) == 8) {
+    return static_cast<std::uint32_t>(generator() >> 32);
+  } else {
+    return static_cast<std::uint32_t>(generator());
+  }
+}
+}  // namespace random_detail
+
+template <class Generator>
+float uniformFloat(Generator& generator) {
+  // 上位24ビットは float で正確に表せる
+  return static_cast<float>(random_detail::next32(generator) >> 8) *
+         (1.0f / 16777216.0f);
+}
+
+template <class Generator>
+float uniformFloat(Generator& generator, float min, float max) {
+  return min + (max - min) * uniformFloat(generator);
+}
+
+template <class Generator>
+std::uint32_t uniformInt(Generator& generator, std::uint32_t bound) {
+  // Lemire の乗算による方法。偏りが出る範囲だけ引き直す
+  auto m = std::uint64_t(random_detail::next32(generator)) * bound;
+  auto low = static_cast<std::uint32_t>(m);
+  if (low < bound) {
+    auto threshold = (0u - bound) % bound;
+    while (low < threshold) {
+      m = std::uint64_t(random_detail::next32(generator)) * bound;
+      low = static_cast<std::uint32_t>(m);
+    }
+  }
+  return static_cast<std::uint32_t>(m >> 32);
+}
+
+template <class Generator>
+float normalFloat(Generator& generator) {
+  // 1 - u は (0, 1] なので log が発散しない
+  float u1 = 1.0f - uniformFloat(generator);
+  float u2 = uniformFloat(generator);
+  return std::sqrt(-2.0f * fast::log(u1)) * fast::cos(2.0f * kPi * u2);
+}
+
+template <class Generator>
+Vector3 uniformVector3(Generator& generator, const Vector3& min,
+                       const Vector3& max) {
+  float x = uniformFloat(generator, min.x(), max.x());
+  float y = uniformFloat(generator, min.y(), max.y());
+  float z = uniformFloat(generator, min.z(), max.z());
+  return Vector3(x, y, z);
+}
+
+template <class Generator>
+Vector3 uniformOnSphere(Generator& generator) {
+  float z = 1.0f - 2.0f * uniformFloat(generator);
+  float r = std::sqrt(fast::max(1.0f - z * z, 0.0f));
+  float s, c;
+  fast::sincos(2.0f * kPi * uniformFloat(generator), &s, &c);
+  return Vector3(r * c, r * s, z);
+}
+
+template <class Generator>
+Vector3 uniformInCone(Generator& generator, const Vector3& axis,
+                      float half_angle) {
+  // cos(theta) を [cos(half_angle), 1] で一様にすると立体角が一様になる
+  float cos_max = fast::cos(half_angle);
+  float z = 1.0f - uniformFloat(generator) * (1.0f - cos_max);
+  float r = std::sqrt(fast::max(1.0f - z * z, 0.0f));
+  float s, c;
+  fast::sincos(2.0f * kPi * uniformFloat(generator), &s, &c);
+
+  // axis を z 軸とする正規直交基底 (Duff et al. 2017)
+  float sign = std::copysign(1.0f, axis.z());
+  float a = -1.0f / (sign + axis.z());
+  float b = axis.x() * axis.y() * a;
+  Vector3 t(1.0f + sign * axis.x() * axis.x() * a, sign * b, -sign * axis.x());
+  Vector3 u(b, sign + axis.y() * axis.y() * a, -axis.y());
+  return t * (r * c) + u * (r * s) + axis * z;
+}
+
+template <class Generator>
+Quaternion uniformRotation(Generator& generator) {
+  float u1 = uniformFloat(generator);
+  float s1, c1, s2, c2;
+  fast::sincos(2.0f * kPi * uniformFloat(generator), &s1, &c1);
+  fast::sincos(2.0f * kPi * uniformFloat(generator), &s2, &c2);
+  float a = std::sqrt(1.0f - u1);
+  float b = std::sqrt(u1);
+  return Quaternion(a * s1, a * c1, b * s2, b * c2);
+}
+
+}  // namespace math
+}  // namespace temp
@@ -0,0 +1,282 @@
+﻿/**
+ * @file simd.h
+ * @brief Thin wrapper over the 4-wide float SIMD instruction set selected at
+ * compile time (SSE/AVX2 on x86, NEON on ARM).
+ *
+ * TEMP_MATH_SIMD is defined when a SIMD backend is available. Define
+ * TEMP_MATH_NO_SIMD to force the scalar implementation.
+ */
+#pragma once
+
+#if !defined(TEMP_MATH_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEMP_MATH_SIMD
+#define TEMP_MATH_SIMD_SSE
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define TEMP_MATH_SIMD_AVX2
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TEMP_MATH_SIMD
+#define TEMP_MATH_SIMD_NEON
+#endif
+#endif
+
+#include <cmath>
+
+#if defined(TEMP_MATH_SIMD_SSE)
+#include <immintrin.h>
+#elif defined(TEMP_MATH_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace temp {
+namespace math {
+namespace simd {
+
+#if defined(TEMP_MATH_SIMD_SSE)
+
+using Float4 = __m128;
+
+inline Float4 load(const float* p) { return _mm_load_ps(p); }
+inline Float4 loadUnaligned(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, Float4 v) { _mm_store_ps(p, v); }
+inline void storeUnaligned(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+inline Float4 set(float x, float y, float z, float w) {
+  return _mm_setr_ps(x, y, z, w);
+}
+inline Float4 splat(float v) { return _mm_set1_ps(v); }
+
+template <int kLane>
+inline Float4 broadcast(Float4 v) {
+  return _mm_shuffle_ps(v, v, _MM_SHUFFLE(kLane, kLane, kLane, kLane));
+}
+
+template <int kLane>
+inline float get(Float4 v) {
+  return _mm_cvtss_f32(broadcast<kLane>(v));
+}
+
+/// (a[k0], a[k1], b[k2], b[k3])
+template <int k0, int k1, int k2, int k3>
+inline Float4 shuffle(Float4 a, Float4 b) {
+  return _mm_shuffle_ps(a, b, _MM_SHUFFLE(k3, k2, k1, k0));
+}
+
+inline Float4 add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+inline Float4 sqrt(Float4 v) { return _mm_sqrt_ps(v); }
+
+/// a * b + c
+inline Float4 madd(Float4 a, Float4 b, Float4 c) {
+#if defined(TEMP_MATH_SIMD_AVX2)
+  return _mm_fmadd_ps(a, b, c);
+#else
+  return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+/// Sum of all lanes, broadcast to every lane.
+inline Float4 hsum(Float4 v) {
+  Float4 t = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_add_ps(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+inline void transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+  _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+}
+
+inline Float4 neg(Float4 v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+inline Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+inline Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+
+/// All bits of a lane are set when the lane is true.
+using Mask4 = __m128;
+
+inline Mask4 cmpEq(Float4 a, Float4 b) { return _mm_cmpeq_ps(a, b); }
+inline Mask4 cmpLt(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+inline Mask4 cmpLe(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+inline Mask4 maskAnd(Mask4 a, Mask4 b) { return _mm_and_ps(a, b); }
+inline Mask4 maskOr(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+inline Mask4 maskNot(Mask4 m) {
+  return _mm_xor_ps(m, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+}
+/// Bit i is set when lane i is true.
+inline unsigned maskBits(Mask4 m) {
+  return static_cast<unsigned>(_mm_movemask_ps(m));
+}
+/// m ? a : b
+inline Float4 select(Mask4 m, Float4 a, Float4 b) {
+  return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+}
+
+// Building blocks of the fast:: approximations
+
+/// Round to nearest even, |v| < 2^31.
+inline Float4 round(Float4 v) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(v)); }
+/// v * 2^e for integral e in [-126, 127].
+inline Float4 ldexp(Float4 v, Float4 e) {
+  auto bits = _mm_slli_epi32(
+      _mm_add_epi32(_mm_cvtps_epi32(e), _mm_set1_epi32(127)), 23);
+  return _mm_mul_ps(v, _mm_castsi128_ps(bits));
+}
+/// floor(log2(v)) of positive normal v.
+inline Float4 exponent(Float4 v) {
+  auto bits = _mm_and_si128(_mm_srli_epi32(_mm_castps_si128(v), 23),
+                            _mm_set1_epi32(0xff));
+  return _mm_cvtepi32_ps(_mm_sub_epi32(bits, _mm_set1_epi32(127)));
+}
+/// v / 2^exponent(v) in [1, 2) of positive normal v.
+inline Float4 mantissa(Float4 v) {
+  auto bits = _mm_and_si128(_mm_castps_si128(v), _mm_set1_epi32(0x007fffff));
+  return _mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(0x3f800000)));
+}
+/// 1 / sqrt(v) with relative error below 2^-11.
+inline Float4 rsqrtEstimate(Float4 v) { return _mm_rsqrt_ps(v); }
+inline Float4 abs(Float4 v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+#elif defined(TEMP_MATH_SIMD_NEON)
+
+using Float4 = float32x4_t;
+
+inline Float4 load(const float* p) { return vld1q_f32(p); }
+inline Float4 loadUnaligned(const float* p) { return vld1q_f32(p); }
+inline void store(float* p, Float4 v) { vst1q_f32(p, v); }
+inline void storeUnaligned(float* p, Float4 v) { vst1q_f32(p, v); }
+inline Float4 set(float x, float y, float z, float w) {
+  const float v[4] = {x, y, z, w};
+  return vld1q_f32(v);
+}
+inline Float4 splat(float v) { return vdupq_n_f32(v); }
+
+template <int kLane>
+inline Float4 broadcast(Float4 v) {
+  return vdupq_n_f32(vgetq_lane_f32(v, kLane));
+}
+
+template <int kLane>
+inline float get(Float4 v) {
+  return vgetq_lane_f32(v, kLane);
+}
+
+/// (a[k0], a[k1], b[k2], b[k3])
+template <int k0, int k1, int k2, int k3>
+inline Float4 shuffle(Float4 a, Float4 b) {
+  Float4 r = vdupq_n_f32(vgetq_lane_f32(a, k0));
+  r = vsetq_lane_f32(vgetq_lane_f32(a, k1), r, 1);
+  r = vsetq_lane_f32(vgetq_lane_f32(b, k2), r, 2);
+  return vsetq_lane_f32(vgetq_lane_f32(b, k3), r, 3);
+}
+
+inline Float4 add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+inline Float4 sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+inline Float4 mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+
+#if defined(__aarch64__)
+inline Float4 div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+inline Float4 sqrt(Float4 v) { return vsqrtq_f32(v); }
+/// a * b + c
+inline Float4 madd(Float4 a, Float4 b, Float4 c) { return vfmaq_f32(c, a, b); }
+#else
+inline Float4 div(Float4 a, Float4 b) {
+  // Two Newton-Raphson steps on the reciprocal estimate.
+  Float4 r = vrecpeq_f32(b);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  r = vmulq_f32(vrecpsq_f32(b, r), r);
+  return vmulq_f32(a, r);
+}
+inline Float4 sqrt(Float4 v) {
+  float e[4];
+  vst1q_f32(e, v);
+  for (auto& x : e) x = std::sqrt(x);
+  return vld1q_f32(e);
+}
+/// a * b + c
+inline Float4 madd(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(c, a, b); }
+#endif
+
+/// Sum of all lanes, broadcast to every lane.
+inline Float4 hsum(Float4 v) {
+  float32x2_t t = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  t = vpadd_f32(t, t);
+  return vcombine_f32(t, t);
+}
+
+inline void transpose(Float4& r0, Float4& r1, Float4& r2, Float4& r3) {
+  float32x4x2_t t01 = vtrnq_f32(r0, r1);
+  float32x4x2_t t23 = vtrnq_f32(r2, r3);
+  r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+  r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+  r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+inline Float4 neg(Float4 v) { return vnegq_f32(v); }
+inline Float4 min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+inline Float4 max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+
+/// All bits of a lane are set when the lane is true.
+using Mask4 = uint32x4_t;
+
+inline Mask4 cmpEq(Float4 a, Float4 b) { return vceqq_f32(a, b); }
+inline Mask4 cmpLt(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+inline Mask4 cmpLe(Float4 a, Float4 b) { return vcleq_f32(a, b); }
+inline Mask4 maskAnd(Mask4 a, Mask4 b) { return vandq_u32(a, b); }
+inline Mask4 maskOr(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+inline Mask4 maskNot(Mask4 m) { return vmvnq_u32(m); }
+/// Bit i is set when lane i is true.
+inline unsigned maskBits(Mask4 m) {
+  const uint32_t kBits[4] = {1, 2, 4, 8};
+  uint32x4_t b = vandq_u32(m, vld1q_u32(kBits));
+  uint32x2_t t = vadd_u32(vget_low_u32(b), vget_high_u32(b));
+  return vget_lane_u32(vpadd_u32(t, t), 0);
+}
+/// m ? a : b
+inline Float4 select(Mask4 m, Float4 a, Float4 b) { return vbslq_f32(m, a, b); }
+
+// Building blocks of the fast:: approximations
+
+/// Round to nearest even, |v| < 2^22.
+inline Float4 round(Float4 v) {
+#if defined(__aarch64__)
+  return vrndnq_f32(v);
+#else
+  // 1.5 * 2^23 を足すと小数部が丸めで落ちる
+  const float32x4_t kMagic = vdupq_n_f32(12582912.0f);
+  return vsubq_f32(vaddq_f32(v, kMagic), kMagic);
+#endif
+}
+/// v * 2^e for integral e in [-126, 127].
+inline Float4 ldexp(Float4 v, Float4 e) {
+  int32x4_t bits =
+      vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(e), vdupq_n_s32(127)), 23);
+  return vmulq_f32(v, vreinterpretq_f32_s32(bits));
+}
+/// floor(log2(v)) of positive normal v.
+inline Float4 exponent(Float4 v) {
+  uint32x4_t bits =
+      vandq_u32(vshrq_n_u32(vreinterpretq_u32_f32(v), 23), vdupq_n_u32(0xff));
+  return vcvtq_f32_s32(
+      vsubq_s32(vreinterpretq_s32_u32(bits), vdupq_n_s32(127)));
+}
+/// v / 2^exponent(v) in [1, 2) of positive normal v.
+inline Float4 mantissa(Float4 v) {
+  uint32x4_t bits =
+      vandq_u32(vreinterpretq_u32_f32(v), vdupq_n_u32(0x007fffff));
+  return vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3f800000)));
+}
+/// 1 / sqrt(v) with relative error below 2^-11.
+inline Float4 rsqrtEstimate(Float4 v) {
+  // vrsqrteq_f32 は8ビット程度なので1回だけ精度を上げる
+  float32x4_t e = vrsqrteq_f32(v);
+  return vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(v, e), e));
+}
+inline Float4 abs(Float4 v) { return vabsq_f32(v); }
+
+#endif
+
+}  // namespace simd
+}  // namespace math
+}  // namespace temp
@@ -1,12 +1,21 @@
 ﻿#pragma once
+#include "temp/math/bounds.h"
+#include "temp/math/bounds_functions.h"
 #include "temp/math/constants.h"
+#include "temp/math/fast_functions.h"
 #include "temp/math/matrix44.h"
 #include "temp/math/matrix44_functions.h"
+#include "temp/math/matrix44_wide.h"
+#include "temp/math/packing.h"
 #include "temp/math/quaternion.h"
 #include "temp/math/quaternion_functions.h"
+#include "temp/math/quaternion_wide.h"
+#include "temp/math/random.h"
 #include "temp/math/vector2.h"
 #include "temp/math/vector2_functions.h"
 #include "temp/math/vector3.h"
 #include "temp/math/vector3_functions.h"
+#include "temp/math/vector3_wide.h"
 #include "temp/math/vector4.h"
-#include "temp/math/vector4_functions.h"
\ No newline at end of file
+#include "temp/math/vector4_functions.h"
+#include "temp/math/wide.h"
\ No newline at end of file
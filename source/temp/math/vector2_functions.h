@@ -19,25 +19,27 @@ template <class T>
 std::ostream& operator<<(std::ostream& stream, const Vector2Base<T>& vec2);
 
 template <class T>
-Vector2Base<T> operator+(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs);
+constexpr Vector2Base<T> operator+(const Vector2Base<T>& lhs,
+                                   const Vector2Base<T>& rhs);
 
 template <class T>
-Vector2Base<T> operator-(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs);
+constexpr Vector2Base<T> operator-(const Vector2Base<T>& lhs,
+                                   const Vector2Base<T>& rhs);
 
 template <class T>
-Vector2Base<T> operator*(const Vector2Base<T>& lhs, float rhs);
+constexpr Vector2Base<T> operator*(const Vector2Base<T>& lhs, float rhs);
 
 template <class T>
-Vector2Base<T> operator*(float lhs, const Vector2Base<T>& rhs);
+constexpr Vector2Base<T> operator*(float lhs, const Vector2Base<T>& rhs);
 
 template <class T>
-Vector2Base<T> operator/(const Vector2Base<T>& lhs, float rhs);
+constexpr Vector2Base<T> operator/(const Vector2Base<T>& lhs, float rhs);
 
 template <class T>
 T magnitude(const Vector2Base<T>& v);
 
 template <class T>
-T squared_magnitude(const Vector2Base<T>& v);
+constexpr T squared_magnitude(const Vector2Base<T>& v);
 
 template <class T>
 Vector2Base<T> normalize(const Vector2Base<T>& v);
@@ -46,13 +48,14 @@ template <class T>
 T angle(const Vector2Base<T>& from, const Vector2Base<T>& to);
 
 template <class T>
-T dot(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs);
+constexpr T dot(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs);
 
 template <class T>
 T distance(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs);
 
 template <class T>
-Vector2Base<T> lerp(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs, T t);
+constexpr Vector2Base<T> lerp(const Vector2Base<T>& lhs,
+                              const Vector2Base<T>& rhs, T t);
 
 //----------------------------------------
 // implementation
@@ -64,27 +67,29 @@ std::ostream& operator<<(std::ostream& stream, const Vector2Base<T>& vec2) {
 }
 
 template <class T>
-Vector2Base<T> operator+(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs) {
+constexpr Vector2Base<T> operator+(const Vector2Base<T>& lhs,
+                                   const Vector2Base<T>& rhs) {
   return Vector2Base<T>(lhs) += rhs;
 }
 
 template <class T>
-Vector2Base<T> operator-(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs) {
+constexpr Vector2Base<T> operator-(const Vector2Base<T>& lhs,
+                                   const Vector2Base<T>& rhs) {
   return Vector2Base<T>(lhs) -= rhs;
 }
 
 template <class T>
-Vector2Base<T> operator*(const Vector2Base<T>& lhs, float rhs) {
+constexpr Vector2Base<T> operator*(const Vector2Base<T>& lhs, float rhs) {
   return Vector2Base<T>(lhs) *= rhs;
 }
 
 template <class T>
-Vector2Base<T> operator*(float lhs, const Vector2Base<T>& rhs) {
+constexpr Vector2Base<T> operator*(float lhs, const Vector2Base<T>& rhs) {
   return rhs * lhs;
 }
 
 template <class T>
-Vector2Base<T> operator/(const Vector2Base<T>& lhs, float rhs) {
+constexpr Vector2Base<T> operator/(const Vector2Base<T>& lhs, float rhs) {
   return Vector2Base<T>(lhs) /= rhs;
 }
 
@@ -93,7 +98,7 @@ T magnitude(const Vector2Base<T>& v) {
   return sqrtf(squared_magnitude(v));
 }
 template <class T>
-T squared_magnitude(const Vector2Base<T>& v) {
+constexpr T squared_magnitude(const Vector2Base<T>& v) {
   return v.x() * v.x() + v.y() * v.y();
 }
 
@@ -115,7 +120,7 @@ T angle(const Vector2Base<T>& from, const Vector2Base<T>& to) {
 }
 
 template <class T>
-T dot(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs) {
+constexpr T dot(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs) {
   return lhs.x() * rhs.x() + lhs.y() * rhs.y();
 }
 
@@ -125,7 +130,8 @@ T distance(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs) {
 }
 
 template <class T>
-Vector2Base<T> lerp(const Vector2Base<T>& lhs, const Vector2Base<T>& rhs, T t) {
+constexpr Vector2Base<T> lerp(const Vector2Base<T>& lhs,
+                              const Vector2Base<T>& rhs, T t) {
   return lhs * (1 - t) + rhs * (t);
 }
 }  // namespace math
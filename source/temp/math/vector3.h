@@ -30,9 +30,9 @@ class Vector3Base {
   static const Vector3Base kForward;
   static const Vector3Base kBackward;
 
-  Vector3Base();
-  explicit Vector3Base(T x, T y, T z);
-  explicit Vector3Base(const Vector2Base<T> vec2, T z);
+  constexpr Vector3Base();
+  constexpr explicit Vector3Base(T x, T y, T z);
+  constexpr explicit Vector3Base(const Vector2Base<T> vec2, T z);
 
   Vector3Base(const Vector3Base&) = default;
   Vector3Base& operator=(const Vector3Base&) = default;
@@ -46,24 +46,24 @@ class Vector3Base {
   const iterator end() const;
 
   std::string toString() const;
-  T& operator[](std::size_t index);
-  T operator[](std::size_t index) const;
-
-  T& x();
-  T x() const;
-  T& y();
-  T y() const;
-  T& z();
-  T z() const;
-
-  bool operator==(const Vector3Base& rhs) const;
-  bool operator!=(const Vector3Base& rhs) const;
-  Vector3Base operator+() const;
-  Vector3Base operator-() const;
-  Vector3Base& operator+=(const Vector3Base& rhs);
-  Vector3Base& operator-=(const Vector3Base& rhs);
-  Vector3Base& operator*=(float rhs);
-  Vector3Base& operator/=(float rhs);
+  constexpr T& operator[](std::size_t index);
+  constexpr T operator[](std::size_t index) const;
+
+  constexpr T& x();
+  constexpr T x() const;
+  constexpr T& y();
+  constexpr T y() const;
+  constexpr T& z();
+  constexpr T z() const;
+
+  constexpr bool operator==(const Vector3Base& rhs) const;
+  constexpr bool operator!=(const Vector3Base& rhs) const;
+  constexpr Vector3Base operator+() const;
+  constexpr Vector3Base operator-() const;
+  constexpr Vector3Base& operator+=(const Vector3Base& rhs);
+  constexpr Vector3Base& operator-=(const Vector3Base& rhs);
+  constexpr Vector3Base& operator*=(float rhs);
+  constexpr Vector3Base& operator/=(float rhs);
 
  private:
   ElementsType elements_;
@@ -73,30 +73,26 @@ using Vector3 = Vector3Base<float>;
 using Vector3_64b = Vector3Base<double>;
 
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kZero = Vector3Base<T>(0, 0, 0);
+constexpr Vector3Base<T> Vector3Base<T>::kZero = Vector3Base<T>(0, 0, 0);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kRight = Vector3Base<T>(1, 0, 0);
+constexpr Vector3Base<T> Vector3Base<T>::kRight = Vector3Base<T>(1, 0, 0);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kLeft = Vector3Base<T>(-1, 0, 0);
+constexpr Vector3Base<T> Vector3Base<T>::kLeft = Vector3Base<T>(-1, 0, 0);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kUp = Vector3Base<T>(0, 1, 0);
+constexpr Vector3Base<T> Vector3Base<T>::kUp = Vector3Base<T>(0, 1, 0);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kDown = Vector3Base<T>(0, -1, 0);
+constexpr Vector3Base<T> Vector3Base<T>::kDown = Vector3Base<T>(0, -1, 0);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kForward = Vector3Base<T>(0, 0, 1);
+constexpr Vector3Base<T> Vector3Base<T>::kForward = Vector3Base<T>(0, 0, 1);
 template <class T>
-const Vector3Base<T> Vector3Base<T>::kBackward = Vector3Base<T>(0, 0, -1);
+constexpr Vector3Base<T> Vector3Base<T>::kBackward = Vector3Base<T>(0, 0, -1);
 
 template <class T>
-Vector3Base<T>::Vector3Base() : Vector3Base((T)0, (T)0, (T)0) {}
+constexpr Vector3Base<T>::Vector3Base() : Vector3Base((T)0, (T)0, (T)0) {}
 template <class T>
-Vector3Base<T>::Vector3Base(T x, T y, T z) {
-  elements_[0] = x;
-  elements_[1] = y;
-  elements_[2] = z;
-}
+constexpr Vector3Base<T>::Vector3Base(T x, T y, T z) : elements_{x, y, z} {}
 template <class T>
-Vector3Base<T>::Vector3Base(const Vector2Base<T> vec2, T z)
+constexpr Vector3Base<T>::Vector3Base(const Vector2Base<T> vec2, T z)
     : Vector3Base(vec2.x(), vec2.y(), z) {}
 
 template <class T>
@@ -117,64 +113,64 @@ std::string Vector3Base<T>::toString() const {
 }
 
 template <class T>
-T& Vector3Base<T>::operator[](std::size_t index) {
+constexpr T& Vector3Base<T>::operator[](std::size_t index) {
   TEMP_ASSERT(index < 3, "index must be less than 3");
   return elements_[index];
 }
 
 template <class T>
-T Vector3Base<T>::operator[](std::size_t index) const {
+constexpr T Vector3Base<T>::operator[](std::size_t index) const {
   TEMP_ASSERT(index < 3, "index must be less than 3");
   return elements_[index];
 }
 
 template <class T>
-T& Vector3Base<T>::x() {
+constexpr T& Vector3Base<T>::x() {
   return elements_[0];
 }
 template <class T>
-T Vector3Base<T>::x() const {
+constexpr T Vector3Base<T>::x() const {
   return elements_[0];
 }
 template <class T>
-T& Vector3Base<T>::y() {
+constexpr T& Vector3Base<T>::y() {
   return elements_[1];
 }
 template <class T>
-T Vector3Base<T>::y() const {
+constexpr T Vector3Base<T>::y() const {
   return elements_[1];
 }
 template <class T>
-T& Vector3Base<T>::z() {
+constexpr T& Vector3Base<T>::z() {
   return elements_[2];
 }
 template <class T>
-T Vector3Base<T>::z() const {
+constexpr T Vector3Base<T>::z() const {
   return elements_[2];
 }
 
 template <class T>
-bool Vector3Base<T>::operator==(const Vector3Base& rhs) const {
+constexpr bool Vector3Base<T>::operator==(const Vector3Base& rhs) const {
   return x() == rhs.x() && y() == rhs.y() && z() == rhs.z();
 }
 
 template <class T>
-bool Vector3Base<T>::operator!=(const Vector3Base& rhs) const {
+constexpr bool Vector3Base<T>::operator!=(const Vector3Base& rhs) const {
   return !(*this == rhs);
 }
 
 template <class T>
-Vector3Base<T> Vector3Base<T>::operator+() const {
+constexpr Vector3Base<T> Vector3Base<T>::operator+() const {
   return *this;
 }
 
 template <class T>
-Vector3Base<T> Vector3Base<T>::operator-() const {
+constexpr Vector3Base<T> Vector3Base<T>::operator-() const {
   return Vector3Base(-x(), -y(), -z());
 }
 
 template <class T>
-Vector3Base<T>& Vector3Base<T>::operator+=(const Vector3Base& rhs) {
+constexpr Vector3Base<T>& Vector3Base<T>::operator+=(const Vector3Base& rhs) {
   x() += rhs.x();
   y() += rhs.y();
   z() += rhs.z();
@@ -182,7 +178,7 @@ Vector3Base<T>& Vector3Base<T>::operator+=(const Vector3Base& rhs) {
 }
 
 template <class T>
-Vector3Base<T>& Vector3Base<T>::operator-=(const Vector3Base& rhs) {
+constexpr Vector3Base<T>& Vector3Base<T>::operator-=(const Vector3Base& rhs) {
   x() -= rhs.x();
   y() -= rhs.y();
   z() -= rhs.z();
@@ -190,7 +186,7 @@ Vector3Base<T>& Vector3Base<T>::operator-=(const Vector3Base& rhs) {
 }
 
 template <class T>
-Vector3Base<T>& Vector3Base<T>::operator*=(float rhs) {
+constexpr Vector3Base<T>& Vector3Base<T>::operator*=(float rhs) {
   x() *= rhs;
   y() *= rhs;
   z() *= rhs;
@@ -198,7 +194,7 @@ Vector3Base<T>& Vector3Base<T>::operator*=(float rhs) {
 }
 
 template <class T>
-Vector3Base<T>& Vector3Base<T>::operator/=(float rhs) {
+constexpr Vector3Base<T>& Vector3Base<T>::operator/=(float rhs) {
   TEMP_ASSERT(rhs != 0.0f, "rhs must not be zero");
   x() /= rhs;
   y() /= rhs;
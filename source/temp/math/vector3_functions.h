@@ -19,25 +19,27 @@ template <class T>
 std::ostream& operator<<(std::ostream& stream, const Vector3Base<T>& vec3);
 
 template <class T>
-Vector3Base<T> operator+(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
+constexpr Vector3Base<T> operator+(const Vector3Base<T>& lhs,
+                                   const Vector3Base<T>& rhs);
 
 template <class T>
-Vector3Base<T> operator-(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
+constexpr Vector3Base<T> operator-(const Vector3Base<T>& lhs,
+                                   const Vector3Base<T>& rhs);
 
 template <class T>
-Vector3Base<T> operator*(const Vector3Base<T>& lhs, float rhs);
+constexpr Vector3Base<T> operator*(const Vector3Base<T>& lhs, float rhs);
 
 template <class T>
-Vector3Base<T> operator*(float lhs, const Vector3Base<T>& rhs);
+constexpr Vector3Base<T> operator*(float lhs, const Vector3Base<T>& rhs);
 
 template <class T>
-Vector3Base<T> operator/(const Vector3Base<T>& lhs, float rhs);
+constexpr Vector3Base<T> operator/(const Vector3Base<T>& lhs, float rhs);
 
 template <class T>
 T magnitude(const Vector3Base<T>& v);
 
 template <class T>
-T squared_magnitude(const Vector3Base<T>& v);
+constexpr T squared_magnitude(const Vector3Base<T>& v);
 
 template <class T>
 Vector3Base<T> normalize(const Vector3Base<T>& v);
@@ -50,16 +52,18 @@ template <class T>
 T unsigned_angle(const Vector3Base<T>& from, const Vector3Base<T>& to);
 
 template <class T>
-T dot(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
+constexpr T dot(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
 
 template <class T>
-Vector3Base<T> cross(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
+constexpr Vector3Base<T> cross(const Vector3Base<T>& lhs,
+                               const Vector3Base<T>& rhs);
 
 template <class T>
 T distance(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs);
 
 template <class T>
-Vector3Base<T> lerp(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs, T t);
+constexpr Vector3Base<T> lerp(const Vector3Base<T>& lhs,
+                              const Vector3Base<T>& rhs, T t);
 
 //----------------------------------------
 // implementation
@@ -71,27 +75,29 @@ std::ostream& operator<<(std::ostream& stream, const Vector3Base<T>& vec3) {
 }
 
 template <class T>
-Vector3Base<T> operator+(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
+constexpr Vector3Base<T> operator+(const Vector3Base<T>& lhs,
+                                   const Vector3Base<T>& rhs) {
   return Vector3Base<T>(lhs) += rhs;
 }
 
 template <class T>
-Vector3Base<T> operator-(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
+constexpr Vector3Base<T> operator-(const Vector3Base<T>& lhs,
+                                   const Vector3Base<T>& rhs) {
   return Vector3Base<T>(lhs) -= rhs;
 }
 
 template <class T>
-Vector3Base<T> operator*(const Vector3Base<T>& lhs, float rhs) {
+constexpr Vector3Base<T> operator*(const Vector3Base<T>& lhs, float rhs) {
   return Vector3Base<T>(lhs) *= rhs;
 }
 
 template <class T>
-Vector3Base<T> operator*(float lhs, const Vector3Base<T>& rhs) {
+constexpr Vector3Base<T> operator*(float lhs, const Vector3Base<T>& rhs) {
   return rhs * lhs;
 }
 
 template <class T>
-Vector3Base<T> operator/(const Vector3Base<T>& lhs, float rhs) {
+constexpr Vector3Base<T> operator/(const Vector3Base<T>& lhs, float rhs) {
   return Vector3Base<T>(lhs) /= rhs;
 }
 
@@ -101,7 +107,7 @@ T magnitude(const Vector3Base<T>& v) {
 }
 
 template <class T>
-T squared_magnitude(const Vector3Base<T>& v) {
+constexpr T squared_magnitude(const Vector3Base<T>& v) {
   return v.x() * v.x() + v.y() * v.y() + v.z() * v.z();
 }
 
@@ -133,12 +139,13 @@ T unsigned_angle(const Vector3Base<T>& from, const Vector3Base<T>& to) {
 }
 
 template <class T>
-T dot(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
+constexpr T dot(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
   return lhs.x() * rhs.x() + lhs.y() * rhs.y() + lhs.z() * rhs.z();
 }
 
 template <class T>
-Vector3Base<T> cross(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
+constexpr Vector3Base<T> cross(const Vector3Base<T>& lhs,
+                               const Vector3Base<T>& rhs) {
   return Vector3Base<T>(lhs.y() * rhs.z() - rhs.y() * lhs.z(),
                         -(lhs.x() * rhs.z() - rhs.x() * lhs.z()),
                         lhs.x() * rhs.y() - rhs.x() * lhs.y());
@@ -150,7 +157,8 @@ T distance(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs) {
 }
 
 template <class T>
-Vector3Base<T> lerp(const Vector3Base<T>& lhs, const Vector3Base<T>& rhs, T t) {
+constexpr Vector3Base<T> lerp(const Vector3Base<T>& lhs,
+                              const Vector3Base<T>& rhs, T t) {
   return lhs * (1 - t) + rhs * (t);
 }
 }  // namespace math
@@ -0,0 +1,305 @@
+﻿/**
+ * @file vector3_wide.h
+ * @brief N three dimensional vectors stored one lane per vector (AoSoA)
+ */
+#pragma once
+
+#include <cstddef>
+
+#include <array>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/vector3.h"
+#include "temp/math/wide.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+template <class T, std::size_t N>
+class Vector3Wide {
+ public:
+  using WideType = Wide<T, N>;
+  using MaskType = MaskWide<T, N>;
+  using ScalarType = Vector3Base<T>;
+
+  static constexpr std::size_t kWidth = N;
+
+  /**
+   * @brief Load N consecutive vectors stored as Vector3Base (AoS)
+   */
+  static Vector3Wide load(const ScalarType* vectors);
+
+  Vector3Wide();
+  explicit Vector3Wide(const ScalarType& v);
+  explicit Vector3Wide(const WideType& x, const WideType& y,
+                       const WideType& z);
+
+  Vector3Wide(const Vector3Wide&) = default;
+  Vector3Wide& operator=(const Vector3Wide&) = default;
+  ~Vector3Wide() = default;
+
+ public:
+  /**
+   * @brief Store N vectors to consecutive Vector3Base (AoS)
+   */
+  void store(ScalarType* vectors) const;
+
+  ScalarType lane(std::size_t index) const;
+
+  WideType& x();
+  const WideType& x() const;
+  WideType& y();
+  const WideType& y() const;
+  WideType& z();
+  const WideType& z() const;
+
+  Vector3Wide operator+() const;
+  Vector3Wide operator-() const;
+  Vector3Wide& operator+=(const Vector3Wide& rhs);
+  Vector3Wide& operator-=(const Vector3Wide& rhs);
+  Vector3Wide& operator*=(const WideType& rhs);
+  Vector3Wide& operator/=(const WideType& rhs);
+
+ private:
+  std::array<WideType, 3> elements_;
+};
+
+using Vector3x4 = Vector3Wide<float, 4>;
+using Vector3x8 = Vector3Wide<float, 8>;
+using Vector3x16 = Vector3Wide<float, 16>;
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator+(const Vector3Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator-(const Vector3Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator*(const Vector3Wide<T, N>& lhs,
+                            const Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator*(const Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator/(const Vector3Wide<T, N>& lhs,
+                            const Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Wide<T, N> dot(const Vector3Wide<T, N>& lhs, const Vector3Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> cross(const Vector3Wide<T, N>& lhs,
+                        const Vector3Wide<T, N>& rhs);
+
+template <class T, std::size_t N>
+Wide<T, N> squared_magnitude(const Vector3Wide<T, N>& v);
+
+template <class T, std::size_t N>
+Wide<T, N> magnitude(const Vector3Wide<T, N>& v);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> normalize(const Vector3Wide<T, N>& v);
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> select(const MaskWide<T, N>& mask,
+                         const Vector3Wide<T, N>& a,
+                         const Vector3Wide<T, N>& b);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T, std::size_t N>
+Vector3Wide<T, N> Vector3Wide<T, N>::load(const ScalarType* vectors) {
+  alignas(sizeof(T) * N) T xs[N];
+  alignas(sizeof(T) * N) T ys[N];
+  alignas(sizeof(T) * N) T zs[N];
+  for (std::size_t i = 0; i < N; ++i) {
+    xs[i] = vectors[i].x();
+    ys[i] = vectors[i].y();
+    zs[i] = vectors[i].z();
+  }
+  return Vector3Wide(WideType::load(xs), WideType::load(ys),
+                     WideType::load(zs));
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>::Vector3Wide() : elements_{} {}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>::Vector3Wide(const ScalarType& v)
+    : elements_{WideType(v.x()), WideType(v.y()), WideType(v.z())} {}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>::Vector3Wide(const WideType& x, const WideType& y,
+                               const WideType& z)
+    : elements_{x, y, z} {}
+
+template <class T, std::size_t N>
+void Vector3Wide<T, N>::store(ScalarType* vectors) const {
+  alignas(sizeof(T) * N) T xs[N];
+  alignas(sizeof(T) * N) T ys[N];
+  alignas(sizeof(T) * N) T zs[N];
+  x().store(xs);
+  y().store(ys);
+  z().store(zs);
+  for (std::size_t i = 0; i < N; ++i) {
+    vectors[i] = ScalarType(xs[i], ys[i], zs[i]);
+  }
+}
+
+template <class T, std::size_t N>
+typename Vector3Wide<T, N>::ScalarType Vector3Wide<T, N>::lane(
+    std::size_t index) const {
+  TEMP_ASSERT(index < N, "index must be less than lane count");
+  return ScalarType(x()[index], y()[index], z()[index]);
+}
+
+template <class T, std::size_t N>
+typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::x() {
+  return elements_[0];
+}
+
+template <class T, std::size_t N>
+const typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::x() const {
+  return elements_[0];
+}
+
+template <class T, std::size_t N>
+typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::y() {
+  return elements_[1];
+}
+
+template <class T, std::size_t N>
+const typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::y() const {
+  return elements_[1];
+}
+
+template <class T, std::size_t N>
+typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::z() {
+  return elements_[2];
+}
+
+template <class T, std::size_t N>
+const typename Vector3Wide<T, N>::WideType& Vector3Wide<T, N>::z() const {
+  return elements_[2];
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> Vector3Wide<T, N>::operator+() const {
+  return *this;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> Vector3Wide<T, N>::operator-() const {
+  return Vector3Wide(-x(), -y(), -z());
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>& Vector3Wide<T, N>::operator+=(const Vector3Wide& rhs) {
+  x() += rhs.x();
+  y() += rhs.y();
+  z() += rhs.z();
+  return *this;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>& Vector3Wide<T, N>::operator-=(const Vector3Wide& rhs) {
+  x() -= rhs.x();
+  y() -= rhs.y();
+  z() -= rhs.z();
+  return *this;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>& Vector3Wide<T, N>::operator*=(const WideType& rhs) {
+  x() *= rhs;
+  y() *= rhs;
+  z() *= rhs;
+  return *this;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N>& Vector3Wide<T, N>::operator/=(const WideType& rhs) {
+  x() /= rhs;
+  y() /= rhs;
+  z() /= rhs;
+  return *this;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator+(const Vector3Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs) {
+  return Vector3Wide<T, N>(lhs) += rhs;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator-(const Vector3Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs) {
+  return Vector3Wide<T, N>(lhs) -= rhs;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator*(const Vector3Wide<T, N>& lhs,
+                            const Wide<T, N>& rhs) {
+  return Vector3Wide<T, N>(lhs) *= rhs;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator*(const Wide<T, N>& lhs,
+                            const Vector3Wide<T, N>& rhs) {
+  return rhs * lhs;
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> operator/(const Vector3Wide<T, N>& lhs,
+                            const Wide<T, N>& rhs) {
+  return Vector3Wide<T, N>(lhs) /= rhs;
+}
+
+template <class T, std::size_t N>
+Wide<T, N> dot(const Vector3Wide<T, N>& lhs, const Vector3Wide<T, N>& rhs) {
+  return madd(lhs.x(), rhs.x(), madd(lhs.y(), rhs.y(), lhs.z() * rhs.z()));
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> cross(const Vector3Wide<T, N>& lhs,
+                        const Vector3Wide<T, N>& rhs) {
+  return Vector3Wide<T, N>(lhs.y() * rhs.z() - lhs.z() * rhs.y(),
+                           lhs.z() * rhs.x() - lhs.x() * rhs.z(),
+                           lhs.x() * rhs.y() - lhs.y() * rhs.x());
+}
+
+template <class T, std::size_t N>
+Wide<T, N> squared_magnitude(const Vector3Wide<T, N>& v) {
+  return dot(v, v);
+}
+
+template <class T, std::size_t N>
+Wide<T, N> magnitude(const Vector3Wide<T, N>& v) {
+  return sqrt(squared_magnitude(v));
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> normalize(const Vector3Wide<T, N>& v) {
+  return v / magnitude(v);
+}
+
+template <class T, std::size_t N>
+Vector3Wide<T, N> select(const MaskWide<T, N>& mask,
+                         const Vector3Wide<T, N>& a,
+                         const Vector3Wide<T, N>& b) {
+  return Vector3Wide<T, N>(select(mask, a.x(), b.x()),
+                           select(mask, a.y(), b.y()),
+                           select(mask, a.z(), b.z()));
+}
+
+}  // namespace math
+}  // namespace temp
@@ -26,9 +26,9 @@ class Vector4Base {
   using iterator = typename ElementsType::iterator;
   using const_iterator = typename ElementsType::const_iterator;
 
-  Vector4Base();
-  explicit Vector4Base(T x, T y, T z, T w);
-  explicit Vector4Base(const Vector3Base<T> vec3, T w);
+  constexpr Vector4Base();
+  constexpr explicit Vector4Base(T x, T y, T z, T w);
+  constexpr explicit Vector4Base(const Vector3Base<T> vec3, T w);
 
   Vector4Base(const Vector4Base&) = default;
   ~Vector4Base() = default;
@@ -41,32 +41,35 @@ class Vector4Base {
   const_iterator begin() const;
   const_iterator end() const;
 
+  constexpr T* data();
+  constexpr const T* data() const;
+
   std::string toString() const;
 
-  T& operator[](std::size_t index);
-  T operator[](std::size_t index) const;
+  constexpr T& operator[](std::size_t index);
+  constexpr T operator[](std::size_t index) const;
 
-  T& x();
-  T x() const;
-  T& y();
-  T y() const;
-  T& z();
-  T z() const;
-  T& w();
-  T w() const;
+  constexpr T& x();
+  constexpr T x() const;
+  constexpr T& y();
+  constexpr T y() const;
+  constexpr T& z();
+  constexpr T z() const;
+  constexpr T& w();
+  constexpr T w() const;
 
-  bool operator==(const Vector4Base& rhs) const;
-  bool operator!=(const Vector4Base& rhs) const;
+  constexpr bool operator==(const Vector4Base& rhs) const;
+  constexpr bool operator!=(const Vector4Base& rhs) const;
 
-  Vector4Base operator+() const;
-  Vector4Base operator-() const;
-  Vector4Base& operator+=(const Vector4Base& rhs);
-  Vector4Base& operator-=(const Vector4Base& rhs);
-  Vector4Base& operator*=(float rhs);
-  Vector4Base& operator/=(float rhs);
+  constexpr Vector4Base operator+() const;
+  constexpr Vector4Base operator-() const;
+  constexpr Vector4Base& operator+=(const Vector4Base& rhs);
+  constexpr Vector4Base& operator-=(const Vector4Base& rhs);
+  constexpr Vector4Base& operator*=(float rhs);
+  constexpr Vector4Base& operator/=(float rhs);
 
  private:
-  ElementsType elements_;
+  alignas(sizeof(T) * 4) ElementsType elements_;
 };
 
 using Vector4 = Vector4Base<float>;
@@ -76,16 +79,13 @@ using Vector4_64b = Vector4Base<double>;
 // implementation
 //----------------------------------------
 template <class T>
-Vector4Base<T>::Vector4Base() : Vector4Base((T)0, (T)0, (T)0, (T)0) {}
+constexpr Vector4Base<T>::Vector4Base()
+    : Vector4Base((T)0, (T)0, (T)0, (T)0) {}
 template <class T>
-Vector4Base<T>::Vector4Base(T x, T y, T z, T w) {
-  elements_[0] = x;
-  elements_[1] = y;
-  elements_[2] = z;
-  elements_[3] = w;
-}
+constexpr Vector4Base<T>::Vector4Base(T x, T y, T z, T w)
+    : elements_{x, y, z, w} {}
 template <class T>
-Vector4Base<T>::Vector4Base(const Vector3Base<T> vec3, T w)
+constexpr Vector4Base<T>::Vector4Base(const Vector3Base<T> vec3, T w)
     : Vector4Base(vec3.x(), vec3.y(), vec3.z(), w) {}
 
 template <class T>
@@ -98,6 +98,16 @@ auto Vector4Base<T>::end() -> iterator {
   return elements_.end();
 }
 
+template <class T>
+constexpr T* Vector4Base<T>::data() {
+  return elements_.data();
+}
+
+template <class T>
+constexpr const T* Vector4Base<T>::data() const {
+  return elements_.data();
+}
+
 template <class T>
 std::string Vector4Base<T>::toString() const {
   std::stringstream ss;
@@ -106,72 +116,72 @@ std::string Vector4Base<T>::toString() const {
 }
 
 template <class T>
-T& Vector4Base<T>::operator[](std::size_t index) {
+constexpr T& Vector4Base<T>::operator[](std::size_t index) {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return elements_[index];
 }
 
 template <class T>
-T Vector4Base<T>::operator[](std::size_t index) const {
+constexpr T Vector4Base<T>::operator[](std::size_t index) const {
   TEMP_ASSERT(index < 4, "index must be less than 4");
   return elements_[index];
 }
 
 template <class T>
-T& Vector4Base<T>::x() {
+constexpr T& Vector4Base<T>::x() {
   return elements_[0];
 }
 template <class T>
-T Vector4Base<T>::x() const {
+constexpr T Vector4Base<T>::x() const {
   return elements_[0];
 }
 template <class T>
-T& Vector4Base<T>::y() {
+constexpr T& Vector4Base<T>::y() {
   return elements_[1];
 }
 template <class T>
-T Vector4Base<T>::y() const {
+constexpr T Vector4Base<T>::y() const {
   return elements_[1];
 }
 template <class T>
-T& Vector4Base<T>::z() {
+constexpr T& Vector4Base<T>::z() {
   return elements_[2];
 }
 template <class T>
-T Vector4Base<T>::z() const {
+constexpr T Vector4Base<T>::z() const {
   return elements_[2];
 }
 template <class T>
-T& Vector4Base<T>::w() {
+constexpr T& Vector4Base<T>::w() {
   return elements_[3];
 }
 template <class T>
-T Vector4Base<T>::w() const {
+constexpr T Vector4Base<T>::w() const {
   return elements_[3];
 }
 
 template <class T>
-bool Vector4Base<T>::operator==(const Vector4Base& rhs) const {
+constexpr bool Vector4Base<T>::operator==(const Vector4Base& rhs) const {
   return x() == rhs.x() && y() == rhs.y() && z() == rhs.z() && w() == rhs.w();
 }
 
 template <class T>
-bool Vector4Base<T>::operator!=(const Vector4Base& rhs) const {
+constexpr bool Vector4Base<T>::operator!=(const Vector4Base& rhs) const {
   return !(*this == rhs);
 }
 
 template <class T>
-Vector4Base<T> Vector4Base<T>::operator+() const {
+constexpr Vector4Base<T> Vector4Base<T>::operator+() const {
   return *this;
 }
 
 template <class T>
-Vector4Base<T> Vector4Base<T>::operator-() const {
+constexpr Vector4Base<T> Vector4Base<T>::operator-() const {
   return Vector4Base(-x(), -y(), -z(), -w());
 }
 
 template <class T>
-Vector4Base<T>& Vector4Base<T>::operator+=(const Vector4Base& rhs) {
+constexpr Vector4Base<T>& Vector4Base<T>::operator+=(const Vector4Base& rhs) {
   x() += rhs.x();
   y() += rhs.y();
   z() += rhs.z();
@@ -180,7 +190,7 @@ Vector4Base<T>& Vector4Base<T>::operator+=(const Vector4Base& rhs) {
 }
 
 template <class T>
-Vector4Base<T>& Vector4Base<T>::operator-=(const Vector4Base& rhs) {
+constexpr Vector4Base<T>& Vector4Base<T>::operator-=(const Vector4Base& rhs) {
   x() -= rhs.x();
   y() -= rhs.y();
   z() -= rhs.z();
@@ -189,7 +199,7 @@ Vector4Base<T>& Vector4Base<T>::operator-=(const Vector4Base& rhs) {
 }
 
 template <class T>
-Vector4Base<T>& Vector4Base<T>::operator*=(float rhs) {
+constexpr Vector4Base<T>& Vector4Base<T>::operator*=(float rhs) {
   x() *= rhs;
   y() *= rhs;
   z() *= rhs;
@@ -198,7 +208,7 @@ Vector4Base<T>& Vector4Base<T>::operator*=(float rhs) {
 }
 
 template <class T>
-Vector4Base<T>& Vector4Base<T>::operator/=(float rhs) {
+constexpr Vector4Base<T>& Vector4Base<T>::operator/=(float rhs) {
   TEMP_ASSERT(rhs != 0.0f, "rhs must not be zero");
   x() /= rhs;
   y() /= rhs;
@@ -3,6 +3,7 @@
 
 #include <iostream>
 
+#include "temp/math/simd.h"
 #include "temp/math/vector4.h"
 
 namespace temp {
@@ -15,27 +16,29 @@ std::ostream& operator<<(std::ostream& stream, const Vector4Base<T>& vec4) {
 }
 
 template <class T>
-Vector4Base<T> operator+(const Vector4Base<T>& lhs, const Vector4Base<T>& rhs) {
+constexpr Vector4Base<T> operator+(const Vector4Base<T>& lhs,
+                                   const Vector4Base<T>& rhs) {
   return Vector4Base<T>(lhs) += rhs;
 }
 
 template <class T>
-Vector4Base<T> operator-(const Vector4Base<T>& lhs, const Vector4Base<T>& rhs) {
+constexpr Vector4Base<T> operator-(const Vector4Base<T>& lhs,
+                                   const Vector4Base<T>& rhs) {
   return Vector4Base<T>(lhs) -= rhs;
 }
 
 template <class T>
-Vector4Base<T> operator*(const Vector4Base<T>& lhs, float rhs) {
+constexpr Vector4Base<T> operator*(const Vector4Base<T>& lhs, float rhs) {
   return Vector4Base<T>(lhs) *= rhs;
 }
 
 template <class T>
-Vector4Base<T> operator*(float lhs, const Vector4Base<T>& rhs) {
+constexpr Vector4Base<T> operator*(float lhs, const Vector4Base<T>& rhs) {
   return rhs * lhs;
 }
 
 template <class T>
-Vector4Base<T> operator/(const Vector4Base<T>& lhs, float rhs) {
+constexpr Vector4Base<T> operator/(const Vector4Base<T>& lhs, float rhs) {
   return Vector4Base<T>(lhs) /= rhs;
 }
 
@@ -44,7 +47,7 @@ T magnitude(const Vector4Base<T>& v) {
   return sqrtf(squared_magnitude(v));
 }
 template <class T>
-T squared_magnitude(const Vector4Base<T>& v) {
+constexpr T squared_magnitude(const Vector4Base<T>& v) {
   return v.x() * v.x() + v.y() * v.y() + v.z() * v.z() + v.w() * v.w();
 }
 
@@ -54,9 +57,27 @@ Vector4Base<T> normalize(const Vector4Base<T>& v) {
 }
 
 template <class T>
-T dot(const Vector4Base<T>& lhs, const Vector4Base<T>& rhs) {
+constexpr T dot(const Vector4Base<T>& lhs, const Vector4Base<T>& rhs) {
   return lhs.x() * rhs.x() + lhs.y() * rhs.y() + lhs.z() * rhs.z() +
          lhs.w() * rhs.w();
 }
+
+#if defined(TEMP_MATH_SIMD)
+template <>
+inline float dot(const Vector4Base<float>& lhs, const Vector4Base<float>& rhs) {
+  auto m = simd::mul(simd::load(lhs.data()), simd::load(rhs.data()));
+  return simd::get<0>(simd::hsum(m));
+}
+
+template <>
+inline Vector4Base<float> normalize(const Vector4Base<float>& v) {
+  auto a = simd::load(v.data());
+  auto mag = simd::sqrt(simd::hsum(simd::mul(a, a)));
+  TEMP_ASSERT(simd::get<0>(mag) != 0.0f, "rhs must not be zero");
+  Vector4Base<float> result;
+  simd::store(result.data(), simd::div(a, mag));
+  return result;
+}
+#endif
 }  // namespace math
 }  // namespace temp
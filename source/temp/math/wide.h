@@ -0,0 +1,642 @@
+﻿/**
+ * @file wide.h
+ * @brief Lane-wide scalar and mask types for AoSoA math
+ *
+ * Wide<T, N> holds N lanes of T. Wide<float, 4>, Wide<float, 8> and
+ * Wide<float, 16> map to SSE/NEON, AVX and AVX-512 registers when the build
+ * enables those instruction sets; other combinations fall back to plain
+ * arrays that the compiler can auto-vectorize.
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/simd.h"
+
+namespace temp {
+namespace math {
+
+//----------------------------------------
+// register traits
+//----------------------------------------
+template <class T, std::size_t N>
+struct WideRegister {
+  struct Type {
+    alignas(sizeof(T) * N) std::array<T, N> lanes;
+  };
+  struct MaskType {
+    std::array<bool, N> lanes;
+  };
+
+  template <class F>
+  static Type map(const Type& a, const Type& b, F f) {
+    Type r;
+    for (std::size_t i = 0; i < N; ++i) r.lanes[i] = f(a.lanes[i], b.lanes[i]);
+    return r;
+  }
+  template <class F>
+  static MaskType compare(const Type& a, const Type& b, F f) {
+    MaskType r;
+    for (std::size_t i = 0; i < N; ++i) r.lanes[i] = f(a.lanes[i], b.lanes[i]);
+    return r;
+  }
+
+  static Type splat(T v) {
+    Type r;
+    r.lanes.fill(v);
+    return r;
+  }
+  static Type load(const T* p) {
+    Type r;
+    std::copy(p, p + N, r.lanes.begin());
+    return r;
+  }
+  static void store(T* p, const Type& v) {
+    std::copy(v.lanes.begin(), v.lanes.end(), p);
+  }
+  static T get(const Type& v, std::size_t i) { return v.lanes[i]; }
+
+  static Type add(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return x + y; });
+  }
+  static Type sub(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return x - y; });
+  }
+  static Type mul(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return x * y; });
+  }
+  static Type div(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return x / y; });
+  }
+  static Type min(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return std::min(x, y); });
+  }
+  static Type max(const Type& a, const Type& b) {
+    return map(a, b, [](T x, T y) { return std::max(x, y); });
+  }
+  static Type madd(const Type& a, const Type& b, const Type& c) {
+    return add(mul(a, b), c);
+  }
+  static Type neg(const Type& a) {
+    return map(a, a, [](T x, T) { return -x; });
+  }
+  static Type sqrt(const Type& a) {
+    return map(a, a, [](T x, T) { return std::sqrt(x); });
+  }
+  static Type round(const Type& a) {
+    return map(a, a, [](T x, T) { return std::nearbyint(x); });
+  }
+  static Type ldexp(const Type& a, const Type& e) {
+    return map(a, e, [](T x, T y) { return std::ldexp(x, (int)y); });
+  }
+  static Type exponent(const Type& a) {
+    return map(a, a, [](T x, T) { return (T)std::ilogb(x); });
+  }
+  static Type mantissa(const Type& a) {
+    return map(a, a, [](T x, T) {
+      return std::scalbn(std::abs(x), -std::ilogb(x));
+    });
+  }
+  static Type rsqrtEstimate(const Type& a) {
+    return map(a, a, [](T x, T) { return 1 / std::sqrt(x); });
+  }
+  static Type abs(const Type& a) {
+    return map(a, a, [](T x, T) { return std::abs(x); });
+  }
+
+  static MaskType cmpEq(const Type& a, const Type& b) {
+    return compare(a, b, [](T x, T y) { return x == y; });
+  }
+  static MaskType cmpLt(const Type& a, const Type& b) {
+    return compare(a, b, [](T x, T y) { return x < y; });
+  }
+  static MaskType cmpLe(const Type& a, const Type& b) {
+    return compare(a, b, [](T x, T y) { return x <= y; });
+  }
+  static MaskType maskAnd(const MaskType& a, const MaskType& b) {
+    MaskType r;
+    for (std::size_t i = 0; i < N; ++i) r.lanes[i] = a.lanes[i] && b.lanes[i];
+    return r;
+  }
+  static MaskType maskOr(const MaskType& a, const MaskType& b) {
+    MaskType r;
+    for (std::size_t i = 0; i < N; ++i) r.lanes[i] = a.lanes[i] || b.lanes[i];
+    return r;
+  }
+  static MaskType maskNot(const MaskType& m) {
+    MaskType r;
+    for (std::size_t i = 0; i < N; ++i) r.lanes[i] = !m.lanes[i];
+    return r;
+  }
+  static std::uint32_t maskBits(const MaskType& m) {
+    std::uint32_t bits = 0;
+    for (std::size_t i = 0; i < N; ++i) bits |= (m.lanes[i] ? 1u : 0u) << i;
+    return bits;
+  }
+  static Type select(const MaskType& m, const Type& a, const Type& b) {
+    Type r;
+    for (std::size_t i = 0; i < N; ++i) {
+      r.lanes[i] = m.lanes[i] ? a.lanes[i] : b.lanes[i];
+    }
+    return r;
+  }
+};
+
+#if defined(TEMP_MATH_SIMD)
+template <>
+struct WideRegister<float, 4> {
+  using Type = simd::Float4;
+  using MaskType = simd::Mask4;
+
+  static Type splat(float v) { return simd::splat(v); }
+  static Type load(const float* p) { return simd::loadUnaligned(p); }
+  static void store(float* p, Type v) { simd::storeUnaligned(p, v); }
+  static float get(Type v, std::size_t i) {
+    alignas(16) float lanes[4];
+    simd::store(lanes, v);
+    return lanes[i];
+  }
+
+  static Type add(Type a, Type b) { return simd::add(a, b); }
+  static Type sub(Type a, Type b) { return simd::sub(a, b); }
+  static Type mul(Type a, Type b) { return simd::mul(a, b); }
+  static Type div(Type a, Type b) { return simd::div(a, b); }
+  static Type min(Type a, Type b) { return simd::min(a, b); }
+  static Type max(Type a, Type b) { return simd::max(a, b); }
+  static Type madd(Type a, Type b, Type c) { return simd::madd(a, b, c); }
+  static Type neg(Type a) { return simd::neg(a); }
+  static Type sqrt(Type a) { return simd::sqrt(a); }
+  static Type round(Type a) { return simd::round(a); }
+  static Type ldexp(Type a, Type e) { return simd::ldexp(a, e); }
+  static Type exponent(Type a) { return simd::exponent(a); }
+  static Type mantissa(Type a) { return simd::mantissa(a); }
+  static Type rsqrtEstimate(Type a) { return simd::rsqrtEstimate(a); }
+  static Type abs(Type a) { return simd::abs(a); }
+
+  static MaskType cmpEq(Type a, Type b) { return simd::cmpEq(a, b); }
+  static MaskType cmpLt(Type a, Type b) { return simd::cmpLt(a, b); }
+  static MaskType cmpLe(Type a, Type b) { return simd::cmpLe(a, b); }
+  static MaskType maskAnd(MaskType a, MaskType b) {
+    return simd::maskAnd(a, b);
+  }
+  static MaskType maskOr(MaskType a, MaskType b) { return simd::maskOr(a, b); }
+  static MaskType maskNot(MaskType m) { return simd::maskNot(m); }
+  static std::uint32_t maskBits(MaskType m) { return simd::maskBits(m); }
+  static Type select(MaskType m, Type a, Type b) {
+    return simd::select(m, a, b);
+  }
+};
+#endif
+
+#if defined(TEMP_MATH_SIMD_SSE) && defined(__AVX__)
+template <>
+struct WideRegister<float, 8> {
+  using Type = __m256;
+  using MaskType = __m256;
+
+#if !defined(__AVX2__)
+  // AVXには256ビットの整数演算がないので、128ビットずつ処理する
+  template <class F>
+  static Type halves(Type a, Type b, F f) {
+    auto lo = f(_mm256_castps256_ps128(a), _mm256_castps256_ps128(b));
+    auto hi = f(_mm256_extractf128_ps(a, 1), _mm256_extractf128_ps(b, 1));
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+  }
+#endif
+
+  static Type splat(float v) { return _mm256_set1_ps(v); }
+  static Type load(const float* p) { return _mm256_loadu_ps(p); }
+  static void store(float* p, Type v) { _mm256_storeu_ps(p, v); }
+  static float get(Type v, std::size_t i) {
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, v);
+    return lanes[i];
+  }
+
+  static Type add(Type a, Type b) { return _mm256_add_ps(a, b); }
+  static Type sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+  static Type mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+  static Type div(Type a, Type b) { return _mm256_div_ps(a, b); }
+  static Type min(Type a, Type b) { return _mm256_min_ps(a, b); }
+  static Type max(Type a, Type b) { return _mm256_max_ps(a, b); }
+  static Type madd(Type a, Type b, Type c) {
+#if defined(TEMP_MATH_SIMD_AVX2)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+  }
+  static Type neg(Type a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+  static Type sqrt(Type a) { return _mm256_sqrt_ps(a); }
+  static Type round(Type a) {
+    return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static Type ldexp(Type a, Type e) {
+#if defined(__AVX2__)
+    auto bits = _mm256_slli_epi32(
+        _mm256_add_epi32(_mm256_cvtps_epi32(e), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(a, _mm256_castsi256_ps(bits));
+#else
+    return halves(a, e, [](__m128 x, __m128 y) { return simd::ldexp(x, y); });
+#endif
+  }
+  static Type exponent(Type a) {
+#if defined(__AVX2__)
+    auto bits = _mm256_and_si256(_mm256_srli_epi32(_mm256_castps_si256(a), 23),
+                                 _mm256_set1_epi32(0xff));
+    return _mm256_cvtepi32_ps(_mm256_sub_epi32(bits, _mm256_set1_epi32(127)));
+#else
+    return halves(a, a, [](__m128 x, __m128) { return simd::exponent(x); });
+#endif
+  }
+  static Type mantissa(Type a) {
+    auto bits =
+        _mm256_and_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff)));
+    return _mm256_or_ps(bits,
+                        _mm256_castsi256_ps(_mm256_set1_epi32(0x3f800000)));
+  }
+  static Type rsqrtEstimate(Type a) { return _mm256_rsqrt_ps(a); }
+  static Type abs(Type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+  static MaskType cmpEq(Type a, Type b) {
+    return _mm256_cmp_ps(a, b, _CMP_EQ_OQ);
+  }
+  static MaskType cmpLt(Type a, Type b) {
+    return _mm256_cmp_ps(a, b, _CMP_LT_OQ);
+  }
+  static MaskType cmpLe(Type a, Type b) {
+    return _mm256_cmp_ps(a, b, _CMP_LE_OQ);
+  }
+  static MaskType maskAnd(MaskType a, MaskType b) {
+    return _mm256_and_ps(a, b);
+  }
+  static MaskType maskOr(MaskType a, MaskType b) { return _mm256_or_ps(a, b); }
+  static MaskType maskNot(MaskType m) {
+    return _mm256_xor_ps(m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+  }
+  static std::uint32_t maskBits(MaskType m) {
+    return static_cast<std::uint32_t>(_mm256_movemask_ps(m));
+  }
+  static Type select(MaskType m, Type a, Type b) {
+    return _mm256_blendv_ps(b, a, m);
+  }
+};
+#endif
+
+#if defined(TEMP_MATH_SIMD_SSE) && defined(__AVX512F__)
+template <>
+struct WideRegister<float, 16> {
+  using Type = __m512;
+  using MaskType = __mmask16;
+
+  static Type splat(float v) { return _mm512_set1_ps(v); }
+  static Type load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, Type v) { _mm512_storeu_ps(p, v); }
+  static float get(Type v, std::size_t i) {
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, v);
+    return lanes[i];
+  }
+
+  static Type add(Type a, Type b) { return _mm512_add_ps(a, b); }
+  static Type sub(Type a, Type b) { return _mm512_sub_ps(a, b); }
+  static Type mul(Type a, Type b) { return _mm512_mul_ps(a, b); }
+  static Type div(Type a, Type b) { return _mm512_div_ps(a, b); }
+  static Type min(Type a, Type b) { return _mm512_min_ps(a, b); }
+  static Type max(Type a, Type b) { return _mm512_max_ps(a, b); }
+  static Type madd(Type a, Type b, Type c) { return _mm512_fmadd_ps(a, b, c); }
+  static Type neg(Type a) { return _mm512_sub_ps(_mm512_setzero_ps(), a); }
+  static Type sqrt(Type a) { return _mm512_sqrt_ps(a); }
+  static Type round(Type a) {
+    return _mm512_roundscale_ps(a,
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static Type ldexp(Type a, Type e) { return _mm512_scalef_ps(a, e); }
+  static Type exponent(Type a) { return _mm512_getexp_ps(a); }
+  static Type mantissa(Type a) {
+    return _mm512_getmant_ps(a, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+  }
+  static Type rsqrtEstimate(Type a) { return _mm512_rsqrt14_ps(a); }
+  static Type abs(Type a) { return _mm512_abs_ps(a); }
+
+  static MaskType cmpEq(Type a, Type b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ);
+  }
+  static MaskType cmpLt(Type a, Type b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ);
+  }
+  static MaskType cmpLe(Type a, Type b) {
+    return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ);
+  }
+  static MaskType maskAnd(MaskType a, MaskType b) {
+    return static_cast<MaskType>(a & b);
+  }
+  static MaskType maskOr(MaskType a, MaskType b) {
+    return static_cast<MaskType>(a | b);
+  }
+  static MaskType maskNot(MaskType m) { return static_cast<MaskType>(~m); }
+  static std::uint32_t maskBits(MaskType m) {
+    return static_cast<std::uint32_t>(m);
+  }
+  static Type select(MaskType m, Type a, Type b) {
+    return _mm512_mask_blend_ps(m, b, a);
+  }
+};
+#endif
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+template <class T, std::size_t N>
+class MaskWide {
+ public:
+  using RegisterTraits = WideRegister<T, N>;
+  using RegisterType = typename RegisterTraits::MaskType;
+
+  MaskWide() = default;
+  explicit MaskWide(RegisterType reg) : reg_(reg) {}
+
+  RegisterType reg() const { return reg_; }
+
+  /// Bit i is set when lane i is true.
+  std::uint32_t bits() const { return RegisterTraits::maskBits(reg_); }
+  bool any() const { return bits() != 0; }
+  bool all() const { return bits() == (std::uint32_t)((1ull << N) - 1); }
+  bool operator[](std::size_t index) const {
+    TEMP_ASSERT(index < N, "index must be less than lane count");
+    return ((bits() >> index) & 1) != 0;
+  }
+
+  friend MaskWide operator&(const MaskWide& lhs, const MaskWide& rhs) {
+    return MaskWide(RegisterTraits::maskAnd(lhs.reg_, rhs.reg_));
+  }
+  friend MaskWide operator|(const MaskWide& lhs, const MaskWide& rhs) {
+    return MaskWide(RegisterTraits::maskOr(lhs.reg_, rhs.reg_));
+  }
+  friend MaskWide operator!(const MaskWide& m) {
+    return MaskWide(RegisterTraits::maskNot(m.reg_));
+  }
+
+ private:
+  RegisterType reg_;
+};
+
+template <class T, std::size_t N>
+class Wide {
+ public:
+  using RegisterTraits = WideRegister<T, N>;
+  using RegisterType = typename RegisterTraits::Type;
+  using MaskType = MaskWide<T, N>;
+  using ElementType = T;
+
+  static constexpr std::size_t kWidth = N;
+
+  /**
+   * @brief Load N lanes from consecutive elements
+   */
+  static Wide load(const T* elements);
+
+  Wide();
+  Wide(T value);  // NOLINT: broadcasting a scalar is implicit
+  explicit Wide(RegisterType reg);
+
+  Wide(const Wide&) = default;
+  Wide& operator=(const Wide&) = default;
+  ~Wide() = default;
+
+ public:
+  void store(T* elements) const;
+
+  T operator[](std::size_t index) const;
+
+  RegisterType reg() const;
+
+  Wide operator+() const;
+  Wide operator-() const;
+  Wide& operator+=(const Wide& rhs);
+  Wide& operator-=(const Wide& rhs);
+  Wide& operator*=(const Wide& rhs);
+  Wide& operator/=(const Wide& rhs);
+
+  friend Wide operator+(const Wide& lhs, const Wide& rhs) {
+    return Wide(lhs) += rhs;
+  }
+  friend Wide operator-(const Wide& lhs, const Wide& rhs) {
+    return Wide(lhs) -= rhs;
+  }
+  friend Wide operator*(const Wide& lhs, const Wide& rhs) {
+    return Wide(lhs) *= rhs;
+  }
+  friend Wide operator/(const Wide& lhs, const Wide& rhs) {
+    return Wide(lhs) /= rhs;
+  }
+
+  friend MaskType operator==(const Wide& lhs, const Wide& rhs) {
+    return MaskType(RegisterTraits::cmpEq(lhs.reg_, rhs.reg_));
+  }
+  friend MaskType operator!=(const Wide& lhs, const Wide& rhs) {
+    return !(lhs == rhs);
+  }
+  friend MaskType operator<(const Wide& lhs, const Wide& rhs) {
+    return MaskType(RegisterTraits::cmpLt(lhs.reg_, rhs.reg_));
+  }
+  friend MaskType operator<=(const Wide& lhs, const Wide& rhs) {
+    return MaskType(RegisterTraits::cmpLe(lhs.reg_, rhs.reg_));
+  }
+  friend MaskType operator>(const Wide& lhs, const Wide& rhs) {
+    return rhs < lhs;
+  }
+  friend MaskType operator>=(const Wide& lhs, const Wide& rhs) {
+    return rhs <= lhs;
+  }
+
+ private:
+  RegisterType reg_;
+};
+
+using Floatx4 = Wide<float, 4>;
+using Floatx8 = Wide<float, 8>;
+using Floatx16 = Wide<float, 16>;
+
+template <class T, std::size_t N>
+Wide<T, N> select(const MaskWide<T, N>& mask, const Wide<T, N>& a,
+                  const Wide<T, N>& b);
+
+template <class T, std::size_t N>
+Wide<T, N> sqrt(const Wide<T, N>& v);
+
+template <class T, std::size_t N>
+Wide<T, N> min(const Wide<T, N>& a, const Wide<T, N>& b);
+
+template <class T, std::size_t N>
+Wide<T, N> max(const Wide<T, N>& a, const Wide<T, N>& b);
+
+template <class T, std::size_t N>
+Wide<T, N> madd(const Wide<T, N>& a, const Wide<T, N>& b, const Wide<T, N>& c);
+
+template <class T, std::size_t N>
+Wide<T, N> abs(const Wide<T, N>& v);
+
+/**
+ * @brief Round to nearest integer, |v| < 2^22
+ */
+template <class T, std::size_t N>
+Wide<T, N> round(const Wide<T, N>& v);
+
+/**
+ * @brief v * 2^e for integral e in [-126, 127]
+ */
+template <class T, std::size_t N>
+Wide<T, N> ldexp(const Wide<T, N>& v, const Wide<T, N>& e);
+
+/**
+ * @brief floor(log2(v)) of positive normal v
+ */
+template <class T, std::size_t N>
+Wide<T, N> exponent(const Wide<T, N>& v);
+
+/**
+ * @brief v / 2^exponent(v) in [1, 2) of positive normal v
+ */
+template <class T, std::size_t N>
+Wide<T, N> mantissa(const Wide<T, N>& v);
+
+/**
+ * @brief 1 / sqrt(v) with relative error below 2^-11
+ */
+template <class T, std::size_t N>
+Wide<T, N> rsqrtEstimate(const Wide<T, N>& v);
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class T, std::size_t N>
+Wide<T, N> Wide<T, N>::load(const T* elements) {
+  return Wide(RegisterTraits::load(elements));
+}
+
+template <class T, std::size_t N>
+Wide<T, N>::Wide() : Wide((T)0) {}
+
+template <class T, std::size_t N>
+Wide<T, N>::Wide(T value) : reg_(RegisterTraits::splat(value)) {}
+
+template <class T, std::size_t N>
+Wide<T, N>::Wide(RegisterType reg) : reg_(reg) {}
+
+template <class T, std::size_t N>
+void Wide<T, N>::store(T* elements) const {
+  RegisterTraits::store(elements, reg_);
+}
+
+template <class T, std::size_t N>
+T Wide<T, N>::operator[](std::size_t index) const {
+  TEMP_ASSERT(index < N, "index must be less than lane count");
+  return RegisterTraits::get(reg_, index);
+}
+
+template <class T, std::size_t N>
+typename Wide<T, N>::RegisterType Wide<T, N>::reg() const {
+  return reg_;
+}
+
+template <class T, std::size_t N>
+Wide<T, N> Wide<T, N>::operator+() const {
+  return *this;
+}
+
+template <class T, std::size_t N>
+Wide<T, N> Wide<T, N>::operator-() const {
+  return Wide(RegisterTraits::neg(reg_));
+}
+
+template <class T, std::size_t N>
+Wide<T, N>& Wide<T, N>::operator+=(const Wide& rhs) {
+  reg_ = RegisterTraits::add(reg_, rhs.reg_);
+  return *this;
+}
+
+template <class T, std::size_t N>
+Wide<T, N>& Wide<T, N>::operator-=(const Wide& rhs) {
+  reg_ = RegisterTraits::sub(reg_, rhs.reg_);
+  return *this;
+}
+
+template <class T, std::size_t N>
+Wide<T, N>& Wide<T, N>::operator*=(const Wide& rhs) {
+  reg_ = RegisterTraits::mul(reg_, rhs.reg_);
+  return *this;
+}
+
+template <class T, std::size_t N>
+Wide<T, N>& Wide<T, N>::operator/=(const Wide& rhs) {
+  reg_ = RegisterTraits::div(reg_, rhs.reg_);
+  return *this;
+}
+
+template <class T, std::size_t N>
+Wide<T, N> select(const MaskWide<T, N>& mask, const Wide<T, N>& a,
+                  const Wide<T, N>& b) {
+  return Wide<T, N>(WideRegister<T, N>::select(mask.reg(), a.reg(), b.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> sqrt(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::sqrt(v.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> min(const Wide<T, N>& a, const Wide<T, N>& b) {
+  return Wide<T, N>(WideRegister<T, N>::min(a.reg(), b.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> max(const Wide<T, N>& a, const Wide<T, N>& b) {
+  return Wide<T, N>(WideRegister<T, N>::max(a.reg(), b.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> madd(const Wide<T, N>& a, const Wide<T, N>& b,
+                const Wide<T, N>& c) {
+  return Wide<T, N>(WideRegister<T, N>::madd(a.reg(), b.reg(), c.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> abs(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::abs(v.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> round(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::round(v.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> ldexp(const Wide<T, N>& v, const Wide<T, N>& e) {
+  return Wide<T, N>(WideRegister<T, N>::ldexp(v.reg(), e.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> exponent(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::exponent(v.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> mantissa(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::mantissa(v.reg()));
+}
+
+template <class T, std::size_t N>
+Wide<T, N> rsqrtEstimate(const Wide<T, N>& v) {
+  return Wide<T, N>(WideRegister<T, N>::rsqrtEstimate(v.reg()));
+}
+
+}  // namespace math
+}  // namespace temp
@@ -1,7 +1,145 @@
 ﻿#include "temp/render/camera.h"
 
+#include <cmath>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/bounds_functions.h"
+#include "temp/math/functions.h"
+#include "temp/math/matrix44_functions.h"
+
 namespace temp {
 namespace render {
 
+Camera::Camera()
+    : clear_mode(ClearMode::kSolidColor),
+      clear_color(gfx::Color::kBlack),
+      position_(0.0f, 0.0f, 0.0f),
+      rotation_(math::Quaternion::kIdentity),
+      projection_type_(ProjectionType::kPerspective),
+      near_clip_(0.3f),
+      far_clip_(1000.0f),
+      field_of_view_(60.0f),
+      orthographic_size_(5.0f),
+      aspect_ratio_(16.0f / 9.0f),
+      reversed_z_(false),
+      dirty_(kViewDirty | kProjectionDirty),
+      matrix_version_(0) {}
+
+void Camera::set_position(const math::Vector3& position) {
+  position_ = position;
+  dirty_ |= kViewDirty;
+}
+
+void Camera::set_rotation(const math::Quaternion& rotation) {
+  rotation_ = rotation;
+  dirty_ |= kViewDirty;
+}
+
+void Camera::set_projection_type(ProjectionType projection_type) {
+  projection_type_ = projection_type;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_near_clip(float near_clip) {
+  near_clip_ = near_clip;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_far_clip(float far_clip) {
+  far_clip_ = far_clip;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_field_of_view(float field_of_view) {
+  field_of_view_ = field_of_view;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_orthographic_size(float orthographic_size) {
+  orthographic_size_ = orthographic_size;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_aspect_ratio(float aspect_ratio) {
+  aspect_ratio_ = aspect_ratio;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::set_reversed_z(bool reversed_z) {
+  reversed_z_ = reversed_z;
+  dirty_ |= kProjectionDirty;
+}
+
+void Camera::UpdateMatrices() {
+  if (dirty_ == 0) {
+    return;
+  }
+
+  if ((dirty_ & kViewDirty) != 0) {
+    view_matrix_ = math::viewFromTransform(rotation_, position_);
+  }
+
+  if ((dirty_ & kProjectionDirty) != 0) {
+    if (projection_type_ == ProjectionType::kPerspective) {
+      float fov = math::degreeToRadian(field_of_view_);
+      if (std::isinf(far_clip_)) {
+        projection_matrix_ =
+            reversed_z_ ? math::perspectiveInfiniteReversedZ(
+                              fov, aspect_ratio_, near_clip_)
+                        : math::perspectiveInfinite(fov, aspect_ratio_,
+                                                    near_clip_);
+      } else {
+        projection_matrix_ =
+            reversed_z_ ? math::perspectiveReversedZ(fov, aspect_ratio_,
+                                                     near_clip_, far_clip_)
+                        : math::perspective(fov, aspect_ratio_, near_clip_,
+                                            far_clip_);
+      }
+    } else {
+      float height = orthographic_size_ * 2.0f;
+      float width = height * aspect_ratio_;
+      projection_matrix_ =
+          reversed_z_ ? math::orthographicReversedZ(width, height, near_clip_,
+                                                    far_clip_)
+                      : math::orthographic(width, height, near_clip_,
+                                           far_clip_);
+    }
+  }
+
+  view_projection_matrix_ = projection_matrix_ * view_matrix_;
+  frustum_ = math::extractFrustum(view_projection_matrix_);
+  dirty_ = 0;
+  ++matrix_version_;
+}
+
+void Camera::UpdateMatrices(Camera* const* cameras, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    if (cameras[i]->dirty_ != 0) {
+      cameras[i]->UpdateMatrices();
+    }
+  }
+}
+
+const math::Matrix44& Camera::view_matrix() const {
+  TEMP_ASSERT(dirty_ == 0, "Call UpdateMatrices() after changing camera");
+  return view_matrix_;
+}
+
+const math::Matrix44& Camera::projection_matrix() const {
+  TEMP_ASSERT(dirty_ == 0, "Call UpdateMatrices() after changing camera");
+  return projection_matrix_;
+}
+
+const math::Matrix44& Camera::view_projection_matrix() const {
+  TEMP_ASSERT(dirty_ == 0, "Call UpdateMatrices() after changing camera");
+  return view_projection_matrix_;
+}
+
+const math::Frustum& Camera::frustum() const {
+  TEMP_ASSERT(dirty_ == 0, "Call UpdateMatrices() after changing camera");
+  return frustum_;
+}
+
 }  // namespace render
 }  // namespace temp
\ No newline at end of file
@@ -1,8 +1,11 @@
 ﻿#pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 
+#include "temp/math/bounds.h"
 #include "temp/math/matrix44.h"
 #include "temp/math/quaternion.h"
 #include "temp/math/vector3.h"
@@ -17,7 +20,17 @@ class ObjectManager;
 
 namespace render {
 
-struct Camera {
+/**
+ * @brief Camera with cached view and projection matrices
+ *
+ * Parameters that affect the matrices are changed through setters, which
+ * only mark the matrices dirty. UpdateMatrices() recomputes what changed,
+ * so a camera that did not move costs nothing per frame.
+ *
+ * The matrices follow the left handed, depth [0, 1] convention of
+ * math::perspective; the camera looks down its local +z axis.
+ */
+class Camera {
   friend class ObjectManager<Camera>;
 
  public:
@@ -32,17 +45,109 @@ struct Camera {
     kNone,
   };
 
-  math::Vector3 position;
-  math::Quaternion rotation;
+  Camera();
+
+ public:
   ClearMode clear_mode;
   gfx::Color clear_color;
-  ProjectionType projection_type;
-  float near_clip;
-  float far_clip;
-  float field_of_view;
-  float orthographic_size;
-  float aspect_ratio;
   std::shared_ptr<gfx::SwapChain> swap_chain;
+
+ public:
+  const math::Vector3& position() const { return position_; }
+  void set_position(const math::Vector3& position);
+
+  const math::Quaternion& rotation() const { return rotation_; }
+  void set_rotation(const math::Quaternion& rotation);
+
+  ProjectionType projection_type() const { return projection_type_; }
+  void set_projection_type(ProjectionType projection_type);
+
+  float near_clip() const { return near_clip_; }
+  void set_near_clip(float near_clip);
+
+  /**
+   * @brief Distance to far plane, infinity for a perspective without one
+   */
+  float far_clip() const { return far_clip_; }
+  void set_far_clip(float far_clip);
+
+  /**
+   * @brief Vertical field of view in degrees
+   */
+  float field_of_view() const { return field_of_view_; }
+  void set_field_of_view(float field_of_view);
+
+  /**
+   * @brief Half of the vertical size of orthographic view volume
+   */
+  float orthographic_size() const { return orthographic_size_; }
+  void set_orthographic_size(float orthographic_size);
+
+  float aspect_ratio() const { return aspect_ratio_; }
+  void set_aspect_ratio(float aspect_ratio);
+
+  /**
+   * @brief Map near to depth 1 and far to depth 0
+   */
+  bool reversed_z() const { return reversed_z_; }
+  void set_reversed_z(bool reversed_z);
+
+  /**
+   * @brief Recompute the matrices whose inputs changed
+   */
+  void UpdateMatrices();
+
+  /**
+   * @brief UpdateMatrices() for many cameras, skipping unchanged ones
+   */
+  static void UpdateMatrices(Camera* const* cameras, std::size_t count);
+
+  /**
+   * @brief Whether UpdateMatrices() has to recompute the view matrix
+   */
+  bool view_dirty() const { return (dirty_ & kViewDirty) != 0; }
+
+  /**
+   * @brief Whether UpdateMatrices() has to recompute the projection matrix
+   */
+  bool projection_dirty() const { return (dirty_ & kProjectionDirty) != 0; }
+
+  /**
+   * @brief Count of UpdateMatrices() calls that recomputed the matrices
+   *
+   * Compare with a previous value to find out whether data built from the
+   * matrices is stale.
+   */
+  std::uint32_t matrix_version() const { return matrix_version_; }
+
+  // UpdateMatrices() の後でのみ有効
+  const math::Matrix44& view_matrix() const;
+  const math::Matrix44& projection_matrix() const;
+  const math::Matrix44& view_projection_matrix() const;
+  const math::Frustum& frustum() const;
+
+ private:
+  enum DirtyFlag : std::uint32_t {
+    kViewDirty = 1 << 0,
+    kProjectionDirty = 1 << 1,
+  };
+
+  math::Vector3 position_;
+  math::Quaternion rotation_;
+  ProjectionType projection_type_;
+  float near_clip_;
+  float far_clip_;
+  float field_of_view_;
+  float orthographic_size_;
+  float aspect_ratio_;
+  bool reversed_z_;
+
+  std::uint32_t dirty_;
+  std::uint32_t matrix_version_;
+  math::Matrix44 view_matrix_;
+  math::Matrix44 projection_matrix_;
+  math::Matrix44 view_projection_matrix_;
+  math::Frustum frustum_;
 };
 
 }  // namespace render
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "temp/math/bounds.h"
+
+namespace temp {
+namespace render {
+
+/**
+ * @brief Object drawn by every camera whose frustum intersects its bounds
+ *
+ * There are no meshes or materials yet, so each item is one draw of a
+ * triangle covering the render target in white.
+ */
+struct DrawItem {
+  /// world space
+  math::Aabb bounds;
+};
+
+}  // namespace render
+}  // namespace temp
@@ -1,6 +1,7 @@
 #include "temp/base/define.h"
 
 #include "temp/render/camera.h"
+#include "temp/render/draw_item.h"
 #include "temp/render/renderer.h"
 
 #ifdef TEMP_GFX_API_VULKAN
@@ -22,7 +23,10 @@ Renderer* CreateVulkanRenderer(
 }
 }  // namespace
 
-Renderer::Renderer() { camera_manager_ = ObjectManager<Camera>::Create(); }
+Renderer::Renderer() {
+  camera_manager_ = ObjectManager<Camera>::Create();
+  draw_item_manager_ = ObjectManager<DrawItem>::Create();
+}
 
 Renderer::~Renderer() {}
 
@@ -30,6 +34,27 @@ ObjectManager<Camera>::CreateType Renderer::CreateCamera() {
   return camera_manager_->CreateObject();
 }
 
+ObjectManager<DrawItem>::CreateType Renderer::CreateDrawItem() {
+  return draw_item_manager_->CreateObject();
+}
+
+const std::vector<Camera*>& Renderer::UpdateCameras() {
+  camera_manager_->RemoveUnusedObjects();
+  cameras_.clear();
+  camera_manager_->Foreach(
+      [this](Camera& camera) { cameras_.push_back(&camera); });
+  Camera::UpdateMatrices(cameras_.data(), cameras_.size());
+  return cameras_;
+}
+
+const std::vector<DrawItem*>& Renderer::UpdateDrawItems() {
+  draw_item_manager_->RemoveUnusedObjects();
+  draw_items_.clear();
+  draw_item_manager_->Foreach(
+      [this](DrawItem& item) { draw_items_.push_back(&item); });
+  return draw_items_;
+}
+
 std::unique_ptr<Renderer> CreateRenderer(
     const std::shared_ptr<temp::gfx::Device>& device) {
   auto api = device->api_type();
@@ -3,6 +3,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include "temp/base/object_manager.h"
 #include "temp/gfx/device.h"
@@ -10,7 +11,8 @@
 namespace temp {
 namespace render {
 
-struct Camera;
+class Camera;
+struct DrawItem;
 
 class Renderer {
  public:
@@ -21,8 +23,29 @@ class Renderer {
 
   ObjectManager<Camera>::CreateType CreateCamera();
 
+  ObjectManager<DrawItem>::CreateType CreateDrawItem();
+
  protected:
+  /**
+   * @brief Refresh cached matrices of cameras changed since last frame
+   *
+   * @return Cameras to render this frame
+   */
+  const std::vector<Camera*>& UpdateCameras();
+
+  /**
+   * @brief Remove destroyed draw items
+   *
+   * @return Draw items to render this frame
+   */
+  const std::vector<DrawItem*>& UpdateDrawItems();
+
   std::shared_ptr<ObjectManager<Camera>> camera_manager_;
+  std::shared_ptr<ObjectManager<DrawItem>> draw_item_manager_;
+
+ private:
+  std::vector<Camera*> cameras_;
+  std::vector<DrawItem*> draw_items_;
 };
 
 std::unique_ptr<Renderer> CreateRenderer(
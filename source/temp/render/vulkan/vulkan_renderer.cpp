@@ -1,91 +1,205 @@
 ﻿#pragma once
 
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <thread>
+
 #include "temp/render/vulkan/vulkan_renderer.h"
 #include "temp/render/camera.h"
+#include "temp/render/draw_item.h"
+
+#include "temp/math/bounds_functions.h"
 
 #include "temp/gfx/vulkan/vulkan_swap_chain.h"
 
 namespace temp {
 namespace render {
 namespace vulkan {
-
 namespace {
-vk::UniqueRenderPass CreateRenderPass(const vk::Device vk_device,
-                                      vk::Format color_format) {
-  vk::AttachmentDescription color_attachment;
-  color_attachment.format = color_format;
-  color_attachment.samples = vk::SampleCountFlagBits::e1;
-  color_attachment.loadOp = vk::AttachmentLoadOp::eClear;
-  color_attachment.storeOp = vk::AttachmentStoreOp::eStore;
-  color_attachment.stencilLoadOp = vk::AttachmentLoadOp::eDontCare;
-  color_attachment.stencilStoreOp = vk::AttachmentStoreOp::eDontCare;
-  color_attachment.initialLayout = vk::ImageLayout::eUndefined;
-  color_attachment.finalLayout = vk::ImageLayout::ePresentSrcKHR;
-
-  vk::AttachmentReference color_attachment_ref;
-  color_attachment_ref.attachment = 0;
-  color_attachment_ref.layout = vk::ImageLayout::eColorAttachmentOptimal;
-
-  vk::SubpassDescription subpass;
-  subpass.pipelineBindPoint = vk::PipelineBindPoint::eGraphics;
-  subpass.colorAttachmentCount = 1;
-  subpass.pColorAttachments = &color_attachment_ref;
-
-  vk::RenderPassCreateInfo render_pass_ci;
-  vk::SubpassDependency subpass_dependency;
-  subpass_dependency.dstSubpass = 0;
-  subpass_dependency.srcStageMask =
-      vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  subpass_dependency.srcAccessMask = vk::AccessFlagBits();
-  subpass_dependency.dstStageMask =
-      vk::PipelineStageFlagBits::eColorAttachmentOutput;
-  subpass_dependency.dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead |
-                                     vk::AccessFlagBits::eColorAttachmentWrite;
-  render_pass_ci.attachmentCount = 1;
-  render_pass_ci.pAttachments = &color_attachment;
-  render_pass_ci.subpassCount = 1;
-  render_pass_ci.pSubpasses = &subpass;
-  render_pass_ci.dependencyCount = 1;
-  render_pass_ci.pDependencies = &subpass_dependency;
-  return vk_device.createRenderPassUnique(render_pass_ci);
-}
+// void main() {
+//   vec2 uv = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+//   gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
+// }
+const std::vector<std::uint32_t> kFullScreenVertexSpirv = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001c, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0007000f, 0x00000000,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00000003, 0x00040047,
+    0x00000002, 0x0000000b, 0x0000002a, 0x00040047, 0x00000003, 0x0000000b,
+    0x00000000, 0x00020013, 0x00000004, 0x00030021, 0x00000005, 0x00000004,
+    0x00040015, 0x00000006, 0x00000020, 0x00000001, 0x00030016, 0x00000007,
+    0x00000020, 0x00040017, 0x00000008, 0x00000007, 0x00000004, 0x00040020,
+    0x00000009, 0x00000001, 0x00000006, 0x00040020, 0x0000000a, 0x00000003,
+    0x00000008, 0x0004003b, 0x00000009, 0x00000002, 0x00000001, 0x0004003b,
+    0x0000000a, 0x00000003, 0x00000003, 0x0004002b, 0x00000006, 0x0000000b,
+    0x00000001, 0x0004002b, 0x00000006, 0x0000000c, 0x00000002, 0x0004002b,
+    0x00000007, 0x0000000d, 0x00000000, 0x0004002b, 0x00000007, 0x0000000e,
+    0x3f800000, 0x0004002b, 0x00000007, 0x0000000f, 0x40000000, 0x00050036,
+    0x00000004, 0x00000001, 0x00000000, 0x00000005, 0x000200f8, 0x00000010,
+    0x0004003d, 0x00000006, 0x00000011, 0x00000002, 0x000500c4, 0x00000006,
+    0x00000012, 0x00000011, 0x0000000b, 0x000500c7, 0x00000006, 0x00000013,
+    0x00000012, 0x0000000c, 0x000500c7, 0x00000006, 0x00000014, 0x00000011,
+    0x0000000c, 0x0004006f, 0x00000007, 0x00000015, 0x00000013, 0x0004006f,
+    0x00000007, 0x00000016, 0x00000014, 0x00050085, 0x00000007, 0x00000017,
+    0x00000015, 0x0000000f, 0x00050085, 0x00000007, 0x00000018, 0x00000016,
+    0x0000000f, 0x00050083, 0x00000007, 0x00000019, 0x00000017, 0x0000000e,
+    0x00050083, 0x00000007, 0x0000001a, 0x00000018, 0x0000000e, 0x00070050,
+    0x00000008, 0x0000001b, 0x00000019, 0x0000001a, 0x0000000d, 0x0000000e,
+    0x0003003e, 0x00000003, 0x0000001b, 0x000100fd, 0x00010038};
+
+// layout(location = 0) out vec4 color;
+// void main() { color = vec4(1.0); }
+const std::vector<std::uint32_t> kWhiteFragmentSpirv = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000000b, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001,
+    0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013,
+    0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005,
+    0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020,
+    0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002,
+    0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x3f800000, 0x0007002c,
+    0x00000006, 0x00000009, 0x00000008, 0x00000008, 0x00000008, 0x00000008,
+    0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8,
+    0x0000000a, 0x0003003e, 0x00000002, 0x00000009, 0x000100fd, 0x00010038};
 }  // namespace
 
-VulkanRenderer::VulkanRenderer(const std::shared_ptr<gfx::Device>& device) {
+VulkanRenderer::VulkanRenderer(const std::shared_ptr<gfx::Device>& device)
+    : VulkanRenderer(device, std::thread::hardware_concurrency()) {}
+
+VulkanRenderer::VulkanRenderer(const std::shared_ptr<gfx::Device>& device,
+                               std::size_t worker_count,
+                               bool recycle_command_buffers)
+    : worker_count_(worker_count) {
   using namespace std;
   using namespace gfx::vulkan;
   device_ = static_pointer_cast<VulkanDevice>(device);
   auto vk_device = device_->device();
 
-  vk::CommandPoolCreateInfo command_pool_ci;
-  auto pair = device_->queue_index_table().find(vk::QueueFlagBits::eGraphics);
-  command_pool_ci.queueFamilyIndex = pair->second;
-  command_pool_ = vk_device.createCommandPoolUnique(command_pool_ci);
+  if (worker_count_ > 0) {
+    thread_pool_ = make_unique<ThreadPool>(worker_count_);
+  }
+
+  auto queue_family_index = device_->graphics_queue_index();
+
+  vk::FenceCreateInfo fence_ci;
+  fence_ci.flags = vk::FenceCreateFlagBits::eSignaled;
+  for (auto&& frame : frames_) {
+    // 0 番は呼び出し元のスレッド用
+    for (size_t i = 0; i < worker_count_ + 1; ++i) {
+      frame.command_pools.emplace_back(vk_device, queue_family_index,
+                                       recycle_command_buffers);
+    }
+    frame.fence = vk_device.createFenceUnique(fence_ci);
+  }
+
+  // 描画項目はまだメッシュを持たないので、画面を覆う白い三角形を描く
+  pipeline_layout_ =
+      vk_device.createPipelineLayoutUnique(vk::PipelineLayoutCreateInfo());
+  pipeline_cache_ = make_unique<VulkanPipelineStateCache>(*device_, "", 0);
+  draw_state_.vertex_shader = kFullScreenVertexSpirv;
+  draw_state_.fragment_shader = kWhiteFragmentSpirv;
+  draw_state_.cull_mode = vk::CullModeFlagBits::eNone;
+  vk::PipelineColorBlendAttachmentState blend_attachment;
+  blend_attachment.colorWriteMask =
+      vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+      vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+  draw_state_.blend_attachments.push_back(blend_attachment);
+  draw_state_.layout = *pipeline_layout_;
+}
+
+VulkanRenderer::~VulkanRenderer() {
+  // 実行中のコマンドバッファを解放しないように待つ
+  device_->device().waitIdle();
 }
 
 void VulkanRenderer::Render() {
   using namespace std;
   using namespace gfx::vulkan;
 
-  primary_command_buffers_.clear();
+  auto vk_device = device_->device();
 
-  camera_manager_->Foreach([this](Camera camera) {
-    if (camera.swap_chain != nullptr) {
-      vk::CommandBufferAllocateInfo command_buffer_ai;
-      command_buffer_ai.commandPool = *command_pool_;
-      command_buffer_ai.level = vk::CommandBufferLevel::ePrimary;
-      command_buffer_ai.commandBufferCount = 1;
-      auto command_buffers =
-          device_->device().allocateCommandBuffersUnique(command_buffer_ai);
+  // frames_.size() 前のフレームが終われば、そのコマンドバッファを再利用できる
+  auto&& frame = frames_[frame_index_ % frames_.size()];
+  ++frame_index_;
+  vk_device.waitForFences(*frame.fence, VK_TRUE,
+                          numeric_limits<uint64_t>::max());
+  for (auto&& command_pool : frame.command_pools) {
+    command_pool.Reset();
+  }
 
-      auto&& command_buffer = command_buffers[0];
+  // 行列は変更のあったカメラだけ更新され、描画中は再計算しない
+  vector<Camera*> cameras;
+  for (auto camera : UpdateCameras()) {
+    if (camera->swap_chain != nullptr) {
+      cameras.push_back(camera);
+    }
+  }
 
-      auto swap_chain = static_pointer_cast<VulkanSwapChain>(camera.swap_chain);
+  auto&& draw_items = UpdateDrawItems();
 
-      vk::CommandBufferBeginInfo command_buffer_bi;
-      command_buffer_bi.flags =
-          vk::CommandBufferUsageFlagBits::eSimultaneousUse;
-      command_buffer->begin(command_buffer_bi);
+  // スワップチェーンは最初に現れたカメラの順に、一度だけイメージを取得する。
+  // パイプラインはレンダーパスで決まり、キャッシュはスレッドセーフでない
+  // ので、記録の前にここで引いておく
+  vector<VulkanSwapChain*> swap_chains;
+  vector<vk::Pipeline> pipelines;
+  vector<vk::Pipeline> camera_pipelines;
+  camera_pipelines.reserve(cameras.size());
+  for (auto camera : cameras) {
+    auto swap_chain = static_cast<VulkanSwapChain*>(camera->swap_chain.get());
+    auto iter = find(swap_chains.begin(), swap_chains.end(), swap_chain);
+    if (iter == swap_chains.end()) {
+      swap_chain->AcquireNextImage(vk_device);
+      draw_state_.render_pass = swap_chain->render_pass();
+      pipelines.push_back(pipeline_cache_->GetPipeline(draw_state_));
+      iter = swap_chains.insert(swap_chains.end(), swap_chain);
+    }
+    camera_pipelines.push_back(pipelines[iter - swap_chains.begin()]);
+  }
+
+  // カメラの中身はセカンダリに並列で記録する。どのスレッドが記録しても
+  // 実行する順番はカメラの順で変わらない
+  vector<vk::CommandBuffer> secondaries(cameras.size());
+  auto record = [this, &frame, &cameras, &camera_pipelines, &draw_items,
+                 &secondaries](size_t pool_index, size_t begin, size_t end) {
+    auto&& command_pool = frame.command_pools[pool_index];
+    for (auto i = begin; i < end; ++i) {
+      secondaries[i] =
+          command_pool.Allocate(vk::CommandBufferLevel::eSecondary);
+      RecordCamera(secondaries[i], *cameras[i], camera_pipelines[i],
+                   draw_items);
+    }
+  };
+  auto task_count =
+      min(worker_count_, (cameras.size() + kMinTaskCameras - 1) /
+                             kMinTaskCameras);
+  if (task_count <= 1) {
+    record(0, 0, cameras.size());
+  } else {
+    vector<future<void>> futures;
+    for (size_t t = 0; t < task_count; ++t) {
+      auto begin = cameras.size() * t / task_count;
+      auto end = cameras.size() * (t + 1) / task_count;
+      futures.push_back(thread_pool_->enqueue(record, t + 1, begin, end));
+    }
+    for (auto&& future : futures) {
+      future.get();
+    }
+  }
+
+  // スワップチェーンごとにプライマリを1つ作り、レンダーパスを並べる
+  auto&& command_pool = frame.command_pools[0];
+  for (auto swap_chain : swap_chains) {
+    auto command_buffer =
+        command_pool.Allocate(vk::CommandBufferLevel::ePrimary);
+
+    vk::CommandBufferBeginInfo command_buffer_bi;
+    command_buffer_bi.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit;
+    command_buffer.begin(command_buffer_bi);
+
+    for (size_t i = 0; i < cameras.size(); ++i) {
+      if (cameras[i]->swap_chain.get() != swap_chain) {
+        continue;
+      }
 
       vk::RenderPassBeginInfo render_pass_bi;
       render_pass_bi.renderPass = swap_chain->render_pass();
@@ -93,26 +207,64 @@ void VulkanRenderer::Render() {
       render_pass_bi.renderArea.extent =
           vk::Extent2D{swap_chain->width(), swap_chain->height()};
       vk::ClearValue clear_value;
-      auto&& c = camera.clear_color;
+      auto&& c = cameras[i]->clear_color;
       clear_value.color.setFloat32({c.red, c.green, c.blue, c.alpha});
       render_pass_bi.clearValueCount = 1;
       render_pass_bi.pClearValues = &clear_value;
       render_pass_bi.framebuffer = swap_chain->current_frame_buffer();
 
-      command_buffer->beginRenderPass(render_pass_bi,
-                                      vk::SubpassContents::eInline);
+      command_buffer.beginRenderPass(
+          render_pass_bi, vk::SubpassContents::eSecondaryCommandBuffers);
+      command_buffer.executeCommands(secondaries[i]);
+      command_buffer.endRenderPass();
+    }
 
-      command_buffer->endRenderPass();
-      command_buffer->end();
+    command_buffer.end();
+    swap_chain->Submit(*device_, {command_buffer});
+  }
 
-      primary_command_buffers_.insert(
-          primary_command_buffers_.end(),
-          make_move_iterator(command_buffers.begin()),
-          make_move_iterator(command_buffers.end()));
+  // 空の提出のフェンスは、先に提出した処理がすべて終わるとシグナルされる
+  auto&& graphics_queue =
+      device_->queue_table().find(vk::QueueFlagBits::eGraphics)->second;
+  vk_device.resetFences(*frame.fence);
+  graphics_queue.submit(nullptr, *frame.fence);
+}
+
+void VulkanRenderer::RecordCamera(
+    vk::CommandBuffer command_buffer, const Camera& camera,
+    vk::Pipeline pipeline, const std::vector<DrawItem*>& draw_items) const {
+  using namespace gfx::vulkan;
+  auto swap_chain = static_cast<VulkanSwapChain*>(camera.swap_chain.get());
+
+  vk::CommandBufferInheritanceInfo inheritance_info;
+  inheritance_info.renderPass = swap_chain->render_pass();
+  inheritance_info.subpass = 0;
+  inheritance_info.framebuffer = swap_chain->current_frame_buffer();
+
+  vk::CommandBufferBeginInfo command_buffer_bi;
+  command_buffer_bi.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit |
+                            vk::CommandBufferUsageFlagBits::eRenderPassContinue;
+  command_buffer_bi.pInheritanceInfo = &inheritance_info;
+  command_buffer.begin(command_buffer_bi);
+
+  auto width = static_cast<float>(swap_chain->width());
+  auto height = static_cast<float>(swap_chain->height());
+  vk::Viewport viewport(0.0f, 0.0f, width, height, 0.0f, 1.0f);
+  command_buffer.setViewport(0, viewport);
+  vk::Rect2D scissor(vk::Offset2D{0, 0},
+                     vk::Extent2D{swap_chain->width(), swap_chain->height()});
+  command_buffer.setScissor(0, scissor);
+
+  // 視錐台と交わる描画項目だけを記録する
+  command_buffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+  auto&& frustum = camera.frustum();
+  for (auto item : draw_items) {
+    if (math::intersects(frustum, item->bounds)) {
+      command_buffer.draw(3, 1, 0, 0);
     }
-    camera.clear_color;
-  });
-  camera_manager_->RemoveUnusedObjects();
+  }
+
+  command_buffer.end();
 }
 }  // namespace vulkan
 }  // namespace render
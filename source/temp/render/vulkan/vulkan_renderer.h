@@ -3,30 +3,84 @@
 #include "temp/base/define.h"
 #ifdef TEMP_GFX_API_VULKAN
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
+
+#include "temp/base/thread_pool.h"
 
 #include "temp/render/renderer.h"
 
+#include "temp/gfx/vulkan/vulkan_command_pool.h"
 #include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_pipeline_state_cache.h"
+#include "temp/gfx/vulkan/vulkan_swap_chain.h"
 
 namespace temp {
 namespace render {
 namespace vulkan {
+/**
+ * @brief Renderer recording cameras in parallel
+ *
+ * The contents of each camera's render pass are recorded into a secondary
+ * command buffer on worker threads, and a primary per swap chain executes
+ * them in camera order, so the result does not depend on the scheduling.
+ * A secondary has one draw per draw item the camera sees.
+ */
 class VulkanRenderer : public Renderer {
  public:
   VulkanRenderer() = delete;
   explicit VulkanRenderer(const std::shared_ptr<gfx::Device>& device);
 
+  /**
+   * @param worker_count threads recording secondary command buffers,
+   *                     0 records on the calling thread
+   * @param recycle_command_buffers false allocates and frees command buffers
+   *                                every frame, for comparison in benchmarks
+   */
+  VulkanRenderer(const std::shared_ptr<gfx::Device>& device,
+                 std::size_t worker_count,
+                 bool recycle_command_buffers = true);
+  ~VulkanRenderer();
+
   void Render() override;
 
  private:
+  // 1つのタスクで記録する最小のカメラ数
+  static const std::size_t kMinTaskCameras = 16;
+
   using VkDeviceSPtr = std::shared_ptr<gfx::vulkan::VulkanDevice>;
 
+  /**
+   * @brief Resources of a frame alive until the GPU finishes it
+   */
+  struct Frame {
+    // 記録するスレッドごとに1つ
+    std::vector<gfx::vulkan::VulkanCommandPool> command_pools;
+    vk::UniqueFence fence;
+  };
+
+  void RecordCamera(vk::CommandBuffer command_buffer, const Camera& camera,
+                    vk::Pipeline pipeline,
+                    const std::vector<DrawItem*>& draw_items) const;
+
   VkDeviceSPtr device_;
 
-  vk::UniqueCommandPool command_pool_;
-  std::vector<vk::UniqueCommandBuffer> primary_command_buffers_;
+  vk::UniquePipelineLayout pipeline_layout_;
+  std::unique_ptr<gfx::vulkan::VulkanPipelineStateCache> pipeline_cache_;
+  // render_pass はスワップチェーンごとに差し替える
+  gfx::vulkan::GraphicsPipelineState draw_state_;
+
+  std::size_t worker_count_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // スワップチェーンのフレーム数以上あれば、スワップチェーンより先に待たない
+  std::array<Frame, gfx::vulkan::VulkanSwapChain::kMaxFrameCount> frames_;
+  std::uint64_t frame_index_ = 0;
 };
 }  // namespace vulkan
 }  // namespace render
@@ -0,0 +1,461 @@
+﻿#include "temp/spatial/aabb_tree.h"
+
+#include <algorithm>
+#include <array>
+
+namespace temp {
+namespace spatial {
+
+namespace {
+// Bins per axis of the SAH rebuild
+constexpr int kSahBins = 16;
+
+// Ranges this small are split by sorting instead of binning
+constexpr std::size_t kSahSortThreshold = 4;
+
+math::Aabb emptyAabb() {
+  auto inf = std::numeric_limits<float>::infinity();
+  return math::Aabb{math::Vector3(inf, inf, inf),
+                    math::Vector3(-inf, -inf, -inf)};
+}
+}  // namespace
+
+AabbTree::AabbTree(float margin)
+    : margin_(margin),
+      root_(kNullNode),
+      free_node_(kNullNode),
+      free_proxy_(kNullProxy),
+      proxy_count_(0) {}
+
+auto AabbTree::insert(const math::Aabb& aabb, std::uintptr_t user_data)
+    -> ProxyId {
+  ProxyId proxy;
+  if (free_proxy_ != kNullProxy) {
+    proxy = free_proxy_;
+    free_proxy_ = proxies_[proxy].node;
+  } else {
+    proxy = static_cast<ProxyId>(proxies_.size());
+    proxies_.emplace_back();
+  }
+
+  auto leaf = allocateNode();
+  auto&& node = nodes_[leaf];
+  math::Vector3 margin(margin_, margin_, margin_);
+  node.aabb = math::Aabb{aabb.min - margin, aabb.max + margin};
+  node.proxy = proxy;
+  node.height = 0;
+  proxies_[proxy] = Proxy{leaf, user_data};
+  ++proxy_count_;
+
+  insertLeaf(leaf);
+  return proxy;
+}
+
+void AabbTree::remove(ProxyId proxy) {
+  TEMP_ASSERT(0 <= proxy && proxy < (ProxyId)proxies_.size(),
+              "proxy is out of range");
+  auto leaf = proxies_[proxy].node;
+  removeLeaf(leaf);
+  freeNode(leaf);
+
+  proxies_[proxy].node = free_proxy_;
+  free_proxy_ = proxy;
+  --proxy_count_;
+}
+
+bool AabbTree::update(ProxyId proxy, const math::Aabb& aabb) {
+  TEMP_ASSERT(0 <= proxy && proxy < (ProxyId)proxies_.size(),
+              "proxy is out of range");
+  auto leaf = proxies_[proxy].node;
+  const auto& fat = nodes_[leaf].aabb;
+  if (math::contains(fat, aabb.min) && math::contains(fat, aabb.max)) {
+    return false;
+  }
+
+  removeLeaf(leaf);
+  math::Vector3 margin(margin_, margin_, margin_);
+  nodes_[leaf].aabb = math::Aabb{aabb.min - margin, aabb.max + margin};
+  insertLeaf(leaf);
+  return true;
+}
+
+void AabbTree::refit(ProxyId proxy, const math::Aabb& aabb) {
+  TEMP_ASSERT(0 <= proxy && proxy < (ProxyId)proxies_.size(),
+              "proxy is out of range");
+  auto leaf = proxies_[proxy].node;
+  math::Vector3 margin(margin_, margin_, margin_);
+  nodes_[leaf].aabb = math::Aabb{aabb.min - margin, aabb.max + margin};
+  refitAncestors(nodes_[leaf].parent);
+}
+
+void AabbTree::rebuild() {
+  if (root_ == kNullNode) {
+    return;
+  }
+
+  std::vector<BuildItem> items;
+  items.reserve(proxy_count_);
+  for (NodeId i = 0; i < (NodeId)nodes_.size(); ++i) {
+    if (nodes_[i].height == 0) {
+      const auto& aabb = nodes_[i].aabb;
+      items.push_back(BuildItem{aabb, math::center(aabb), i});
+    }
+  }
+
+  std::vector<Node> nodes;
+  nodes.reserve(items.size() * 2 - 1);
+  root_ = buildSah(items, 0, items.size(), nodes);
+  nodes[root_].parent = kNullNode;
+  nodes_.swap(nodes);
+  free_node_ = kNullNode;
+
+  for (NodeId i = 0; i < (NodeId)nodes_.size(); ++i) {
+    if (nodes_[i].isLeaf()) {
+      proxies_[nodes_[i].proxy].node = i;
+    }
+  }
+}
+
+void AabbTree::clear() {
+  root_ = kNullNode;
+  free_node_ = kNullNode;
+  free_proxy_ = kNullProxy;
+  proxy_count_ = 0;
+  nodes_.clear();
+  proxies_.clear();
+}
+
+const math::Aabb& AabbTree::fatAabb(ProxyId proxy) const {
+  TEMP_ASSERT(0 <= proxy && proxy < (ProxyId)proxies_.size(),
+              "proxy is out of range");
+  return nodes_[proxies_[proxy].node].aabb;
+}
+
+std::uintptr_t AabbTree::userData(ProxyId proxy) const {
+  TEMP_ASSERT(0 <= proxy && proxy < (ProxyId)proxies_.size(),
+              "proxy is out of range");
+  return proxies_[proxy].user_data;
+}
+
+std::size_t AabbTree::proxyCount() const { return proxy_count_; }
+
+std::int32_t AabbTree::height() const {
+  return root_ == kNullNode ? -1 : nodes_[root_].height;
+}
+
+float AabbTree::cost() const {
+  if (root_ == kNullNode) {
+    return 0.0f;
+  }
+  float area = 0.0f;
+  for (const auto& node : nodes_) {
+    if (node.height > 0) {
+      area += math::surfaceArea(node.aabb);
+    }
+  }
+  float root_area = math::surfaceArea(nodes_[root_].aabb);
+  return root_area > 0.0f ? area / root_area : 0.0f;
+}
+
+void AabbTree::validate() const {
+  if (root_ == kNullNode) {
+    TEMP_ASSERT(proxy_count_ == 0, "empty tree must not have proxies");
+    return;
+  }
+  TEMP_ASSERT(nodes_[root_].parent == kNullNode, "root must not have parent");
+  validate(root_);
+
+  std::size_t free_count = 0;
+  for (auto node = free_node_; node != kNullNode; node = nodes_[node].parent) {
+    ++free_count;
+  }
+  TEMP_ASSERT(free_count + proxy_count_ * 2 - 1 == nodes_.size(),
+              "every node must be in the tree or on the free list");
+}
+
+auto AabbTree::allocateNode() -> NodeId {
+  NodeId node;
+  if (free_node_ != kNullNode) {
+    node = free_node_;
+    free_node_ = nodes_[node].parent;
+  } else {
+    node = static_cast<NodeId>(nodes_.size());
+    nodes_.emplace_back();
+  }
+  auto&& n = nodes_[node];
+  n.parent = kNullNode;
+  n.child1 = kNullNode;
+  n.child2 = kNullNode;
+  n.proxy = kNullProxy;
+  n.height = 0;
+  return node;
+}
+
+void AabbTree::freeNode(NodeId node) {
+  nodes_[node].parent = free_node_;
+  nodes_[node].height = -1;
+  free_node_ = node;
+}
+
+void AabbTree::insertLeaf(NodeId leaf) {
+  if (root_ == kNullNode) {
+    root_ = leaf;
+    nodes_[root_].parent = kNullNode;
+    return;
+  }
+
+  // 面積の増分が最小になる兄弟を、親へ押し付けられる増分も含めて探す
+  auto leaf_aabb = nodes_[leaf].aabb;
+  auto index = root_;
+  while (!nodes_[index].isLeaf()) {
+    const auto& node = nodes_[index];
+    float area = math::surfaceArea(node.aabb);
+    float combined_area = math::surfaceArea(math::merge(node.aabb, leaf_aabb));
+
+    // ここを兄弟にしたときのコストと、下に降りるときに祖先に増える面積
+    float cost = 2.0f * combined_area;
+    float inheritance_cost = 2.0f * (combined_area - area);
+
+    auto child_cost = [&](NodeId child) {
+      const auto& c = nodes_[child];
+      float merged = math::surfaceArea(math::merge(c.aabb, leaf_aabb));
+      float grown = c.isLeaf() ? merged : merged - math::surfaceArea(c.aabb);
+      return grown + inheritance_cost;
+    };
+    float cost1 = child_cost(node.child1);
+    float cost2 = child_cost(node.child2);
+    if (cost < cost1 && cost < cost2) {
+      break;
+    }
+    index = cost1 < cost2 ? node.child1 : node.child2;
+  }
+  auto sibling = index;
+
+  auto old_parent = nodes_[sibling].parent;
+  auto new_parent = allocateNode();
+  {
+    auto&& p = nodes_[new_parent];
+    p.parent = old_parent;
+    p.aabb = math::merge(leaf_aabb, nodes_[sibling].aabb);
+    p.height = nodes_[sibling].height + 1;
+    p.child1 = sibling;
+    p.child2 = leaf;
+  }
+  if (old_parent != kNullNode) {
+    auto&& op = nodes_[old_parent];
+    (op.child1 == sibling ? op.child1 : op.child2) = new_parent;
+  } else {
+    root_ = new_parent;
+  }
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+
+  refitAncestors(nodes_[leaf].parent);
+}
+
+void AabbTree::removeLeaf(NodeId leaf) {
+  if (leaf == root_) {
+    root_ = kNullNode;
+    return;
+  }
+
+  auto parent = nodes_[leaf].parent;
+  auto grand_parent = nodes_[parent].parent;
+  auto sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2
+                                               : nodes_[parent].child1;
+  if (grand_parent != kNullNode) {
+    auto&& gp = nodes_[grand_parent];
+    (gp.child1 == parent ? gp.child1 : gp.child2) = sibling;
+    nodes_[sibling].parent = grand_parent;
+    freeNode(parent);
+    refitAncestors(grand_parent);
+  } else {
+    root_ = sibling;
+    nodes_[sibling].parent = kNullNode;
+    freeNode(parent);
+  }
+}
+
+void AabbTree::refitAncestors(NodeId node) {
+  while (node != kNullNode) {
+    node = balance(node);
+    auto&& n = nodes_[node];
+    const auto& c1 = nodes_[n.child1];
+    const auto& c2 = nodes_[n.child2];
+    n.height = 1 + std::max(c1.height, c2.height);
+    n.aabb = math::merge(c1.aabb, c2.aabb);
+    node = n.parent;
+  }
+}
+
+auto AabbTree::balance(NodeId ia) -> NodeId {
+  // 左右の高さの差が2以上ならAVL木と同じように回転して、高い方の子を持ち上げる
+  const auto& node = nodes_[ia];
+  if (node.isLeaf()) {
+    return ia;
+  }
+
+  auto ib = node.child1;
+  auto ic = node.child2;
+  std::int32_t diff = nodes_[ic].height - nodes_[ib].height;
+  if (diff >= -1 && diff <= 1) {
+    return ia;
+  }
+
+  // up を a の位置に持ち上げ、a は up の子になる
+  auto rotate = [this, ia](NodeId up, NodeId other) {
+    auto&& a = nodes_[ia];
+    auto&& u = nodes_[up];
+    auto ifc = u.child1;
+    auto igc = u.child2;
+
+    u.child1 = ia;
+    u.parent = a.parent;
+    a.parent = up;
+    if (u.parent != kNullNode) {
+      auto&& p = nodes_[u.parent];
+      (p.child1 == ia ? p.child1 : p.child2) = up;
+    } else {
+      root_ = up;
+    }
+
+    // 高い方の孫を u に残し、低い方を a に渡す
+    auto&& f = nodes_[ifc];
+    auto&& g = nodes_[igc];
+    NodeId keep = f.height > g.height ? ifc : igc;
+    NodeId give = keep == ifc ? igc : ifc;
+    u.child2 = keep;
+    (a.child1 == up ? a.child1 : a.child2) = give;
+    nodes_[give].parent = ia;
+
+    const auto& o = nodes_[other];
+    const auto& gv = nodes_[give];
+    a.aabb = math::merge(o.aabb, gv.aabb);
+    a.height = 1 + std::max(o.height, gv.height);
+    const auto& k = nodes_[keep];
+    u.aabb = math::merge(a.aabb, k.aabb);
+    u.height = 1 + std::max(a.height, k.height);
+    return up;
+  };
+
+  return diff > 1 ? rotate(ic, ib) : rotate(ib, ic);
+}
+
+auto AabbTree::buildSah(std::vector<BuildItem>& items, std::size_t begin,
+                        std::size_t end, std::vector<Node>& nodes) const
+    -> NodeId {
+  auto index = static_cast<NodeId>(nodes.size());
+  if (end - begin == 1) {
+    auto leaf = nodes_[items[begin].leaf];
+    leaf.parent = kNullNode;
+    nodes.push_back(leaf);
+    return index;
+  }
+  nodes.emplace_back();
+
+  // 重心の範囲が最も広い軸で分割する
+  auto centroid_bounds = emptyAabb();
+  for (auto i = begin; i < end; ++i) {
+    const auto& c = items[i].centroid;
+    centroid_bounds = math::merge(centroid_bounds, math::Aabb{c, c});
+  }
+  auto size = centroid_bounds.max - centroid_bounds.min;
+  int axis = size.x() > size.y() ? (size.x() > size.z() ? 0 : 2)
+                                 : (size.y() > size.z() ? 1 : 2);
+
+  auto first = items.begin() + begin;
+  auto last = items.begin() + end;
+  auto middle = first + (end - begin) / 2;
+  if (size[axis] <= 0.0f) {
+    // 重心が全て同じなら半分に分ける
+  } else if (end - begin <= kSahSortThreshold) {
+    std::sort(first, last, [axis](const BuildItem& lhs, const BuildItem& rhs) {
+      return lhs.centroid[axis] < rhs.centroid[axis];
+    });
+  } else {
+    struct Bin {
+      math::Aabb aabb = emptyAabb();
+      std::size_t count = 0;
+    };
+    std::array<Bin, kSahBins> bins;
+    float offset = centroid_bounds.min[axis];
+    float scale = kSahBins / size[axis];
+    auto binIndex = [axis, offset, scale](const BuildItem& item) {
+      int b = static_cast<int>((item.centroid[axis] - offset) * scale);
+      return std::min(b, kSahBins - 1);
+    };
+    for (auto it = first; it != last; ++it) {
+      auto&& bin = bins[binIndex(*it)];
+      bin.aabb = math::merge(bin.aabb, it->aabb);
+      ++bin.count;
+    }
+
+    // 右から累積した面積と数を用意して、分割ごとに左右のコストを比べる
+    std::array<float, kSahBins> right_cost;
+    auto right = emptyAabb();
+    std::size_t right_count = 0;
+    for (int b = kSahBins - 1; b > 0; --b) {
+      right = math::merge(right, bins[b].aabb);
+      right_count += bins[b].count;
+      right_cost[b] =
+          right_count > 0 ? math::surfaceArea(right) * right_count : 0.0f;
+    }
+    int best_split = -1;
+    float best_cost = std::numeric_limits<float>::max();
+    auto left = emptyAabb();
+    std::size_t left_count = 0;
+    for (int b = 1; b < kSahBins; ++b) {
+      left = math::merge(left, bins[b - 1].aabb);
+      left_count += bins[b - 1].count;
+      if (left_count == 0 || left_count == end - begin) {
+        continue;
+      }
+      float cost = math::surfaceArea(left) * left_count + right_cost[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_split = b;
+      }
+    }
+    if (best_split > 0) {
+      middle = std::partition(first, last, [&](const BuildItem& item) {
+        return binIndex(item) < best_split;
+      });
+    }
+  }
+
+  auto split = static_cast<std::size_t>(middle - items.begin());
+  auto child1 = buildSah(items, begin, split, nodes);
+  auto child2 = buildSah(items, split, end, nodes);
+  auto&& node = nodes[index];
+  node.child1 = child1;
+  node.child2 = child2;
+  node.proxy = kNullProxy;
+  node.parent = kNullNode;
+  node.aabb = math::merge(nodes[child1].aabb, nodes[child2].aabb);
+  node.height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+  nodes[child1].parent = index;
+  nodes[child2].parent = index;
+  return index;
+}
+
+std::int32_t AabbTree::validate(NodeId node) const {
+  const auto& n = nodes_[node];
+  if (n.isLeaf()) {
+    TEMP_ASSERT(n.height == 0, "leaf height must be 0");
+    TEMP_ASSERT(proxies_[n.proxy].node == node, "proxy must point to leaf");
+    return 1;
+  }
+  const auto& c1 = nodes_[n.child1];
+  const auto& c2 = nodes_[n.child2];
+  TEMP_ASSERT(c1.parent == node && c2.parent == node,
+              "children must point to parent");
+  TEMP_ASSERT(n.height == 1 + std::max(c1.height, c2.height),
+              "height must be one more than the higher child");
+  auto merged = math::merge(c1.aabb, c2.aabb);
+  TEMP_ASSERT(merged.min == n.aabb.min && merged.max == n.aabb.max,
+              "node must be the union of its children");
+  return validate(n.child1) + validate(n.child2);
+}
+
+}  // namespace spatial
+}  // namespace temp
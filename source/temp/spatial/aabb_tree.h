@@ -0,0 +1,388 @@
+﻿/**
+ * @file aabb_tree.h
+ * @brief Dynamic bounding volume hierarchy of axis aligned boxes
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/bounds.h"
+#include "temp/math/bounds_functions.h"
+
+namespace temp {
+namespace spatial {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+/**
+ * @brief Dynamic AABB tree
+ *
+ * Each object is a proxy whose id stays valid until it is removed. Leaves
+ * hold the object box grown by margin ("fat" box), so small movements can
+ * be applied by update() without touching the tree. Insertion picks the
+ * sibling by surface area heuristic and keeps the tree balanced with
+ * rotations; rebuild() rebuilds everything with binned SAH.
+ *
+ * Nodes live in one array. rebuild() lays them out in depth first order so
+ * that a left child follows its parent.
+ *
+ * Queries report proxies whose fat box passes the test, so callers that
+ * need exact results test their own bounds in the callback. Queries are
+ * const and may run concurrently with each other.
+ */
+class AabbTree {
+ public:
+  using ProxyId = std::int32_t;
+  static constexpr ProxyId kNullProxy = -1;
+
+  /**
+   * @param margin distance leaf boxes are grown by
+   */
+  explicit AabbTree(float margin = 0.0f);
+
+  AabbTree(const AabbTree&) = default;
+  AabbTree& operator=(const AabbTree&) = default;
+  ~AabbTree() = default;
+
+ public:
+  /**
+   * @brief Add object
+   *
+   * @param aabb bounds of object
+   * @param user_data value returned by userData()
+   * @return ProxyId
+   */
+  ProxyId insert(const math::Aabb& aabb, std::uintptr_t user_data = 0);
+
+  void remove(ProxyId proxy);
+
+  /**
+   * @brief Move object, reinserting it when it leaves its fat box
+   *
+   * @return true The tree was restructured
+   * @return false The fat box still contains aabb
+   */
+  bool update(ProxyId proxy, const math::Aabb& aabb);
+
+  /**
+   * @brief Replace the bounds of object and refit its ancestors
+   *
+   * Cheaper than update() for objects that move a lot but stay in the same
+   * region, at the cost of tree quality. Call rebuild() from time to time.
+   */
+  void refit(ProxyId proxy, const math::Aabb& aabb);
+
+  /**
+   * @brief Rebuild the whole tree with binned SAH
+   *
+   * Proxy ids do not change.
+   */
+  void rebuild();
+
+  void clear();
+
+  const math::Aabb& fatAabb(ProxyId proxy) const;
+  std::uintptr_t userData(ProxyId proxy) const;
+  std::size_t proxyCount() const;
+
+  /**
+   * @brief Height of tree, 0 for a single leaf and -1 when empty
+   */
+  std::int32_t height() const;
+
+  /**
+   * @brief SAH cost of tree: summed area of internal nodes over root area
+   */
+  float cost() const;
+
+  /**
+   * @brief Check structural invariants with TEMP_ASSERT
+   */
+  void validate() const;
+
+  /**
+   * @brief Report proxies whose fat box overlaps aabb
+   *
+   * @param callback called as callback(ProxyId)
+   */
+  template <class F>
+  void query(const math::Aabb& aabb, F&& callback) const;
+
+  /**
+   * @brief Report proxies whose fat box overlaps sphere
+   */
+  template <class F>
+  void query(const math::Sphere& sphere, F&& callback) const;
+
+  /**
+   * @brief Report proxies whose fat box passes intersects(Frustum, Aabb)
+   *
+   * Subtrees entirely inside the frustum are reported without further
+   * tests.
+   */
+  template <class F>
+  void query(const math::Frustum& frustum, F&& callback) const;
+
+  /**
+   * @brief Find the closest object hit by ray
+   *
+   * Leaves are visited roughly front to back and skipped once their fat box
+   * is farther than the closest hit so far.
+   *
+   * @param ray ray
+   * @param max_distance ignore hits at or beyond this distance
+   * @param callback called as callback(ProxyId), returns the distance to
+   *                 the object or infinity when it is missed
+   * @param distance receives the distance to the closest hit (max_distance
+   *                 when nothing is hit), may be null
+   * @return ProxyId closest proxy or kNullProxy
+   */
+  template <class F>
+  ProxyId raycast(const math::Ray& ray, float max_distance, F&& callback,
+                  float* distance = nullptr) const;
+
+ private:
+  using NodeId = std::int32_t;
+  static constexpr NodeId kNullNode = -1;
+
+  struct Node {
+    math::Aabb aabb;
+    NodeId parent;  /// next free node while on the free list
+    NodeId child1;  /// kNullNode for leaves
+    NodeId child2;
+    ProxyId proxy;  /// leaves only
+    std::int32_t height;
+
+    bool isLeaf() const { return child1 == kNullNode; }
+  };
+
+  struct Proxy {
+    NodeId node;  /// next free proxy while on the free list
+    std::uintptr_t user_data;
+  };
+
+  // Traversal stack that lives on the call stack unless the tree is deep.
+  template <class T>
+  class Stack {
+   public:
+    void push(const T& value) {
+      if (size_ < kInlineSize) {
+        inline_[size_] = value;
+      } else {
+        heap_.push_back(value);
+      }
+      ++size_;
+    }
+    T pop() {
+      --size_;
+      if (size_ < kInlineSize) {
+        return inline_[size_];
+      }
+      auto value = heap_.back();
+      heap_.pop_back();
+      return value;
+    }
+    bool empty() const { return size_ == 0; }
+
+   private:
+    static constexpr std::size_t kInlineSize = 128;
+    T inline_[kInlineSize];
+    std::size_t size_ = 0;
+    std::vector<T> heap_;
+  };
+
+  NodeId allocateNode();
+  void freeNode(NodeId node);
+  void insertLeaf(NodeId leaf);
+  void removeLeaf(NodeId leaf);
+  void refitAncestors(NodeId node);
+  NodeId balance(NodeId node);
+
+  // Leaf copied out of nodes_ so that rebuild() partitions a compact array
+  struct BuildItem {
+    math::Aabb aabb;
+    math::Vector3 centroid;
+    NodeId leaf;
+  };
+
+  NodeId buildSah(std::vector<BuildItem>& items, std::size_t begin,
+                  std::size_t end, std::vector<Node>& nodes) const;
+  std::int32_t validate(NodeId node) const;
+
+  float margin_;
+  NodeId root_;
+  NodeId free_node_;
+  ProxyId free_proxy_;
+  std::size_t proxy_count_;
+  std::vector<Node> nodes_;
+  std::vector<Proxy> proxies_;
+};
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+template <class F>
+void AabbTree::query(const math::Aabb& aabb, F&& callback) const {
+  if (root_ == kNullNode) {
+    return;
+  }
+  Stack<NodeId> stack;
+  stack.push(root_);
+  while (!stack.empty()) {
+    const auto& node = nodes_[stack.pop()];
+    if (!math::intersects(node.aabb, aabb)) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      callback(node.proxy);
+    } else {
+      stack.push(node.child2);
+      stack.push(node.child1);
+    }
+  }
+}
+
+template <class F>
+void AabbTree::query(const math::Sphere& sphere, F&& callback) const {
+  if (root_ == kNullNode) {
+    return;
+  }
+  Stack<NodeId> stack;
+  stack.push(root_);
+  while (!stack.empty()) {
+    const auto& node = nodes_[stack.pop()];
+    if (!math::intersects(node.aabb, sphere)) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      callback(node.proxy);
+    } else {
+      stack.push(node.child2);
+      stack.push(node.child1);
+    }
+  }
+}
+
+template <class F>
+void AabbTree::query(const math::Frustum& frustum, F&& callback) const {
+  if (root_ == kNullNode) {
+    return;
+  }
+  constexpr std::uint32_t kAllPlanes = (1u << math::Frustum::kPlaneCount) - 1;
+
+  // 子は親を完全に含む平面を検査しなくてよいので、残りの平面をビットで持つ
+  struct Entry {
+    NodeId node;
+    std::uint32_t planes;
+  };
+  Stack<Entry> stack;
+  stack.push(Entry{root_, kAllPlanes});
+  while (!stack.empty()) {
+    auto entry = stack.pop();
+    const auto& node = nodes_[entry.node];
+
+    auto planes = entry.planes;
+    bool outside = false;
+    if (planes != 0) {
+      auto c = math::center(node.aabb);
+      auto e = math::extent(node.aabb);
+      for (int p = 0; p < math::Frustum::kPlaneCount; ++p) {
+        if ((planes & (1u << p)) == 0) {
+          continue;
+        }
+        const auto& plane = frustum.planes[p];
+        const auto& n = plane.normal;
+        float r = std::abs(n.x()) * e.x() + std::abs(n.y()) * e.y() +
+                  std::abs(n.z()) * e.z();
+        float d = math::signedDistance(plane, c);
+        if (d < -r) {
+          outside = true;
+          break;
+        }
+        if (d >= r) {
+          planes &= ~(1u << p);
+        }
+      }
+    }
+    if (outside) {
+      continue;
+    }
+    if (node.isLeaf()) {
+      callback(node.proxy);
+    } else {
+      stack.push(Entry{node.child2, planes});
+      stack.push(Entry{node.child1, planes});
+    }
+  }
+}
+
+template <class F>
+AabbTree::ProxyId AabbTree::raycast(const math::Ray& ray, float max_distance,
+                                    F&& callback, float* distance) const {
+  auto closest = kNullProxy;
+  auto closest_distance = max_distance;
+  if (root_ != kNullNode) {
+    // 逆数を先に求めておくスラブ法。方向成分0は無限大になり比較で正しく扱える
+    math::Vector3 inv_d(1.0f / ray.direction.x(), 1.0f / ray.direction.y(),
+                        1.0f / ray.direction.z());
+    auto entry = [&](const math::Aabb& aabb) {
+      float t_min = 0.0f;
+      float t_max = closest_distance;
+      for (int i = 0; i < 3; ++i) {
+        float t0 = (aabb.min[i] - ray.origin[i]) * inv_d[i];
+        float t1 = (aabb.max[i] - ray.origin[i]) * inv_d[i];
+        if (t0 > t1) {
+          std::swap(t0, t1);
+        }
+        // NaN (原点が境界上で方向0) は区間を狭めない
+        t_min = t0 > t_min ? t0 : t_min;
+        t_max = t1 < t_max ? t1 : t_max;
+      }
+      return t_min <= t_max ? t_min : std::numeric_limits<float>::infinity();
+    };
+
+    Stack<NodeId> stack;
+    stack.push(root_);
+    while (!stack.empty()) {
+      const auto& node = nodes_[stack.pop()];
+      if (entry(node.aabb) > closest_distance) {
+        continue;
+      }
+      if (node.isLeaf()) {
+        float d = callback(node.proxy);
+        if (d < closest_distance) {
+          closest = node.proxy;
+          closest_distance = d;
+        }
+        continue;
+      }
+      // 近い子を後に積んで先に調べる
+      float d1 = entry(nodes_[node.child1].aabb);
+      float d2 = entry(nodes_[node.child2].aabb);
+      if (d1 <= d2) {
+        stack.push(node.child2);
+        stack.push(node.child1);
+      } else {
+        stack.push(node.child1);
+        stack.push(node.child2);
+      }
+    }
+  }
+  if (distance != nullptr) {
+    *distance = closest_distance;
+  }
+  return closest;
+}
+
+}  // namespace spatial
+}  // namespace temp
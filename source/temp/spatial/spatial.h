@@ -0,0 +1,3 @@
+﻿#pragma once
+#include "temp/spatial/aabb_tree.h"
+#include "temp/spatial/transform_hierarchy.h"
@@ -0,0 +1,369 @@
+﻿#include "temp/spatial/transform_hierarchy.h"
+
+#include <algorithm>
+#include <future>
+
+#include "temp/base/thread_pool.h"
+
+#include "temp/math/matrix44_functions.h"
+
+namespace temp {
+namespace spatial {
+
+namespace {
+// Nodes a parallel update task processes at least
+constexpr std::size_t kMinTaskNodes = 16384;
+}  // namespace
+
+TransformHierarchy::TransformHierarchy(std::size_t group_size)
+    : group_size_(std::max<std::size_t>(group_size, 1)),
+      free_link_(kNullNode),
+      first_root_(kNullNode),
+      size_(0),
+      sorted_(true),
+      top_count_(0) {}
+
+auto TransformHierarchy::create(NodeId parent) -> NodeId {
+  NodeId node;
+  if (free_link_ != kNullNode) {
+    node = free_link_;
+    free_link_ = links_[node].parent;
+  } else {
+    node = static_cast<NodeId>(links_.size());
+    links_.emplace_back();
+  }
+
+  // 並べ替えまでは末尾に追加しておく。親は必ず前にある
+  auto index = static_cast<Index>(nodes_.size());
+  scales_.emplace_back(1.0f, 1.0f, 1.0f);
+  rotations_.push_back(math::Quaternion::kIdentity);
+  positions_.emplace_back(0.0f, 0.0f, 0.0f);
+  worlds_.push_back(math::Matrix44::kIdentity);
+  parents_.push_back(parent == kNullNode ? kNullNode : indexOf(parent));
+  nodes_.push_back(node);
+  dirties_.push_back(1);
+  changes_.push_back(0);
+
+  links_[node].first_child = kNullNode;
+  links_[node].index = index;
+  link(node, parent);
+  ++size_;
+  sorted_ = false;
+  return node;
+}
+
+void TransformHierarchy::destroy(NodeId node) {
+  indexOf(node);
+  unlink(node);
+
+  // 子孫をすべて解放する。配列上の場所は次の並べ替えで詰める
+  std::vector<NodeId> stack{node};
+  while (!stack.empty()) {
+    auto n = stack.back();
+    stack.pop_back();
+    for (auto c = links_[n].first_child; c != kNullNode;
+         c = links_[c].next_sibling) {
+      stack.push_back(c);
+    }
+    links_[n].index = kNullNode;
+    links_[n].parent = free_link_;
+    free_link_ = n;
+    --size_;
+  }
+  sorted_ = false;
+}
+
+void TransformHierarchy::setParent(NodeId node, NodeId parent) {
+  auto index = indexOf(node);
+  for (auto p = parent; p != kNullNode; p = links_[p].parent) {
+    TEMP_ASSERT(p != node, "parent is a descendant of node");
+  }
+  unlink(node);
+  link(node, parent);
+  dirties_[index] = 1;
+  sorted_ = false;
+}
+
+void TransformHierarchy::clear() {
+  free_link_ = kNullNode;
+  first_root_ = kNullNode;
+  size_ = 0;
+  sorted_ = true;
+  links_.clear();
+  scales_.clear();
+  rotations_.clear();
+  positions_.clear();
+  worlds_.clear();
+  parents_.clear();
+  nodes_.clear();
+  dirties_.clear();
+  changes_.clear();
+  top_count_ = 0;
+  groups_.clear();
+  group_dirties_.clear();
+  group_roots_.clear();
+}
+
+auto TransformHierarchy::parent(NodeId node) const -> NodeId {
+  indexOf(node);
+  return links_[node].parent;
+}
+
+std::size_t TransformHierarchy::size() const { return size_; }
+
+void TransformHierarchy::setLocalScale(NodeId node,
+                                       const math::Vector3& scale) {
+  auto index = indexOf(node);
+  scales_[index] = scale;
+  markDirty(index);
+}
+
+void TransformHierarchy::setLocalRotation(NodeId node,
+                                          const math::Quaternion& rotation) {
+  auto index = indexOf(node);
+  rotations_[index] = rotation;
+  markDirty(index);
+}
+
+void TransformHierarchy::setLocalPosition(NodeId node,
+                                          const math::Vector3& position) {
+  auto index = indexOf(node);
+  positions_[index] = position;
+  markDirty(index);
+}
+
+void TransformHierarchy::setLocal(NodeId node, const math::Vector3& scale,
+                                  const math::Quaternion& rotation,
+                                  const math::Vector3& position) {
+  auto index = indexOf(node);
+  scales_[index] = scale;
+  rotations_[index] = rotation;
+  positions_[index] = position;
+  markDirty(index);
+}
+
+void TransformHierarchy::update() {
+  if (!sorted_) {
+    sortNodes();
+  }
+  updateTop();
+  for (std::size_t g = 0; g < groups_.size(); ++g) {
+    if (group_dirties_[g] != 0 || groupChanged(groups_[g])) {
+      updateRange(groups_[g].begin, groups_[g].end);
+      group_dirties_[g] = 0;
+    }
+  }
+}
+
+void TransformHierarchy::update(ThreadPool& pool) {
+  if (!sorted_) {
+    sortNodes();
+  }
+  updateTop();
+
+  std::vector<std::size_t> changed_groups;
+  for (std::size_t g = 0; g < groups_.size(); ++g) {
+    if (group_dirties_[g] != 0 || groupChanged(groups_[g])) {
+      changed_groups.push_back(g);
+      group_dirties_[g] = 0;
+    }
+  }
+
+  // グループ同士は依存しないので、まとまった数ずつワーカーに渡す
+  std::vector<std::future<void>> futures;
+  std::size_t first = 0;
+  std::size_t nodes = 0;
+  for (std::size_t i = 0; i < changed_groups.size(); ++i) {
+    const auto& group = groups_[changed_groups[i]];
+    nodes += group.end - group.begin;
+    if (nodes >= kMinTaskNodes || i + 1 == changed_groups.size()) {
+      futures.push_back(pool.enqueue([this, &changed_groups, first, i] {
+        for (auto j = first; j <= i; ++j) {
+          const auto& g = groups_[changed_groups[j]];
+          updateRange(g.begin, g.end);
+        }
+      }));
+      first = i + 1;
+      nodes = 0;
+    }
+  }
+  for (auto&& future : futures) {
+    future.get();
+  }
+}
+
+void TransformHierarchy::markDirty(Index index) {
+  dirties_[index] = 1;
+  if (sorted_ && index >= top_count_) {
+    auto it = std::upper_bound(
+        groups_.begin(), groups_.end(), index,
+        [](Index i, const Group& group) { return i < group.begin; });
+    group_dirties_[it - groups_.begin() - 1] = 1;
+  }
+}
+
+void TransformHierarchy::link(NodeId node, NodeId parent) {
+  auto& head = parent == kNullNode ? first_root_ : links_[parent].first_child;
+  auto&& l = links_[node];
+  l.parent = parent;
+  l.prev_sibling = kNullNode;
+  l.next_sibling = head;
+  if (head != kNullNode) {
+    links_[head].prev_sibling = node;
+  }
+  head = node;
+}
+
+void TransformHierarchy::unlink(NodeId node) {
+  auto&& l = links_[node];
+  if (l.prev_sibling != kNullNode) {
+    links_[l.prev_sibling].next_sibling = l.next_sibling;
+  } else if (l.parent != kNullNode) {
+    links_[l.parent].first_child = l.next_sibling;
+  } else {
+    first_root_ = l.next_sibling;
+  }
+  if (l.next_sibling != kNullNode) {
+    links_[l.next_sibling].prev_sibling = l.prev_sibling;
+  }
+  l.prev_sibling = kNullNode;
+  l.next_sibling = kNullNode;
+}
+
+void TransformHierarchy::sortNodes() {
+  // 全体の幅優先順
+  std::vector<NodeId> order;
+  order.reserve(size_);
+  for (auto r = first_root_; r != kNullNode; r = links_[r].next_sibling) {
+    order.push_back(r);
+  }
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    for (auto c = links_[order[i]].first_child; c != kNullNode;
+         c = links_[c].next_sibling) {
+      order.push_back(c);
+    }
+  }
+
+  // 部分木のサイズは逆順にたどって親に足し込む
+  std::vector<std::uint32_t> subtree_sizes(links_.size(), 1);
+  for (auto it = order.rbegin(); it != order.rend(); ++it) {
+    auto p = links_[*it].parent;
+    if (p != kNullNode) {
+      subtree_sizes[p] += subtree_sizes[*it];
+    }
+  }
+  auto large = [&](NodeId n) { return subtree_sizes[n] > group_size_; };
+
+  // 大きな部分木を持つノードを先頭に、残りは部分木ごとにグループへ詰める
+  std::vector<NodeId> sorted;
+  sorted.reserve(size_);
+  for (auto n : order) {
+    if (large(n)) {
+      sorted.push_back(n);
+    }
+  }
+  top_count_ = static_cast<Index>(sorted.size());
+
+  groups_.clear();
+  group_roots_.clear();
+  auto current = Group{top_count_, top_count_, 0, 0};
+  for (auto n : order) {
+    auto p = links_[n].parent;
+    if (large(n) || (p != kNullNode && !large(p))) {
+      continue;
+    }
+    if (current.end > current.begin &&
+        current.end - current.begin + subtree_sizes[n] > group_size_) {
+      current.roots_end = group_roots_.size();
+      groups_.push_back(current);
+      current = Group{current.end, current.end, group_roots_.size(), 0};
+    }
+    group_roots_.push_back(static_cast<Index>(sorted.size()));
+    auto head = sorted.size();
+    sorted.push_back(n);
+    for (; head < sorted.size(); ++head) {
+      for (auto c = links_[sorted[head]].first_child; c != kNullNode;
+           c = links_[c].next_sibling) {
+        sorted.push_back(c);
+      }
+    }
+    current.end = static_cast<Index>(sorted.size());
+  }
+  if (current.end > current.begin) {
+    current.roots_end = group_roots_.size();
+    groups_.push_back(current);
+  }
+
+  // 新しい順に配列を並べ替える
+  auto count = sorted.size();
+  std::vector<math::Vector3> scales(count);
+  std::vector<math::Quaternion> rotations(count);
+  std::vector<math::Vector3> positions(count);
+  std::vector<math::Matrix44> worlds(count);
+  std::vector<std::uint8_t> dirties(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto old_index = links_[sorted[i]].index;
+    scales[i] = scales_[old_index];
+    rotations[i] = rotations_[old_index];
+    positions[i] = positions_[old_index];
+    worlds[i] = worlds_[old_index];
+    dirties[i] = dirties_[old_index];
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    links_[sorted[i]].index = static_cast<Index>(i);
+  }
+  parents_.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto p = links_[sorted[i]].parent;
+    parents_[i] = p == kNullNode ? kNullNode : links_[p].index;
+  }
+  scales_.swap(scales);
+  rotations_.swap(rotations);
+  positions_.swap(positions);
+  worlds_.swap(worlds);
+  dirties_.swap(dirties);
+  nodes_.swap(sorted);
+  changes_.assign(count, 0);
+
+  group_dirties_.assign(groups_.size(), 0);
+  for (std::size_t g = 0; g < groups_.size(); ++g) {
+    const auto& group = groups_[g];
+    group_dirties_[g] =
+        std::any_of(dirties_.begin() + group.begin,
+                    dirties_.begin() + group.end,
+                    [](std::uint8_t dirty) { return dirty != 0; })
+            ? 1
+            : 0;
+  }
+  sorted_ = true;
+}
+
+void TransformHierarchy::updateTop() { updateRange(0, top_count_); }
+
+bool TransformHierarchy::groupChanged(const Group& group) const {
+  // 部分木の根の親は先頭の範囲にあり、すでに更新済み
+  for (auto i = group.roots_begin; i < group.roots_end; ++i) {
+    auto p = parents_[group_roots_[i]];
+    if (p != kNullNode && changes_[p] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void TransformHierarchy::updateRange(Index begin, Index end) {
+  for (auto i = begin; i < end; ++i) {
+    auto p = parents_[i];
+    bool changed = dirties_[i] != 0 || (p != kNullNode && changes_[p] != 0);
+    if (changed) {
+      auto local = math::Matrix44::scaleRotationTranslation(
+          scales_[i], rotations_[i], positions_[i]);
+      worlds_[i] = p == kNullNode ? local : worlds_[p] * local;
+      dirties_[i] = 0;
+    }
+    changes_[i] = changed ? 1 : 0;
+  }
+}
+
+}  // namespace spatial
+}  // namespace temp
\ No newline at end of file
@@ -0,0 +1,198 @@
+﻿/**
+ * @file transform_hierarchy.h
+ * @brief Parent/child transforms with cached world matrices
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "temp/base/assertion.h"
+
+#include "temp/math/matrix44.h"
+#include "temp/math/quaternion.h"
+#include "temp/math/vector3.h"
+
+namespace temp {
+
+class ThreadPool;
+
+namespace spatial {
+
+//----------------------------------------
+// declaration
+//----------------------------------------
+
+/**
+ * @brief Hierarchy of local scale, rotation and translation values
+ *
+ * World matrices are parent world * Matrix44::scaleRotationTranslation of
+ * the local values, recomputed by update() only for nodes whose local
+ * values or ancestors changed.
+ *
+ * Node data is stored in arrays sorted so that every parent comes before
+ * its children, which makes update() a single linear sweep. The nodes with
+ * the largest subtrees come first; below them every subtree of at most
+ * group_size nodes is stored contiguously in breadth first order and packed
+ * into groups. A group with no changes inside and no changed parent is
+ * skipped as a whole, and groups are the unit of work for the parallel
+ * update.
+ *
+ * Structural changes (create, destroy, setParent) only edit links; the
+ * arrays are re-sorted by the next update().
+ */
+class TransformHierarchy {
+ public:
+  using NodeId = std::int32_t;
+  static constexpr NodeId kNullNode = -1;
+
+  /**
+   * @param group_size maximum node count of a group
+   */
+  explicit TransformHierarchy(std::size_t group_size = 4096);
+
+  TransformHierarchy(const TransformHierarchy&) = default;
+  TransformHierarchy& operator=(const TransformHierarchy&) = default;
+  ~TransformHierarchy() = default;
+
+ public:
+  /**
+   * @brief Add node with identity local transform
+   *
+   * @param parent parent node or kNullNode for a root
+   * @return NodeId valid until the node is destroyed
+   */
+  NodeId create(NodeId parent = kNullNode);
+
+  /**
+   * @brief Remove node and all of its descendants
+   */
+  void destroy(NodeId node);
+
+  /**
+   * @brief Move node under parent, keeping its local transform
+   *
+   * @param parent new parent, must not be node or one of its descendants
+   */
+  void setParent(NodeId node, NodeId parent);
+
+  void clear();
+
+  NodeId parent(NodeId node) const;
+  std::size_t size() const;
+
+  const math::Vector3& localScale(NodeId node) const;
+  const math::Quaternion& localRotation(NodeId node) const;
+  const math::Vector3& localPosition(NodeId node) const;
+
+  void setLocalScale(NodeId node, const math::Vector3& scale);
+  void setLocalRotation(NodeId node, const math::Quaternion& rotation);
+  void setLocalPosition(NodeId node, const math::Vector3& position);
+  void setLocal(NodeId node, const math::Vector3& scale,
+                const math::Quaternion& rotation,
+                const math::Vector3& position);
+
+  /**
+   * @brief World matrix computed by the last update()
+   */
+  const math::Matrix44& worldMatrix(NodeId node) const;
+
+  /**
+   * @brief Recompute world matrices of changed nodes
+   */
+  void update();
+
+  /**
+   * @brief update() with groups spread over pool workers
+   *
+   * The calling thread waits for the workers, so this must not be called
+   * from a task of the same pool.
+   */
+  void update(ThreadPool& pool);
+
+ private:
+  using Index = std::int32_t;
+
+  // Links by NodeId; they do not move when the arrays are sorted.
+  struct Link {
+    NodeId parent;       /// next free id while on the free list
+    NodeId first_child;
+    NodeId prev_sibling;
+    NodeId next_sibling;
+    Index index;         /// kNullNode while free
+  };
+
+  // Range of a group and of its subtree roots in group_roots_
+  struct Group {
+    Index begin;
+    Index end;
+    std::size_t roots_begin;
+    std::size_t roots_end;
+  };
+
+  Index indexOf(NodeId node) const;
+  void markDirty(Index index);
+  void link(NodeId node, NodeId parent);
+  void unlink(NodeId node);
+  void sortNodes();
+  void updateTop();
+  bool groupChanged(const Group& group) const;
+  void updateRange(Index begin, Index end);
+
+  std::size_t group_size_;
+  NodeId free_link_;
+  NodeId first_root_;
+  std::size_t size_;
+  bool sorted_;
+  std::vector<Link> links_;
+
+  // Sorted by Index
+  std::vector<math::Vector3> scales_;
+  std::vector<math::Quaternion> rotations_;
+  std::vector<math::Vector3> positions_;
+  std::vector<math::Matrix44> worlds_;
+  std::vector<Index> parents_;
+  std::vector<NodeId> nodes_;
+  std::vector<std::uint8_t> dirties_;
+  std::vector<std::uint8_t> changes_;  /// world changed in last update
+
+  Index top_count_;  /// nodes before the first group
+  std::vector<Group> groups_;
+  std::vector<std::uint8_t> group_dirties_;
+  std::vector<Index> group_roots_;
+};
+
+//----------------------------------------
+// implementation
+//----------------------------------------
+inline auto TransformHierarchy::indexOf(NodeId node) const -> Index {
+  TEMP_ASSERT(0 <= node && node < (NodeId)links_.size() &&
+                  links_[node].index != kNullNode,
+              "node is not alive");
+  return links_[node].index;
+}
+
+inline const math::Vector3& TransformHierarchy::localScale(
+    NodeId node) const {
+  return scales_[indexOf(node)];
+}
+
+inline const math::Quaternion& TransformHierarchy::localRotation(
+    NodeId node) const {
+  return rotations_[indexOf(node)];
+}
+
+inline const math::Vector3& TransformHierarchy::localPosition(
+    NodeId node) const {
+  return positions_[indexOf(node)];
+}
+
+inline const math::Matrix44& TransformHierarchy::worldMatrix(
+    NodeId node) const {
+  return worlds_[indexOf(node)];
+}
+
+}  // namespace spatial
+}  // namespace temp
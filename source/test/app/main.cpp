@@ -253,35 +253,9 @@ class TestRenderer {
     auto swap_chain = tvk_device_->main_swap_chain();
     auto tvk_swap_chain =
         static_cast<gfx::vulkan::VulkanSwapChain*>(swap_chain);
-    auto&& wait_semaphore =
-        tvk_swap_chain->current_image().acquire_image_semaphore.get();
-    auto image_index = tvk_swap_chain->AcquireNextImage(tvk_device_->device());
-
-    auto& image = tvk_swap_chain->image(image_index);
-    vk::SubmitInfo submit_info;
-    vk::PipelineStageFlags wait_stages[] = {
-        vk::PipelineStageFlagBits::eColorAttachmentOutput};
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &wait_semaphore;
-    submit_info.pWaitDstStageMask = wait_stages;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &(command_buffers_[image_index].get());
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &image.render_semaphore.get();
-    auto& queue_table = tvk_device_->queue_table();
-    auto& graphics_queue =
-        queue_table.find(vk::QueueFlagBits::eGraphics)->second;
-    graphics_queue.submit(1, &submit_info, vk::Fence());
-
-    vk::PresentInfoKHR present_info;
-    auto vk_swap_chain = tvk_swap_chain->swap_chain();
-    present_info.waitSemaphoreCount = 1;
-    present_info.pWaitSemaphores = &image.render_semaphore.get();
-    present_info.swapchainCount = 1;
-    present_info.pSwapchains = &vk_swap_chain;
-    present_info.pImageIndices = &image_index;
-
-    graphics_queue.presentKHR(present_info);
+    auto image_index = tvk_swap_chain->AcquireNextImage(vk_device);
+    tvk_swap_chain->Submit(*tvk_device_, {*command_buffers_[image_index]});
+    tvk_swap_chain->Present(tvk_device_.get());
   }
 
   void Terminate() {
@@ -1,6 +1,7 @@
 ﻿#define BOOST_TEST_MAIN
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
+#include "temp/base/hash.h"
 #include "temp/base/logger.h"
 #include "temp/base/sleep.h"
 #include "temp/base/thread_pool.h"
@@ -38,4 +39,21 @@ BOOST_AUTO_TEST_CASE(threadpool) {
     TEMP_LOG_TRACE("total: ", timer.durationMs(), "ms");
   }
 }
+BOOST_AUTO_TEST_CASE(hash) {
+  // FNV-1a の公開されているテストベクタ
+  auto hash = kFnvOffsetBasis;
+  HashBytes("a", 1, &hash);
+  BOOST_TEST(hash == 0xaf63dc4c8601ec8cull);
+
+  hash = kFnvOffsetBasis;
+  HashBytes("foobar", 6, &hash);
+  BOOST_TEST(hash == 0x85944171f73967e8ull);
+
+  // 要素が同じでも数が違えば別のハッシュになる
+  auto a = kFnvOffsetBasis;
+  auto b = kFnvOffsetBasis;
+  HashVector(std::vector<std::uint32_t>{1, 2}, &a);
+  HashVector(std::vector<std::uint32_t>{1, 2, 0}, &b);
+  BOOST_TEST(a != b);
+}
 BOOST_AUTO_TEST_SUITE_END()
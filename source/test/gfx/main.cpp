@@ -0,0 +1,326 @@
+﻿#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "temp/base/logger.h"
+#include "temp/base/timer.h"
+#include "temp/gfx/color.h"
+#include "temp/gfx/tlsf_allocator.h"
+
+using namespace temp::gfx;
+
+namespace {
+// Colors with components in [-0.1, 1.1] so that clamping is exercised.
+std::vector<Color> randomColors(std::mt19937& engine, std::size_t count) {
+  std::uniform_real_distribution<float> dist(-0.1f, 1.1f);
+  std::vector<Color> colors(count);
+  for (auto& c : colors) {
+    c = Color{dist(engine), dist(engine), dist(engine), dist(engine)};
+  }
+  return colors;
+}
+
+std::vector<Color32Bit> randomColors32(std::mt19937& engine,
+                                       std::size_t count) {
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<Color32Bit> colors(count);
+  for (auto& c : colors) {
+    c = Color32Bit{(std::uint8_t)dist(engine), (std::uint8_t)dist(engine),
+                   (std::uint8_t)dist(engine), (std::uint8_t)dist(engine)};
+  }
+  return colors;
+}
+
+bool equal(const Color& a, const Color& b) {
+  return a.red == b.red && a.green == b.green && a.blue == b.blue &&
+         a.alpha == b.alpha;
+}
+
+int maxDifference(const Color32Bit& a, const Color32Bit& b) {
+  return std::max({std::abs(a.red - b.red), std::abs(a.green - b.green),
+                   std::abs(a.blue - b.blue), std::abs(a.alpha - b.alpha)});
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(color)
+
+BOOST_AUTO_TEST_CASE(conversion) {
+  BOOST_TEST(equal(Color32BitToColor(Color32Bit::kMagenta), Color::kMagenta));
+  auto c = ColorToColor32Bit(Color{0.5f, -1.0f, 2.0f, 0.998f});
+  BOOST_TEST(c.red == 128);
+  BOOST_TEST(c.green == 0);
+  BOOST_TEST(c.blue == 255);
+  BOOST_TEST(c.alpha == 254);
+
+  // 8ビット値は往復で変わらない
+  for (int i = 0; i < 256; ++i) {
+    auto v = (std::uint8_t)i;
+    auto back = ColorToColor32Bit(Color32BitToColor(Color32Bit{v, v, v, v}));
+    BOOST_TEST(back.red == v);
+  }
+
+  std::mt19937 engine(39);
+  const std::size_t kCount = 1027;
+  auto colors = randomColors(engine, kCount);
+  auto colors32 = randomColors32(engine, kCount);
+  std::vector<Color> floats(kCount);
+  std::vector<Color32Bit> bytes(kCount);
+  Color32BitToColor(colors32.data(), kCount, floats.data());
+  ColorToColor32Bit(colors.data(), kCount, bytes.data());
+  for (std::size_t i = 0; i < kCount; ++i) {
+    BOOST_TEST(equal(floats[i], Color32BitToColor(colors32[i])));
+    BOOST_TEST(maxDifference(bytes[i], ColorToColor32Bit(colors[i])) == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(srgb) {
+  BOOST_TEST(SrgbToLinear(0.0f) == 0.0f);
+  BOOST_TEST(SrgbToLinear(1.0f) == 1.0f, boost::test_tools::tolerance(1e-6f));
+  BOOST_TEST(SrgbToLinear(0.5f) == 0.21404114f,
+             boost::test_tools::tolerance(1e-5f));
+  BOOST_TEST(LinearToSrgb(0.21404114f) == 0.5f,
+             boost::test_tools::tolerance(1e-5f));
+
+  // 8ビットの sRGB 値は線形を経由しても変わらない。アルファは線形のまま
+  for (int i = 0; i < 256; ++i) {
+    auto v = (std::uint8_t)i;
+    auto linear = SrgbToLinear(Color32Bit{v, v, v, v});
+    BOOST_TEST(linear.alpha == (float)i / 255.0f);
+    Color32Bit back;
+    LinearToSrgb(&linear, 1, &back);
+    BOOST_TEST(maxDifference(back, Color32Bit{v, v, v, v}) == 0);
+    BOOST_TEST(maxDifference(LinearToSrgb(linear), back) == 0);
+  }
+
+  std::mt19937 engine(40);
+  const std::size_t kCount = 1027;
+  auto colors = randomColors(engine, kCount);
+  auto colors32 = randomColors32(engine, kCount);
+  std::vector<Color> linears(kCount);
+  std::vector<Color32Bit> srgbs(kCount);
+  SrgbToLinear(colors32.data(), kCount, linears.data());
+  LinearToSrgb(colors.data(), kCount, srgbs.data());
+  for (std::size_t i = 0; i < kCount; ++i) {
+    BOOST_TEST(equal(linears[i], SrgbToLinear(colors32[i])));
+    BOOST_TEST(maxDifference(srgbs[i], LinearToSrgb(colors[i])) <= 1);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(premultiply) {
+  auto p = Premultiply(Color{1.0f, 0.5f, 0.25f, 0.5f});
+  BOOST_TEST(equal(p, Color{0.5f, 0.25f, 0.125f, 0.5f}));
+  BOOST_TEST(equal(Unpremultiply(p), Color{1.0f, 0.5f, 0.25f, 0.5f}));
+  BOOST_TEST(equal(Unpremultiply(Color{0.5f, 0.5f, 0.5f, 0.0f}),
+                   Color{0.0f, 0.0f, 0.0f, 0.0f}));
+
+  // 8ビットは c * a / 255 の最近接に丸める
+  for (int c = 0; c < 256; ++c) {
+    for (int a = 0; a < 256; ++a) {
+      auto r = Premultiply(Color32Bit{(std::uint8_t)c, 0, 0, (std::uint8_t)a});
+      BOOST_TEST_REQUIRE(r.red == (int)std::lround(c * a / 255.0));
+      BOOST_TEST_REQUIRE(r.alpha == a);
+    }
+  }
+
+  std::mt19937 engine(41);
+  const std::size_t kCount = 1027;
+  auto colors = randomColors(engine, kCount);
+  auto colors32 = randomColors32(engine, kCount);
+  auto premultiplied = colors;
+  auto premultiplied32 = colors32;
+  Premultiply(premultiplied.data(), kCount);
+  Premultiply(premultiplied32.data(), kCount);
+  auto unpremultiplied = premultiplied;
+  Unpremultiply(unpremultiplied.data(), kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    BOOST_TEST(equal(premultiplied[i], Premultiply(colors[i])));
+    BOOST_TEST(equal(unpremultiplied[i], Unpremultiply(premultiplied[i])));
+    BOOST_TEST(maxDifference(premultiplied32[i], Premultiply(colors32[i])) ==
+               0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::size_t kCount = 1 << 18;
+  const int kLoop = 20;
+  std::mt19937 engine(42);
+  auto colors = randomColors(engine, kCount);
+  auto colors32 = randomColors32(engine, kCount);
+  std::vector<Color> floats(kCount);
+  std::vector<Color32Bit> bytes(kCount);
+
+  // 読み込みと書き込みを合わせた転送量で測る
+  auto bench = [&](const char* name, std::size_t bytes_per_pixel, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      func();
+    }
+    auto total = (double)bytes_per_pixel * kCount * kLoop;
+    TEMP_LOG_TRACE(name, ": ", total / (timer.durationUs() * 1000.0),
+                   " GB/s");
+  };
+  bench("Color32BitToColor scalar", 20, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      floats[i] = Color32BitToColor(colors32[i]);
+    }
+  });
+  bench("Color32BitToColor batch", 20, [&] {
+    Color32BitToColor(colors32.data(), kCount, floats.data());
+  });
+  bench("ColorToColor32Bit scalar", 20, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      bytes[i] = ColorToColor32Bit(colors[i]);
+    }
+  });
+  bench("ColorToColor32Bit batch", 20, [&] {
+    ColorToColor32Bit(colors.data(), kCount, bytes.data());
+  });
+  bench("SrgbToLinear batch", 20, [&] {
+    SrgbToLinear(colors32.data(), kCount, floats.data());
+  });
+  bench("LinearToSrgb scalar", 20, [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      bytes[i] = LinearToSrgb(colors[i]);
+    }
+  });
+  bench("LinearToSrgb batch", 20,
+        [&] { LinearToSrgb(colors.data(), kCount, bytes.data()); });
+  bench("Premultiply Color batch", 32,
+        [&] { Premultiply(floats.data(), kCount); });
+  bench("Premultiply Color32Bit batch", 8,
+        [&] { Premultiply(colors32.data(), kCount); });
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(tlsf_allocator)
+
+BOOST_AUTO_TEST_CASE(alignment) {
+  TlsfAllocator allocator(1024);
+  TlsfAllocator::Allocation a, b;
+  BOOST_TEST(allocator.Allocate(3, 1, &a));
+  BOOST_TEST(allocator.Allocate(100, 256, &b));
+  BOOST_TEST(a.offset == 0);
+  BOOST_TEST(b.offset % 256 == 0);
+  BOOST_TEST(b.size == 100);
+  BOOST_TEST(allocator.used_size() == 103);
+
+  // 揃えで空いた先頭も再利用される
+  TlsfAllocator::Allocation c;
+  BOOST_TEST(allocator.Allocate(16, 4, &c));
+  BOOST_TEST(c.offset < b.offset);
+}
+
+BOOST_AUTO_TEST_CASE(coalescing) {
+  TlsfAllocator allocator(4096);
+  std::vector<TlsfAllocator::Allocation> allocations(16);
+  for (auto&& a : allocations) {
+    BOOST_TEST(allocator.Allocate(256, 1, &a));
+  }
+  TlsfAllocator::Allocation full;
+  BOOST_TEST(!allocator.Allocate(1, 1, &full));
+  BOOST_TEST(allocator.free_size() == 0);
+
+  // 1つおきに解放すると断片化し、大きな領域は取れない
+  for (std::size_t i = 0; i < allocations.size(); i += 2) {
+    allocator.Free(allocations[i].handle);
+  }
+  BOOST_TEST(allocator.free_size() == 2048);
+  BOOST_TEST(allocator.LargestFreeSize() == 256);
+  BOOST_TEST(allocator.Fragmentation() > 0.8f);
+  BOOST_TEST(!allocator.Allocate(512, 1, &full));
+
+  // 残りを解放すると1つの領域に戻る
+  for (std::size_t i = 1; i < allocations.size(); i += 2) {
+    allocator.Free(allocations[i].handle);
+  }
+  BOOST_TEST(allocator.allocation_count() == 0);
+  BOOST_TEST(allocator.LargestFreeSize() == 4096);
+  BOOST_TEST(allocator.Fragmentation() == 0.0f);
+  BOOST_TEST(allocator.Allocate(4096, 1, &full));
+}
+
+BOOST_AUTO_TEST_CASE(random) {
+  const std::uint64_t kSize = 1 << 24;
+  TlsfAllocator allocator(kSize);
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<std::uint64_t> size_dist(1, 1 << 16);
+  std::uniform_int_distribution<int> align_dist(0, 8);
+  std::vector<TlsfAllocator::Allocation> allocations;
+
+  for (int i = 0; i < 100000; ++i) {
+    if (!allocations.empty() && engine() % 2 == 0) {
+      auto index = engine() % allocations.size();
+      allocator.Free(allocations[index].handle);
+      allocations[index] = allocations.back();
+      allocations.pop_back();
+      continue;
+    }
+    TlsfAllocator::Allocation a;
+    std::uint64_t alignment = 1ull << align_dist(engine);
+    if (allocator.Allocate(size_dist(engine), alignment, &a)) {
+      BOOST_TEST(a.offset % alignment == 0);
+      allocations.push_back(a);
+    }
+  }
+
+  // 確保した領域は重ならず、ブロック内に収まる
+  std::map<std::uint64_t, std::uint64_t> ranges;
+  std::uint64_t used = 0;
+  for (auto&& a : allocations) {
+    ranges.emplace(a.offset, a.size);
+    used += a.size;
+  }
+  BOOST_TEST(ranges.size() == allocations.size());
+  std::uint64_t end = 0;
+  for (auto&& range : ranges) {
+    BOOST_TEST(range.first >= end);
+    end = range.first + range.second;
+  }
+  BOOST_TEST(end <= kSize);
+  BOOST_TEST(allocator.used_size() == used);
+
+  for (auto&& a : allocations) {
+    allocator.Free(a.handle);
+  }
+  BOOST_TEST(allocator.LargestFreeSize() == kSize);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const int kCount = 1 << 16;
+  const int kLoop = 20;
+  TlsfAllocator allocator(std::uint64_t(1) << 32);
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<std::uint64_t> size_dist(256, 1 << 16);
+  std::vector<std::uint64_t> sizes(kCount);
+  for (auto&& size : sizes) {
+    size = size_dist(engine);
+  }
+  std::vector<TlsfAllocator::Allocation> allocations(kCount);
+
+  bool succeeded = true;
+  temp::Timer timer;
+  for (int loop = 0; loop < kLoop; ++loop) {
+    for (int i = 0; i < kCount; ++i) {
+      succeeded &= allocator.Allocate(sizes[i], 256, &allocations[i]);
+    }
+    // 確保と逆でない順で解放して、つなげる処理も測る
+    for (int i = 0; i < kCount; i += 2) {
+      allocator.Free(allocations[i].handle);
+    }
+    for (int i = 1; i < kCount; i += 2) {
+      allocator.Free(allocations[i].handle);
+    }
+  }
+  BOOST_TEST(succeeded);
+  TEMP_LOG_TRACE("Allocate + Free: ",
+                 timer.durationUs() * 1000.0 / (kCount * kLoop), " ns");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -2,13 +2,184 @@
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 
+#include <cstdio>
+#include <random>
+#include <vector>
+
 #include "temp/base/define.h"
 #include "temp/base/logger.h"
+#include "temp/base/timer.h"
+#include "temp/math/batch.h"
 #include "temp/math/temp_math.h"
 
 using namespace temp::math;
 namespace utf = boost::unit_test;
 
+namespace {
+// Scalar reference implementations used to check and benchmark the SIMD
+// specializations.
+Matrix44 scalarMul(const Matrix44& lhs, const Matrix44& rhs) {
+  Matrix44 result;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      result[r][c] = lhs[r][0] * rhs[0][c] + lhs[r][1] * rhs[1][c] +
+                     lhs[r][2] * rhs[2][c] + lhs[r][3] * rhs[3][c];
+    }
+  }
+  return result;
+}
+
+Vector4 scalarMul(const Matrix44& lhs, const Vector4& rhs) {
+  Vector4 result;
+  for (int r = 0; r < 4; ++r) {
+    result[r] = lhs[r][0] * rhs[0] + lhs[r][1] * rhs[1] + lhs[r][2] * rhs[2] +
+                lhs[r][3] * rhs[3];
+  }
+  return result;
+}
+
+std::vector<Vector3> randomPoints(std::mt19937& engine, std::size_t count) {
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+  std::vector<Vector3> points;
+  for (std::size_t i = 0; i < count; ++i) {
+    points.emplace_back(dist(engine), dist(engine), dist(engine));
+  }
+  return points;
+}
+
+std::vector<Quaternion> randomQuaternions(std::mt19937& engine,
+                                         std::size_t count) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<Quaternion> quats;
+  for (std::size_t i = 0; i < count; ++i) {
+    quats.emplace_back(dist(engine), dist(engine), dist(engine), dist(engine));
+  }
+  return quats;
+}
+
+// Rotation through two quaternion products, which was the original rotate.
+Vector3 naiveRotate(const Vector3& vec3, const Quaternion& quat) {
+  auto result = quat * Quaternion(vec3.x(), vec3.y(), vec3.z(), 0) *
+                conjugated(quat);
+  return Vector3(result.x(), result.y(), result.z());
+}
+
+Matrix44 randomMatrix(std::mt19937& engine) {
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  Matrix44 m;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      m[r][c] = dist(engine);
+    }
+  }
+  return m;
+}
+
+// Inverse through the 16 cofactors, which was the original implementation.
+Matrix44 cofactorInverse(const Matrix44& mat) {
+  auto d = determinant(mat);
+  Matrix44 result;
+  for (std::size_t r = 0; r < 4; ++r) {
+    for (std::size_t c = 0; c < 4; ++c) {
+      result[c][r] = cofactor(mat, r, c) / d;
+    }
+  }
+  return result;
+}
+
+// Scale, rotation and translation combined through full matrix products,
+// which was the original implementation.
+Matrix44 threeMatrixTRS(const Vector3& scale, const Quaternion& rotation,
+                        const Vector3& translation) {
+  auto s = Matrix44(scale.x(), 0, 0, 0,  //
+                    0, scale.y(), 0, 0,  //
+                    0, 0, scale.z(), 0,  //
+                    0, 0, 0, 1);
+  auto t = Matrix44(0, 0, 0, translation.x(),  //
+                    0, 0, 0, translation.y(),  //
+                    0, 0, 0, translation.z(),  //
+                    0, 0, 0, 0);
+  float x = rotation.x(), y = rotation.y(), z = rotation.z();
+  float w = rotation.w();
+  auto r = Matrix44(1 - 2 * (y * y + z * z), 2 * (x * y + w * z),
+                    2 * (x * z - w * y), 0,  //
+                    2 * (x * y - w * z), 1 - 2 * (x * x + z * z),
+                    2 * (y * z + w * x), 0,  //
+                    2 * (x * z + w * y), 2 * (y * z - w * x),
+                    1 - 2 * (x * x + y * y), 0,  //
+                    0, 0, 0, 1);
+  return t + (r * s);
+}
+
+// Inverse by Gauss-Jordan elimination with partial pivoting in double, to
+// check the closed-form inverses against an independent method.
+Matrix44_64bit gaussJordanInverse(const Matrix44& mat) {
+  double a[4][8];
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      a[r][c] = mat[r][c];
+      a[r][c + 4] = r == c ? 1.0 : 0.0;
+    }
+  }
+  for (int c = 0; c < 4; ++c) {
+    int pivot = c;
+    for (int r = c + 1; r < 4; ++r) {
+      if (std::abs(a[r][c]) > std::abs(a[pivot][c])) {
+        pivot = r;
+      }
+    }
+    std::swap(a[c], a[pivot]);
+    auto scale = 1.0 / a[c][c];
+    for (int k = 0; k < 8; ++k) {
+      a[c][k] *= scale;
+    }
+    for (int r = 0; r < 4; ++r) {
+      if (r == c) {
+        continue;
+      }
+      auto factor = a[r][c];
+      for (int k = 0; k < 8; ++k) {
+        a[r][k] -= factor * a[c][k];
+      }
+    }
+  }
+  Matrix44_64bit result;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      result[r][c] = a[r][c + 4];
+    }
+  }
+  return result;
+}
+
+// Largest difference from the reference relative to its largest element.
+double relativeError(const Matrix44& mat, const Matrix44_64bit& reference) {
+  double max_diff = 0;
+  double max_ref = 0;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      max_diff = std::max(max_diff, std::abs(mat[r][c] - reference[r][c]));
+      max_ref = std::max(max_ref, std::abs(reference[r][c]));
+    }
+  }
+  return max_diff / max_ref;
+}
+
+// Runs func with every SIMD level of the batch kernels available here, then
+// restores the dispatched level.
+template <class Func>
+void forEachSimdLevel(Func func) {
+  auto initial = batchSimdLevel();
+  for (auto level : {SimdLevel::kScalar, SimdLevel::kFloat4, SimdLevel::kAvx2,
+                     SimdLevel::kAvx512}) {
+    if (setBatchSimdLevel(level)) {
+      BOOST_TEST_CONTEXT("simd level " << (int)level) { func(level); }
+    }
+  }
+  setBatchSimdLevel(initial);
+}
+}  // namespace
+
 BOOST_AUTO_TEST_SUITE(vector2)
 
 BOOST_AUTO_TEST_CASE(add, *utf::tolerance(0.00001f)) {
@@ -272,6 +443,157 @@ BOOST_AUTO_TEST_CASE(transform_) {
   BOOST_CHECK_CLOSE_FRACTION(pos.y(), 1.0f, 0.00001f);
   BOOST_CHECK_CLOSE_FRACTION(pos.z(), 1.0f, 0.00001f);
 }
+
+BOOST_AUTO_TEST_CASE(trs) {
+  std::mt19937 engine(48);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  for (int i = 0; i < 100; ++i) {
+    auto scale = Vector3(dist(engine), dist(engine), dist(engine));
+    auto rotation = Quaternion::axisAngle(
+        Vector3(dist(engine), dist(engine), dist(engine)), dist(engine) * 36);
+    auto translation = Vector3(dist(engine), dist(engine), dist(engine));
+    auto mat = Matrix44::scaleRotationTranslation(scale, rotation, translation);
+    auto expected = threeMatrixTRS(scale, rotation, translation);
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        BOOST_CHECK_SMALL(mat[r][c] - expected[r][c], 0.0001f);
+      }
+    }
+
+    auto components = decompose(mat);
+    auto rebuilt = Matrix44::scaleRotationTranslation(
+        components.scale, components.rotation, components.translation);
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        BOOST_CHECK_SMALL(rebuilt[r][c] - mat[r][c], 0.001f);
+      }
+    }
+    BOOST_CHECK_SMALL(distance(components.translation, translation), 0.0001f);
+    BOOST_CHECK_CLOSE(std::abs(components.scale.y()), std::abs(scale.y()),
+                      0.01f);
+  }
+
+  auto components = decompose(Matrix44::scaleRotationTranslation(
+      Vector3(1, 2, 3), Quaternion::axisAngle(Vector3(0, 1, 0), 90),
+      Vector3(4, 5, 6)));
+  BOOST_CHECK_SMALL(distance(components.scale, Vector3(1, 2, 3)), 0.0001f);
+  auto v = rotate(Vector3(1, 0, 0), components.rotation);
+  BOOST_CHECK_SMALL(
+      distance(v, rotate(Vector3(1, 0, 0),
+                         Quaternion::axisAngle(Vector3(0, 1, 0), 90))),
+      0.0001f);
+}
+
+BOOST_AUTO_TEST_CASE(trs_benchmark) {
+  const std::size_t kCount = 100000;
+  std::mt19937 engine(49);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  std::vector<Vector3> scales, translations;
+  std::vector<Quaternion> rotations;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    scales.emplace_back(dist(engine), dist(engine), dist(engine));
+    rotations.push_back(normalize(Quaternion(dist(engine), dist(engine),
+                                             dist(engine), dist(engine))));
+    translations.emplace_back(dist(engine), dist(engine), dist(engine));
+  }
+  std::vector<Matrix44> results(kCount);
+  std::vector<TransformComponents> components(kCount);
+
+  {
+    temp::Timer timer;
+    for (std::size_t i = 0; i < kCount; ++i) {
+      results[i] = threeMatrixTRS(scales[i], rotations[i], translations[i]);
+    }
+    TEMP_LOG_TRACE("three matrices: ", timer.durationUs(), " us");
+  }
+  {
+    temp::Timer timer;
+    scaleRotationTranslation(scales.data(), rotations.data(),
+                             translations.data(), kCount, results.data());
+    TEMP_LOG_TRACE("scaleRotationTranslation: ", timer.durationUs(), " us");
+  }
+  {
+    temp::Timer timer;
+    decompose(results.data(), kCount, components.data());
+    TEMP_LOG_TRACE("decompose: ", timer.durationUs(), " us");
+  }
+  BOOST_CHECK_SMALL(distance(components[0].translation, translations[0]),
+                    0.0001f);
+}
+
+BOOST_AUTO_TEST_CASE(inv_singular) {
+  auto mat = Matrix44(  //
+      1, 2, 3, 4,       //
+      2, 4, 6, 8,       //
+      0, 1, 0, 1,       //
+      1, 0, 1, 0);
+  BOOST_CHECK(std::isnan(inverse(mat)[0][0]));
+  BOOST_CHECK(std::isnan(inverseAffine(Matrix44::kZero)[0][0]));
+}
+
+BOOST_AUTO_TEST_CASE(inv_affine) {
+  auto mat = Matrix44::scaleRotationTranslation(
+      Vector3(2, 3, 0.5f), Quaternion::axisAngle(Vector3(1, 2, 3), 30),
+      Vector3(4, -5, 6));
+  auto inv = inverseAffine(mat);
+  auto expected = gaussJordanInverse(mat);
+  BOOST_CHECK_SMALL(relativeError(inv, expected), 1e-6);
+
+  auto rigid = Matrix44::scaleRotationTranslation(
+      Vector3(1, 1, 1), Quaternion::axisAngle(Vector3(-1, 0, 2), 60),
+      Vector3(-7, 8, 9));
+  BOOST_CHECK_SMALL(
+      relativeError(inverseOrthonormal(rigid), gaussJordanInverse(rigid)),
+      1e-6);
+}
+
+BOOST_AUTO_TEST_CASE(inv_precision) {
+  std::mt19937 engine(46);
+  double max_general = 0;
+  double max_cofactor = 0;
+  for (int i = 0; i < 1000; ++i) {
+    auto mat = randomMatrix(engine);
+    auto reference = gaussJordanInverse(mat);
+    max_general = std::max(max_general, relativeError(inverse(mat), reference));
+    max_cofactor =
+        std::max(max_cofactor, relativeError(cofactorInverse(mat), reference));
+  }
+  TEMP_LOG_TRACE("inverse relative error: ", max_general,
+                 " (cofactor: ", max_cofactor, ")");
+  BOOST_CHECK_SMALL(max_general, 1e-3);
+  BOOST_CHECK_LE(max_general, max_cofactor);
+}
+
+BOOST_AUTO_TEST_CASE(inv_benchmark) {
+  const std::size_t kCount = 1024;
+  const int kLoop = 100;
+  std::mt19937 engine(47);
+  std::vector<Matrix44> mats;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    mats.push_back(Matrix44::scaleRotationTranslation(
+        Vector3(1, 1, 1), Quaternion::axisAngle(Vector3(1, 1, 0), (float)i),
+        Vector3((float)i, 1, 2)));
+  }
+  std::vector<Matrix44> results(kCount);
+
+  auto run = [&](const char* name, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      for (std::size_t i = 0; i < kCount; ++i) {
+        results[i] = func(mats[i]);
+      }
+    }
+    TEMP_LOG_TRACE(name, ": ", timer.durationUs(), " us");
+  };
+  run("cofactor", [](const Matrix44& m) { return cofactorInverse(m); });
+  run("inverse", [](const Matrix44& m) { return inverse(m); });
+  run("inverseAffine", [](const Matrix44& m) { return inverseAffine(m); });
+  run("inverseOrthonormal",
+      [](const Matrix44& m) { return inverseOrthonormal(m); });
+
+  auto id = results[1] * mats[1];
+  BOOST_CHECK_SMALL(id[0][0] - 1.0f, 0.0001f);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(quat)
@@ -322,4 +644,1526 @@ BOOST_AUTO_TEST_CASE(rot) {
   BOOST_CHECK_CLOSE_FRACTION(pos.y(), 0.0f, 0.00001f);
   BOOST_CHECK_CLOSE_FRACTION(pos.z(), -1.0f, 0.00001f);
 }
+
+BOOST_AUTO_TEST_CASE(rot_naive) {
+  std::mt19937 engine(50);
+  auto quats = randomQuaternions(engine, 1000);
+  auto points = randomPoints(engine, 1000);
+  for (std::size_t i = 0; i < quats.size(); ++i) {
+    // Also the non unit quaternions have to match q * v * conjugated(q).
+    auto expected = naiveRotate(points[i], quats[i]);
+    BOOST_CHECK_SMALL(distance(rotate(points[i], quats[i]), expected),
+                      0.0001f * magnitude(expected));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lerp_) {
+  auto a = Quaternion::axisAngle(Vector3(0, 0, 1), 0);
+  auto b = Quaternion::axisAngle(Vector3(0, 0, 1), 90);
+  auto expected = Quaternion::axisAngle(Vector3(0, 0, 1), 30);
+  auto s = slerp(a, b, 1.0f / 3);
+  auto f = slerpFast(a, b, 1.0f / 3);
+  BOOST_CHECK_CLOSE_FRACTION(dot(s, expected), 1.0f, 0.000001f);
+  BOOST_CHECK_CLOSE_FRACTION(dot(f, expected), 1.0f, 0.000001f);
+  BOOST_CHECK_CLOSE_FRACTION(dot(nlerp(a, b, 0.5f), slerp(a, b, 0.5f)), 1.0f,
+                             0.000001f);
+
+  // -b is the same rotation, both have to take the shorter arc.
+  BOOST_CHECK_CLOSE_FRACTION(std::abs(dot(slerp(a, -b, 1.0f / 3), expected)),
+                             1.0f, 0.000001f);
+  BOOST_CHECK_CLOSE_FRACTION(
+      std::abs(dot(nlerp(a, -b, 0.5f), nlerp(a, b, 0.5f))), 1.0f, 0.000001f);
+  BOOST_CHECK_CLOSE_FRACTION(dot(slerp(a, b, 0.0f), a), 1.0f, 0.000001f);
+}
+
+BOOST_AUTO_TEST_CASE(slerp_accuracy) {
+  std::mt19937 engine(51);
+  auto as = randomQuaternions(engine, 1000);
+  auto bs = randomQuaternions(engine, 1000);
+  float max_fast = 0;
+  float max_nlerp = 0;
+  for (std::size_t i = 0; i < as.size(); ++i) {
+    auto a = normalize(as[i]);
+    auto b = normalize(bs[i]);
+    for (float t = 0; t <= 1.0f; t += 0.125f) {
+      auto expected = slerp(a, b, t);
+      auto angle = [&expected](const Quaternion& q) {
+        auto d = std::min(std::abs(dot(q, expected)), 1.0f);
+        return radianToDegree(2 * std::acos(d));
+      };
+      max_fast = std::max(max_fast, angle(slerpFast(a, b, t)));
+      max_nlerp = std::max(max_nlerp, angle(nlerp(a, b, t)));
+    }
+  }
+  TEMP_LOG_TRACE("max error from slerp: slerpFast ", max_fast,
+                 " deg, nlerp ", max_nlerp, " deg");
+  BOOST_CHECK_SMALL(max_fast, 0.1f);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(simd)
+BOOST_AUTO_TEST_CASE(exact) {
+  // Integer valued inputs are exact in any evaluation order.
+  auto mat0 = Matrix44(  //
+      3, 1, 1, 2,        //
+      5, 1, 3, 4,        //
+      2, 0, 1, 0,        //
+      1, 3, 2, 1);
+  auto mat1 = Matrix44(  //
+      1, 1, 1, -1,       //
+      1, 1, -1, 1,       //
+      1, -1, 1, 1,       //
+      -1, 1, 1, 1);
+  BOOST_CHECK_EQUAL(mat0 * mat1, scalarMul(mat0, mat1));
+  BOOST_CHECK_EQUAL(mat0 * Matrix44::kIdentity, mat0);
+  auto vec = Vector4(1, -2, 3, 4);
+  BOOST_CHECK_EQUAL(mat0 * vec, scalarMul(mat0, vec));
+  BOOST_CHECK_EQUAL(dot(vec, Vector4(2, 3, 4, 5)), 28.0f);
+  BOOST_CHECK_EQUAL(transform(Vector3(1, -2, 3), mat0),
+                    Vector3(6.0f, 16.0f, 5.0f));
+  BOOST_CHECK_EQUAL(normalize(Vector4(0, 3, 0, 4)), Vector4(0, 0.6f, 0, 0.8f));
+}
+
+BOOST_AUTO_TEST_CASE(random_) {
+  std::mt19937 engine(1234);
+  for (int i = 0; i < 1000; ++i) {
+    auto lhs = randomMatrix(engine);
+    auto rhs = randomMatrix(engine);
+    auto m0 = lhs * rhs;
+    auto m1 = scalarMul(lhs, rhs);
+    auto v0 = lhs * rhs[0];
+    auto v1 = scalarMul(lhs, rhs[0]);
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        BOOST_CHECK_SMALL(m0[r][c] - m1[r][c], 0.001f);
+      }
+      BOOST_CHECK_SMALL(v0[r] - v1[r], 0.001f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const int kCount = 1024;
+  const int kLoop = 1000;
+  std::mt19937 engine(5678);
+  std::vector<Matrix44> matrices;
+  std::vector<Vector4> vectors;
+  for (int i = 0; i < kCount; ++i) {
+    matrices.emplace_back(randomMatrix(engine));
+    vectors.emplace_back(randomMatrix(engine)[0]);
+  }
+  auto rhs = randomMatrix(engine);
+  std::vector<Matrix44> mat_results(kCount);
+  std::vector<Vector4> vec_results(kCount);
+
+  {
+    temp::Timer timer;
+    for (int l = 0; l < kLoop; ++l) {
+      for (int i = 0; i < kCount; ++i) {
+        mat_results[i] = scalarMul(matrices[i], rhs);
+      }
+    }
+    TEMP_LOG_TRACE("scalar Matrix44 * Matrix44: ", timer.durationUs(), "us");
+  }
+  {
+    temp::Timer timer;
+    for (int l = 0; l < kLoop; ++l) {
+      for (int i = 0; i < kCount; ++i) {
+        mat_results[i] = matrices[i] * rhs;
+      }
+    }
+    TEMP_LOG_TRACE("simd Matrix44 * Matrix44: ", timer.durationUs(), "us");
+  }
+  {
+    temp::Timer timer;
+    for (int l = 0; l < kLoop; ++l) {
+      for (int i = 0; i < kCount; ++i) {
+        vec_results[i] = scalarMul(rhs, vectors[i]);
+      }
+    }
+    TEMP_LOG_TRACE("scalar Matrix44 * Vector4: ", timer.durationUs(), "us");
+  }
+  {
+    temp::Timer timer;
+    for (int l = 0; l < kLoop; ++l) {
+      for (int i = 0; i < kCount; ++i) {
+        vec_results[i] = rhs * vectors[i];
+      }
+    }
+    TEMP_LOG_TRACE("simd Matrix44 * Vector4: ", timer.durationUs(), "us");
+  }
+  BOOST_CHECK_EQUAL(vec_results.size(), kCount);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(batch)
+BOOST_AUTO_TEST_CASE(transform_points) {
+  auto mat = Matrix44::scaleRotationTranslation(
+      Vector3(1, 2, 3), Quaternion::axisAngle(Vector3(1, 1, 0), 30),
+      Vector3(4, 5, 6));
+  forEachSimdLevel([&mat](SimdLevel) {
+    std::mt19937 engine(42);
+    for (std::size_t count : {0, 1, 7, 8, 9, 15, 16, 17, 33, 1000}) {
+      auto points = randomPoints(engine, count);
+      std::vector<Vector3> results(count);
+      transformPoints(points.data(), count, mat, results.data());
+
+      std::vector<float> xs, ys, zs;
+      for (auto&& p : points) {
+        xs.push_back(p.x());
+        ys.push_back(p.y());
+        zs.push_back(p.z());
+      }
+      transformPoints(xs.data(), ys.data(), zs.data(), count, mat, xs.data(),
+                      ys.data(), zs.data());
+
+      for (std::size_t i = 0; i < count; ++i) {
+        auto expected = transform(points[i], mat);
+        BOOST_CHECK_SMALL(distance(results[i], expected), 0.001f);
+        BOOST_CHECK_SMALL(distance(Vector3(xs[i], ys[i], zs[i]), expected),
+                          0.001f);
+      }
+
+      // in place
+      transformPoints(points.data(), count, mat, points.data());
+      for (std::size_t i = 0; i < count; ++i) {
+        BOOST_CHECK_EQUAL(points[i], results[i]);
+      }
+    }
+  });
+}
+
+BOOST_AUTO_TEST_CASE(rotate_points) {
+  auto quat = Quaternion::axisAngle(Vector3(1, 2, 3), 70);
+  forEachSimdLevel([&quat](SimdLevel) {
+    std::mt19937 engine(43);
+    const std::size_t kCount = 45;
+    auto points = randomPoints(engine, kCount);
+    std::vector<Vector3> results(kCount);
+    rotatePoints(points.data(), kCount, quat, results.data());
+    for (std::size_t i = 0; i < kCount; ++i) {
+      BOOST_CHECK_SMALL(distance(results[i], rotate(points[i], quat)),
+                        0.001f);
+    }
+  });
+}
+
+BOOST_AUTO_TEST_CASE(levels) {
+  // 各命令セットのカーネルを、最初に使えたカーネルの結果と比べる
+  const std::size_t kCount = 1027;
+  std::mt19937 engine(45);
+  auto points = randomPoints(engine, kCount);
+  auto mat = randomMatrix(engine);
+  std::vector<float> xs, ys, zs;
+  for (auto&& p : points) {
+    xs.push_back(p.x());
+    ys.push_back(p.y());
+    zs.push_back(p.z());
+  }
+
+  std::vector<Vector3> reference_aos;
+  std::vector<float> reference_soa;
+  int level_count = 0;
+  forEachSimdLevel([&](SimdLevel) {
+    std::vector<Vector3> aos(kCount);
+    std::vector<float> rxs(kCount), rys(kCount), rzs(kCount);
+    transformPoints(points.data(), kCount, mat, aos.data());
+    transformPoints(xs.data(), ys.data(), zs.data(), kCount, mat, rxs.data(),
+                    rys.data(), rzs.data());
+    std::vector<float> soa = rxs;
+    soa.insert(soa.end(), rys.begin(), rys.end());
+    soa.insert(soa.end(), rzs.begin(), rzs.end());
+    if (level_count++ == 0) {
+      reference_aos = aos;
+      reference_soa = soa;
+      return;
+    }
+    for (std::size_t i = 0; i < kCount; ++i) {
+      BOOST_CHECK_SMALL(distance(aos[i], reference_aos[i]), 0.001f);
+    }
+    for (std::size_t i = 0; i < soa.size(); ++i) {
+      BOOST_CHECK_SMALL(soa[i] - reference_soa[i], 0.001f);
+    }
+  });
+  BOOST_TEST(level_count >= 1);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::size_t kCount = 1 << 20;
+  std::mt19937 engine(44);
+  auto points = randomPoints(engine, kCount);
+  std::vector<Vector3> results(kCount);
+  std::vector<float> xs(kCount), ys(kCount), zs(kCount);
+  std::vector<float> result_xs(kCount), result_ys(kCount), result_zs(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    xs[i] = points[i].x();
+    ys[i] = points[i].y();
+    zs[i] = points[i].z();
+  }
+  auto mat = randomMatrix(engine);
+  auto pointsPerSec = [kCount](std::int64_t us) {
+    return us > 0 ? (double)kCount * 1000000.0 / us : 0.0;
+  };
+
+  TEMP_LOG_TRACE("batch simd level: ", (int)batchSimdLevel());
+  {
+    temp::Timer timer;
+    for (std::size_t i = 0; i < kCount; ++i) {
+      results[i] = transform(points[i], mat);
+    }
+    TEMP_LOG_TRACE("scalar loop: ", pointsPerSec(timer.durationUs()),
+                   " points/s");
+  }
+  forEachSimdLevel([&](SimdLevel level) {
+    {
+      temp::Timer timer;
+      transformPoints(points.data(), kCount, mat, results.data());
+      TEMP_LOG_TRACE("level ", (int)level, " transformPoints AoS: ",
+                     pointsPerSec(timer.durationUs()), " points/s");
+    }
+    {
+      temp::Timer timer;
+      transformPoints(xs.data(), ys.data(), zs.data(), kCount, mat,
+                      result_xs.data(), result_ys.data(), result_zs.data());
+      TEMP_LOG_TRACE("level ", (int)level, " transformPoints SoA: ",
+                     pointsPerSec(timer.durationUs()), " points/s");
+    }
+  });
+  BOOST_CHECK_EQUAL(results.size(), kCount);
+}
+
+BOOST_AUTO_TEST_CASE(blend_quaternions) {
+  std::mt19937 engine(52);
+  for (std::size_t count : {0, 1, 7, 16, 37}) {
+    auto as = randomQuaternions(engine, count);
+    auto bs = randomQuaternions(engine, count);
+    for (auto& q : as) q = normalize(q);
+    for (auto& q : bs) q = normalize(q);
+    auto points = randomPoints(engine, count);
+    std::vector<Quaternion> results(count);
+    std::vector<Vector3> rotated(count);
+
+    nlerp(as.data(), bs.data(), count, 0.3f, results.data());
+    for (std::size_t i = 0; i < count; ++i) {
+      BOOST_CHECK_CLOSE_FRACTION(dot(results[i], nlerp(as[i], bs[i], 0.3f)),
+                                 1.0f, 0.00001f);
+    }
+    slerp(as.data(), bs.data(), count, 0.3f, results.data());
+    for (std::size_t i = 0; i < count; ++i) {
+      BOOST_CHECK_EQUAL(results[i], slerp(as[i], bs[i], 0.3f));
+    }
+    slerpFast(as.data(), bs.data(), count, 0.3f, results.data());
+    for (std::size_t i = 0; i < count; ++i) {
+      BOOST_CHECK_CLOSE_FRACTION(
+          dot(results[i], slerpFast(as[i], bs[i], 0.3f)), 1.0f, 0.00001f);
+    }
+    rotatePoints(points.data(), as.data(), count, rotated.data());
+    for (std::size_t i = 0; i < count; ++i) {
+      BOOST_CHECK_SMALL(distance(rotated[i], rotate(points[i], as[i])),
+                        0.001f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(blend_benchmark) {
+  const std::size_t kCount = 4096;
+  const int kLoop = 100;
+  std::mt19937 engine(53);
+  auto as = randomQuaternions(engine, kCount);
+  auto bs = randomQuaternions(engine, kCount);
+  for (auto& q : as) q = normalize(q);
+  for (auto& q : bs) q = normalize(q);
+  auto points = randomPoints(engine, kCount);
+  std::vector<Quaternion> results(kCount);
+  std::vector<Vector3> rotated(kCount);
+
+  auto bench = [kLoop](const char* name, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      func();
+    }
+    TEMP_LOG_TRACE(name, ": ", timer.durationUs(), " us");
+  };
+  bench("naive rotate", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      rotated[i] = naiveRotate(points[i], as[i]);
+    }
+  });
+  bench("rotate", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      rotated[i] = rotate(points[i], as[i]);
+    }
+  });
+  bench("batch rotatePoints", [&] {
+    rotatePoints(points.data(), as.data(), kCount, rotated.data());
+  });
+  bench("slerp", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      results[i] = slerp(as[i], bs[i], 0.3f);
+    }
+  });
+  bench("batch nlerp", [&] {
+    nlerp(as.data(), bs.data(), kCount, 0.3f, results.data());
+  });
+  bench("batch slerpFast", [&] {
+    slerpFast(as.data(), bs.data(), kCount, 0.3f, results.data());
+  });
+  BOOST_CHECK_EQUAL(results.size(), kCount);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+template <std::size_t N>
+void checkWideVector3(std::mt19937& engine) {
+  auto as = randomPoints(engine, N);
+  auto bs = randomPoints(engine, N);
+  auto a = Vector3Wide<float, N>::load(as.data());
+  auto b = Vector3Wide<float, N>::load(bs.data());
+  auto d = dot(a, b);
+  auto c = cross(a, b);
+  auto n = normalize(a);
+  auto s = select(d < Wide<float, N>(0.0f), a, b);
+  std::vector<Vector3> stored(N);
+  (a + b).store(stored.data());
+  for (std::size_t i = 0; i < N; ++i) {
+    auto expected = dot(as[i], bs[i]);
+    BOOST_CHECK_CLOSE(d[i], expected, 0.01f);
+    BOOST_CHECK_SMALL(distance(c.lane(i), cross(as[i], bs[i])), 0.01f);
+    BOOST_CHECK_SMALL(distance(n.lane(i), normalize(as[i])), 0.0001f);
+    BOOST_CHECK_EQUAL(s.lane(i), expected < 0.0f ? as[i] : bs[i]);
+    BOOST_CHECK_EQUAL(stored[i], as[i] + bs[i]);
+  }
+}
+
+template <std::size_t N>
+void checkWideQuaternion(std::mt19937& engine) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<Quaternion> qs, rs;
+  for (std::size_t i = 0; i < N; ++i) {
+    qs.emplace_back(dist(engine), dist(engine), dist(engine), dist(engine));
+    rs.emplace_back(dist(engine), dist(engine), dist(engine), dist(engine));
+  }
+  auto points = randomPoints(engine, N);
+  auto q = QuaternionWide<float, N>::load(qs.data());
+  auto r = QuaternionWide<float, N>::load(rs.data());
+  auto v = Vector3Wide<float, N>::load(points.data());
+  auto qr = q * r;
+  auto rotated = rotate(v, normalize(q));
+  for (std::size_t i = 0; i < N; ++i) {
+    auto expected = qs[i] * rs[i];
+    BOOST_CHECK_SMALL(qr.x()[i] - expected.x(), 0.0001f);
+    BOOST_CHECK_SMALL(qr.y()[i] - expected.y(), 0.0001f);
+    BOOST_CHECK_SMALL(qr.z()[i] - expected.z(), 0.0001f);
+    BOOST_CHECK_SMALL(qr.w()[i] - expected.w(), 0.0001f);
+    BOOST_CHECK_SMALL(
+        distance(rotated.lane(i), rotate(points[i], normalize(qs[i]))),
+        0.001f);
+  }
+}
+
+template <std::size_t N>
+void checkWideMatrix44(std::mt19937& engine) {
+  std::vector<Matrix44> as, bs;
+  for (std::size_t i = 0; i < N; ++i) {
+    as.push_back(randomMatrix(engine));
+    bs.push_back(randomMatrix(engine));
+  }
+  auto points = randomPoints(engine, N);
+  auto ab = Matrix44Wide<float, N>::load(as.data()) *
+            Matrix44Wide<float, N>::load(bs.data());
+  auto transformed = transform(Vector3Wide<float, N>::load(points.data()),
+                               Matrix44Wide<float, N>::load(as.data()));
+  std::vector<Matrix44> stored(N);
+  ab.store(stored.data());
+  for (std::size_t i = 0; i < N; ++i) {
+    auto expected = scalarMul(as[i], bs[i]);
+    for (int r = 0; r < 4; ++r) {
+      for (int c = 0; c < 4; ++c) {
+        BOOST_CHECK_SMALL(stored[i][r][c] - expected[r][c], 0.01f);
+      }
+    }
+    BOOST_CHECK_SMALL(
+        distance(transformed.lane(i), transform(points[i], as[i])), 0.01f);
+  }
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(wide)
+BOOST_AUTO_TEST_CASE(mask) {
+  const float kA[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const float kB[8] = {8, 7, 6, 5, 4, 3, 2, 1};
+  auto a = Floatx8::load(kA);
+  auto b = Floatx8::load(kB);
+  auto lt = a < b;
+  BOOST_CHECK_EQUAL(lt.bits(), 0x0fu);
+  BOOST_CHECK_EQUAL((!lt).bits(), 0xf0u);
+  BOOST_CHECK_EQUAL((lt & (a >= Floatx8(3.0f))).bits(), 0x0cu);
+  BOOST_CHECK_EQUAL((lt | (a == Floatx8(8.0f))).bits(), 0x8fu);
+  BOOST_CHECK((a <= Floatx8(8.0f)).all());
+  BOOST_CHECK(!(a > Floatx8(8.0f)).any());
+
+  float selected[8];
+  select(lt, a, b).store(selected);
+  for (int i = 0; i < 8; ++i) {
+    BOOST_CHECK_EQUAL(selected[i], std::min(kA[i], kB[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(lanes) {
+  std::mt19937 engine(45);
+  checkWideVector3<4>(engine);
+  checkWideVector3<8>(engine);
+  checkWideVector3<16>(engine);
+  checkWideQuaternion<4>(engine);
+  checkWideQuaternion<8>(engine);
+  checkWideQuaternion<16>(engine);
+  checkWideMatrix44<4>(engine);
+  checkWideMatrix44<8>(engine);
+  checkWideMatrix44<16>(engine);
+}
+
+BOOST_AUTO_TEST_CASE(double_lanes) {
+  std::vector<Vector3_64b> vs = {Vector3_64b(1, 0, 0), Vector3_64b(0, 2, 0),
+                                 Vector3_64b(0, 0, 3), Vector3_64b(1, 1, 1)};
+  auto v = Vector3Wide<double, 4>::load(vs.data());
+  auto q = QuaternionWide<double, 4>(
+      Quaternion_64b::axisAngle(Vector3_64b(0, 0, 1), 90.0));
+  auto rotated = rotate(v, q);
+  for (std::size_t i = 0; i < 4; ++i) {
+    auto expected = rotate(vs[i], q.lane(i));
+    BOOST_CHECK_SMALL(distance(rotated.lane(i), expected), 1e-9);
+  }
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+// 関数内staticで係数を保持していた以前の実装(比較用)
+template <class T>
+T guardedDegreeToRadian(T degree) {
+  static const T deg2rad = ConstantsBase<T>::kPi / (T)180;
+  return deg2rad * degree;
+}
+
+template <std::size_t N>
+constexpr std::array<float, N> makeRadianTable() {
+  std::array<float, N> table{};
+  for (std::size_t i = 0; i < N; ++i) {
+    table[i] = degreeToRadian((float)i);
+  }
+  return table;
+}
+
+constexpr auto kRadianTable = makeRadianTable<361>();
+
+constexpr bool nearlyEqual(double lhs, double rhs) {
+  return lhs - rhs < 1e-12 && rhs - lhs < 1e-12;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(constexpr_)
+BOOST_AUTO_TEST_CASE(constants) {
+  static_assert(Vector3::kForward == Vector3(0, 0, 1), "");
+  static_assert(Vector4().w() == 0.0f, "");
+  static_assert(Quaternion_64b::kIdentity.w() == 1.0, "");
+  static_assert(Matrix44_64bit::kIdentity[2][2] == 1.0, "");
+  static_assert(kPi_64b == ConstantsBase<double>::kPi, "");
+  static_assert(k_2_Pi == ConstantsBase<float>::k_2_Pi, "");
+  static_assert(approximately(radianToDegree(kPi_64b), 180.0), "");
+  static_assert(kRadianTable[180] == degreeToRadian(180.0f), "");
+  BOOST_TEST(kRadianTable[90] == kPi_2);
+}
+
+BOOST_AUTO_TEST_CASE(functions) {
+  constexpr Vector3_64b x(1, 0, 0);
+  constexpr Vector3_64b y(0, 1, 0);
+  static_assert(dot(x, y) == 0.0, "");
+  static_assert(cross(x, y) == Vector3_64b(0, 0, 1), "");
+  static_assert(lerp(x, y, 0.5) == Vector3_64b(0.5, 0.5, 0), "");
+
+  constexpr Matrix44_64bit m(1, 2, 0, 4,  //
+                             0, 1, 0, 5,  //
+                             0, 0, 1, 6,  //
+                             0, 0, 0, 1);
+  static_assert(transpose(m)[3][0] == 4.0, "");
+  static_assert(determinant(m) == 1.0, "");
+  static_assert(inverse(m) * m == Matrix44_64bit::kIdentity, "");
+  static_assert(transform(Vector3_64b::kZero, m) == Vector3_64b(4, 5, 6), "");
+
+  // z軸回り90度の回転
+  constexpr double kHalf = 0.70710678118654752440;
+  constexpr Quaternion_64b rot(0, 0, kHalf, kHalf);
+  constexpr auto trs = Matrix44_64bit::scaleRotationTranslation(
+      Vector3_64b(1, 1, 1), rot, Vector3_64b(1, 2, 3));
+  constexpr auto inv = inverseOrthonormal(trs);
+  constexpr auto p = transform(transform(Vector3_64b(7, 8, 9), trs), inv);
+  static_assert(nearlyEqual(p.x(), 7.0) && nearlyEqual(p.z(), 9.0), "");
+  static_assert(rotate(x, rot).y() > 0.99, "");
+  BOOST_TEST(p.y() == 8.0, boost::test_tools::tolerance(1e-12));
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const int kCount = 1 << 22;
+  float sum = 0.0f;
+  temp::Timer timer;
+  for (int i = 0; i < kCount; ++i) {
+    sum += guardedDegreeToRadian((float)(i & 1023));
+  }
+  TEMP_LOG_TRACE("static local degreeToRadian: ", timer.durationUs(), " us");
+
+  float sum_constexpr = 0.0f;
+  timer = temp::Timer();
+  for (int i = 0; i < kCount; ++i) {
+    sum_constexpr += degreeToRadian((float)(i & 1023));
+  }
+  TEMP_LOG_TRACE("constexpr degreeToRadian: ", timer.durationUs(), " us");
+  BOOST_TEST(sum == sum_constexpr, boost::test_tools::tolerance(0.0001f));
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+// Left handed perspective (+z forward, depth 0..1) with 90 degree fov.
+// A far of 0 makes the far plane infinite.
+Matrix44 testProjection(float near, float far) {
+  float a = far == 0 ? 1.0f : far / (far - near);
+  return Matrix44(1, 0, 0, 0,  //
+                  0, 1, 0, 0,  //
+                  0, 0, a, -a * near,  //
+                  0, 0, 1, 0);
+}
+
+// Smallest signed distance plus radius over the planes, in double.
+double cullMargin(const Frustum& frustum, const Vector3& c, const Vector3& e,
+                  float radius) {
+  double margin = 1e30;
+  for (const auto& plane : frustum.planes) {
+    const auto& n = plane.normal;
+    double d = (double)n.x() * c.x() + (double)n.y() * c.y() +
+               (double)n.z() * c.z() + plane.distance;
+    d += std::abs(n.x()) * e.x() + std::abs(n.y()) * e.y() +
+         std::abs(n.z()) * e.z() + radius;
+    margin = std::min(margin, d);
+  }
+  return margin;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(bounds)
+BOOST_AUTO_TEST_CASE(primitives) {
+  auto a = Aabb{Vector3(-1, -1, -1), Vector3(1, 1, 1)};
+  auto b = Aabb::fromCenterExtent(Vector3(2, 0, 0), Vector3(0.5f, 0.5f, 0.5f));
+  BOOST_TEST(!intersects(a, b));
+  BOOST_TEST(merge(a, b).max.x() == 2.5f);
+  BOOST_TEST(center(merge(a, b)).x() == 0.75f);
+  BOOST_TEST(contains(a, Vector3(0.5f, -0.5f, 1)));
+  BOOST_TEST(intersects(a, Sphere{Vector3(1.5f, 1.5f, 0), 0.75f}));
+  BOOST_TEST(!intersects(a, Sphere{Vector3(1.5f, 1.5f, 0), 0.7f}));
+  BOOST_TEST(intersects(Sphere{Vector3(0, 0, 0), 1},
+                        Sphere{Vector3(0, 1.5f, 0), 0.5f}));
+
+  auto plane = normalize(Plane{Vector3(0, 2, 0), -4});
+  BOOST_TEST(plane.distance == -2.0f);
+  BOOST_TEST(signedDistance(plane, Vector3(5, 3, 5)) == 1.0f);
+
+  // z軸回り90度回転して平行移動
+  auto half = std::sqrt(0.5f);
+  auto m = Matrix44::scaleRotationTranslation(
+      Vector3(1, 2, 1), Quaternion(0, 0, half, half), Vector3(10, 0, 0));
+  auto t = transform(b, m);
+  for (int i = 0; i < 8; ++i) {
+    Vector3 corner((i & 1) ? b.max.x() : b.min.x(),
+                   (i & 2) ? b.max.y() : b.min.y(),
+                   (i & 4) ? b.max.z() : b.min.z());
+    auto p = transform(corner, m);
+    auto grown = Aabb{t.min - Vector3(1e-4f, 1e-4f, 1e-4f),
+                      t.max + Vector3(1e-4f, 1e-4f, 1e-4f)};
+    BOOST_TEST(contains(grown, p));
+  }
+  BOOST_TEST(extent(t).x() + extent(t).y() == 1.5f,
+             boost::test_tools::tolerance(0.0001f));
+}
+
+BOOST_AUTO_TEST_CASE(frustum) {
+  auto frustum = extractFrustum(testProjection(1, 100));
+  BOOST_TEST(intersects(frustum, Sphere{Vector3(0, 0, 10), 1}));
+  BOOST_TEST(!intersects(frustum, Sphere{Vector3(0, 0, -10), 1}));
+  BOOST_TEST(!intersects(frustum, Sphere{Vector3(20, 0, 10), 1}));
+  BOOST_TEST(intersects(frustum, Sphere{Vector3(11, 0, 10), 1}));
+  BOOST_TEST(!intersects(frustum, Sphere{Vector3(0, 0, 0), 0.5f}));
+  BOOST_TEST(!intersects(frustum, Sphere{Vector3(0, 0, 102), 1}));
+  BOOST_TEST(
+      intersects(frustum, Aabb{Vector3(10.5f, 0, 9), Vector3(12, 1, 11)}));
+  BOOST_TEST(!intersects(frustum, Aabb{Vector3(12, 0, 9), Vector3(13, 1, 11)}));
+
+  BOOST_TEST(frustum.planes[Frustum::kNear].distance == -1.0f,
+             boost::test_tools::tolerance(0.0001f));
+  BOOST_TEST(frustum.planes[Frustum::kLeft].normal.x() == std::sqrt(0.5f),
+             boost::test_tools::tolerance(0.0001f));
+
+  // 遠平面が無限遠の場合は縮退した遠平面で何も除外しない
+  auto infinite = extractFrustum(testProjection(1, 0));
+  BOOST_TEST(squared_magnitude(infinite.planes[Frustum::kFar].normal) == 0.0f);
+  BOOST_TEST(intersects(infinite, Sphere{Vector3(0, 0, 1e6f), 1}));
+  BOOST_TEST(!intersects(infinite, Sphere{Vector3(0, 0, 0.5f), 0.1f}));
+}
+
+BOOST_AUTO_TEST_CASE(cull) {
+  auto frustum = extractFrustum(testProjection(1, 100));
+  forEachSimdLevel([&frustum](SimdLevel) {
+    std::mt19937 engine(61);
+    std::uniform_real_distribution<float> size(0.0f, 5.0f);
+    for (std::size_t count : {0, 1, 31, 32, 33, 1000, 1027}) {
+      auto centers = randomPoints(engine, count);
+      std::vector<Sphere> spheres;
+      std::vector<Aabb> aabbs;
+      std::vector<float> xs, ys, zs, radii, exs, eys, ezs;
+      for (const auto& c : centers) {
+        spheres.push_back(Sphere{c, size(engine)});
+        Vector3 e(size(engine), size(engine), size(engine));
+        aabbs.push_back(Aabb::fromCenterExtent(c, e));
+        xs.push_back(c.x()), ys.push_back(c.y()), zs.push_back(c.z());
+        radii.push_back(spheres.back().radius);
+        exs.push_back(e.x()), eys.push_back(e.y()), ezs.push_back(e.z());
+      }
+
+      auto words = (count + 31) / 32;
+      std::vector<std::uint32_t> sphere_aos(words + 1, 0xcdcdcdcd);
+      std::vector<std::uint32_t> sphere_soa(words + 1, 0xcdcdcdcd);
+      std::vector<std::uint32_t> aabb_aos(words + 1, 0xcdcdcdcd);
+      std::vector<std::uint32_t> aabb_soa(words + 1, 0xcdcdcdcd);
+      cullSpheres(frustum, spheres.data(), count, sphere_aos.data());
+      cullSpheres(frustum, xs.data(), ys.data(), zs.data(), radii.data(), count,
+                  sphere_soa.data());
+      cullAabbs(frustum, aabbs.data(), count, aabb_aos.data());
+      cullAabbs(frustum, xs.data(), ys.data(), zs.data(), exs.data(),
+                eys.data(), ezs.data(), count, aabb_soa.data());
+
+      BOOST_TEST(sphere_aos[words] == 0xcdcdcdcd);
+      BOOST_TEST(aabb_soa[words] == 0xcdcdcdcd);
+      if (count % 32 != 0) {
+        BOOST_TEST((sphere_soa[words - 1] >> (count % 32)) == 0u);
+        BOOST_TEST((aabb_aos[words - 1] >> (count % 32)) == 0u);
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        auto bit = [i](const std::vector<std::uint32_t>& v) {
+          return ((v[i / 32] >> (i % 32)) & 1) != 0;
+        };
+        // 境界付近は丸め方で結果が変わるので除く
+        auto zero = Vector3::kZero;
+        auto e = extent(aabbs[i]);
+        if (std::abs(cullMargin(frustum, centers[i], zero, radii[i])) > 1e-3) {
+          BOOST_TEST(bit(sphere_aos) == intersects(frustum, spheres[i]));
+          BOOST_TEST(bit(sphere_soa) == intersects(frustum, spheres[i]));
+        }
+        if (std::abs(cullMargin(frustum, centers[i], e, 0)) > 1e-3) {
+          BOOST_TEST(bit(aabb_aos) == intersects(frustum, aabbs[i]));
+          BOOST_TEST(bit(aabb_soa) == intersects(frustum, aabbs[i]));
+        }
+      }
+    }
+  });
+}
+
+BOOST_AUTO_TEST_CASE(cull_benchmark) {
+  const std::size_t kCount = 1 << 20;
+  const int kLoop = 10;
+  auto frustum = extractFrustum(testProjection(1, 100));
+  std::mt19937 engine(67);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> size(0.0f, 5.0f);
+  std::vector<Sphere> spheres(kCount);
+  std::vector<float> xs(kCount), ys(kCount), zs(kCount), radii(kCount);
+  std::vector<float> exs(kCount), eys(kCount), ezs(kCount);
+  for (std::size_t i = 0; i < kCount; ++i) {
+    xs[i] = dist(engine), ys[i] = dist(engine), zs[i] = dist(engine);
+    radii[i] = size(engine);
+    exs[i] = size(engine), eys[i] = size(engine), ezs[i] = size(engine);
+    spheres[i] = Sphere{Vector3(xs[i], ys[i], zs[i]), radii[i]};
+  }
+  std::vector<std::uint32_t> visibility(kCount / 32);
+
+  auto bench = [kLoop, kCount](const char* name, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      func();
+    }
+    auto us = std::max<std::int64_t>(timer.durationUs(), 1);
+    TEMP_LOG_TRACE(name, ": ", (double)kCount * kLoop / us * 1000,
+                   " bounds/ms");
+  };
+  bench("scalar spheres", [&] {
+    for (std::size_t i = 0; i < kCount; i += 32) {
+      std::uint32_t bits = 0;
+      for (std::size_t j = 0; j < 32; ++j) {
+        bits |= (intersects(frustum, spheres[i + j]) ? 1u : 0u) << j;
+      }
+      visibility[i / 32] = bits;
+    }
+  });
+  bench("cullSpheres AoS", [&] {
+    cullSpheres(frustum, spheres.data(), kCount, visibility.data());
+  });
+  bench("cullSpheres SoA", [&] {
+    cullSpheres(frustum, xs.data(), ys.data(), zs.data(), radii.data(),
+                kCount, visibility.data());
+  });
+  bench("cullAabbs SoA", [&] {
+    cullAabbs(frustum, xs.data(), ys.data(), zs.data(), exs.data(),
+              eys.data(), ezs.data(), kCount, visibility.data());
+  });
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+// Normalized device coordinates of point.
+Vector3 project(const Matrix44& mat, const Vector3& point) {
+  auto clip = mat * Vector4(point, 1.0f);
+  return Vector3(clip.x(), clip.y(), clip.z()) / clip.w();
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(camera_matrix)
+BOOST_AUTO_TEST_CASE(view, *utf::tolerance(0.0001f)) {
+  Vector3 eye(1, 2, 3);
+  auto view = lookAt(eye, Vector3(1, 2, 10), Vector3(0, 1, 0));
+  BOOST_TEST(transform(eye, view).z() == 0.0f);
+  BOOST_TEST(transform(Vector3(1, 2, 10), view).z() == 7.0f);
+  BOOST_TEST(transform(Vector3(2, 3, 3), view).x() == 1.0f);
+  BOOST_TEST(transform(Vector3(2, 3, 3), view).y() == 1.0f);
+
+  // 回転と位置からのビュー行列は、同じ向きのlookAtと一致する
+  auto rotation = Quaternion::axisAngle(normalize(Vector3(1, 2, 3)), 70);
+  auto from_transform = viewFromTransform(rotation, eye);
+  auto from_look_at = lookAt(eye, eye + rotate(Vector3(0, 0, 1), rotation),
+                             rotate(Vector3(0, 1, 0), rotation));
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      BOOST_TEST(from_transform[r][c] == from_look_at[r][c]);
+    }
+  }
+  // カメラ座標の点をワールドに置いてビュー行列で戻す
+  auto point = Vector3(4, -5, 6);
+  auto world = rotate(point, rotation) + eye;
+  BOOST_TEST(transform(world, from_transform).x() == point.x());
+  BOOST_TEST(transform(world, from_transform).y() == point.y());
+  BOOST_TEST(transform(world, from_transform).z() == point.z());
+}
+
+BOOST_AUTO_TEST_CASE(projection, *utf::tolerance(0.0001f)) {
+  float fov = degreeToRadian(60.0f);
+  float aspect = 16.0f / 9.0f;
+  float n = 0.5f;
+  float f = 100.0f;
+  // 視錐台の右上の角
+  auto corner = [&](float z) {
+    float y = z * std::tan(fov / 2);
+    return Vector3(y * aspect, y, z);
+  };
+
+  auto standard = perspective(fov, aspect, n, f);
+  BOOST_TEST(project(standard, corner(n)).x() == 1.0f);
+  BOOST_TEST(project(standard, corner(n)).y() == 1.0f);
+  BOOST_TEST(project(standard, corner(n)).z() == 0.0f);
+  BOOST_TEST(project(standard, corner(f)).z() == 1.0f);
+
+  auto reversed = perspectiveReversedZ(fov, aspect, n, f);
+  BOOST_TEST(project(reversed, corner(n)).y() == 1.0f);
+  BOOST_TEST(project(reversed, corner(n)).z() == 1.0f);
+  BOOST_TEST(project(reversed, corner(f)).z() == 0.0f);
+
+  auto infinite = perspectiveInfinite(fov, aspect, n);
+  BOOST_TEST(project(infinite, corner(n)).z() == 0.0f);
+  BOOST_TEST(project(infinite, corner(1e6f)).z() == 1.0f);
+
+  auto infinite_reversed = perspectiveInfiniteReversedZ(fov, aspect, n);
+  BOOST_TEST(project(infinite_reversed, corner(n)).x() == 1.0f);
+  BOOST_TEST(project(infinite_reversed, corner(n)).z() == 1.0f);
+  BOOST_TEST(project(infinite_reversed, corner(2 * n)).z() == 0.5f);
+
+  auto ortho = orthographic(8.0f, 4.0f, n, f);
+  BOOST_TEST(project(ortho, Vector3(4, 2, n)).x() == 1.0f);
+  BOOST_TEST(project(ortho, Vector3(4, 2, n)).y() == 1.0f);
+  BOOST_TEST(project(ortho, Vector3(4, 2, n)).z() == 0.0f);
+  BOOST_TEST(project(ortho, Vector3(-4, -2, f)).z() == 1.0f);
+  auto ortho_reversed = orthographicReversedZ(8.0f, 4.0f, n, f);
+  BOOST_TEST(project(ortho_reversed, Vector3(4, 2, n)).z() == 1.0f);
+  BOOST_TEST(project(ortho_reversed, Vector3(-4, -2, f)).z() == 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(reversed_z_precision) {
+  // float深度バッファで離れた2点を区別できる距離を比べる
+  float fov = degreeToRadian(60.0f);
+  float n = 0.1f;
+  float f = 10000.0f;
+  auto standard = perspective(fov, 1.0f, n, f);
+  auto reversed = perspectiveReversedZ(fov, 1.0f, n, f);
+  int standard_distinct = 0;
+  int reversed_distinct = 0;
+  for (float z = 100.0f; z < f; z *= 1.1f) {
+    Vector3 a(0, 0, z);
+    Vector3 b(0, 0, z * 1.001f);
+    standard_distinct += project(standard, a).z() != project(standard, b).z();
+    reversed_distinct += project(reversed, a).z() != project(reversed, b).z();
+  }
+  TEMP_LOG_TRACE("distinct depths at 0.1%: standard ", standard_distinct,
+                 ", reversed ", reversed_distinct);
+  BOOST_TEST(reversed_distinct > standard_distinct);
+}
+
+BOOST_AUTO_TEST_CASE(frustum_) {
+  float fov = degreeToRadian(90.0f);
+  auto view = lookAt(Vector3(0, 0, -10), Vector3(), Vector3(0, 1, 0));
+  for (const auto& proj : {perspective(fov, 1.0f, 1.0f, 100.0f),
+                           perspectiveReversedZ(fov, 1.0f, 1.0f, 100.0f),
+                           perspectiveInfinite(fov, 1.0f, 1.0f),
+                           perspectiveInfiniteReversedZ(fov, 1.0f, 1.0f)}) {
+    auto frustum = extractFrustum(proj * view);
+    BOOST_TEST(intersects(frustum, Sphere{Vector3(0, 0, 0), 1.0f}));
+    BOOST_TEST(!intersects(frustum, Sphere{Vector3(0, 0, -12), 1.0f}));
+    BOOST_TEST(!intersects(frustum, Sphere{Vector3(20, 0, 0), 1.0f}));
+  }
+  auto finite = extractFrustum(perspective(fov, 1.0f, 1.0f, 100.0f) * view);
+  BOOST_TEST(!intersects(finite, Sphere{Vector3(0, 0, 200), 1.0f}));
+  auto infinite = extractFrustum(perspectiveInfinite(fov, 1.0f, 1.0f) * view);
+  BOOST_TEST(intersects(infinite, Sphere{Vector3(0, 0, 1e6f), 1.0f}));
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+// Inputs and double precision results of one function of the fast suite
+struct FastCase {
+  const char* name;
+  bool relative;     // relative error, otherwise absolute error up to 1
+  double max_error;  // documented bound
+  std::vector<float> as;
+  std::vector<float> bs;  // second argument of atan2, unused otherwise
+  std::vector<double> expected;
+};
+
+double maxFastError(const FastCase& c, const std::vector<float>& results) {
+  double max_error = 0.0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    double error = std::abs(results[i] - c.expected[i]);
+    // 絶対誤差でも1を超える値は相対誤差で測る (floatの丸め誤差が大きくなるため)
+    error /= c.relative ? std::abs(c.expected[i])
+                        : std::max(1.0, std::abs(c.expected[i]));
+    max_error = std::max(max_error, error);
+  }
+  return max_error;
+}
+
+template <std::size_t N, class F>
+void evaluateFast(const FastCase& c, F func, std::vector<float>& results) {
+  using T = Wide<float, N>;
+  for (std::size_t i = 0; i < c.as.size(); i += N) {
+    func(T::load(&c.as[i]), T::load(&c.bs[i])).store(&results[i]);
+  }
+}
+
+// Check the error bound of the scalar and Wide versions and log a row of the
+// accuracy/throughput table. func is called as func(a, b) with float and
+// Wide<float, N>.
+template <class StdF, class F>
+void checkFast(const FastCase& c, StdF std_func, F func) {
+  const int kLoop = 20;
+  const auto count = c.as.size();
+  std::vector<float> results(count);
+  auto nsPerValue = [&](auto evaluate) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      evaluate();
+    }
+    return timer.durationUs() * 1000.0 / ((double)kLoop * count);
+  };
+
+  auto std_ns = nsPerValue([&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = std_func(c.as[i], c.bs[i]);
+    }
+  });
+  auto std_error = maxFastError(c, results);
+
+  auto scalar_ns = nsPerValue([&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = func(c.as[i], c.bs[i]);
+    }
+  });
+  auto error = maxFastError(c, results);
+  BOOST_CHECK_LT(error, c.max_error);
+
+  auto x4_ns = nsPerValue([&] { evaluateFast<4>(c, func, results); });
+  BOOST_CHECK_LT(maxFastError(c, results), c.max_error);
+  auto x8_ns = nsPerValue([&] { evaluateFast<8>(c, func, results); });
+  BOOST_CHECK_LT(maxFastError(c, results), c.max_error);
+  auto x16_ns = nsPerValue([&] { evaluateFast<16>(c, func, results); });
+  BOOST_CHECK_LT(maxFastError(c, results), c.max_error);
+
+  char row[160];
+  std::snprintf(row, sizeof(row),
+                "%-6s %-3s %9.2e %9.2e %7.2f %7.2f %7.2f %7.2f %7.2f", c.name,
+                c.relative ? "rel" : "abs", std_error, error, std_ns,
+                scalar_ns, x4_ns, x8_ns, x16_ns);
+  TEMP_LOG_TRACE(row);
+}
+
+template <class Dist, class Reference>
+FastCase makeFastCase(const char* name, bool relative, double max_error,
+                      Dist dist, Reference reference) {
+  const std::size_t kCount = 1 << 16;
+  std::mt19937 engine(59);
+  FastCase c{name, relative, max_error, {}, {}, {}};
+  for (std::size_t i = 0; i < kCount; ++i) {
+    c.as.push_back(dist(engine));
+    c.bs.push_back(dist(engine));
+    c.expected.push_back(reference((double)c.as[i], (double)c.bs[i]));
+  }
+  return c;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(fast_)
+BOOST_AUTO_TEST_CASE(special_values) {
+  BOOST_CHECK_EQUAL(fast::atan2(0.0f, 0.0f), 0.0f);
+  BOOST_CHECK_SMALL(fast::atan2(0.0f, -1.0f) - kPi, 1e-6f);
+  BOOST_CHECK_SMALL(fast::atan2(-1.0f, 0.0f) + kPi / 2, 1e-6f);
+  BOOST_CHECK_SMALL(fast::acos(1.0f), 1e-6f);
+  BOOST_CHECK_SMALL(fast::acos(-1.0f) - kPi, 1e-6f);
+  BOOST_CHECK_CLOSE(fast::exp(100.0f), fast::exp(88.3f), 1e-4f);
+  BOOST_CHECK_GT(fast::exp(-100.0f), 0.0f);
+  BOOST_CHECK_EQUAL(fast::log(1.0f), 0.0f);
+
+  float s, c;
+  fast::sincos(kPi / 6, &s, &c);
+  BOOST_CHECK_SMALL(s - 0.5f, 1e-6f);
+  BOOST_CHECK_SMALL(c - std::sqrt(3.0f) / 2, 1e-6f);
+  Floatx8 sw, cw;
+  fast::sincos(Floatx8(kPi / 6), &sw, &cw);
+  BOOST_CHECK_EQUAL(sw[7], s);
+  BOOST_CHECK_EQUAL(cw[7], c);
+}
+
+// 誤差の最大値とns/値の表を出力する
+// 列: 関数 誤差の種類 std誤差 fast誤差 std scalar x4 x8 x16
+BOOST_AUTO_TEST_CASE(accuracy_and_throughput) {
+  using Uniform = std::uniform_real_distribution<float>;
+  auto logUniform = [](float lo, float hi) {
+    return [lo, hi](std::mt19937& engine) {
+      return std::exp2(Uniform(lo, hi)(engine));
+    };
+  };
+
+  auto sin_case = makeFastCase("sin", false, 2e-7, Uniform(-8192, 8192),
+                               [](double a, double) { return std::sin(a); });
+  checkFast(
+      sin_case, [](float a, float) { return std::sin(a); },
+      [](auto a, auto) { return fast::sin(a); });
+
+  auto cos_case = makeFastCase("cos", false, 2e-7, Uniform(-8192, 8192),
+                               [](double a, double) { return std::cos(a); });
+  checkFast(
+      cos_case, [](float a, float) { return std::cos(a); },
+      [](auto a, auto) { return fast::cos(a); });
+
+  auto atan2_case =
+      makeFastCase("atan2", false, 1e-5, Uniform(-10, 10),
+                   [](double a, double b) { return std::atan2(a, b); });
+  checkFast(
+      atan2_case, [](float a, float b) { return std::atan2(a, b); },
+      [](auto a, auto b) { return fast::atan2(a, b); });
+
+  auto acos_case = makeFastCase("acos", false, 5e-7, Uniform(-1, 1),
+                                [](double a, double) { return std::acos(a); });
+  checkFast(
+      acos_case, [](float a, float) { return std::acos(a); },
+      [](auto a, auto) { return fast::acos(a); });
+
+  auto rsqrt_case =
+      makeFastCase("rsqrt", true, 5e-7, logUniform(-120, 120),
+                   [](double a, double) { return 1 / std::sqrt(a); });
+  checkFast(
+      rsqrt_case, [](float a, float) { return 1 / std::sqrt(a); },
+      [](auto a, auto) { return fast::rsqrt(a); });
+
+  auto exp_case = makeFastCase("exp", true, 4e-7, Uniform(-87, 88),
+                               [](double a, double) { return std::exp(a); });
+  checkFast(
+      exp_case, [](float a, float) { return std::exp(a); },
+      [](auto a, auto) { return fast::exp(a); });
+
+  auto log_case = makeFastCase("log", false, 3e-7, logUniform(-125, 127),
+                               [](double a, double) { return std::log(a); });
+  checkFast(
+      log_case, [](float a, float) { return std::log(a); },
+      [](auto a, auto) { return fast::log(a); });
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+// Largest component difference, ignoring the sign of the quaternion
+float quaternionError(const Quaternion& lhs, const Quaternion& rhs) {
+  float sign = dot(lhs, rhs) < 0.0f ? -1.0f : 1.0f;
+  float error = 0.0f;
+  for (std::size_t i = 0; i < 4; ++i) {
+    error = std::max(error, std::abs(lhs[i] - rhs[i] * sign));
+  }
+  return error;
+}
+
+template <class Packed, class Pack>
+void checkPackedQuaternion(const std::vector<Quaternion>& quats, Pack pack,
+                           float max_error) {
+  const auto count = quats.size();
+  std::vector<Packed> packed(count);
+  std::vector<Quaternion> unpacked(count);
+  pack(quats.data(), count, packed.data());
+  unpackQuaternion(packed.data(), count, unpacked.data());
+  float error = 0.0f;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto scalar = unpackQuaternion(packed[i]);
+    error = std::max(error, quaternionError(quats[i], scalar));
+    BOOST_CHECK_SMALL(quaternionError(unpacked[i], scalar), 1e-6f);
+  }
+  BOOST_CHECK_LT(error, max_error);
+  TEMP_LOG_TRACE(sizeof(Packed) * 8, " bit quaternion max error: ", error);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(packing)
+BOOST_AUTO_TEST_CASE(half) {
+  // すべてのhalfが往復で元に戻る
+  std::vector<std::uint16_t> halves(1 << 16);
+  for (std::size_t i = 0; i < halves.size(); ++i) {
+    halves[i] = (std::uint16_t)i;
+  }
+  std::vector<float> floats(halves.size());
+  halfToFloat(halves.data(), halves.size(), floats.data());
+  for (std::size_t i = 0; i < halves.size(); ++i) {
+    auto value = halfToFloat(halves[i]);
+    if (std::isnan(value)) {
+      BOOST_CHECK(std::isnan(floats[i]));
+      continue;
+    }
+    BOOST_CHECK_EQUAL(floats[i], value);
+    BOOST_CHECK_EQUAL(floatToHalf(value), halves[i]);
+  }
+
+  BOOST_CHECK_EQUAL(halfToFloat(0x3c00), 1.0f);
+  BOOST_CHECK_EQUAL(halfToFloat(0xc000), -2.0f);
+  BOOST_CHECK_EQUAL(halfToFloat(0x7bff), 65504.0f);
+  BOOST_CHECK_EQUAL(halfToFloat(0x0001), std::ldexp(1.0f, -24));
+  BOOST_CHECK_EQUAL(floatToHalf(65519.0f), 0x7bff);
+  BOOST_CHECK_EQUAL(floatToHalf(65520.0f), 0x7c00);
+  BOOST_CHECK_EQUAL(floatToHalf(-1e10f), 0xfc00);
+  BOOST_CHECK_EQUAL(floatToHalf(1e-10f), 0x0000);
+  // 1 + 2^-11 は偶数側の 1 に丸める
+  BOOST_CHECK_EQUAL(floatToHalf(1.0f + std::ldexp(1.0f, -11)), 0x3c00);
+  BOOST_CHECK(std::isnan(halfToFloat(floatToHalf(std::nanf("")))));
+
+  // 配列版はスカラー版と同じ結果になる
+  std::mt19937 engine(61);
+  std::uniform_real_distribution<float> exponent(-26.0f, 17.0f);
+  std::vector<float> values(10007);
+  for (auto& v : values) {
+    v = std::exp2(exponent(engine)) * (engine() % 2 == 0 ? 1.0f : -1.0f);
+  }
+  std::vector<std::uint16_t> results(values.size());
+  floatToHalf(values.data(), values.size(), results.data());
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    BOOST_CHECK_EQUAL(results[i], floatToHalf(values[i]));
+  }
+
+  auto points = randomPoints(engine, 1001);
+  std::vector<Half3> packed(points.size());
+  std::vector<Vector3> unpacked(points.size());
+  packHalf(points.data(), points.size(), packed.data());
+  unpackHalf(packed.data(), packed.size(), unpacked.data());
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    BOOST_CHECK_EQUAL(unpacked[i], unpackHalf(packHalf(points[i])));
+    BOOST_CHECK_SMALL(distance(unpacked[i], points[i]), 0.1f);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(snorm16) {
+  BOOST_CHECK_EQUAL(floatToSnorm16(1.0f), 32767);
+  BOOST_CHECK_EQUAL(floatToSnorm16(-2.0f), -32767);
+  BOOST_CHECK_EQUAL(floatToSnorm16(0.0f), 0);
+  BOOST_CHECK_EQUAL(snorm16ToFloat(-32768), -1.0f);
+  BOOST_CHECK_EQUAL(snorm16ToFloat(32767), 1.0f);
+
+  std::mt19937 engine(67);
+  std::uniform_real_distribution<float> dist(-1.2f, 1.2f);
+  std::vector<Vector4> vectors;
+  for (int i = 0; i < 1001; ++i) {
+    vectors.emplace_back(dist(engine), dist(engine), dist(engine),
+                         dist(engine));
+  }
+  std::vector<Snorm16x4> packed(vectors.size());
+  std::vector<Vector4> unpacked(vectors.size());
+  packSnorm16(vectors.data(), vectors.size(), packed.data());
+  unpackSnorm16(packed.data(), packed.size(), unpacked.data());
+  for (std::size_t i = 0; i < vectors.size(); ++i) {
+    auto scalar = packSnorm16(vectors[i]);
+    BOOST_CHECK_EQUAL(packed[i].x, scalar.x);
+    BOOST_CHECK_EQUAL(packed[i].w, scalar.w);
+    BOOST_CHECK_EQUAL(unpacked[i], unpackSnorm16(scalar));
+    for (std::size_t c = 0; c < 4; ++c) {
+      auto clamped = std::min(std::max(vectors[i][c], -1.0f), 1.0f);
+      BOOST_CHECK_SMALL(unpacked[i][c] - clamped, 0.5f / 32767 + 1e-7f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(octahedral) {
+  BOOST_CHECK_EQUAL(unpackOctahedral(packOctahedral(Vector3(0, 0, 1))),
+                    Vector3(0, 0, 1));
+  BOOST_CHECK_EQUAL(unpackOctahedral(packOctahedral(Vector3(0, 0, -1))),
+                    Vector3(0, 0, -1));
+  BOOST_CHECK_EQUAL(unpackOctahedral(packOctahedral(Vector3(-1, 0, 0))),
+                    Vector3(-1, 0, 0));
+
+  std::mt19937 engine(71);
+  auto normals = randomPoints(engine, 10007);
+  for (auto& n : normals) n = normalize(n);
+  std::vector<Snorm16x2> packed(normals.size());
+  std::vector<Vector3> unpacked(normals.size());
+  packOctahedral(normals.data(), normals.size(), packed.data());
+  unpackOctahedral(packed.data(), packed.size(), unpacked.data());
+  float max_degree = 0.0f;
+  for (std::size_t i = 0; i < normals.size(); ++i) {
+    auto scalar = packOctahedral(normals[i]);
+    BOOST_CHECK_LE(std::abs(packed[i].x - scalar.x), 1);
+    BOOST_CHECK_LE(std::abs(packed[i].y - scalar.y), 1);
+    BOOST_CHECK_SMALL(distance(unpacked[i], unpackOctahedral(packed[i])),
+                      1e-6f);
+    // acosは1付近で精度が出ないので弦の長さから角度を求める
+    auto chord = distance(unpacked[i], normals[i]);
+    max_degree =
+        std::max(max_degree, radianToDegree(2.0f * std::asin(chord * 0.5f)));
+  }
+  BOOST_CHECK_LT(max_degree, 0.005f);
+  TEMP_LOG_TRACE("octahedral max error: ", max_degree, " deg");
+}
+
+BOOST_AUTO_TEST_CASE(quaternion) {
+  std::mt19937 engine(73);
+  auto quats = randomQuaternions(engine, 10007);
+  for (auto& q : quats) q = normalize(q);
+  quats.push_back(Quaternion::kIdentity);
+  quats.push_back(Quaternion(0, 0, 0, -1));
+  quats.push_back(normalize(Quaternion(1, 1, 1, 1)));
+
+  auto pack32 = [](const Quaternion* q, std::size_t n, PackedQuaternion32* r) {
+    packQuaternion32(q, n, r);
+  };
+  auto pack48 = [](const Quaternion* q, std::size_t n, PackedQuaternion48* r) {
+    packQuaternion48(q, n, r);
+  };
+  auto pack64 = [](const Quaternion* q, std::size_t n, PackedQuaternion64* r) {
+    packQuaternion64(q, n, r);
+  };
+  checkPackedQuaternion<PackedQuaternion32>(quats, pack32, 2e-3f);
+  checkPackedQuaternion<PackedQuaternion48>(quats, pack48, 6e-5f);
+  checkPackedQuaternion<PackedQuaternion64>(quats, pack64, 2e-6f);
+
+  // 符号を反転しても同じ回転になる
+  auto q = quats[0];
+  BOOST_CHECK_EQUAL(packQuaternion48(q).bits[2],
+                    packQuaternion48(-q).bits[2]);
+}
+
+// 1要素あたりの変換時間 (ns)
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::size_t kCount = 1 << 16;
+  const int kLoop = 50;
+  std::mt19937 engine(79);
+  auto points = randomPoints(engine, kCount);
+  auto quats = randomQuaternions(engine, kCount);
+  for (auto& q : quats) q = normalize(q);
+  auto normals = points;
+  for (auto& n : normals) n = normalize(n);
+
+  auto bench = [&](const char* name, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      func();
+    }
+    TEMP_LOG_TRACE(name, ": ",
+                   timer.durationUs() * 1000.0 / ((double)kLoop * kCount),
+                   " ns");
+  };
+  std::vector<Half3> halves(kCount);
+  std::vector<Snorm16x3> snorms(kCount);
+  std::vector<Snorm16x2> octahedrals(kCount);
+  std::vector<PackedQuaternion32> packed32(kCount);
+  std::vector<PackedQuaternion64> packed64(kCount);
+  std::vector<Vector3> vectors(kCount);
+  std::vector<Quaternion> unpacked(kCount);
+  bench("packHalf Vector3 scalar", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      halves[i] = packHalf(points[i]);
+    }
+  });
+  bench("packHalf Vector3 batch",
+        [&] { packHalf(points.data(), kCount, halves.data()); });
+  bench("unpackHalf Vector3 batch",
+        [&] { unpackHalf(halves.data(), kCount, vectors.data()); });
+  bench("packSnorm16 Vector3 batch",
+        [&] { packSnorm16(normals.data(), kCount, snorms.data()); });
+  bench("unpackSnorm16 Vector3 batch",
+        [&] { unpackSnorm16(snorms.data(), kCount, vectors.data()); });
+  bench("packOctahedral scalar", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      octahedrals[i] = packOctahedral(normals[i]);
+    }
+  });
+  bench("packOctahedral batch",
+        [&] { packOctahedral(normals.data(), kCount, octahedrals.data()); });
+  bench("unpackOctahedral batch",
+        [&] { unpackOctahedral(octahedrals.data(), kCount, vectors.data()); });
+  bench("packQuaternion32 scalar", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      packed32[i] = packQuaternion32(quats[i]);
+    }
+  });
+  bench("packQuaternion32 batch",
+        [&] { packQuaternion32(quats.data(), kCount, packed32.data()); });
+  bench("unpackQuaternion32 batch",
+        [&] { unpackQuaternion(packed32.data(), kCount, unpacked.data()); });
+  bench("packQuaternion64 batch",
+        [&] { packQuaternion64(quats.data(), kCount, packed64.data()); });
+  bench("unpackQuaternion64 batch",
+        [&] { unpackQuaternion(packed64.data(), kCount, unpacked.data()); });
+  BOOST_CHECK_EQUAL(unpacked.size(), kCount);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(random_)
+BOOST_AUTO_TEST_CASE(generators) {
+  // pcg32-demo の seed 42, stream 54 の出力
+  Pcg32 pcg(42, 54);
+  const std::uint32_t kExpected[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330,
+                                     0x83d2f293, 0xbfa4784b, 0xcbed606e};
+  for (auto expected : kExpected) {
+    BOOST_CHECK_EQUAL(pcg(), expected);
+  }
+  Pcg32 stepped(7, 3);
+  Pcg32 advanced(7, 3);
+  for (int i = 0; i < 1000; ++i) {
+    stepped();
+  }
+  advanced.advance(1000);
+  BOOST_CHECK_EQUAL(stepped(), advanced());
+
+  Xoshiro256 a(1);
+  Xoshiro256 b(1);
+  Xoshiro256 c(2);
+  BOOST_CHECK_EQUAL(a(), b());
+  BOOST_CHECK_NE(a(), c());
+
+  // レーン i は i 回ジャンプした生成器と同じ列になる
+  Xoshiro256 source(3);
+  Xoshiro256x8 lanes(source);
+  std::uint64_t values[Xoshiro256x8::kLanes];
+  lanes.next(values);
+  for (std::size_t lane = 0; lane < Xoshiro256x8::kLanes; ++lane) {
+    auto copy = source;
+    BOOST_CHECK_EQUAL(values[lane], copy());
+    source.jump();
+  }
+
+  // SIMD の変換はスカラーの上位24ビットと一致する
+  Xoshiro256x8 g1(9);
+  Xoshiro256x8 g2(9);
+  float floats[Xoshiro256x8::kLanes * 2];
+  g1.nextUniform(2, floats);
+  for (std::size_t b = 0; b < 2; ++b) {
+    g2.next(values);
+    for (std::size_t lane = 0; lane < Xoshiro256x8::kLanes; ++lane) {
+      BOOST_CHECK_EQUAL(floats[b * Xoshiro256x8::kLanes + lane],
+                        (float)(values[lane] >> 40) / 16777216.0f);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(samplers) {
+  const int kCount = 100000;
+  Xoshiro256 generator(40);
+  double sum = 0.0;
+  double normal_sum = 0.0;
+  double normal_squares = 0.0;
+  std::vector<int> histogram(10, 0);
+  Vector3 sphere_sum(0.0f, 0.0f, 0.0f);
+  for (int i = 0; i < kCount; ++i) {
+    auto u = uniformFloat(generator);
+    BOOST_REQUIRE(u >= 0.0f && u < 1.0f);
+    sum += u;
+    auto n = uniformInt(generator, 10);
+    BOOST_REQUIRE(n < 10);
+    ++histogram[n];
+    auto normal = normalFloat(generator);
+    normal_sum += normal;
+    normal_squares += normal * normal;
+    auto v = uniformOnSphere(generator);
+    BOOST_REQUIRE_SMALL(magnitude(v) - 1.0f, 1e-5f);
+    sphere_sum = sphere_sum + v;
+  }
+  BOOST_CHECK_SMALL(sum / kCount - 0.5, 0.01);
+  for (auto h : histogram) {
+    BOOST_CHECK_SMALL(h / (double)kCount - 0.1, 0.01);
+  }
+  BOOST_CHECK_SMALL(normal_sum / kCount, 0.02);
+  BOOST_CHECK_SMALL(normal_squares / kCount - 1.0, 0.02);
+  BOOST_CHECK_SMALL(magnitude(sphere_sum) / kCount, 0.01f);
+
+  const Vector3 kAxes[] = {Vector3(0.0f, 0.0f, 1.0f),
+                           Vector3(0.0f, 0.0f, -1.0f),
+                           normalize(Vector3(1.0f, -2.0f, 0.5f))};
+  for (const auto& axis : kAxes) {
+    for (int i = 0; i < 1000; ++i) {
+      auto v = uniformInCone(generator, axis, 0.3f);
+      BOOST_REQUIRE_SMALL(magnitude(v) - 1.0f, 1e-5f);
+      BOOST_REQUIRE_GE(dot(v, axis), std::cos(0.3f) - 1e-5f);
+    }
+  }
+  for (int i = 0; i < 1000; ++i) {
+    auto q = uniformRotation(generator);
+    BOOST_REQUIRE_SMALL(dot(q, q) - 1.0f, 1e-5f);
+  }
+
+  auto min = Vector3(-1.0f, 2.0f, 3.0f);
+  auto max = Vector3(1.0f, 4.0f, 3.5f);
+  for (int i = 0; i < 1000; ++i) {
+    auto v = uniformVector3(generator, min, max);
+    for (std::size_t a = 0; a < 3; ++a) {
+      BOOST_REQUIRE(v[a] >= min[a] && v[a] < max[a]);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(bulk) {
+  const std::size_t kCount = 100003;
+  Xoshiro256x8 generator(41);
+  // 末尾の端数が範囲外に書き込まないことも確かめる
+  std::vector<float> values(kCount + 1, -1.0f);
+  generateUniform(generator, 2.0f, 3.0f, kCount, values.data());
+  double sum = 0.0;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    BOOST_REQUIRE(values[i] >= 2.0f && values[i] < 3.0f);
+    sum += values[i];
+  }
+  BOOST_CHECK_EQUAL(values[kCount], -1.0f);
+  BOOST_CHECK_SMALL(sum / kCount - 2.5, 0.01);
+
+  generateNormal(generator, kCount, values.data());
+  double normal_sum = 0.0;
+  double normal_squares = 0.0;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    normal_sum += values[i];
+    normal_squares += values[i] * values[i];
+  }
+  BOOST_CHECK_SMALL(normal_sum / kCount, 0.02);
+  BOOST_CHECK_SMALL(normal_squares / kCount - 1.0, 0.02);
+
+  std::vector<Vector3> points(kCount);
+  generateOnSphere(generator, kCount, points.data());
+  for (const auto& p : points) {
+    BOOST_REQUIRE_SMALL(magnitude(p) - 1.0f, 1e-5f);
+  }
+
+  // 同じシードからは同じ列になる
+  Xoshiro256x8 g1(5);
+  Xoshiro256x8 g2(5);
+  std::vector<float> v1(100);
+  std::vector<float> v2(100);
+  generateUniform(g1, v1.size(), v1.data());
+  generateUniform(g2, v2.size(), v2.data());
+  BOOST_CHECK(v1 == v2);
+}
+
+BOOST_AUTO_TEST_CASE(perlin) {
+  PerlinNoise noise(42);
+  BOOST_CHECK_EQUAL(noise.evaluate(Vector3(3.0f, -2.0f, 7.0f)), 0.0f);
+
+  std::mt19937 engine(42);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+  const std::size_t kCount = 10007;
+  std::vector<Vector3> points(kCount);
+  for (auto& p : points) {
+    p = Vector3(dist(engine), dist(engine), dist(engine));
+  }
+  std::vector<float> values(kCount);
+  noise.evaluate(points.data(), kCount, values.data());
+  float low = 0.0f;
+  float high = 0.0f;
+  for (std::size_t i = 0; i < kCount; ++i) {
+    BOOST_REQUIRE_SMALL(values[i] - noise.evaluate(points[i]), 1e-5f);
+    low = std::min(low, values[i]);
+    high = std::max(high, values[i]);
+  }
+  BOOST_CHECK(low > -1.1f && low < -0.5f);
+  BOOST_CHECK(high < 1.1f && high > 0.5f);
+
+  PerlinNoise same(42);
+  PerlinNoise other(43);
+  BOOST_CHECK_EQUAL(same.evaluate(points[0]), noise.evaluate(points[0]));
+  BOOST_CHECK_NE(other.evaluate(points[0]), noise.evaluate(points[0]));
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::size_t kCount = 1 << 18;
+  const int kLoop = 20;
+  std::vector<float> values(kCount);
+  std::vector<Vector3> vectors(kCount);
+
+  auto bench = [&](const char* name, auto func) {
+    temp::Timer timer;
+    for (int loop = 0; loop < kLoop; ++loop) {
+      func();
+    }
+    TEMP_LOG_TRACE(name, ": ",
+                   timer.durationUs() * 1000.0 / ((double)kLoop * kCount),
+                   " ns");
+  };
+  std::mt19937 engine(1);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::normal_distribution<float> normal;
+  Xoshiro256 xoshiro(1);
+  Pcg32 pcg(1);
+  Xoshiro256x8 xoshiro8(1);
+  bench("std::mt19937 uniform", [&] {
+    for (auto& v : values) v = uniform(engine);
+  });
+  bench("Xoshiro256 uniformFloat", [&] {
+    for (auto& v : values) v = uniformFloat(xoshiro);
+  });
+  bench("Pcg32 uniformFloat", [&] {
+    for (auto& v : values) v = uniformFloat(pcg);
+  });
+  bench("generateUniform",
+        [&] { generateUniform(xoshiro8, kCount, values.data()); });
+  bench("std::mt19937 normal", [&] {
+    for (auto& v : values) v = normal(engine);
+  });
+  bench("Xoshiro256 normalFloat", [&] {
+    for (auto& v : values) v = normalFloat(xoshiro);
+  });
+  bench("generateNormal",
+        [&] { generateNormal(xoshiro8, kCount, values.data()); });
+  bench("Xoshiro256 uniformOnSphere", [&] {
+    for (auto& v : vectors) v = uniformOnSphere(xoshiro);
+  });
+  bench("generateOnSphere",
+        [&] { generateOnSphere(xoshiro8, kCount, vectors.data()); });
+
+  generateUniform(xoshiro8, kCount * 3, &vectors[0][0]);
+  PerlinNoise noise;
+  bench("PerlinNoise scalar", [&] {
+    for (std::size_t i = 0; i < kCount; ++i) {
+      values[i] = noise.evaluate(vectors[i] * 64.0f);
+    }
+  });
+  for (auto& v : vectors) v = v * 64.0f;
+  bench("PerlinNoise batch",
+        [&] { noise.evaluate(vectors.data(), kCount, values.data()); });
+  BOOST_CHECK_EQUAL(values.size(), kCount);
+}
 BOOST_AUTO_TEST_SUITE_END()
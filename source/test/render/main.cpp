@@ -0,0 +1,1002 @@
+﻿#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "temp/base/logger.h"
+#include "temp/base/object_manager.h"
+#include "temp/base/timer.h"
+
+#include "temp/gfx/color.h"
+#include "temp/gfx/device.h"
+#include "temp/gfx/swap_chain.h"
+#include "temp/gfx/vulkan/vulkan_bindless_descriptor_set.h"
+#include "temp/gfx/vulkan/vulkan_compute_pipeline.h"
+#include "temp/gfx/vulkan/vulkan_compute_queue.h"
+#include "temp/gfx/vulkan/vulkan_descriptor_allocator.h"
+#include "temp/gfx/vulkan/vulkan_descriptor_set_layout_cache.h"
+#include "temp/gfx/vulkan/vulkan_device.h"
+#include "temp/gfx/vulkan/vulkan_memory_allocator.h"
+#include "temp/gfx/vulkan/vulkan_offscreen_swap_chain.h"
+#include "temp/gfx/vulkan/vulkan_pipeline_state_cache.h"
+#include "temp/gfx/vulkan/vulkan_render_pass_cache.h"
+#include "temp/gfx/vulkan/vulkan_uploader.h"
+
+#include "temp/math/bounds_functions.h"
+#include "temp/math/functions.h"
+#include "temp/math/matrix44_functions.h"
+
+#include "temp/render/camera.h"
+#include "temp/render/draw_item.h"
+#include "temp/render/vulkan/vulkan_renderer.h"
+
+using namespace temp;
+
+namespace {
+const std::uint32_t kWidth = 64;
+const std::uint32_t kHeight = 64;
+
+using CameraPtr = ObjectManager<render::Camera>::CreateType;
+
+std::vector<CameraPtr> createCameras(
+    render::Renderer& renderer,
+    const std::shared_ptr<gfx::SwapChain>& swap_chain, std::size_t count) {
+  std::vector<CameraPtr> cameras;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto camera = renderer.CreateCamera();
+    camera->swap_chain = swap_chain;
+    cameras.push_back(std::move(camera));
+  }
+  return cameras;
+}
+
+using DrawItemPtr = ObjectManager<render::DrawItem>::CreateType;
+
+// 既定のカメラから見える位置に置く
+std::vector<DrawItemPtr> createDrawItems(render::Renderer& renderer,
+                                         std::size_t count) {
+  std::vector<DrawItemPtr> draw_items;
+  for (std::size_t i = 0; i < count; ++i) {
+    auto draw_item = renderer.CreateDrawItem();
+    draw_item->bounds.min = math::Vector3(-1.0f, -1.0f, 9.0f);
+    draw_item->bounds.max = math::Vector3(1.0f, 1.0f, 11.0f);
+    draw_items.push_back(std::move(draw_item));
+  }
+  return draw_items;
+}
+
+bool equals(const gfx::Color32Bit& a, const gfx::Color32Bit& b) {
+  return a.red == b.red && a.green == b.green && a.blue == b.blue &&
+         a.alpha == b.alpha;
+}
+
+// layout(local_size_x = 64) in;
+// layout(set = 0, binding = 0) buffer Data { uint values[]; };
+// void main() {
+//   uint i = gl_GlobalInvocationID.x;
+//   values[i] = values[i] * 2u + 1u;
+// }
+const std::vector<std::uint32_t> kDoubleIncrementSpirv = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000001a, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000005,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00060010, 0x00000001,
+    0x00000011, 0x00000040, 0x00000001, 0x00000001, 0x00040047, 0x00000002,
+    0x0000000b, 0x0000001c, 0x00040047, 0x00000008, 0x00000006, 0x00000004,
+    0x00050048, 0x00000009, 0x00000000, 0x00000023, 0x00000000, 0x00030047,
+    0x00000009, 0x00000003, 0x00040047, 0x0000000b, 0x00000022, 0x00000000,
+    0x00040047, 0x0000000b, 0x00000021, 0x00000000, 0x00020013, 0x00000003,
+    0x00030021, 0x00000004, 0x00000003, 0x00040015, 0x00000005, 0x00000020,
+    0x00000000, 0x00040017, 0x00000006, 0x00000005, 0x00000003, 0x00040020,
+    0x00000007, 0x00000001, 0x00000006, 0x0004003b, 0x00000007, 0x00000002,
+    0x00000001, 0x0003001d, 0x00000008, 0x00000005, 0x0003001e, 0x00000009,
+    0x00000008, 0x00040020, 0x0000000a, 0x00000002, 0x00000009, 0x0004003b,
+    0x0000000a, 0x0000000b, 0x00000002, 0x00040015, 0x0000000c, 0x00000020,
+    0x00000001, 0x0004002b, 0x0000000c, 0x0000000d, 0x00000000, 0x0004002b,
+    0x00000005, 0x0000000e, 0x00000000, 0x0004002b, 0x00000005, 0x0000000f,
+    0x00000001, 0x0004002b, 0x00000005, 0x00000010, 0x00000002, 0x00040020,
+    0x00000011, 0x00000001, 0x00000005, 0x00040020, 0x00000012, 0x00000002,
+    0x00000005, 0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004,
+    0x000200f8, 0x00000013, 0x00050041, 0x00000011, 0x00000014, 0x00000002,
+    0x0000000e, 0x0004003d, 0x00000005, 0x00000015, 0x00000014, 0x00060041,
+    0x00000012, 0x00000016, 0x0000000b, 0x0000000d, 0x00000015, 0x0004003d,
+    0x00000005, 0x00000017, 0x00000016, 0x00050084, 0x00000005, 0x00000018,
+    0x00000017, 0x00000010, 0x00050080, 0x00000005, 0x00000019, 0x00000018,
+    0x0000000f, 0x0003003e, 0x00000016, 0x00000019, 0x000100fd, 0x00010038};
+
+// void main() {}
+const std::vector<std::uint32_t> kEmptyVertexSpirv = {
+    0x07230203, 0x00010000, 0x00000000, 0x00000005, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0005000f, 0x00000000,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00020013, 0x00000002, 0x00030021,
+    0x00000003, 0x00000002, 0x00050036, 0x00000002, 0x00000001, 0x00000000,
+    0x00000003, 0x000200f8, 0x00000004, 0x000100fd, 0x00010038};
+
+// layout(location = 0) out vec4 color;
+// void main() { color = vec4(1.0); }
+const std::vector<std::uint32_t> kWhiteFragmentSpirv = {
+    0x07230203, 0x00010000, 0x00000000, 0x0000000b, 0x00000000, 0x00020011,
+    0x00000001, 0x0003000e, 0x00000000, 0x00000001, 0x0006000f, 0x00000004,
+    0x00000001, 0x6e69616d, 0x00000000, 0x00000002, 0x00030010, 0x00000001,
+    0x00000007, 0x00040047, 0x00000002, 0x0000001e, 0x00000000, 0x00020013,
+    0x00000003, 0x00030021, 0x00000004, 0x00000003, 0x00030016, 0x00000005,
+    0x00000020, 0x00040017, 0x00000006, 0x00000005, 0x00000004, 0x00040020,
+    0x00000007, 0x00000003, 0x00000006, 0x0004003b, 0x00000007, 0x00000002,
+    0x00000003, 0x0004002b, 0x00000005, 0x00000008, 0x3f800000, 0x0007002c,
+    0x00000006, 0x00000009, 0x00000008, 0x00000008, 0x00000008, 0x00000008,
+    0x00050036, 0x00000003, 0x00000001, 0x00000000, 0x00000004, 0x000200f8,
+    0x0000000a, 0x0003003e, 0x00000002, 0x00000009, 0x000100fd, 0x00010038};
+
+gfx::vulkan::GraphicsPipelineState createPipelineState(
+    vk::PipelineLayout layout, vk::RenderPass render_pass) {
+  gfx::vulkan::GraphicsPipelineState state;
+  state.vertex_shader = kEmptyVertexSpirv;
+  state.fragment_shader = kWhiteFragmentSpirv;
+  vk::PipelineColorBlendAttachmentState blend_attachment;
+  blend_attachment.colorWriteMask =
+      vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+      vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA;
+  state.blend_attachments.push_back(blend_attachment);
+  state.layout = layout;
+  state.render_pass = render_pass;
+  return state;
+}
+
+// ステートの組み合わせで 48 個の異なるパイプラインを作る
+std::vector<gfx::vulkan::GraphicsPipelineState> createPipelineStates(
+    vk::PipelineLayout layout, vk::RenderPass render_pass) {
+  std::vector<gfx::vulkan::GraphicsPipelineState> states;
+  for (auto topology : {vk::PrimitiveTopology::eTriangleList,
+                        vk::PrimitiveTopology::eTriangleStrip,
+                        vk::PrimitiveTopology::eLineList}) {
+    for (auto cull_mode :
+         {vk::CullModeFlags(vk::CullModeFlagBits::eNone),
+          vk::CullModeFlags(vk::CullModeFlagBits::eFront),
+          vk::CullModeFlags(vk::CullModeFlagBits::eBack),
+          vk::CullModeFlags(vk::CullModeFlagBits::eFrontAndBack)}) {
+      for (auto front_face :
+           {vk::FrontFace::eClockwise, vk::FrontFace::eCounterClockwise}) {
+        for (bool blend : {false, true}) {
+          auto state = createPipelineState(layout, render_pass);
+          state.topology = topology;
+          state.cull_mode = cull_mode;
+          state.front_face = front_face;
+          auto&& attachment = state.blend_attachments[0];
+          attachment.blendEnable = blend;
+          attachment.srcColorBlendFactor = vk::BlendFactor::eSrcAlpha;
+          attachment.dstColorBlendFactor =
+              vk::BlendFactor::eOneMinusSrcAlpha;
+          states.push_back(std::move(state));
+        }
+      }
+    }
+  }
+  return states;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(camera)
+
+BOOST_AUTO_TEST_CASE(dirty_flags) {
+  render::Camera camera;
+  BOOST_TEST(camera.view_dirty());
+  BOOST_TEST(camera.projection_dirty());
+  camera.UpdateMatrices();
+  BOOST_TEST(!camera.view_dirty());
+  BOOST_TEST(!camera.projection_dirty());
+  BOOST_TEST(camera.matrix_version() == 1u);
+
+  // 変わっていなければ計算し直さない
+  camera.UpdateMatrices();
+  BOOST_TEST(camera.matrix_version() == 1u);
+
+  using Setter = void (*)(render::Camera&);
+  Setter view_setters[] = {
+      [](render::Camera& c) { c.set_position(math::Vector3(1, 2, 3)); },
+      [](render::Camera& c) {
+        c.set_rotation(math::Quaternion::axisAngle(math::Vector3(0, 1, 0), 30));
+      },
+  };
+  for (auto setter : view_setters) {
+    setter(camera);
+    BOOST_TEST(camera.view_dirty());
+    BOOST_TEST(!camera.projection_dirty());
+    camera.UpdateMatrices();
+  }
+
+  Setter projection_setters[] = {
+      [](render::Camera& c) {
+        c.set_projection_type(render::Camera::ProjectionType::kOrthographic);
+      },
+      [](render::Camera& c) { c.set_near_clip(0.5f); },
+      [](render::Camera& c) { c.set_far_clip(100.0f); },
+      [](render::Camera& c) { c.set_field_of_view(45.0f); },
+      [](render::Camera& c) { c.set_orthographic_size(2.0f); },
+      [](render::Camera& c) { c.set_aspect_ratio(1.0f); },
+      [](render::Camera& c) { c.set_reversed_z(true); },
+  };
+  for (auto setter : projection_setters) {
+    setter(camera);
+    BOOST_TEST(!camera.view_dirty());
+    BOOST_TEST(camera.projection_dirty());
+    camera.UpdateMatrices();
+  }
+  BOOST_TEST(camera.matrix_version() == 10u);
+}
+
+BOOST_AUTO_TEST_CASE(batch_update) {
+  std::vector<render::Camera> cameras(8);
+  std::vector<render::Camera*> pointers;
+  for (auto&& camera : cameras) {
+    pointers.push_back(&camera);
+  }
+  render::Camera::UpdateMatrices(pointers.data(), pointers.size());
+  for (auto&& camera : cameras) {
+    BOOST_TEST(camera.matrix_version() == 1u);
+  }
+
+  cameras[2].set_position(math::Vector3(0, 0, -10));
+  cameras[5].set_aspect_ratio(1.0f);
+  render::Camera::UpdateMatrices(pointers.data(), pointers.size());
+  for (std::size_t i = 0; i < cameras.size(); ++i) {
+    auto updated = i == 2 || i == 5;
+    BOOST_TEST(cameras[i].matrix_version() == (updated ? 2u : 1u));
+    BOOST_TEST(!cameras[i].view_dirty());
+    BOOST_TEST(!cameras[i].projection_dirty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(cached_matrices) {
+  const float kAspect = 1.5f;
+  const float kNear = 0.1f;
+  const float kFar = 500.0f;
+  auto fov = math::degreeToRadian(45.0f);
+
+  render::Camera camera;
+  camera.set_position(math::Vector3(1, -2, 3));
+  camera.set_rotation(math::Quaternion::axisAngle(math::Vector3(0, 1, 0), 30));
+  camera.set_field_of_view(45.0f);
+  camera.set_aspect_ratio(kAspect);
+  camera.set_near_clip(kNear);
+  camera.set_far_clip(kFar);
+
+  auto check = [&camera](const math::Matrix44& projection) {
+    camera.UpdateMatrices();
+    auto view = math::viewFromTransform(camera.rotation(), camera.position());
+    auto view_projection = projection * view;
+    BOOST_CHECK_EQUAL(camera.view_matrix(), view);
+    BOOST_CHECK_EQUAL(camera.projection_matrix(), projection);
+    BOOST_CHECK_EQUAL(camera.view_projection_matrix(), view_projection);
+    auto frustum = math::extractFrustum(view_projection);
+    for (int i = 0; i < math::Frustum::kPlaneCount; ++i) {
+      BOOST_CHECK_EQUAL(camera.frustum().planes[i].normal,
+                        frustum.planes[i].normal);
+      BOOST_CHECK_EQUAL(camera.frustum().planes[i].distance,
+                        frustum.planes[i].distance);
+    }
+  };
+  check(math::perspective(fov, kAspect, kNear, kFar));
+
+  // 片方だけ計算し直しても、もう片方のキャッシュと正しく組み合わさる
+  camera.set_position(math::Vector3(4, 5, 6));
+  check(math::perspective(fov, kAspect, kNear, kFar));
+  camera.set_reversed_z(true);
+  check(math::perspectiveReversedZ(fov, kAspect, kNear, kFar));
+  camera.set_projection_type(render::Camera::ProjectionType::kOrthographic);
+  camera.set_orthographic_size(2.0f);
+  check(math::orthographicReversedZ(4.0f * kAspect, 4.0f, kNear, kFar));
+  camera.set_projection_type(render::Camera::ProjectionType::kPerspective);
+  camera.set_far_clip(std::numeric_limits<float>::infinity());
+  camera.set_reversed_z(false);
+  check(math::perspectiveInfinite(fov, kAspect, kNear));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_swap_chain)
+
+BOOST_AUTO_TEST_CASE(frames_in_flight) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vulkan_device =
+      std::static_pointer_cast<gfx::vulkan::VulkanDevice>(device);
+  auto vk_device = vulkan_device->device();
+
+  for (std::uint32_t frame_count = 1;
+       frame_count <= gfx::vulkan::VulkanSwapChain::kMaxFrameCount;
+       ++frame_count) {
+    gfx::vulkan::VulkanOffscreenSwapChain swap_chain(*vulkan_device, kWidth,
+                                                     kHeight, frame_count);
+    BOOST_TEST(swap_chain.frame_count() == frame_count);
+
+    // フレームの同期オブジェクトを何周か使い回しても止まらない
+    for (std::uint32_t frame = 0; frame < frame_count * 4; ++frame) {
+      BOOST_TEST(swap_chain.current_frame_index() == frame % frame_count);
+      auto image_index = swap_chain.AcquireNextImage(vk_device);
+      BOOST_TEST(image_index < swap_chain.image_count());
+      swap_chain.Submit(*vulkan_device, {});
+      swap_chain.Present(device.get());
+    }
+    BOOST_TEST(swap_chain.current_frame_index() == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  // GPU の負荷を CPU の記録と重ねられるかを、フレーム数ごとに比べる
+  const std::size_t kCameras = 100;
+  const std::size_t kDrawItems = 100;
+  const int kFrames = 100;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vulkan_device =
+      std::static_pointer_cast<gfx::vulkan::VulkanDevice>(device);
+
+  for (std::uint32_t frame_count = 1;
+       frame_count <= gfx::vulkan::VulkanSwapChain::kMaxFrameCount;
+       ++frame_count) {
+    std::shared_ptr<gfx::SwapChain> swap_chain =
+        std::make_shared<gfx::vulkan::VulkanOffscreenSwapChain>(
+            *vulkan_device, kWidth, kHeight, frame_count);
+    render::vulkan::VulkanRenderer renderer(device, 0);
+    auto cameras = createCameras(renderer, swap_chain, kCameras);
+    auto draw_items = createDrawItems(renderer, kDrawItems);
+
+    // 最初のフレームはパイプラインの作成を含むので除く
+    renderer.Render();
+    swap_chain->Present(device.get());
+
+    temp::Timer timer;
+    for (int frame = 0; frame < kFrames; ++frame) {
+      renderer.Render();
+      swap_chain->Present(device.get());
+    }
+    TEMP_LOG_TRACE("frames in flight: ", frame_count,
+                   ", frame: ", timer.durationUs() / 1000.0 / kFrames, " ms");
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// ディスプレイなしで動くように、ヘッドレスのデバイスで描画する
+BOOST_AUTO_TEST_SUITE(vulkan_renderer)
+
+BOOST_AUTO_TEST_CASE(clear) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  offscreen->set_readback_enabled(true);
+
+  const gfx::Color colors[] = {gfx::Color::kRed, gfx::Color::kGreen,
+                               gfx::Color::kBlue, gfx::Color::kWhite};
+  const gfx::Color32Bit expects[] = {
+      gfx::Color32Bit::kRed, gfx::Color32Bit::kGreen, gfx::Color32Bit::kBlue,
+      gfx::Color32Bit::kWhite};
+
+  // 1スレッドでも複数のタスクに分けても同じ結果になる
+  for (std::size_t workers : {0, 4}) {
+    render::vulkan::VulkanRenderer renderer(device, workers);
+    auto cameras = createCameras(renderer, swap_chain, 100);
+
+    for (int frame = 0; frame < 4; ++frame) {
+      for (auto&& camera : cameras) {
+        camera->clear_color = colors[frame];
+      }
+      renderer.Render();
+      swap_chain->Present(device.get());
+
+      auto&& pixels = offscreen->readback_pixels();
+      BOOST_TEST(pixels.size() == kWidth * kHeight);
+      BOOST_TEST(std::all_of(pixels.begin(), pixels.end(),
+                             [&](const gfx::Color32Bit& pixel) {
+                               return equals(pixel, expects[frame]);
+                             }));
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(draw) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  offscreen->set_readback_enabled(true);
+
+  render::vulkan::VulkanRenderer renderer(device, 0);
+  auto cameras = createCameras(renderer, swap_chain, 1);
+  cameras[0]->clear_color = gfx::Color::kBlue;
+  auto draw_items = createDrawItems(renderer, 1);
+
+  auto render = [&](const gfx::Color32Bit& expect) {
+    renderer.Render();
+    swap_chain->Present(device.get());
+    auto&& pixels = offscreen->readback_pixels();
+    BOOST_TEST(pixels.size() == kWidth * kHeight);
+    BOOST_TEST(std::all_of(
+        pixels.begin(), pixels.end(),
+        [&](const gfx::Color32Bit& pixel) { return equals(pixel, expect); }));
+  };
+
+  // 見える描画項目は画面全体を白く塗る
+  render(gfx::Color32Bit::kWhite);
+
+  // カメラの後ろに移すと描画されない
+  draw_items[0]->bounds.min = math::Vector3(-1.0f, -1.0f, -11.0f);
+  draw_items[0]->bounds.max = math::Vector3(1.0f, 1.0f, -9.0f);
+  render(gfx::Color32Bit::kBlue);
+
+  // 破棄した描画項目も描画されない
+  draw_items.clear();
+  cameras[0]->clear_color = gfx::Color::kRed;
+  render(gfx::Color32Bit::kRed);
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  // 描画コマンドの記録はカメラ単位で分かれるので、カメラごとに見える描画
+  // 項目の数だけ描画コマンドを記録させて負荷をかける
+  const std::size_t kCameras = 100;
+  const std::size_t kDrawItems = 100;
+  const int kFrames = 10;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+
+  std::vector<std::size_t> worker_counts = {0};
+  auto hardware = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t workers = 1; workers <= hardware; workers *= 2) {
+    worker_counts.push_back(workers);
+  }
+
+  for (auto workers : worker_counts) {
+    render::vulkan::VulkanRenderer renderer(device, workers);
+    auto cameras = createCameras(renderer, swap_chain, kCameras);
+    auto draw_items = createDrawItems(renderer, kDrawItems);
+
+    // 最初のフレームはコマンドバッファの確保を含むので除く
+    renderer.Render();
+    swap_chain->Present(device.get());
+
+    std::int64_t render_us = 0;
+    temp::Timer frame_timer;
+    for (int frame = 0; frame < kFrames; ++frame) {
+      temp::Timer timer;
+      renderer.Render();
+      render_us += timer.durationUs();
+      swap_chain->Present(device.get());
+    }
+    auto frame_us = frame_timer.durationUs();
+    TEMP_LOG_TRACE("workers: ", workers, ", draws: ", kCameras * kDrawItems,
+                   ", Render: ", render_us / 1000.0 / kFrames,
+                   " ms, frame: ", frame_us / 1000.0 / kFrames, " ms");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(command_pool) {
+  // 描画項目なしで、コマンドバッファの確保と解放の負荷を比べる
+  const std::size_t kCameras = 100;
+  const int kFrames = 100;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+
+  for (auto recycle : {false, true}) {
+    render::vulkan::VulkanRenderer renderer(device, 0, recycle);
+    auto cameras = createCameras(renderer, swap_chain, kCameras);
+
+    // 最初のフレームはコマンドバッファの確保を含むので除く
+    renderer.Render();
+    swap_chain->Present(device.get());
+
+    std::int64_t render_us = 0;
+    for (int frame = 0; frame < kFrames; ++frame) {
+      temp::Timer timer;
+      renderer.Render();
+      render_us += timer.durationUs();
+      swap_chain->Present(device.get());
+    }
+    TEMP_LOG_TRACE("cameras: ", kCameras,
+                   ", command pool ring: ", recycle ? "on" : "off",
+                   ", Render: ", render_us / 1000.0 / kFrames, " ms");
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_uploader)
+
+BOOST_AUTO_TEST_CASE(image) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  offscreen->set_readback_enabled(true);
+
+  std::vector<gfx::Color32Bit> pixels(kWidth * kHeight);
+  for (std::size_t i = 0; i < pixels.size(); ++i) {
+    pixels[i] = gfx::Color32Bit{(std::uint8_t)i, (std::uint8_t)(i >> 8), 0x80,
+                                0xff};
+  }
+
+  // Present() は現在のフレームのイメージを読み戻す
+  gfx::vulkan::VulkanUploader uploader(*vk_device);
+  auto image = offscreen->image(offscreen->current_frame_index()).image;
+  vk::ImageSubresourceLayers subresource(vk::ImageAspectFlagBits::eColor, 0,
+                                         0, 1);
+  uploader.UploadImage(image, subresource, vk::Extent3D(kWidth, kHeight, 1),
+                       vk::ImageLayout::eTransferSrcOptimal, pixels.data(),
+                       sizeof(gfx::Color32Bit) * pixels.size());
+  uploader.Wait(uploader.Flush());
+  swap_chain->Present(device.get());
+
+  auto&& readback = offscreen->readback_pixels();
+  BOOST_TEST(readback.size() == pixels.size());
+  BOOST_TEST(std::equal(readback.begin(), readback.end(), pixels.begin(),
+                        equals));
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::size_t kCameras = 1000;
+  const int kFrames = 30;
+  const vk::DeviceSize kMiB = 1024 * 1024;
+  const vk::DeviceSize kBufferSize = 64 * kMiB;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  render::vulkan::VulkanRenderer renderer(device);
+  auto cameras = createCameras(renderer, swap_chain, kCameras);
+
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = kBufferSize;
+  buffer_ci.usage = vk::BufferUsageFlagBits::eTransferDst |
+                    vk::BufferUsageFlagBits::eVertexBuffer;
+  auto buffer = vk_device->device().createBufferUnique(buffer_ci);
+  auto memory = vk_device->memory_allocator().AllocateBufferMemory(
+      *buffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  gfx::vulkan::VulkanUploader uploader(*vk_device);
+  std::vector<std::uint8_t> data(16 * kMiB, 0x5a);
+
+  // 描画しながらフレームごとにアップロードして、フレーム時間への影響を見る
+  for (vk::DeviceSize size : {vk::DeviceSize(0), kMiB, 4 * kMiB, 16 * kMiB}) {
+    temp::Timer timer;
+    for (int frame = 0; frame < kFrames; ++frame) {
+      renderer.Render();
+      if (size > 0) {
+        uploader.UploadBuffer(*buffer, frame * size % kBufferSize,
+                              data.data(), size);
+        uploader.Flush();
+      }
+      swap_chain->Present(device.get());
+    }
+    uploader.Wait(uploader.Flush());
+    auto us = timer.durationUs();
+    TEMP_LOG_TRACE("upload: ", size / kMiB, " MiB/frame, frame: ",
+                   us / 1000.0 / kFrames, " ms, ",
+                   (double)size * kFrames / us, " MB/s, transfer queue: ",
+                   uploader.uses_transfer_queue());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_compute)
+
+BOOST_AUTO_TEST_CASE(dispatch) {
+  const std::uint32_t kCount = 1024;
+  const std::uint32_t kLocalSize = 64;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  gfx::vulkan::VulkanComputeQueue queue(*vk_device);
+
+  // キューをまたいで使うので、非同期なら所有権の移動なしで共有させる
+  std::vector<std::uint32_t> queue_families = {
+      static_cast<std::uint32_t>(vk_device->graphics_queue_index()),
+      queue.queue_family_index()};
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = sizeof(std::uint32_t) * kCount;
+  buffer_ci.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+  if (queue.async()) {
+    buffer_ci.sharingMode = vk::SharingMode::eConcurrent;
+    buffer_ci.queueFamilyIndexCount =
+        static_cast<std::uint32_t>(queue_families.size());
+    buffer_ci.pQueueFamilyIndices = queue_families.data();
+  }
+  auto buffer = vk_device->device().createBufferUnique(buffer_ci);
+  auto memory = vk_device->memory_allocator().AllocateBufferMemory(
+      *buffer, vk::MemoryPropertyFlagBits::eHostVisible |
+                   vk::MemoryPropertyFlagBits::eHostCoherent);
+  auto values = static_cast<std::uint32_t*>(memory->mapped);
+  for (std::uint32_t i = 0; i < kCount; ++i) {
+    values[i] = i;
+  }
+
+  gfx::vulkan::VulkanComputePipeline pipeline(vk_device->device(),
+                                              kDoubleIncrementSpirv, 1);
+  auto descriptor_set = pipeline.CreateDescriptorSet(
+      {vk::DescriptorBufferInfo(*buffer, 0, VK_WHOLE_SIZE)});
+  auto record = [&](vk::CommandBuffer command_buffer) {
+    pipeline.Dispatch(command_buffer, *descriptor_set, nullptr,
+                      vk::Extent3D(kCount / kLocalSize, 1, 1));
+    vk::MemoryBarrier barrier(vk::AccessFlagBits::eShaderWrite,
+                              vk::AccessFlagBits::eHostRead);
+    command_buffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                   vk::PipelineStageFlagBits::eHost,
+                                   vk::DependencyFlags(), barrier, nullptr,
+                                   nullptr);
+  };
+
+  auto ticket = queue.Submit(record);
+  queue.Wait(ticket);
+  BOOST_TEST(queue.IsCompleted(ticket));
+  for (std::uint32_t i = 0; i < kCount; ++i) {
+    BOOST_TEST_REQUIRE(values[i] == i * 2 + 1);
+  }
+
+  // グラフィックスキューとの順序をつけても結果は同じ
+  ticket = queue.Submit(record, queue.SignalGraphics());
+  queue.WaitOnGraphicsQueue(ticket);
+  queue.Wait(ticket);
+  for (std::uint32_t i = 0; i < kCount; ++i) {
+    BOOST_TEST_REQUIRE(values[i] == (i * 2 + 1) * 2 + 1);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_pipeline_state_cache)
+
+BOOST_AUTO_TEST_CASE(hash) {
+  auto a = createPipelineState(vk::PipelineLayout(), vk::RenderPass());
+  auto b = createPipelineState(vk::PipelineLayout(), vk::RenderPass());
+  BOOST_TEST((a == b));
+  BOOST_TEST(a.Hash() == b.Hash());
+
+  b.cull_mode = vk::CullModeFlagBits::eNone;
+  BOOST_TEST((a != b));
+  BOOST_TEST(a.Hash() != b.Hash());
+
+  b = a;
+  b.fragment_shader.back() = 0;
+  BOOST_TEST((a != b));
+  BOOST_TEST(a.Hash() != b.Hash());
+}
+
+BOOST_AUTO_TEST_CASE(prepare) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  auto layout = vk_device->device().createPipelineLayoutUnique(
+      vk::PipelineLayoutCreateInfo());
+
+  gfx::vulkan::VulkanPipelineStateCache cache(*vk_device);
+  auto states = createPipelineStates(*layout, offscreen->render_pass());
+  for (auto&& state : states) {
+    cache.Prepare(state);
+  }
+  cache.WaitForCompilation();
+  BOOST_TEST(cache.pipeline_count() == states.size());
+
+  // 同じステートには同じパイプラインを返す
+  for (auto&& state : states) {
+    auto pipeline = cache.FindPipeline(state);
+    BOOST_TEST((pipeline != vk::Pipeline()));
+    BOOST_TEST((cache.GetPipeline(state) == pipeline));
+  }
+  BOOST_TEST(cache.pipeline_count() == states.size());
+}
+
+BOOST_AUTO_TEST_CASE(broken_file) {
+  const std::string kFilePath = "pipeline_state_cache_broken.bin";
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  auto layout = vk_device->device().createPipelineLayoutUnique(
+      vk::PipelineLayoutCreateInfo());
+  auto state = createPipelineState(*layout, offscreen->render_pass());
+
+  std::remove(kFilePath.c_str());
+  {
+    gfx::vulkan::VulkanPipelineStateCache cache(*vk_device, kFilePath);
+    cache.GetPipeline(state);
+    BOOST_TEST_REQUIRE(cache.Save());
+  }
+  std::vector<char> bytes;
+  {
+    std::ifstream fs(kFilePath, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(fs),
+                 std::istreambuf_iterator<char>());
+  }
+  auto load = [&](const std::vector<char>& contents) {
+    {
+      std::ofstream fs(kFilePath, std::ios::binary | std::ios::trunc);
+      fs.write(contents.data(), contents.size());
+    }
+    gfx::vulkan::VulkanPipelineStateCache cache(*vk_device, kFilePath);
+    return cache.loaded();
+  };
+
+  // ヘッダーのサイズとファイルの残りが合わなければ捨てる
+  BOOST_TEST(load(bytes));
+  auto truncated = bytes;
+  truncated.pop_back();
+  BOOST_TEST(!load(truncated));
+  auto extended = bytes;
+  extended.push_back(0);
+  BOOST_TEST(!load(extended));
+  std::remove(kFilePath.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  const std::string kFilePath = "pipeline_state_cache.bin";
+  const std::size_t kWorkers = 4;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  auto layout = vk_device->device().createPipelineLayoutUnique(
+      vk::PipelineLayoutCreateInfo());
+  auto states = createPipelineStates(*layout, offscreen->render_pass());
+
+  // 起動時にすべてのパイプラインを用意する時間を、ファイルがない場合と
+  // 前回の実行で保存された場合で比べる
+  std::remove(kFilePath.c_str());
+  for (bool warm : {false, true}) {
+    temp::Timer timer;
+    gfx::vulkan::VulkanPipelineStateCache cache(*vk_device, kFilePath,
+                                                kWorkers);
+    BOOST_TEST(cache.loaded() == warm);
+    for (auto&& state : states) {
+      cache.Prepare(state);
+    }
+    cache.WaitForCompilation();
+    auto us = timer.durationUs();
+    TEMP_LOG_TRACE(warm ? "warm" : "cold", " pipeline cache: ",
+                   states.size(), " pipelines, ", us / 1000.0, " ms");
+  }
+  std::remove(kFilePath.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_render_pass_cache)
+
+BOOST_AUTO_TEST_CASE(share) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  auto&& cache = vk_device->render_pass_cache();
+  auto main_swap_chain = static_cast<gfx::vulkan::VulkanSwapChain*>(
+      device->main_swap_chain());
+  auto render_pass_count = cache.render_pass_count();
+  auto framebuffer_count = cache.framebuffer_count();
+
+  // 同じ形式のスワップチェインはレンダーパスを作らない
+  std::shared_ptr<gfx::SwapChain> swap_chain =
+      device->CreateSwapChain(nullptr, kWidth, kHeight);
+  auto offscreen =
+      static_cast<gfx::vulkan::VulkanOffscreenSwapChain*>(swap_chain.get());
+  BOOST_TEST((offscreen->render_pass() == main_swap_chain->render_pass()));
+  BOOST_TEST(cache.render_pass_count() == render_pass_count);
+  BOOST_TEST(cache.framebuffer_count() ==
+             framebuffer_count + offscreen->image_count());
+
+  gfx::vulkan::FramebufferState state;
+  state.render_pass = offscreen->render_pass();
+  state.attachments = {*offscreen->image(0).view};
+  state.width = kWidth;
+  state.height = kHeight;
+  BOOST_TEST((cache.GetFramebuffer(state) == offscreen->frame_buffer(0)));
+
+  // 作り直したイメージのフレームバッファと入れ替わり、古いものは残らない
+  swap_chain->Resize(device.get(), kWidth * 2, kHeight * 2);
+  BOOST_TEST(cache.framebuffer_count() ==
+             framebuffer_count + offscreen->image_count());
+
+  swap_chain.reset();
+  BOOST_TEST(cache.framebuffer_count() == framebuffer_count);
+  BOOST_TEST(cache.render_pass_count() == render_pass_count);
+}
+
+BOOST_AUTO_TEST_CASE(depth) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  auto&& cache = vk_device->render_pass_cache();
+  auto depth_formats = vk_device->GetSupportedDepthFormats();
+  BOOST_TEST_REQUIRE(!depth_formats.empty());
+
+  auto state = gfx::vulkan::RenderPassState::Color(
+      vk::Format::eR8G8B8A8Unorm, vk::ImageLayout::eTransferSrcOptimal);
+  auto color_render_pass = cache.GetRenderPass(state);
+  auto&& depth = state.depth_stencil_attachment;
+  depth.format = depth_formats[0];
+  depth.loadOp = vk::AttachmentLoadOp::eClear;
+  depth.storeOp = vk::AttachmentStoreOp::eDontCare;
+  depth.finalLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+  auto depth_render_pass = cache.GetRenderPass(state);
+
+  BOOST_TEST((depth_render_pass != color_render_pass));
+  BOOST_TEST((cache.GetRenderPass(state) == depth_render_pass));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(vulkan_descriptor)
+
+BOOST_AUTO_TEST_CASE(layout_cache) {
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  gfx::vulkan::VulkanDescriptorSetLayoutCache cache(*vk_device);
+
+  std::vector<vk::DescriptorSetLayoutBinding> bindings = {
+      {0, vk::DescriptorType::eUniformBuffer, 1,
+       vk::ShaderStageFlagBits::eVertex},
+      {1, vk::DescriptorType::eCombinedImageSampler, 2,
+       vk::ShaderStageFlagBits::eFragment}};
+  auto&& layout = cache.GetLayout(bindings);
+  BOOST_TEST((cache.GetLayout(bindings).layout == layout.layout));
+  BOOST_TEST(cache.layout_count() == 1);
+  BOOST_TEST(layout.data_size == sizeof(vk::DescriptorBufferInfo) +
+                                     2 * sizeof(vk::DescriptorImageInfo));
+
+  bindings[1].descriptorCount = 3;
+  BOOST_TEST((cache.GetLayout(bindings).layout != layout.layout));
+  BOOST_TEST(cache.layout_count() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(allocator) {
+  const std::uint32_t kFrameCount = 2;
+  const int kFrames = 8;
+  const int kSetsPerFrame = 1000;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  gfx::vulkan::VulkanDescriptorSetLayoutCache cache(*vk_device);
+  gfx::vulkan::VulkanDescriptorAllocator allocator(*vk_device, kFrameCount);
+
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = 256;
+  buffer_ci.usage = vk::BufferUsageFlagBits::eUniformBuffer |
+                    vk::BufferUsageFlagBits::eStorageBuffer;
+  auto buffer = vk_device->device().createBufferUnique(buffer_ci);
+  auto memory = vk_device->memory_allocator().AllocateBufferMemory(
+      *buffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  // 描画ごとに使うようなバインディングで、テンプレートの配置どおりのデータ
+  auto&& layout = cache.GetLayout(
+      {{0, vk::DescriptorType::eUniformBuffer, 1,
+        vk::ShaderStageFlagBits::eVertex},
+       {1, vk::DescriptorType::eStorageBuffer, 1,
+        vk::ShaderStageFlagBits::eVertex}});
+  vk::DescriptorBufferInfo data[] = {{*buffer, 0, 128}, {*buffer, 128, 128}};
+  BOOST_TEST(layout.data_size == sizeof(data));
+
+  std::size_t pool_count = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    temp::Timer timer;
+    allocator.BeginFrame(frame % kFrameCount);
+    for (int i = 0; i < kSetsPerFrame; ++i) {
+      auto set = allocator.Allocate(layout);
+      cache.UpdateDescriptorSet(set, layout, data);
+    }
+    TEMP_LOG_TRACE("descriptor sets: ", kSetsPerFrame, ", ",
+                   timer.durationUs() / 1000.0, " ms, update template: ",
+                   vk_device->descriptor_update_template_enabled());
+
+    // すべてのフレームが一巡したら、リセットしたプールだけで足りる
+    if (frame == kFrameCount - 1) {
+      pool_count = allocator.pool_count();
+    }
+  }
+  BOOST_TEST(allocator.pool_count() == pool_count);
+}
+
+BOOST_AUTO_TEST_CASE(all_types) {
+  const int kSets = 200;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  gfx::vulkan::VulkanDescriptorSetLayoutCache cache(*vk_device);
+  gfx::vulkan::VulkanDescriptorAllocator allocator(*vk_device, 1);
+  allocator.BeginFrame(0);
+
+  // キャッシュが受け付ける種類はどれもプールから割り当てられる
+  const vk::DescriptorType kTypes[] = {
+      vk::DescriptorType::eSampler,
+      vk::DescriptorType::eCombinedImageSampler,
+      vk::DescriptorType::eSampledImage,
+      vk::DescriptorType::eStorageImage,
+      vk::DescriptorType::eUniformTexelBuffer,
+      vk::DescriptorType::eStorageTexelBuffer,
+      vk::DescriptorType::eUniformBuffer,
+      vk::DescriptorType::eStorageBuffer,
+      vk::DescriptorType::eUniformBufferDynamic,
+      vk::DescriptorType::eStorageBufferDynamic,
+      vk::DescriptorType::eInputAttachment};
+  for (auto type : kTypes) {
+    auto&& layout = cache.GetLayout(
+        {{0, type, 1, vk::ShaderStageFlagBits::eFragment}});
+    for (int i = 0; i < kSets; ++i) {
+      BOOST_TEST((allocator.Allocate(layout) != vk::DescriptorSet()));
+    }
+  }
+  BOOST_TEST(cache.layout_count() == std::size(kTypes));
+}
+
+BOOST_AUTO_TEST_CASE(bindless) {
+  const std::uint32_t kFrameCount = 2;
+
+  auto device =
+      gfx::CreateDevice(gfx::ApiType::kVulkan, nullptr, kWidth, kHeight);
+  auto vk_device = static_cast<gfx::vulkan::VulkanDevice*>(device.get());
+  if (!vk_device->descriptor_indexing_enabled()) {
+    BOOST_TEST_MESSAGE("descriptor indexing is not supported");
+    return;
+  }
+  gfx::vulkan::VulkanBindlessDescriptorSet set(*vk_device, kFrameCount, 16,
+                                               16);
+
+  vk::BufferCreateInfo buffer_ci;
+  buffer_ci.size = 256;
+  buffer_ci.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+  auto buffer = vk_device->device().createBufferUnique(buffer_ci);
+  auto memory = vk_device->memory_allocator().AllocateBufferMemory(
+      *buffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+  set.BeginFrame(0);
+  auto a = set.AddBuffer(*buffer);
+  auto b = set.AddBuffer(*buffer);
+  BOOST_TEST(a != b);
+  set.RemoveBuffer(a);
+
+  // 外したフレームがまた始まるまで、実行中のフレームが読むかもしれない
+  set.BeginFrame(1);
+  auto c = set.AddBuffer(*buffer);
+  BOOST_TEST(c != a);
+
+  set.BeginFrame(0);
+  BOOST_TEST(set.AddBuffer(*buffer) == a);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
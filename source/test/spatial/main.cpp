@@ -0,0 +1,582 @@
+﻿#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "temp/base/logger.h"
+#include "temp/base/thread_pool.h"
+#include "temp/base/timer.h"
+#include "temp/math/temp_math.h"
+#include "temp/spatial/spatial.h"
+
+using namespace temp::math;
+using temp::spatial::AabbTree;
+using temp::spatial::TransformHierarchy;
+namespace utf = boost::unit_test;
+
+namespace {
+// Boxes with centers in [-range, range] and sizes up to max_size.
+std::vector<Aabb> randomAabbs(std::mt19937& engine, std::size_t count,
+                              float range, float max_size) {
+  std::uniform_real_distribution<float> position(-range, range);
+  std::uniform_real_distribution<float> size(0.0f, max_size);
+  std::vector<Aabb> aabbs;
+  for (std::size_t i = 0; i < count; ++i) {
+    Vector3 c(position(engine), position(engine), position(engine));
+    Vector3 e(size(engine), size(engine), size(engine));
+    aabbs.push_back(Aabb::fromCenterExtent(c, e * 0.5f));
+  }
+  return aabbs;
+}
+
+// Left handed perspective (+z forward, depth 0..1) looking from
+// (0, 0, -range) to the origin. zoom 1 is a 90 degree fov.
+Frustum testFrustum(float range, float zoom = 1.0f) {
+  float near = 1.0f;
+  float far = range * 2.0f;
+  float a = far / (far - near);
+  auto proj = Matrix44(zoom, 0, 0, 0,  //
+                       0, zoom, 0, 0,  //
+                       0, 0, a, -a * near,  //
+                       0, 0, 1, 0);
+  auto view = Matrix44(1, 0, 0, 0,  //
+                       0, 1, 0, 0,  //
+                       0, 0, 1, range,  //
+                       0, 0, 0, 1);
+  return extractFrustum(proj * view);
+}
+
+template <class Query>
+std::vector<AabbTree::ProxyId> collect(const AabbTree& tree,
+                                       const Query& query) {
+  std::vector<AabbTree::ProxyId> result;
+  tree.query(query, [&](AabbTree::ProxyId id) { result.push_back(id); });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+// Proxies whose fat box passes pred, found by a linear scan.
+template <class Pred>
+std::vector<AabbTree::ProxyId> linear(const AabbTree& tree,
+                                      const std::vector<AabbTree::ProxyId>& ids,
+                                      Pred pred) {
+  std::vector<AabbTree::ProxyId> result;
+  for (auto id : ids) {
+    if (pred(tree.fatAabb(id))) {
+      result.push_back(id);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+void checkQueries(const AabbTree& tree,
+                  const std::vector<AabbTree::ProxyId>& ids,
+                  std::mt19937& engine) {
+  for (const auto& box : randomAabbs(engine, 20, 100.0f, 40.0f)) {
+    auto expected = linear(tree, ids, [&](const Aabb& a) {
+      return intersects(a, box);
+    });
+    BOOST_TEST(collect(tree, box) == expected);
+  }
+  std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+  for (int i = 0; i < 20; ++i) {
+    Sphere sphere{Vector3(position(engine), position(engine), position(engine)),
+                  20.0f};
+    auto expected = linear(tree, ids, [&](const Aabb& a) {
+      return intersects(a, sphere);
+    });
+    BOOST_TEST(collect(tree, sphere) == expected);
+  }
+  auto frustum = testFrustum(100.0f);
+  auto expected = linear(tree, ids, [&](const Aabb& a) {
+    return intersects(frustum, a);
+  });
+  BOOST_TEST(collect(tree, frustum) == expected);
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(aabb_tree)
+BOOST_AUTO_TEST_CASE(empty) {
+  AabbTree tree;
+  tree.validate();
+  BOOST_TEST(tree.height() == -1);
+  BOOST_TEST(collect(tree, Aabb{Vector3(-1, -1, -1), Vector3(1, 1, 1)})
+                 .empty());
+  auto hit = tree.raycast(Ray{Vector3(), Vector3(0, 0, 1)}, 100.0f,
+                          [](AabbTree::ProxyId) { return 0.0f; });
+  BOOST_TEST(hit == AabbTree::kNullProxy);
+  tree.rebuild();
+  tree.validate();
+}
+
+BOOST_AUTO_TEST_CASE(insert_remove) {
+  std::mt19937 engine(71);
+  auto aabbs = randomAabbs(engine, 2000, 100.0f, 5.0f);
+  AabbTree tree(0.5f);
+  std::vector<AabbTree::ProxyId> ids;
+  for (std::size_t i = 0; i < aabbs.size(); ++i) {
+    ids.push_back(tree.insert(aabbs[i], i));
+  }
+  tree.validate();
+  BOOST_TEST(tree.proxyCount() == aabbs.size());
+  BOOST_TEST(tree.userData(ids[10]) == 10u);
+  // 平衡していれば高さは log2(n) の数倍に収まる
+  BOOST_TEST(tree.height() < 30);
+  checkQueries(tree, ids, engine);
+
+  std::vector<AabbTree::ProxyId> kept;
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    if (i % 3 == 0) {
+      tree.remove(ids[i]);
+    } else {
+      kept.push_back(ids[i]);
+    }
+  }
+  tree.validate();
+  BOOST_TEST(tree.proxyCount() == kept.size());
+  checkQueries(tree, kept, engine);
+
+  // 空いたidは再利用される
+  auto reused = tree.insert(aabbs[0], 0);
+  BOOST_TEST(reused % 3 == 0);
+  tree.validate();
+}
+
+BOOST_AUTO_TEST_CASE(update_refit_rebuild) {
+  std::mt19937 engine(73);
+  auto aabbs = randomAabbs(engine, 2000, 100.0f, 5.0f);
+  AabbTree tree(1.0f);
+  std::vector<AabbTree::ProxyId> ids;
+  for (const auto& aabb : aabbs) {
+    ids.push_back(tree.insert(aabb));
+  }
+
+  std::uniform_real_distribution<float> step(-2.0f, 2.0f);
+  int reinserted = 0;
+  for (int frame = 0; frame < 10; ++frame) {
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      Vector3 d(step(engine), step(engine), step(engine));
+      aabbs[i] = Aabb{aabbs[i].min + d * 0.1f, aabbs[i].max + d * 0.1f};
+      if (i % 2 == 0) {
+        reinserted += tree.update(ids[i], aabbs[i]) ? 1 : 0;
+      } else {
+        tree.refit(ids[i], aabbs[i]);
+      }
+    }
+  }
+  tree.validate();
+  BOOST_TEST(reinserted > 0);
+  BOOST_TEST(reinserted < 10 * 1000);
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    const auto& fat = tree.fatAabb(ids[i]);
+    BOOST_TEST((contains(fat, aabbs[i].min) && contains(fat, aabbs[i].max)));
+  }
+  checkQueries(tree, ids, engine);
+
+  auto incremental_cost = tree.cost();
+  tree.rebuild();
+  tree.validate();
+  TEMP_LOG_TRACE("SAH cost incremental: ", incremental_cost,
+                 ", rebuilt: ", tree.cost());
+  BOOST_TEST(tree.cost() < incremental_cost);
+  checkQueries(tree, ids, engine);
+
+  // 再構築後も追加と削除ができる
+  tree.remove(ids[5]);
+  ids.erase(ids.begin() + 5);
+  ids.push_back(tree.insert(aabbs[5]));
+  tree.validate();
+  checkQueries(tree, ids, engine);
+}
+
+BOOST_AUTO_TEST_CASE(raycast_) {
+  std::mt19937 engine(79);
+  auto aabbs = randomAabbs(engine, 2000, 100.0f, 5.0f);
+  AabbTree tree(0.5f);
+  for (const auto& aabb : aabbs) {
+    tree.insert(aabb);
+  }
+  tree.rebuild();
+
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (int i = 0; i < 100; ++i) {
+    Ray ray{Vector3(dist(engine), dist(engine), dist(engine)) * 100.0f,
+            normalize(Vector3(dist(engine), dist(engine), dist(engine)))};
+    float expected = 150.0f;
+    AabbTree::ProxyId expected_id = AabbTree::kNullProxy;
+    for (std::size_t j = 0; j < aabbs.size(); ++j) {
+      float d = intersectDistance(ray, aabbs[j]);
+      if (d < expected) {
+        expected = d;
+        expected_id = static_cast<AabbTree::ProxyId>(j);
+      }
+    }
+
+    float distance = 0.0f;
+    auto hit = tree.raycast(
+        ray, 150.0f,
+        [&](AabbTree::ProxyId id) { return intersectDistance(ray, aabbs[id]); },
+        &distance);
+    BOOST_TEST(hit == expected_id);
+    BOOST_TEST(distance == expected);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  for (std::size_t count : {10000, 100000, 1000000}) {
+    std::mt19937 engine(83);
+    auto aabbs = randomAabbs(engine, count, 1000.0f, 4.0f);
+    AabbTree tree;
+    temp::Timer build_timer;
+    for (const auto& aabb : aabbs) {
+      tree.insert(aabb);
+    }
+    auto insert_us = build_timer.durationUs();
+    build_timer = temp::Timer();
+    tree.rebuild();
+    auto rebuild_us = build_timer.durationUs();
+    TEMP_LOG_TRACE(count, " objects: insert ", insert_us, " us, rebuild ",
+                   rebuild_us, " us, height ", tree.height());
+
+    auto boxes = randomAabbs(engine, 100, 1000.0f, 50.0f);
+    auto bench = [](const char* name, auto func) {
+      temp::Timer timer;
+      std::size_t hits = func();
+      TEMP_LOG_TRACE("  ", name, ": ", timer.durationUs(), " us (", hits,
+                     " hits)");
+      return hits;
+    };
+    auto tree_box = bench("100 box queries, tree", [&] {
+      std::size_t hits = 0;
+      for (const auto& box : boxes) {
+        tree.query(box, [&](AabbTree::ProxyId) { ++hits; });
+      }
+      return hits;
+    });
+    auto linear_box = bench("100 box queries, linear", [&] {
+      std::size_t hits = 0;
+      for (const auto& box : boxes) {
+        for (const auto& aabb : aabbs) {
+          hits += intersects(aabb, box) ? 1 : 0;
+        }
+      }
+      return hits;
+    });
+    BOOST_TEST(tree_box == linear_box);
+
+    // 視野の狭いカメラで一部だけが見える場合
+    auto frustum = testFrustum(1000.0f, 8.0f);
+    auto tree_frustum = bench("frustum query, tree", [&] {
+      std::size_t hits = 0;
+      tree.query(frustum, [&](AabbTree::ProxyId) { ++hits; });
+      return hits;
+    });
+    auto linear_frustum = bench("frustum query, linear", [&] {
+      std::size_t hits = 0;
+      for (const auto& aabb : aabbs) {
+        hits += intersects(frustum, aabb) ? 1 : 0;
+      }
+      return hits;
+    });
+    BOOST_TEST(tree_frustum == linear_frustum);
+
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < 100; ++i) {
+      rays.push_back(
+          Ray{Vector3(dist(engine), dist(engine), dist(engine)) * 1000.0f,
+              normalize(Vector3(dist(engine), dist(engine), dist(engine)))});
+    }
+    auto tree_ray = bench("100 raycasts, tree", [&] {
+      std::size_t hits = 0;
+      for (const auto& ray : rays) {
+        auto hit = tree.raycast(ray, 2000.0f, [&](AabbTree::ProxyId id) {
+          return intersectDistance(ray, aabbs[id]);
+        });
+        hits += hit != AabbTree::kNullProxy ? 1 : 0;
+      }
+      return hits;
+    });
+    auto linear_ray = bench("100 raycasts, linear", [&] {
+      std::size_t hits = 0;
+      for (const auto& ray : rays) {
+        float closest = 2000.0f;
+        for (const auto& aabb : aabbs) {
+          closest = std::min(closest, intersectDistance(ray, aabb));
+        }
+        hits += closest < 2000.0f ? 1 : 0;
+      }
+      return hits;
+    });
+    BOOST_TEST(tree_ray == linear_ray);
+  }
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+namespace {
+Matrix44 localMatrix(const TransformHierarchy& hierarchy,
+                     TransformHierarchy::NodeId node) {
+  return Matrix44::scaleRotationTranslation(hierarchy.localScale(node),
+                                            hierarchy.localRotation(node),
+                                            hierarchy.localPosition(node));
+}
+
+// World matrix multiplied out along the ancestors.
+Matrix44 referenceWorld(const TransformHierarchy& hierarchy,
+                        TransformHierarchy::NodeId node) {
+  auto world = localMatrix(hierarchy, node);
+  for (auto p = hierarchy.parent(node); p != TransformHierarchy::kNullNode;
+       p = hierarchy.parent(p)) {
+    world = localMatrix(hierarchy, p) * world;
+  }
+  return world;
+}
+
+float maxDifference(const Matrix44& lhs, const Matrix44& rhs) {
+  float result = 0.0f;
+  for (int r = 0; r < 4; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      result = std::max(result, std::abs(lhs[r][c] - rhs[r][c]));
+    }
+  }
+  return result;
+}
+
+void checkWorlds(const TransformHierarchy& hierarchy,
+                 const std::vector<TransformHierarchy::NodeId>& nodes) {
+  float error = 0.0f;
+  for (auto node : nodes) {
+    error = std::max(error, maxDifference(hierarchy.worldMatrix(node),
+                                          referenceWorld(hierarchy, node)));
+  }
+  BOOST_TEST(error < 0.001f);
+}
+
+void randomLocal(TransformHierarchy& hierarchy,
+                 TransformHierarchy::NodeId node, std::mt19937& engine) {
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  hierarchy.setLocal(
+      node,
+      Vector3(1.0f + dist(engine) * 0.1f, 1.0f + dist(engine) * 0.1f,
+              1.0f + dist(engine) * 0.1f),
+      Quaternion::axisAngle(
+          normalize(Vector3(dist(engine), dist(engine), dist(engine))),
+          dist(engine) * 180.0f),
+      Vector3(dist(engine), dist(engine), dist(engine)));
+}
+
+// Forest of object_count trees, each a random recursive tree of
+// object_size nodes. Returns parent offsets where -1 is a root.
+std::vector<std::int32_t> randomForest(std::mt19937& engine,
+                                       std::size_t object_count,
+                                       std::size_t object_size) {
+  std::vector<std::int32_t> parents;
+  for (std::size_t o = 0; o < object_count; ++o) {
+    auto base = static_cast<std::int32_t>(parents.size());
+    parents.push_back(-1);
+    for (std::size_t i = 1; i < object_size; ++i) {
+      auto last = static_cast<std::int32_t>(i) - 1;
+      std::uniform_int_distribution<std::int32_t> parent(0, last);
+      parents.push_back(base + parent(engine));
+    }
+  }
+  return parents;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(transform_hierarchy)
+BOOST_AUTO_TEST_CASE(basic, *utf::tolerance(0.0001f)) {
+  TransformHierarchy hierarchy;
+  auto root = hierarchy.create();
+  auto child = hierarchy.create(root);
+  auto grandchild = hierarchy.create(child);
+  BOOST_TEST(hierarchy.size() == 3u);
+  BOOST_TEST(hierarchy.parent(grandchild) == child);
+
+  hierarchy.setLocalPosition(root, Vector3(1, 0, 0));
+  hierarchy.setLocalScale(child, Vector3(2, 2, 2));
+  hierarchy.setLocalPosition(grandchild, Vector3(0, 1, 0));
+  hierarchy.update();
+  auto p = transform(Vector3(), hierarchy.worldMatrix(grandchild));
+  BOOST_TEST(p.x() == 1.0f);
+  BOOST_TEST(p.y() == 2.0f);
+
+  // 親を付け替えると子孫の行列も変わる
+  hierarchy.setParent(child, TransformHierarchy::kNullNode);
+  hierarchy.update();
+  p = transform(Vector3(), hierarchy.worldMatrix(grandchild));
+  BOOST_TEST(p.x() == 0.0f);
+  BOOST_TEST(p.y() == 2.0f);
+
+  hierarchy.destroy(child);
+  BOOST_TEST(hierarchy.size() == 1u);
+  auto reused = hierarchy.create(root);
+  BOOST_TEST((reused == child || reused == grandchild));
+  hierarchy.update();
+  p = transform(Vector3(), hierarchy.worldMatrix(reused));
+  BOOST_TEST(p.x() == 1.0f);
+}
+
+BOOST_AUTO_TEST_CASE(random_changes) {
+  std::mt19937 engine(89);
+  auto parents = randomForest(engine, 20, 300);
+  // 小さいグループでグループ分けと読み飛ばしを通す
+  TransformHierarchy hierarchy(64);
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for (auto p : parents) {
+    nodes.push_back(hierarchy.create(p < 0 ? TransformHierarchy::kNullNode
+                                           : nodes[p]));
+  }
+  for (auto node : nodes) {
+    randomLocal(hierarchy, node, engine);
+  }
+  hierarchy.update();
+  checkWorlds(hierarchy, nodes);
+
+  std::uniform_int_distribution<std::size_t> pick(0, nodes.size() - 1);
+  for (int frame = 0; frame < 5; ++frame) {
+    for (int i = 0; i < 30; ++i) {
+      randomLocal(hierarchy, nodes[pick(engine)], engine);
+    }
+    hierarchy.update();
+    checkWorlds(hierarchy, nodes);
+  }
+
+  // 構造の変更: 付け替えと部分木の削除
+  for (int i = 0; i < 20; ++i) {
+    auto node = nodes[pick(engine)];
+    auto parent = nodes[pick(engine)];
+    bool descendant = false;
+    for (auto p = parent; p != TransformHierarchy::kNullNode;
+         p = hierarchy.parent(p)) {
+      descendant = descendant || p == node;
+    }
+    if (!descendant) {
+      hierarchy.setParent(node, parent);
+    }
+  }
+  auto removed = nodes[1];
+  std::vector<TransformHierarchy::NodeId> alive;
+  for (auto node : nodes) {
+    bool dead = false;
+    for (auto p = node; p != TransformHierarchy::kNullNode;
+         p = hierarchy.parent(p)) {
+      dead = dead || p == removed;
+    }
+    if (!dead) {
+      alive.push_back(node);
+    }
+  }
+  hierarchy.destroy(removed);
+  BOOST_TEST(hierarchy.size() == alive.size());
+  hierarchy.update();
+  checkWorlds(hierarchy, alive);
+
+  temp::ThreadPool pool(4);
+  for (int frame = 0; frame < 3; ++frame) {
+    for (int i = 0; i < 30; ++i) {
+      randomLocal(hierarchy, alive[pick(engine) % alive.size()], engine);
+    }
+    hierarchy.update(pool);
+    checkWorlds(hierarchy, alive);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(benchmark) {
+  constexpr std::size_t kObjects = 1000;
+  constexpr std::size_t kObjectSize = 1000;
+  std::mt19937 engine(97);
+  auto parents = randomForest(engine, kObjects, kObjectSize);
+  std::vector<Vector3> positions;
+  std::vector<Quaternion> rotations;
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  for (std::size_t i = 0; i < parents.size(); ++i) {
+    positions.emplace_back(dist(engine), dist(engine), dist(engine));
+    rotations.push_back(
+        Quaternion::axisAngle(Vector3(0, 1, 0), dist(engine) * 180.0f));
+  }
+
+  // 比較対象: ノードごとに確保して子を再帰でたどる
+  struct NaiveNode {
+    Vector3 position;
+    Quaternion rotation;
+    Matrix44 world;
+    std::vector<NaiveNode*> children;
+  };
+  std::vector<std::unique_ptr<NaiveNode>> naive_nodes;
+  std::vector<NaiveNode*> naive_roots;
+  for (std::size_t i = 0; i < parents.size(); ++i) {
+    naive_nodes.push_back(std::make_unique<NaiveNode>());
+    naive_nodes[i]->position = positions[i];
+    naive_nodes[i]->rotation = rotations[i];
+    if (parents[i] < 0) {
+      naive_roots.push_back(naive_nodes[i].get());
+    } else {
+      naive_nodes[parents[i]]->children.push_back(naive_nodes[i].get());
+    }
+  }
+  struct Naive {
+    static void update(NaiveNode* node, const Matrix44& parent_world) {
+      node->world = parent_world * Matrix44::scaleRotationTranslation(
+                                       Vector3(1, 1, 1), node->rotation,
+                                       node->position);
+      for (auto child : node->children) {
+        update(child, node->world);
+      }
+    }
+  };
+
+  TransformHierarchy hierarchy;
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for (std::size_t i = 0; i < parents.size(); ++i) {
+    nodes.push_back(hierarchy.create(
+        parents[i] < 0 ? TransformHierarchy::kNullNode : nodes[parents[i]]));
+    hierarchy.setLocalRotation(nodes[i], rotations[i]);
+    hierarchy.setLocalPosition(nodes[i], positions[i]);
+  }
+
+  auto bench = [](const char* name, auto func) {
+    temp::Timer timer;
+    func();
+    TEMP_LOG_TRACE(name, ": ", timer.durationUs(), " us");
+  };
+  auto moveObjects = [&](std::size_t count) {
+    for (std::size_t o = 0; o < count; ++o) {
+      hierarchy.setLocalPosition(nodes[o * kObjectSize],
+                                 positions[o * kObjectSize]);
+    }
+  };
+  TEMP_LOG_TRACE(parents.size(), " nodes in ", kObjects, " objects");
+  bench("naive recursive", [&] {
+    for (auto root : naive_roots) {
+      Naive::update(root, Matrix44::kIdentity);
+    }
+  });
+  bench("first update with sort", [&] { hierarchy.update(); });
+  moveObjects(kObjects);
+  bench("all objects moved", [&] { hierarchy.update(); });
+  moveObjects(kObjects / 100);
+  bench("1% of objects moved", [&] { hierarchy.update(); });
+  bench("nothing moved", [&] { hierarchy.update(); });
+
+  auto workers = std::max(2u, std::thread::hardware_concurrency());
+  temp::ThreadPool pool(workers);
+  moveObjects(kObjects);
+  bench("all objects moved, thread pool", [&] { hierarchy.update(pool); });
+  TEMP_LOG_TRACE("  ", workers, " workers, ",
+                 std::thread::hardware_concurrency(), " hardware threads");
+
+  float error = 0.0f;
+  for (std::size_t i = 0; i < nodes.size(); i += 997) {
+    error = std::max(error, maxDifference(hierarchy.worldMatrix(nodes[i]),
+                                          naive_nodes[i]->world));
+  }
+  BOOST_TEST(error < 0.001f);
+}
+BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file